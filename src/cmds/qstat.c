@@ -112,6 +112,10 @@ const char          *conflict_msg = "qstat: conflicting options.\n";
 static const char *summarize_arrays_extend_opt = "summarize_arrays";
 
 static bool print_header = true;
+
+/* jobs per reply when statusing many jobs, 0 to take them in one reply */
+#define DEFAULT_QSTAT_PAGE_SIZE 1000
+int                  page_size = DEFAULT_QSTAT_PAGE_SIZE;
 /* END globals */
 
 
@@ -2960,6 +2964,108 @@ int process_commandline_opts(
   }
 
 
+/*
+ * job_stat_extend()
+ *
+ * Adds the paging options to the extension of a job status request.
+ *
+ * @param base - the extension without paging
+ * @param after - the PAGE_NEXT value of the last page, or empty for the first
+ * @return the extension to send
+ */
+
+std::string job_stat_extend(
+
+  const char        *base,
+  const std::string &after)
+
+  {
+  std::string extend(base);
+  bool        trailing_c = false;
+  char        buf[64];
+
+  if (page_size <= 0)
+    return(extend);
+
+  /* the server reads a trailing C as condensed, so it has to stay last */
+  if ((condensed == true) &&
+      (extend.size() > 0) &&
+      (extend[extend.size() - 1] == 'C'))
+    {
+    extend.erase(extend.size() - 1);
+    trailing_c = true;
+    }
+
+  snprintf(buf, sizeof(buf), "%s%s%d,",
+    (extend.size() > 0) ? "," : "",
+    STATPAGESIZE,
+    page_size);
+  extend += buf;
+
+  if (after.size() > 0)
+    {
+    extend += STATPAGEAFTER;
+    extend += after;
+    extend += ",";
+    }
+
+  if (trailing_c == true)
+    extend += "C";
+
+  return(extend);
+  } /* END job_stat_extend() */
+
+
+
+/*
+ * take_page_cursor()
+ *
+ * Removes the PAGE_STATUS_NAME entry that ends a full page of a paged job
+ * status, so it isn't displayed as a job.
+ *
+ * @param pstatus - the page, updated if the entry was its only one
+ * @param next - set to the entry's PAGE_NEXT value, or cleared on the last page
+ */
+
+void take_page_cursor(
+
+  struct batch_status **pstatus,
+  std::string          &next)
+
+  {
+  struct batch_status *prev = NULL;
+  struct batch_status *pstat;
+  struct attrl        *pat;
+
+  next.clear();
+
+  for (pstat = *pstatus; pstat != NULL; prev = pstat, pstat = pstat->next)
+    {
+    if ((pstat->name == NULL) ||
+        (strcmp(pstat->name, PAGE_STATUS_NAME) != 0))
+      continue;
+
+    for (pat = pstat->attribs; pat != NULL; pat = pat->next)
+      {
+      if ((!strcmp(pat->name, PAGE_NEXT)) &&
+          (pat->value != NULL))
+        next = pat->value;
+      }
+
+    if (prev == NULL)
+      *pstatus = pstat->next;
+    else
+      prev->next = pstat->next;
+
+    pstat->next = NULL;
+    pbs_statfree(pstat);
+
+    break;
+    }
+  } /* END take_page_cursor() */
+
+
+
 int run_job_mode(
 
     bool have_args,
@@ -3120,7 +3226,7 @@ int run_job_mode(
                      connect,
                      job_id_out,
                      attrib,
-                     exec_only ? (char *)EXECQUEONLY : (char *)ExtendOpt.c_str(),
+                     (char *)job_stat_extend(exec_only ? EXECQUEONLY : ExtendOpt.c_str(), "").c_str(),
                      &any_failed);
 
         if (any_failed != PBSE_UNKJOBID)
@@ -3189,24 +3295,48 @@ int run_job_mode(
       }
     else
       {
-      int condition = TRUE;
+      std::string next_page;
+
+      /* show each page as it arrives, then ask for the next one */
+      while (p_status != NULL)
+        {
+        int condition = TRUE;
+
+        take_page_cursor(&p_status, next_page);
+
 #ifdef TCL_QSTAT
-      condition = tcl_stat("job", p_status, f_opt);
+        condition = tcl_stat("job", p_status, f_opt);
 #endif
 
-      if (alt_opt != 0)
-        {
-        altdsp_statjob(p_status, p_server, alt_opt);
-        }
-      else if ((f_opt == 0) ||
-               (condition))
-        {
-        display_statjob(p_status, print_header, f_opt, user);
-        }
+        if (alt_opt != 0)
+          {
+          altdsp_statjob(p_status, p_server, alt_opt);
+          }
+        else if ((f_opt == 0) ||
+                 (condition))
+          {
+          display_statjob(p_status, print_header, f_opt, user);
+          }
 
-      print_header = false;
+        print_header = false;
+        p_server = NULL;
 
-      pbs_statfree(p_status);
+        pbs_statfree(p_status);
+        p_status = NULL;
+
+        if (next_page.size() == 0)
+          break;
+
+        p_status = pbs_statjob_err(
+                     connect,
+                     job_id_out,
+                     attrib,
+                     (char *)job_stat_extend(exec_only ? EXECQUEONLY : ExtendOpt.c_str(), next_page).c_str(),
+                     &any_failed);
+
+        if (any_failed != PBSE_NONE)
+          errmsg = get_err_msg(any_failed, "job", connect, job_id_out);
+        }
       }
 
     pbs_disconnect(connect);
@@ -3501,6 +3631,9 @@ int main(
   if (getenv("PBS_QSTAT_NO_COMPLETE") != NULL)
     do_not_display_complete = true;
 
+  if (getenv("PBS_QSTAT_PAGE_SIZE") != NULL)
+    page_size = atoi(getenv("PBS_QSTAT_PAGE_SIZE"));
+
   rc = process_commandline_opts(argc, argv, &exec_only, &errflg);
   if (rc != PBSE_NONE)
     {
@@ -3523,6 +3656,10 @@ int main(
   if (condensed == true)
     ExtendOpt += "C";
 
+  /* an xml document has to come from a single reply */
+  if (DisplayXML == true)
+    page_size = 0;
+
   def_server = pbs_default();
 
   if (def_server == NULL)
@@ -2,6 +2,7 @@
 #define ARRAY_H
 
 #include <list>
+#include <vector>
 
 /* these are required if you include array.h */
 #include "pbs_ifl.h"
@@ -131,6 +132,36 @@ class array_info
   };
 
 
+/*
+ * array_index_ranges
+ *
+ * The sub job indices of an array request kept as the ranges the user gave
+ * ("0-99999" is one range, not 100000 ints), consumed from the front as the
+ * sub jobs are created.
+ */
+
+class array_index_ranges
+  {
+  std::vector<std::pair<int, int> > ranges;  /* inclusive, in request order */
+  size_t                            current; /* the range the next index comes from */
+  int                               next;
+  size_t                            remaining;
+
+  public:
+  array_index_ranges() : ranges(), current(0), next(-1), remaining(0)
+    {
+    }
+
+  int    parse(const char *range_str, int above);
+  int    front() const;
+  void   pop_front();
+  int    highest() const;
+  size_t size() const;
+  void   clear();
+  };
+
+
+
 /* pbs_server will keep a list of these structs, with one struct per job array*/
 
 class job_array
@@ -146,8 +177,8 @@ class job_array
   // order to not lose sub-jobs
   bool               ai_ghost_recovered;
 
-  // Vector of array sub jobs indices that haven't been created
-  std::vector<int>   uncreated_ids;
+  // array sub job indices that haven't been created
+  array_index_ranges uncreated_ids;
 
   pthread_mutex_t   *ai_mutex;
 
@@ -169,7 +200,7 @@ class job_array
   void update_array_values(int old_state, enum ArrayEventsEnum event, const char *job_id,
                             int job_exit_status);
   void create_job_if_needed();
-  int  get_next_index_to_create(int &internal_index);
+  int  get_next_index_to_create();
   void initialize_uncreated_ids();
 
   bool need_to_update_slot_limits() const;
@@ -135,6 +135,7 @@ struct svrattrl
 
   unsigned int   al_flags:
   ATRFLAG;   /* copy of attribute value flags */
+  unsigned int   al_arena:1;  /* carved from an attrlist_arena, not malloc'd */
 
   /* data follows directly after */
   };
@@ -374,6 +375,19 @@ void free_noop(pbs_attribute *attr);
 svrattrl *attrlist_alloc(int szname, int szresc, int szval);
 svrattrl *attrlist_create(const char *aname, const char *rname, int szval);
 void free_attrlist(tlist_head *attrhead);
+void free_attrlist_entry(svrattrl *pal);
+
+/*
+ * An attrlist_arena is a block of memory that attrlist_alloc() carves entries
+ * from while it is the calling thread's arena. Entries from an arena are
+ * released all at once by attrlist_arena_free().
+ */
+
+typedef struct attrlist_arena attrlist_arena;
+
+attrlist_arena *attrlist_arena_create(void);
+void            attrlist_arena_free(attrlist_arena *arena);
+attrlist_arena *attrlist_use_arena(attrlist_arena *arena);
 int  attr_atomic_set(svrattrl *plist, pbs_attribute *old,
                            pbs_attribute *new_attr, attribute_def *pdef, int limit,
                            int unkn, int privil, int *badattr);
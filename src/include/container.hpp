@@ -15,9 +15,12 @@
 #include <boost/multi_index/member.hpp>
 */
 #include <boost/unordered_map.hpp>
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 #include <pthread.h>
+#include <limits.h>
 #include <memory.h>
 #include <errno.h>
 #include "pbs_error.h"
@@ -27,8 +30,12 @@ extern bool exit_called;
 
 #define THING_NOT_FOUND    -2
 #define ALREADY_IN_LIST     9
+#define RANKS_INCOMPLETE   10
 #define ALWAYS_EMPTY_INDEX  0
 
+/* number of lock stripes in a sharded_index. Must be a power of 2 */
+#define DEFAULT_INDEX_SHARDS 64
+
 
 //#define CHECK_LOCKING
 
@@ -83,6 +90,375 @@ template <class T> class slot
   int     prev;
   };
 
+/* marks a bucket whose entry was removed, so probing continues past it */
+#define DELETED_BUCKET     -1
+#define INITIAL_BUCKETS    16
+
+/*
+ * one entry in an item_container's open-addressed id index. The id itself
+ * lives in the slot's item, so a bucket is just the id's hash and the slot
+ * index. Empty buckets have index == ALWAYS_EMPTY_INDEX.
+ */
+class bucket
+  {
+  public:
+  unsigned int hash;
+  int          index;
+  };
+
+/*
+ * hashes and compares ids either as std::strings or as plain char pointers so
+ * that lookups in a sharded_index don't need to build a std::string temporary
+ */
+class id_hash
+  {
+  public:
+  size_t operator() (
+
+    const char *id) const
+
+    {
+    /* FNV-1a */
+    size_t hash = 2166136261U;
+
+    while (*id != '\0')
+      {
+      hash ^= (unsigned char)*id++;
+      hash *= 16777619U;
+      }
+
+    return(hash);
+    }
+
+  size_t operator() (
+
+    const std::string &id) const
+
+    {
+    return((*this)(id.c_str()));
+    }
+  };
+
+class id_equal
+  {
+  public:
+  bool operator() (const std::string &lhs, const std::string &rhs) const
+    {
+    return(lhs == rhs);
+    }
+
+  bool operator() (const char *lhs, const std::string &rhs) const
+    {
+    return(rhs.compare(lhs) == 0);
+    }
+
+  bool operator() (const std::string &lhs, const char *rhs) const
+    {
+    return(lhs.compare(rhs) == 0);
+    }
+  };
+
+
+
+/*
+ * sharded_index
+ *
+ * A lock-striped id -> item map. The ids are spread across a fixed number of
+ * shards, each with its own read/write lock, so that lookups from many threads
+ * don't serialize on a single mutex. The index is only a lookup structure: it
+ * is kept up to date by the item_container it is attached to, and all ordering
+ * still lives in the container.
+ */
+
+template <class T>
+class sharded_index
+  {
+  public:
+
+  sharded_index(
+      
+    unsigned int num_shards = DEFAULT_INDEX_SHARDS) : shards(NULL), shard_mask(0)
+
+    {
+    unsigned int count = 1;
+
+    /* round up to a power of 2 so we can mask instead of mod */
+    while (count < num_shards)
+      count <<= 1;
+
+    shards = new shard[count];
+    shard_mask = count - 1;
+    }
+
+
+
+  ~sharded_index()
+    {
+    if (exit_called)
+      return;
+
+    delete [] shards;
+    }
+
+
+
+  void insert(
+      
+    std::string const &id,
+    T                  it)
+
+    {
+    shard &s = get_shard(id.c_str());
+
+    pthread_rwlock_wrlock(&s.lock);
+    s.map[id] = it;
+    pthread_rwlock_unlock(&s.lock);
+    }
+
+
+
+  void remove(
+      
+    std::string const &id)
+
+    {
+    shard &s = get_shard(id.c_str());
+
+    pthread_rwlock_wrlock(&s.lock);
+    s.map.erase(id);
+    pthread_rwlock_unlock(&s.lock);
+    }
+
+
+
+  /*
+   * find() - returns the item stored for id, or NULL if there isn't one
+   * Never inserts into the index and only takes the lock for id's shard.
+   */
+
+  T find(
+      
+    const char *id)
+
+    {
+    T    found = NULL;
+    shard &s = get_shard(id);
+
+    pthread_rwlock_rdlock(&s.lock);
+
+    typename shard_map::const_iterator it = s.map.find(id, id_hash(), id_equal());
+
+    if (it != s.map.end())
+      found = it->second;
+
+    pthread_rwlock_unlock(&s.lock);
+
+    return(found);
+    }
+
+
+
+  void clear()
+    {
+    for (unsigned int i = 0; i <= shard_mask; i++)
+      {
+      pthread_rwlock_wrlock(&shards[i].lock);
+      shards[i].map.clear();
+      pthread_rwlock_unlock(&shards[i].lock);
+      }
+    }
+
+
+
+  size_t shard_count() const
+    {
+    return(shard_mask + 1);
+    }
+
+
+
+  private:
+  typedef boost::unordered_map<std::string, T, id_hash, id_equal> shard_map;
+
+  class shard
+    {
+    public:
+    shard()
+      {
+      pthread_rwlock_init(&lock, NULL);
+      }
+
+    ~shard()
+      {
+      pthread_rwlock_destroy(&lock);
+      }
+
+    pthread_rwlock_t lock;
+    shard_map        map;
+    /* keep neighboring shards' locks off of the same cache line */
+    char             pad[64];
+    };
+
+  shard &get_shard(
+      
+    const char *id)
+
+    {
+    return(shards[id_hash()(id) & shard_mask]);
+    }
+
+  sharded_index(const sharded_index &);
+  sharded_index &operator =(const sharded_index &);
+
+  shard        *shards;
+  unsigned int  shard_mask;
+  };
+
+
+
+/*
+ * rank_index
+ *
+ * Orders the ids of a container by an integer rank (a job's qrank) so that the
+ * place for a new id can be found in O(log n) rather than by walking the list
+ * and comparing every item. Ids with the same rank are ordered newest first,
+ * which is the order insert_by_rank() leaves them in the list. Like the
+ * container's own table, it is protected by the container's mutex.
+ *
+ * The index only knows the ranks it was given. It can place a new id only
+ * while every item in the container went in through insert_by_rank(), and an
+ * item's rank may only change through swap() or by removing and reinserting it.
+ */
+
+class rank_index
+  {
+  public:
+
+  rank_index() : sequence(0) {}
+
+
+
+  void insert(
+      
+    std::string const &id,
+    long               rank)
+
+    {
+    insert_key(id, rank_key(rank, --sequence));
+    }
+
+
+
+  void remove(
+      
+    std::string const &id)
+
+    {
+    rank_map::iterator it = ranks.find(id);
+
+    if (it == ranks.end())
+      return;
+
+    ordered.erase(it->second);
+    ranks.erase(it);
+    }
+
+
+
+  /*
+   * find_predecessor() - gets the last id ranked lower than rank
+   *
+   * @param rank - the rank being placed
+   * @param id - set to the predecessor's id
+   * @return true if there is a lower ranked id, false otherwise
+   */
+
+  bool find_predecessor(
+      
+    long         rank,
+    std::string &id) const
+
+    {
+    rank_order::const_iterator it = ordered.lower_bound(rank_key(rank, LONG_MIN));
+
+    if (it == ordered.begin())
+      return(false);
+
+    --it;
+    id = it->second;
+
+    return(true);
+    }
+
+
+
+  /*
+   * swap() - exchanges the places of two ids, as happens when their positions
+   * in the container are swapped
+   */
+
+  void swap(
+      
+    std::string const &id1,
+    std::string const &id2)
+
+    {
+    rank_map::iterator it1 = ranks.find(id1);
+    rank_map::iterator it2 = ranks.find(id2);
+
+    if ((it1 == ranks.end()) ||
+        (it2 == ranks.end()))
+      return;
+
+    rank_key key1 = it1->second;
+    rank_key key2 = it2->second;
+
+    insert_key(id1, key2);
+    insert_key(id2, key1);
+    }
+
+
+
+  void clear()
+    {
+    ordered.clear();
+    ranks.clear();
+    }
+
+
+
+  size_t size() const
+    {
+    return(ranks.size());
+    }
+
+
+
+  private:
+  /* the rank and a sequence number that decreases with every insert */
+  typedef std::pair<long, long>                                          rank_key;
+  typedef std::map<rank_key, std::string>                                rank_order;
+  typedef boost::unordered_map<std::string, rank_key, id_hash, id_equal> rank_map;
+
+  void insert_key(
+      
+    std::string const &id,
+    rank_key const    &key)
+
+    {
+    remove(id);
+
+    ranks[id] = key;
+    ordered[key] = id;
+    }
+
+  rank_order ordered;
+  rank_map   ranks;
+  long       sequence;
+  };
+
+
+
 template <class T>
 class item_container
   {
@@ -165,9 +541,11 @@ class item_container
       pLocked = locked;
 #endif
       pContainer = pCtner;
-      iter = -1;
-      pContainer->initialize_ra_iterator(&iter);
       reversed = reverse;
+      iter = -1;
+      /* -1 makes next_thing_from_back() start at the last item */
+      if (!reversed)
+        pContainer->initialize_ra_iterator(&iter);
       endHit = false;
       }
     void reset(void) //Reset the iterator;
@@ -183,7 +561,13 @@ class item_container
       }
 #endif
       iter = -1;
-      pContainer->initialize_ra_iterator(&iter);
+      if (!reversed)
+        pContainer->initialize_ra_iterator(&iter);
+      endHit = false;
+      }
+    void start_at(int index) // the next item returned is the one in slot index
+      {
+      iter = index;
       endHit = false;
       }
   private:
@@ -202,12 +586,19 @@ class item_container
     max(0),
     num(0),
     next_slot(1),
-    last(0)
+    last(0),
+    buckets(NULL),
+    bucket_mask(0),
+    buckets_used(0),
+    shards(NULL),
+    ranks(NULL)
 
     {
     pthread_mutex_init(&mutex, NULL);
     max = 10;
     slots = (slot<T> *)calloc(max, sizeof(slot<T>));
+    buckets = (bucket *)calloc(INITIAL_BUCKETS, sizeof(bucket));
+    bucket_mask = INITIAL_BUCKETS - 1;
 #ifdef CHECK_LOCKING
     locked = false;
 #endif
@@ -220,9 +611,6 @@ class item_container
     if (exit_called)
       {
       //If exit is called, don't free the slots.
-      lock();
-      map.clear();
-      unlock();
       return;
       }
 
@@ -232,6 +620,12 @@ class item_container
       free(slots);
       slots = NULL;
       }
+
+    free(buckets);
+    buckets = NULL;
+
+    delete ranks;
+    ranks = NULL;
     }
 
 
@@ -247,7 +641,7 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[id];
+    int index = find_slot(id.c_str());
     if (index != ALWAYS_EMPTY_INDEX)
       {
       if (!replace) return false;
@@ -273,7 +667,7 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[location_id];
+    int index = find_slot(location_id.c_str());
     if (index == ALWAYS_EMPTY_INDEX)
       return false;
     
@@ -332,6 +726,58 @@ class item_container
 
 
 
+  /*
+   * insert_by_rank() - inserts it after the last item with a lower rank. Items
+   * inserted this way stay in ascending rank order, and an item goes ahead of
+   * any items already there with the same rank. The place is found in the rank
+   * index so no other item needs to be examined.
+   *
+   * @return PBSE_NONE, ALREADY_IN_LIST if id is already present,
+   * RANKS_INCOMPLETE if some item was inserted without a rank so the index
+   * can't place it (the caller must compare ranks itself), or -1 if the item
+   * couldn't be inserted
+   */
+
+  int insert_by_rank(
+      
+    T                  it,
+    std::string const &id,
+    long               rank)
+
+    {
+    CHECK_LOCK
+    if (exit_called)
+      return(-1);
+
+    if (find_slot(id.c_str()) != ALWAYS_EMPTY_INDEX)
+      return(ALREADY_IN_LIST);
+
+    if (ranks == NULL)
+      ranks = new rank_index();
+
+    /* every removal path updates the index, so a difference in size can only
+     * come from an item inserted some other way */
+    if (ranks->size() != (size_t)num)
+      return(RANKS_INCOMPLETE);
+
+    std::string prev_id;
+    bool        inserted;
+
+    if (ranks->find_predecessor(rank, prev_id) == true)
+      inserted = insert_after(prev_id, it, id);
+    else
+      inserted = insert_first(it, id);
+
+    if (inserted == false)
+      return(-1);
+
+    ranks->insert(id, rank);
+
+    return(PBSE_NONE);
+    }
+
+
+
   bool insert_before(
       
     std::string const &location_id,
@@ -343,7 +789,7 @@ class item_container
     if (exit_called)
       return false;
 
-    int index = map[location_id];
+    int index = find_slot(location_id.c_str());
     if (index == ALWAYS_EMPTY_INDEX)
       return false;
 
@@ -360,12 +806,22 @@ class item_container
       
     std::string const &id)
 
+    {
+    return(remove(id.c_str()));
+    }
+
+
+
+  bool remove(
+      
+    const char *id)
+
     {
     CHECK_LOCK
     if (exit_called)
       return false;
 
-    int index = map[id];
+    int index = find_slot(id);
     if (index == ALWAYS_EMPTY_INDEX)
       return false;
     
@@ -381,12 +837,27 @@ class item_container
       
     std::string const &id)
 
+    {
+    return(find(id.c_str()));
+    }
+
+
+
+  /*
+   * find() - returns the item stored under id. A miss never adds anything
+   * to the container.
+   */
+
+  T find(
+      
+    const char *id)
+
     {
     CHECK_LOCK
     if (exit_called)
       return  empty_val();
 
-    int index = map[id];
+    int index = find_slot(id);
     if (index == ALWAYS_EMPTY_INDEX)
       {
       return empty_val();
@@ -443,21 +914,29 @@ class item_container
     if (exit_called)
       return false;
 
-    int ind1 = map[id1];
-    int ind2 = map[id2];
+    int b1 = find_bucket(id1.c_str());
+    int b2 = find_bucket(id2.c_str());
 
-    if ((ind1 == ALWAYS_EMPTY_INDEX)||
-        (ind2 == ALWAYS_EMPTY_INDEX)||
-        (ind1 == ind2))
+    if ((b1 == -1)||
+        (b2 == -1)||
+        (b1 == b2))
       {
       return false;
       }
 
+    /* the buckets are found by the ids in the slots, so they are repointed
+     * by position rather than looked up again once the items have moved */
+    int ind1 = buckets[b1].index;
+    int ind2 = buckets[b2].index;
+
     item<T> *pTmp = slots[ind1].pItem;
     slots[ind1].pItem = slots[ind2].pItem;
     slots[ind2].pItem = pTmp;
-    map[id1] = ind2;
-    map[id2] = ind1;
+    buckets[b1].index = ind2;
+    buckets[b2].index = ind1;
+
+    if (ranks != NULL)
+      ranks->swap(id1, id2);
 
     return true;
     }
@@ -483,6 +962,39 @@ class item_container
 
 
 
+  /*
+   * get_iterator_after() - an iterator that starts with the item after id
+   * @return the iterator, or NULL if id isn't in the container
+   */
+
+  item_iterator *get_iterator_after(
+
+    const char *id)
+
+    {
+    CHECK_LOCK
+
+    if (exit_called)
+      return(NULL);
+
+    int index = find_slot(id);
+
+    if (index == ALWAYS_EMPTY_INDEX)
+      return(NULL);
+
+    item_iterator *iter = new item_iterator(this,
+#ifdef CHECK_LOCKING
+        &locked,
+#endif
+        false);
+
+    iter->start_at(slots[index].next);
+
+    return(iter);
+    }
+
+
+
   void clear()
     {
     CHECK_LOCK
@@ -493,7 +1005,9 @@ class item_container
       {
       if (slots[i].pItem != NULL)
         {
-        map.erase(slots[i].pItem->id);
+        if (shards != NULL)
+          shards->remove(slots[i].pItem->id);
+
         delete slots[i].pItem;
         slots[i].pItem = NULL;
         }
@@ -502,6 +1016,12 @@ class item_container
       slots[i].prev = ALWAYS_EMPTY_INDEX;
       }
 
+    memset(buckets, 0, (bucket_mask + 1) * sizeof(bucket));
+    buckets_used = 0;
+
+    if (ranks != NULL)
+      ranks->clear();
+
     num = 0;
     next_slot = 1;
     last = 0;
@@ -555,6 +1075,22 @@ class item_container
 
 
 
+  protected:
+
+  /*
+   * attach a sharded_index which will be kept in sync with every insertion
+   * and removal made to this container
+   */
+  void attach_index(
+
+    sharded_index<T> *index)
+
+    {
+    shards = index;
+    }
+
+
+
   private:
   T empty_val(void)
     {
@@ -647,7 +1183,15 @@ class item_container
       }
 
     slots[next_slot].pItem = thing;
-    map[thing->id] = next_slot;
+
+    if (set_slot(thing->id.c_str(), next_slot) != PBSE_NONE)
+      {
+      slots[next_slot].pItem = NULL;
+      return(-1);
+      }
+
+    if (shards != NULL)
+      shards->insert(thing->id, thing->get());
 
     /* save the insertion point */
     rc = next_slot;
@@ -700,7 +1244,15 @@ class item_container
 
     /* insert this element */
     slots[next_slot].pItem = thing;
-    map[thing->id] = next_slot;
+
+    if (set_slot(thing->id.c_str(), next_slot) != PBSE_NONE)
+      {
+      slots[next_slot].pItem = NULL;
+      return(-1);
+      }
+
+    if (shards != NULL)
+      shards->insert(thing->id, thing->get());
 
     /* save the insertion point */
     rc = next_slot;
@@ -751,7 +1303,15 @@ class item_container
 
     /* insert this element */
     slots[next_slot].pItem = thing;
-    map[thing->id] = next_slot;
+
+    if (set_slot(thing->id.c_str(), next_slot) != PBSE_NONE)
+      {
+      slots[next_slot].pItem = NULL;
+      return(-1);
+      }
+
+    if (shards != NULL)
+      shards->insert(thing->id, thing->get());
 
     /* save the insertion point */
     rc = next_slot;
@@ -763,6 +1323,10 @@ class item_container
     slots[index].prev = rc;
     slots[prev].next = rc;
 
+    /* inserting before the empty slot puts this element at the end */
+    if (index == ALWAYS_EMPTY_INDEX)
+      last = rc;
+
     /* increase the count */
     num++;
 
@@ -806,7 +1370,13 @@ class item_container
     int prev = slots[index].prev;
     int next = slots[index].next;
 
-    map.erase(slots[index].pItem->id);
+    if (shards != NULL)
+      shards->remove(slots[index].pItem->id);
+
+    if (ranks != NULL)
+      ranks->remove(slots[index].pItem->id);
+
+    erase_slot(slots[index].pItem->id.c_str());
     slots[index].prev = ALWAYS_EMPTY_INDEX;
     slots[index].next = ALWAYS_EMPTY_INDEX;
     delete slots[index].pItem;
@@ -1071,15 +1641,187 @@ class item_container
     item<T> *thing)
 
     {
-    try
+    int i = find_slot(thing->id.c_str());
+
+    if (i == ALWAYS_EMPTY_INDEX)
+      return(THING_NOT_FOUND);
+
+    return(i);
+    } /* END get_index() */
+
+
+
+  /*
+   * returns the position of id's bucket in the table, or -1 if id isn't in
+   * the container. Linear probing over a power of 2 sized table.
+   */
+
+  int find_bucket(
+
+    const char *id)
+
     {
-      int i = map[thing->id];
-      return i;
-    }catch(...)
+    if (id == NULL)
+      return(-1);
+
+    unsigned int hash = id_hash()(id);
+    unsigned int b = hash & bucket_mask;
+
+    while (buckets[b].index != ALWAYS_EMPTY_INDEX)
       {
-      return(THING_NOT_FOUND);
+      if ((buckets[b].index != DELETED_BUCKET) &&
+          (buckets[b].hash == hash) &&
+          (slots[buckets[b].index].pItem->id.compare(id) == 0))
+        return(b);
+
+      b = (b + 1) & bucket_mask;
+      }
+
+    return(-1);
+    } /* END find_bucket() */
+
+
+
+  /*
+   * returns the slot index for id, or ALWAYS_EMPTY_INDEX if it isn't in the
+   * container
+   */
+
+  int find_slot(
+
+    const char *id)
+
+    {
+    int b = find_bucket(id);
+
+    if (b == -1)
+      return(ALWAYS_EMPTY_INDEX);
+
+    return(buckets[b].index);
+    } /* END find_slot() */
+
+
+
+  /*
+   * points id at slot index, adding id to the table if it isn't there yet.
+   * NOTE: slots[index] must already hold the item for id
+   */
+
+  int set_slot(
+
+    const char *id,
+    int         index)
+
+    {
+    /* keep the load, including deleted markers, at or under 3/4 */
+    if ((buckets_used + 1) * 4 > (bucket_mask + 1) * 3)
+      {
+      if (rehash_buckets() != PBSE_NONE)
+        return(ENOMEM);
+      }
+
+    unsigned int hash = id_hash()(id);
+    unsigned int b = hash & bucket_mask;
+    int          reuse = -1;
+
+    while (buckets[b].index != ALWAYS_EMPTY_INDEX)
+      {
+      if (buckets[b].index == DELETED_BUCKET)
+        {
+        if (reuse == -1)
+          reuse = b;
+        }
+      else if ((buckets[b].hash == hash) &&
+               (slots[buckets[b].index].pItem->id.compare(id) == 0))
+        {
+        buckets[b].index = index;
+        return(PBSE_NONE);
+        }
+
+      b = (b + 1) & bucket_mask;
+      }
+
+    if (reuse != -1)
+      b = reuse;
+    else
+      buckets_used++;
+
+    buckets[b].hash = hash;
+    buckets[b].index = index;
+
+    return(PBSE_NONE);
+    } /* END set_slot() */
+
+
+
+  void erase_slot(
+
+    const char *id)
+
+    {
+    unsigned int hash = id_hash()(id);
+    unsigned int b = hash & bucket_mask;
+
+    while (buckets[b].index != ALWAYS_EMPTY_INDEX)
+      {
+      if ((buckets[b].index != DELETED_BUCKET) &&
+          (buckets[b].hash == hash) &&
+          (slots[buckets[b].index].pItem->id.compare(id) == 0))
+        {
+        buckets[b].index = DELETED_BUCKET;
+        return;
+        }
+
+      b = (b + 1) & bucket_mask;
+      }
+    } /* END erase_slot() */
+
+
+
+  /*
+   * rebuilds the table without its deleted markers, doubling it if it is
+   * more than half full of live entries
+   */
+
+  int rehash_buckets()
+
+    {
+    unsigned int  size = bucket_mask + 1;
+    unsigned int  live = 0;
+    bucket       *tmp;
+
+    for (unsigned int i = 0; i < size; i++)
+      {
+      if (buckets[i].index > ALWAYS_EMPTY_INDEX)
+        live++;
       }
-    } /* END get_index() */
+
+    if (live * 2 >= size)
+      size *= 2;
+
+    if ((tmp = (bucket *)calloc(size, sizeof(bucket))) == NULL)
+      return(ENOMEM);
+
+    for (unsigned int i = 0; i <= bucket_mask; i++)
+      {
+      if (buckets[i].index > ALWAYS_EMPTY_INDEX)
+        {
+        unsigned int b = buckets[i].hash & (size - 1);
+
+        while (tmp[b].index != ALWAYS_EMPTY_INDEX)
+          b = (b + 1) & (size - 1);
+
+        tmp[b] = buckets[i];
+        }
+      }
+
+    free(buckets);
+    buckets = tmp;
+    bucket_mask = size - 1;
+    buckets_used = live;
+
+    return(PBSE_NONE);
+    } /* END rehash_buckets() */
 
 
 
@@ -1105,12 +1847,71 @@ class item_container
   int num;
   int next_slot;
   int last;
-  boost::unordered_map<std::string, int> map;
+  bucket *buckets;
+  unsigned int bucket_mask;
+  unsigned int buckets_used; /* live entries and DELETED_BUCKET markers */
+  sharded_index<T> *shards;
+  rank_index *ranks; /* created by the first insert_by_rank() */
 #ifdef CHECK_LOCKING
   bool locked;
 #endif
   };
 
+
+
+/*
+ * indexed_item_container
+ *
+ * An item_container whose ids are also kept in a sharded_index. Ordered
+ * operations and iteration still require lock(), but lookup() may be called
+ * without holding the container's mutex at all.
+ */
+
+template <class T>
+class indexed_item_container : public item_container<T>
+  {
+  public:
+
+  indexed_item_container(
+      
+    unsigned int num_shards = DEFAULT_INDEX_SHARDS) : item_container<T>(), index(num_shards)
+
+    {
+    this->attach_index(&index);
+    }
+
+
+
+  ~indexed_item_container()
+    {
+    /* the index is destroyed before the base class clears itself */
+    this->attach_index(NULL);
+    }
+
+
+
+  /*
+   * lookup() - find the item for id without taking the container's lock
+   */
+
+  T lookup(
+      
+    const char *id)
+
+    {
+    if ((exit_called) ||
+        (id == NULL))
+      return(NULL);
+
+    return(index.find(id));
+    }
+
+
+
+  private:
+  sharded_index<T> index;
+  };
+
 } //End of namespace scope.
 
 #endif
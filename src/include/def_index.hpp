@@ -0,0 +1,271 @@
+#ifndef DEF_INDEX_HPP
+#define DEF_INDEX_HPP
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#define DEF_INDEX_ARRAYS 32
+
+/*
+ * def_index
+ *
+ * Looks up entries of a definition array (job_attr_def, svr_resc_def, ...) by
+ * name. The first lookup in an array builds an open addressed hash table of
+ * its names, and later lookups probe that table instead of comparing against
+ * every entry. Tables are keyed by the array's address and size, so an array
+ * that is built at runtime, like svr_resc_def with its site resources, gets a
+ * fresh table when it changes. Replaced tables are kept, not freed, so lookups
+ * never lock.
+ *
+ * T is the definition struct, Name its name member, and NoCase makes lookups
+ * case insensitive. As with the linear scan it replaces, the first of several
+ * entries with the same name wins.
+ */
+
+template <class T, const char *T::*Name, bool NoCase>
+class def_index
+  {
+  class table
+    {
+    public:
+    const T     *defs;
+    int          limit;
+    const char  *first_name; /* detects a different array at a reused address */
+    const char  *last_name;
+    unsigned int mask;
+    int         *slots;      /* index + 1 of the entry, 0 when empty */
+    table       *retired;
+    };
+
+  table           *tables[DEF_INDEX_ARRAYS];
+  int              count;
+  pthread_mutex_t  mutex;
+
+  static unsigned int fold(
+
+    char c)
+
+    {
+    /* definition names are ascii, so skip tolower()'s locale lookup */
+    if ((NoCase) &&
+        (c >= 'A') &&
+        (c <= 'Z'))
+      return((unsigned char)c + ('a' - 'A'));
+
+    return((unsigned char)c);
+    }
+
+  static unsigned int hash(
+
+    const char *name)
+
+    {
+    unsigned int h = 2166136261U;
+
+    for (; *name != '\0'; name++)
+      h = (h ^ fold(*name)) * 16777619U;
+
+    return(h);
+    }
+
+  static bool same_name(
+
+    const char *s1,
+    const char *s2)
+
+    {
+    for (; fold(*s1) == fold(*s2); s1++, s2++)
+      {
+      if (*s1 == '\0')
+        return(true);
+      }
+
+    return(false);
+    }
+
+  static bool is_current(
+
+    const table *t,
+    const T     *defs,
+    int          limit)
+
+    {
+    return((t->limit == limit) &&
+           (t->first_name == defs[0].*Name) &&
+           (t->last_name == defs[limit - 1].*Name));
+    }
+
+  /*
+   * build() - hashes the names of the first limit entries of defs
+   * @return the table, or NULL if out of memory
+   */
+
+  static table *build(
+
+    const T *defs,
+    int      limit)
+
+    {
+    table        *t = (table *)calloc(1, sizeof(table));
+    unsigned int  size = 8;
+
+    if (t == NULL)
+      return(NULL);
+
+    /* keep the table at most half full so misses end quickly */
+    while (size < (unsigned int)limit * 2)
+      size <<= 1;
+
+    if ((t->slots = (int *)calloc(size, sizeof(int))) == NULL)
+      {
+      free(t);
+      return(NULL);
+      }
+
+    t->defs = defs;
+    t->limit = limit;
+    t->first_name = defs[0].*Name;
+    t->last_name = defs[limit - 1].*Name;
+    t->mask = size - 1;
+
+    for (int i = 0; i < limit; i++)
+      {
+      const char   *name = defs[i].*Name;
+      unsigned int  h;
+
+      if (name == NULL)
+        continue;
+
+      for (h = hash(name) & t->mask; t->slots[h] != 0; h = (h + 1) & t->mask)
+        {
+        if (same_name(defs[t->slots[h] - 1].*Name, name))
+          break;
+        }
+
+      if (t->slots[h] == 0)
+        t->slots[h] = i + 1;
+      }
+
+    return(t);
+    }
+
+  /*
+   * get_table() - finds the table for defs, building it if needed
+   * @return the table, or NULL if none could be built
+   */
+
+  table *get_table(
+
+    const T *defs,
+    int      limit)
+
+    {
+    int    published = __atomic_load_n(&this->count, __ATOMIC_ACQUIRE);
+    int    i;
+    table *t;
+
+    for (i = 0; i < published; i++)
+      {
+      t = __atomic_load_n(&this->tables[i], __ATOMIC_ACQUIRE);
+
+      if (t->defs == defs)
+        {
+        if (is_current(t, defs, limit))
+          return(t);
+
+        break;
+        }
+      }
+
+    pthread_mutex_lock(&this->mutex);
+
+    for (i = 0; i < this->count; i++)
+      {
+      if (this->tables[i]->defs == defs)
+        break;
+      }
+
+    if ((i < this->count) &&
+        (is_current(this->tables[i], defs, limit)))
+      {
+      t = this->tables[i];
+      }
+    else if ((i == DEF_INDEX_ARRAYS) ||
+             ((t = build(defs, limit)) == NULL))
+      {
+      t = NULL;
+      }
+    else if (i < this->count)
+      {
+      /* readers may still be probing the old table */
+      t->retired = this->tables[i];
+      __atomic_store_n(&this->tables[i], t, __ATOMIC_RELEASE);
+      }
+    else
+      {
+      this->tables[i] = t;
+      __atomic_store_n(&this->count, i + 1, __ATOMIC_RELEASE);
+      }
+
+    pthread_mutex_unlock(&this->mutex);
+
+    return(t);
+    }
+
+  public:
+
+  def_index() : count(0)
+    {
+    for (int i = 0; i < DEF_INDEX_ARRAYS; i++)
+      this->tables[i] = NULL;
+
+    pthread_mutex_init(&this->mutex, NULL);
+    }
+
+  /*
+   * find() - finds the entry of defs called name
+   *
+   * @param defs - the definition array
+   * @param name - the name to look for
+   * @param limit - the number of entries in defs
+   * @return the entry's index, or -1 if no entry has that name
+   */
+
+  int find(
+
+    const T    *defs,
+    const char *name,
+    int         limit)
+
+    {
+    table *t;
+
+    if ((defs == NULL) ||
+        (name == NULL) ||
+        (limit <= 0))
+      return(-1);
+
+    if ((t = get_table(defs, limit)) == NULL)
+      {
+      /* more arrays than tables, or out of memory */
+      for (int i = 0; i < limit; i++)
+        {
+        if ((defs[i].*Name != NULL) &&
+            (same_name(defs[i].*Name, name)))
+          return(i);
+        }
+
+      return(-1);
+      }
+
+    for (unsigned int h = hash(name) & t->mask; t->slots[h] != 0; h = (h + 1) & t->mask)
+      {
+      if (same_name(defs[t->slots[h] - 1].*Name, name))
+        return(t->slots[h] - 1);
+      }
+
+    return(-1);
+    }
+  };
+
+#endif
@@ -237,6 +237,7 @@ int diswsi (struct tcp_chan *chan, int value);
 #endif
 
 int diswcs (struct tcp_chan *chan, const char *value, size_t nchars);
+int diswcf (struct tcp_chan *chan, int fd, off_t offset, size_t nchars);
 #define diswst(chan, value) diswcs(chan, value, strlen(value))
 
 int diswl_ (struct tcp_chan *chan, dis_long_double_t value, unsigned int ndigs);
@@ -259,9 +260,14 @@ extern const char *dis_emsg[];
 
 extern struct tcp_chan * DIS_tcp_setup (int fd);
 extern int  DIS_tcp_wflush (struct tcp_chan *chan);
+extern int  DIS_tcp_put_file(struct tcp_chan *chan, int fd, off_t offset, size_t len);
 extern void DIS_tcp_settimeout (long timeout);
 extern void DIS_tcp_cleanup(struct tcp_chan *chan);
 extern void DIS_tcp_close(struct tcp_chan *chan);
+extern void DIS_tcp_set_peer_version(int sock, int version);
+extern int  DIS_tcp_get_peer_version(int sock);
+extern void DIS_tcp_set_reply_version(int sock, int version);
+extern int  DIS_tcp_get_reply_version(int sock);
 
 
 /* NOTE:  increase THE_BUF_SIZE to 131072 for systems > 5k nodes */
@@ -87,6 +87,9 @@
 
 #define DIS_BUFSIZ (CHAR_BIT * sizeof(ULONG_MAX))
 
+/* longest binary integer: 6 bits in the first byte and 7 in each of the rest */
+#define DIS_VARINT_MAX 10
+
 char *discui_(char *cp, unsigned value, unsigned *ndigs);
 char *discul_(char *cp, unsigned long value, unsigned *ndigs);
 void disi10d_();
@@ -109,6 +112,8 @@ long disrsl(struct tcp_chan *chan, int *retval);
 int disrsl_(struct tcp_chan *chan, int *negate, unsigned long *value,
     unsigned long count);
 /* short disrss(struct tcp_chan *chan, int *retval); */
+int disrv_(struct tcp_chan *chan, int *negate, unsigned long *value, unsigned int timeout);
+int disrvi_(struct tcp_chan *chan, int *negate, unsigned *value, unsigned int timeout);
 char *disrst(struct tcp_chan *chan, int *retval);
 /* unsigned char disruc(struct tcp_chan *chan, int *retval); */
 /* unsigned disrui(struct tcp_chan *chan, int *retval); */
@@ -122,6 +127,7 @@ int diswsl(struct tcp_chan *chan, long value);
 /* int diswui(struct tcp_chan *chan, unsigned value); */
 int diswui_(struct tcp_chan *chan, unsigned value);
 int diswul(struct tcp_chan *chan, unsigned long value);
+int diswv_(struct tcp_chan *chan, int negate, unsigned long value);
 
 extern unsigned dis_dmx10;
 extern double *dis_dp10;
@@ -0,0 +1,46 @@
+#ifndef JOB_CHANGE_LOG_HPP
+#define JOB_CHANGE_LOG_HPP
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+#include <time.h>
+
+#define MAX_REMOVED_JOBS_LOGGED 100000
+
+/*
+ * job_change_log
+ *
+ * Numbers every change to the server's jobs with an increasing generation so
+ * that a client which has seen generation N can ask for only the jobs changed
+ * since then. Each job carries the generation of its last change in
+ * ji_status_generation; jobs that leave the server are remembered here, up to
+ * a limit, so their removal can be reported too. Generations start over when
+ * the server restarts, so clients hold them together with the start time.
+ */
+
+class job_change_log
+  {
+  time_t                                              start_time;
+  unsigned long                                       generation;
+  unsigned long                                       removed_floor; /* removals up to here were forgotten */
+  std::deque<std::pair<unsigned long, std::string> >  removed;
+  size_t                                              max_removed;
+  pthread_mutex_t                                     mutex;
+
+  public:
+  job_change_log(size_t max_removed = MAX_REMOVED_JOBS_LOGGED);
+  ~job_change_log();
+
+  time_t        started() const;
+  unsigned long current();
+  unsigned long mark_changed();
+  void          mark_removed(const char *jobid);
+  bool          removed_since(time_t since_start, unsigned long since, std::vector<std::string> &jobids);
+  };
+
+extern job_change_log job_changes;
+
+#endif
@@ -39,6 +39,7 @@ int validate_user(int sock, const char *user_name, int user_pid, char *msg);
 
 /* pbsd_submit_caps.c */
 int PBSD_scbuf(int c, int reqtype, int seq, char *buf, int len, const char *jobid, enum job_file which);
+int PBSD_scfile(int c, int reqtype, int seq, int fd, off_t offset, int len, const char *jobid, enum job_file which);
 /* PBSD_gpuctrl2.c */
 int PBSD_gpu_put(int c, char *node, char *gpuid, int gpumode, int reset_perm, int reset_vol, char *extend);
 
@@ -186,6 +187,7 @@ int encode_DIS_JobCred(struct tcp_chan *chan, int type, char *cred, int len);
 
 /* enc_JobFile.c */
 int encode_DIS_JobFile(struct tcp_chan *chan, int seq, char *buf, int len, const char *jobid, int which);
+int encode_DIS_JobFile_fd(struct tcp_chan *chan, int seq, int fd, off_t offset, int len, const char *jobid, int which);
 
 /* enc_JobId.c */
 int encode_DIS_JobId(struct tcp_chan *chan, char *jobid);
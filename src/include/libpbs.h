@@ -110,6 +110,7 @@
 
 #define PBS_BATCH_PROT_TYPE 2
 #define PBS_BATCH_PROT_VER 2
+#define PBS_BATCH_PROT_VER_BINARY 3 /* the rest of the message uses DIS_VERSION_BINARY */
 /* #define PBS_REQUEST_MAGIC (56) */
 /* #define PBS_REPLY_MAGIC   (57) */
 #define SCRIPT_CHUNK_Z (65536)
@@ -241,6 +242,8 @@ struct batch_reply
 
     struct brp_rescq brp_rescq; /* query resource reply */
     } brp_un;
+
+  struct attrlist_arena *brp_arena; /* holds the brp_status entries, if set */
   };
 
 /* This construct pulls the constant parts from the batch types definitions
@@ -332,6 +335,7 @@ extern int decode_DIS_replyCmd (struct tcp_chan *chan, struct batch_reply *);
 extern int encode_DIS_GpuCtrl (struct tcp_chan *chan, char *node, char *gpuid, int gpumode, int reset_perm, int reset_vol);
 extern int encode_DIS_JobCred (struct tcp_chan *chan, int type, char *cred, int len);
 extern int encode_DIS_JobFile (struct tcp_chan *chan, int, char *, int, const char *, int);
+extern int encode_DIS_JobFile_fd (struct tcp_chan *chan, int, int, off_t, int, const char *, int);
 extern int encode_DIS_JobId (struct tcp_chan *chan, char *);
 extern int encode_DIS_Manage (struct tcp_chan *chan, int cmd, int objt, const char *, struct attropl *);
 extern int encode_DIS_MoveJob (struct tcp_chan *chan, char *jid, char *dest);
@@ -22,6 +22,9 @@ extern const int ALL_TASKS;
 #define MAX_CPUSET_SIZE 128
 #define MAX_NODESET_SIZE 128
 
+/* a core's processing units are tracked as the bits of an unsigned long */
+#define MAX_PROCESSING_UNITS_PER_CORE (int)(sizeof(unsigned long) * 8)
+
 #define INTEL    1
 #define AMD      2
 #define NON_NUMA 3
@@ -91,9 +94,11 @@ class Core
   int                   totalThreads;
   bool                  free; // Core is not being used at all
   std::vector<int>      indices; // OS indexes of my processing units
-  std::vector<bool>     is_index_busy; // Tells whether or not each processing unit is busy
+  unsigned long         busy_units; // bit i is set when the processing unit indices[i] is busy
   int                   processing_units_open; // Count of currently unused processing units
 
+  unsigned long all_units() const;
+
   public:
     Core();
     Core(const std::string &layout);
@@ -101,11 +106,11 @@ class Core
     int get_id() const;
     int getNumberOfProcessingUnits();
     int initializeCore(hwloc_obj_t obj, hwloc_topology_t topology);
-    std::vector<int> getPU();
     void displayAsString(stringstream &out) const;
     int  get_open_processing_unit();
     int  add_processing_unit(int which, int os_index);
     bool is_free() const;
+    bool is_unit_busy(int which) const;
     bool free_pu_index(int index, bool &core_is_now_free);
     void unit_test_init(); // Only for unit tests
     void append_indices(std::vector<int> core_indices, int which) const;
@@ -134,9 +139,15 @@ class Chip
   hwloc_uint64_t          memory;
   hwloc_uint64_t          available_memory;
   std::vector<Core>       cores;
+  hwloc_bitmap_t          free_cores;   // positions in cores of the cores that are completely free
+  std::vector<int>        core_of_unit; // position in cores of each processing unit, by os index
   std::vector<PCI_Device> devices;
   vector<allocation>      allocations;
 
+  void index_cores();
+  void update_core_state(int core_index);
+  int  find_core_of_unit(int os_index) const;
+
   public:
     Chip();
     Chip(int execution_slots, int &es_remainder, int &per_numa_remainder);
@@ -173,7 +184,6 @@ class Chip
   #endif
 #endif
 
-    std::vector<Core> getCores();
     void displayAsString(stringstream &out) const;
     void displayAsJson(stringstream &out, bool include_jobs) const;
     void displayAllocationsAsJson(stringstream &out) const;
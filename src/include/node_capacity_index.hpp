@@ -0,0 +1,96 @@
+#ifndef NODE_CAPACITY_INDEX_HPP
+#define NODE_CAPACITY_INDEX_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/*
+ * The parts of a node that decide whether a node spec could be placed on it.
+ * Each node keeps its last indexed copy so that unlocking an unchanged node
+ * doesn't touch the index.
+ */
+
+class node_capacity
+  {
+  public:
+  int                       id;
+  bool                      available;       /* powered on and not offline, down, reserved or job exclusive */
+  bool                      has_node_boards; /* placement is done on the node boards, not the node */
+  int                       total_slots;
+  int                       free_slots;
+  int                       gpus;            /* usable gpus, free or not */
+  int                       mics;
+  std::vector<std::string>  properties;
+
+  node_capacity() : id(-1), available(false), has_node_boards(false), total_slots(0),
+                    free_slots(0), gpus(0), mics(0), properties()
+    {
+    }
+
+  // everything but the properties, which are compared last since they cost the most
+  bool same_counts(const node_capacity &other) const
+    {
+    return((this->id == other.id) &&
+           (this->available == other.available) &&
+           (this->has_node_boards == other.has_node_boards) &&
+           (this->total_slots == other.total_slots) &&
+           (this->free_slots == other.free_slots) &&
+           (this->gpus == other.gpus) &&
+           (this->mics == other.mics));
+    }
+
+  bool operator ==(const node_capacity &other) const
+    {
+    return((this->same_counts(other) == true) &&
+           (this->properties == other.properties));
+    }
+
+  bool operator !=(const node_capacity &other) const
+    {
+    return(!(*this == other));
+    }
+  };
+
+
+
+/*
+ * node_capacity_index
+ *
+ * An index of the nodes by property and by free execution slots, kept up to
+ * date as nodes are unlocked. It lets select_from_all_nodes() visit only the
+ * nodes that could take a req instead of locking every node in the cluster.
+ * Results are hints: callers must re-check each node under its lock.
+ */
+
+class node_capacity_index
+  {
+  std::map<int, node_capacity>          nodes;
+  std::map<std::string, std::set<int> > by_property;
+  std::map<int, std::set<int> >         available_by_free_slots;
+  int                                   node_board_count;
+  pthread_mutex_t                       mutex;
+
+  void remove_entry(int id);
+  const std::set<int> *smallest_property_set(const std::vector<std::string> &props) const;
+  bool has_properties(int id, const std::vector<std::string> &props) const;
+
+  public:
+  node_capacity_index();
+  ~node_capacity_index();
+
+  void   update(const node_capacity &nc);
+  void   remove(int id);
+  void   clear();
+  bool   has_node_boards();
+  size_t size();
+
+  int    find_candidates(const std::vector<std::string> &props, int slots, std::vector<int> &ids);
+  int    count_eligible(const std::vector<std::string> &props, int slots, int gpus, int mics);
+  };
+
+extern node_capacity_index node_index;
+
+#endif
@@ -397,6 +397,7 @@
 #define ATTR_tcpincomingtimeout        "tcp_incoming_timeout"
 #define ATTR_ghost_array_recovery      "ghost_array_recovery"
 #define ATTR_cgroup_per_task           "cgroup_per_task"
+#define ATTR_job_journal               "job_journal"
 
 /* notification email formating */
 #define ATTR_mailsubjectfmt "mail_subject_fmt"
@@ -420,8 +421,22 @@
 #define DELASYNC     "delasync"   /* see req_delete.c */
 #define PURGECOMP    "purgecomplete="   /* see req_delete.c */
 #define EXECQUEONLY  "exec_queue_only"   /* see req_stat.c */
+#define SINCEGENERATION "since_generation="   /* see req_stat.c */
+#define STATPAGESIZE "page_size="   /* see req_stat.c */
+#define STATPAGEAFTER "page_after="   /* see req_stat.c */
+#define DIS_BINARY_EXTEND "dis_binary"   /* see dec_ReqExt.c */
 #define RERUNFORCE   "force"
 
+/* the entry that ends a SINCEGENERATION job status, and its attributes */
+#define GENERATION_STATUS_NAME "@generation"
+#define GENERATION_ATTR        "generation"
+#define GENERATION_REMOVED     "removed_jobs"
+#define GENERATION_RESYNC      "resync"
+
+/* the entry that ends a page of a STATPAGESIZE job status, and its attribute */
+#define PAGE_STATUS_NAME "@page"
+#define PAGE_NEXT        "next"
+
 #define USER_HOLD   "u"
 #define OTHER_HOLD  "o"
 #define SYSTEM_HOLD "s"
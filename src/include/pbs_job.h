@@ -492,6 +492,8 @@ typedef struct noderes
 
 typedef std::map< pid_t, pid_t, std::less< int > > pid2jobsid_map_t;
 typedef std::map<pid_t, int> pid2procarrayindex_map_t;
+typedef std::multimap<pid_t, int> jobsid2procarrayindex_map_t;
+typedef std::map<std::string, std::vector<int> > jobid2procarrayindices_map_t;
 typedef std::set<pid_t> job_pid_set_t;
 
 typedef std::map< pid_t, pid_t, std::less< int > > pid2jobsid_map_t;
@@ -806,6 +808,7 @@ class job
   unsigned          ji_queue_counted;
   bool              ji_being_deleted;
   int               ji_commit_done;   /* req_commit has completed. If in routing queue job can now be routed */
+  unsigned long     ji_status_generation; /* job_changes generation of its last change */
 
   /*
    * fixed size internal data - maintained via "quick save"
@@ -848,7 +851,7 @@ class job
 typedef struct job job;
 
 /* on the server this array will replace many of the doubly linked-lists */
-typedef container::item_container<job *> all_jobs;
+typedef container::indexed_item_container<job *> all_jobs;
 typedef container::item_container<job *>::item_iterator all_jobs_iterator;
 
 #ifndef PBS_MOM
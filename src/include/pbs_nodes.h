@@ -99,6 +99,7 @@
 
 #include "container.hpp"
 #include "job_usage_info.hpp"
+#include "node_capacity_index.hpp"
 #include "attribute.h"
 #ifdef PENABLE_LINUX_CGROUPS
 #include "machine.hpp"
@@ -117,6 +118,12 @@
 #define START_MIC_STATUS       "<mic_status>"
 #define END_MIC_STATUS         "</mic_status>"
 
+/* markers for versioned status updates. A delta carries only the entries that
+ * changed since its base version; entries the mom no longer reports are unset */
+#define STATUS_VERSION_EQUALS  "status_version="
+#define STATUS_BASE_EQUALS     "status_base="
+#define STATUS_UNSET_EQUALS    "status_unset="
+
 #ifdef NUMA_SUPPORT
 #  define MAX_NODE_BOARDS      2048
 #endif  /* NUMA_SUPPORT */
@@ -213,6 +220,14 @@ typedef struct nodeboard_t
 
 
 #define SEND_HELLO 11
+/* IS_STATUS replies to moms that version their updates */
+#define STATUS_DELTAS_OK 12   /* applied - later updates may be versioned and be deltas */
+#define STATUS_RESYNC    13   /* the delta's base wasn't the last version applied - send everything */
+
+/* moms reporting this version or later understand STATUS_DELTAS_OK, so they
+ * are sent it even for unversioned updates. 1000 is what set_version() makes
+ * of "master" */
+#define STATUS_DELTAS_MOM_VERSION 1000
 
 /* container for holding communication information */
 class received_node
@@ -252,6 +267,8 @@ public:
   struct array_strings         *nd_prop;             /* array of properities */
 
   std::string                   nd_status;
+  std::vector<std::string>      nd_status_entries;   /* the entries of nd_status, kept to apply status deltas */
+  unsigned long                 nd_status_version;   /* version of the last status update applied */
   std::string                   nd_note;             /* note set by administrator */
   int                           nd_stream;           /* stream to Mom on host */
   enum psit                     nd_flag;
@@ -313,6 +330,7 @@ public:
                                                        doing the unlock intends to lock it again
                                                        so we need a flag here to prevent a node from being
                                                        deleted while it is temporarily locked. */
+  node_capacity               nd_capacity;            /* what node_index last recorded for this node */
 
   /* numa hardware configuration information */
 #ifdef PENABLE_LINUX_CGROUPS
@@ -352,6 +370,7 @@ public:
   void remove_node_state_flag(int flag);
   void capture_plugin_resources(const char *str);
   void add_job_list_to_status(const std::string &job_list);
+  void update_capacity_index();
   };
 
 
@@ -203,3 +203,4 @@ ATTR_tcpincomingtimeout,
 ATTR_ghost_array_recovery,
 ATTR_cgroup_per_task,
 ATTR_idle_slot_limit,
+ATTR_job_journal,
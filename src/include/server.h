@@ -228,6 +228,7 @@ enum srv_atr
   SRV_ATR_GhostArrayRecovery,
   SRV_ATR_CgroupPerTask,
   SRV_ATR_IdleSlotLimit,
+  SRV_ATR_JobJournal,
 
   /* This must be last */
   SRV_ATR_LAST
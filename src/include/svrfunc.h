@@ -85,6 +85,12 @@ struct stat_cntl    /* used in req_stat_job */
   int        sc_XXXY;
   int        sc_conn;
   bool       sc_condensed;
+  bool       sc_since_set;        /* only jobs changed since the given generation */
+  time_t     sc_since_start;      /* server start time the generation is from */
+  unsigned long sc_since_generation;
+  int        sc_page_size;        /* most jobs in one reply, 0 for no limit */
+  int        sc_page_offset;      /* jobs walked before this page */
+  char       sc_page_after[PBS_MAXSVRJOBID+1]; /* the last job of the previous page */
   pbs_queue      *sc_pque;
 
   struct batch_request *sc_origrq;
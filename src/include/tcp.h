@@ -4,6 +4,7 @@
 
 #include <stddef.h>
 #include <time.h>
+#include <sys/types.h>
 
 struct tcpdisbuf
   {
@@ -27,8 +28,20 @@ struct tcp_chan
   int              sock;
   int              reused; /* do_tcp() may call tm_request more than once with the same tcp_chan structure
                               We need to mark it when it does */
+  int              dis_version; /* DIS_VERSION_TEXT or DIS_VERSION_BINARY */
+
+  /* a file body DIS_tcp_wflush() sends after file_at bytes of writebuf, see DIS_tcp_put_file() */
+  int              file_fd;
+  off_t            file_offset;
+  size_t           file_len; /* 0 if there is no file to send */
+  size_t           file_at;
+  int              file_committed;
   };
 
+/* how integers and string lengths are encoded on a tcp_chan */
+#define DIS_VERSION_TEXT   0 /* decimal digits with count prefixes */
+#define DIS_VERSION_BINARY 1 /* sign and magnitude in 7 bit groups, see disrv_.c */
+
 
 int tcp_getc(struct tcp_chan *chan, unsigned int timeout);
 int tcp_gets(struct tcp_chan *chan, char *, size_t, unsigned int timeout);
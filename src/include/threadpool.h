@@ -87,10 +87,26 @@
 
 
 #include <pthread.h>
+#include <time.h>
 
 
 #define POOL_DESTROY 0x1
 
+/*
+ * Work is queued in priority lanes. Idle threads always take work from the
+ * highest priority lane that has some, unless the oldest work in a lower lane
+ * has waited longer than TP_LANE_MAX_WAIT_SECS, in which case it goes first.
+ */
+enum tp_lane
+  {
+  TP_LANE_CLIENT,     /* client batch requests - the default */
+  TP_LANE_MOM_STATUS, /* work generated by MOM status updates */
+  TP_LANE_BACKGROUND, /* periodic housekeeping such as check_nodes_work */
+  TP_NUM_LANES
+  };
+
+#define TP_LANE_MAX_WAIT_SECS 5
+
 
 
 typedef struct tp_work tp_work_t;
@@ -99,6 +115,21 @@ struct tp_work
   tp_work_t *next;
   void      *(*work_func)(void *); /* function to call */
   void      *work_arg; /* argument */
+  struct timespec enqueued; /* CLOCK_MONOTONIC time of enqueue */
+  };
+
+
+
+typedef struct tp_lane_queue tp_lane_queue_t;
+struct tp_lane_queue
+  {
+  tp_work_t          *first;           /* first in queue */
+  tp_work_t          *last;            /* last in queue */
+  int                 depth;           /* number of work items queued */
+  int                 max_depth;       /* high water mark of depth */
+  unsigned long       dequeued;        /* work items handed to threads */
+  unsigned long long  total_wait_usecs; /* time dequeued items spent queued */
+  unsigned long       max_wait_usecs;  /* longest time an item spent queued */
   };
 
 
@@ -121,8 +152,8 @@ struct threadpool
   pthread_cond_t   tp_waiting_work; /* what waiting threads pend on */
   pthread_cond_t   tp_can_destroy; /* thread pool is ready to be deleted */
   tp_working_t    *tp_active;  /* list of currently working threads */
-  tp_work_t       *tp_first; /* first in queue */
-  tp_work_t       *tp_last;  /* last in queue */
+  tp_lane_queue_t  tp_lanes[TP_NUM_LANES]; /* queued work, by priority */
+  int              tp_queued; /* work items queued in all lanes */
   pthread_attr_t   tp_attr; /* attributes for workers */
   int              tp_nthreads; /* number of threads */
   int              tp_min_threads; /* minimum number of threads */
@@ -141,6 +172,8 @@ extern threadpool_t *task_pool;
 extern threadpool_t *async_pool;
 
 int  enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *tp);
+int  enqueue_threadpool_request_lane(void *(*func)(void *), void *arg, threadpool_t *tp, int lane);
+int  threadpool_get_lane_stats(threadpool_t *tp, int lane, tp_lane_queue_t *stats);
 int  initialize_threadpool(threadpool_t **,int,int,int);
 void destroy_request_pool(threadpool_t *tp);
 void start_request_pool(threadpool_t *tp);
@@ -129,10 +129,42 @@ int task_is_in_threadpool(struct work_task *ptask);
 
 typedef struct timed_task
   {
-  work_task *wt;
-  long       task_time;
+  work_task     *wt;
+  long           task_time;
+  unsigned long  sequence;  /* breaks ties so equal times fire in the order they were set */
   } timed_task;
 
+
+
+/*
+ * timed_task_heap
+ *
+ * A binary min-heap of the timed tasks ordered by task time. Each queued task
+ * records its position in wt_timed_index so that it can be cancelled without
+ * searching. Callers serialize access with task_list_timed_mutex.
+ */
+
+class timed_task_heap
+  {
+  std::vector<timed_task> heap;
+  unsigned long           next_sequence;
+
+  bool earlier(size_t a, size_t b) const;
+  void place(size_t index, const timed_task &tt);
+  void sift_up(size_t index);
+  void sift_down(size_t index);
+
+  public:
+  timed_task_heap() : heap(), next_sequence(0)
+    {
+    }
+
+  void       push(work_task *wt);
+  work_task *pop_due(long time_now);
+  bool       remove(work_task *wt);
+  size_t     size() const;
+  };
+
 class all_tasks
   {
 public:
@@ -165,6 +197,7 @@ typedef struct work_task
   void (*wt_parmfunc)  (struct work_task *);
   /* used in reissue_to_svr to store wt_func */
   int                  wt_aux; /* optional info: e.g. child status */
+  size_t               wt_timed_index; /* position + 1 in the timed task heap, 0 if not queued */
   } work_task;
 
 int        insert_task(all_tasks *, work_task *);
@@ -172,7 +205,7 @@ int        remove_task(all_tasks *,work_task *);
 int        has_task(all_tasks *);
 int        dispatch_timed_task(work_task *);
 work_task *pop_timed_task(time_t time_now);
-int        insert_timed_task(all_tasks *, time_t task_time, work_task *);
+void       insert_timed_task(work_task *);
 
 
 struct batch_request;
@@ -92,6 +92,7 @@
 #include "resource.h"
 #include "pbs_error.h"
 #include "pbs_helper.h"
+#include "def_index.hpp"
 
 /*
  * This file contains functions for manipulating attributes of type
@@ -619,9 +620,14 @@ void free_resc(
  * find_resc_def - find the resource_def structure for a resource with
  * a given name
  *
+ * The name is looked up in a hash table of the array's names, which is
+ * rebuilt when site resources change the array.
+ *
  * Returns: pointer to the structure or NULL
  */
 
+static def_index<resource_def, &resource_def::rs_name, false> resc_names;
+
 resource_def *find_resc_def(
 
   resource_def *rscdf, /* address of array of resource_def structs */
@@ -629,19 +635,12 @@ resource_def *find_resc_def(
   int           limit) /* number of members in resource_def array */
 
   {
-  while (limit--)
-    {
-    if (!strcmp(rscdf->rs_name, name))
-      {
-      /* SUCCESS */
+  int index = resc_names.find(rscdf, name, limit);
 
-      return(rscdf);
-      }
-
-    rscdf++;
-    }
+  if (index < 0)
+    return(NULL);
 
-  return(NULL);
+  return(rscdf + index);
   }  /* END find_resc_def() */
 
 
@@ -672,7 +671,10 @@ resource *find_resc_entry(
   for (size_t i = 0; i < resources->size(); i++)
     {
     resource &r = resources->at(i);
-    if (!strcmp(r.rs_defin->rs_name, rscdf->rs_name))
+
+    /* entries normally point at the same definition, so try that first */
+    if ((r.rs_defin == rscdf) ||
+        (!strcmp(r.rs_defin->rs_name, rscdf->rs_name)))
       {
       pr = &r;
       break;
@@ -80,6 +80,7 @@
 
 #include <ctype.h>
 #include <memory.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -88,6 +89,7 @@
 #include "attribute.h"
 #include "pbs_error.h"
 #include "pbs_helper.h"
+#include "def_index.hpp"
 
 /*
  * This file contains general functions for manipulating attributes.
@@ -97,6 +99,11 @@
  * free_null()
  * attrlist_alloc()
  * attrlist_create()
+ * free_attrlist()
+ * free_attrlist_entry()
+ * attrlist_arena_create()
+ * attrlist_arena_free()
+ * attrlist_use_arena()
  * parse_equal_string()
  * parse_comma_string()
  * count_substrings()
@@ -139,41 +146,18 @@ void clear_attr(
 
 
 
-/*
- * str_nc_cmp - string no-case comparision
- */
-
-static int str_nc_cmp(
-
-  const char *s1,  /* I */
-  const char *s2)  /* I */
-
-  {
-  do
-    {
-    if (tolower((int)*s1) != tolower((int)*s2))
-      {
-      return(-1);
-      }
-    }
-  while (*s1++ && *s2++);
-
-  return(0);
-  }  /* END str_nc_cmp() */
-
-
-
-
 /*
  * find_attr - find pbs_attribute definition by name
  *
- * Searches array of pbs_attribute definition strutures to find one
- * whose name matches the requested name.
+ * Looks the name up, ignoring case, in a hash table of the definition
+ * array's names that is built by the first lookup in the array.
  *
  * Returns: >= 0 index into definition struture array
  *     -1 if didn't find matching name
  */
 
+static def_index<attribute_def, &attribute_def::at_name, true> attr_names;
+
 int find_attr(
 
   struct attribute_def *attr_def, /* ptr to pbs_attribute definitions */
@@ -181,22 +165,7 @@ int find_attr(
   int                   limit)    /* limit on size of def array */
 
   {
-  int index;
-
-  if (attr_def != NULL)
-    {
-    for (index = 0;index < limit;index++)
-      {
-      if (!str_nc_cmp(attr_def->at_name, name))
-        {
-        return(index);
-        }
-
-      attr_def++;
-      }  /* END for (index) */
-    }
-
-  return(-1);
+  return(attr_names.find(attr_def, name, limit));
   }
 
 
@@ -307,6 +276,163 @@ int comp_null(
 
 
 
+/*
+ * Arenas hand out memory in chunks of ARENA_CHUNK_SIZE bytes, or a chunk of
+ * its own for an entry that won't fit in one.
+ */
+
+#define ARENA_CHUNK_SIZE 65536
+
+struct arena_chunk
+  {
+  struct arena_chunk *next;
+  size_t              size;
+  size_t              used;
+  };
+
+struct attrlist_arena
+  {
+  struct arena_chunk *chunks; /* the chunk being carved is first */
+  };
+
+static pthread_key_t  arena_key;
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+
+
+
+static void make_arena_key(void)
+
+  {
+  pthread_key_create(&arena_key, NULL);
+  }  /* END make_arena_key() */
+
+
+
+
+/*
+ * arena_alloc - carve size zeroed bytes from arena
+ *
+ * Returns: the memory or NULL if a new chunk couldn't be allocated
+ */
+
+static void *arena_alloc(
+
+  attrlist_arena *arena,
+  size_t          size)
+
+  {
+  struct arena_chunk *chunk = arena->chunks;
+  size_t              hdr = (sizeof(struct arena_chunk) + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+  size_t              chunk_size = ARENA_CHUNK_SIZE;
+  void               *mem;
+
+  size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+  if ((chunk == NULL) ||
+      (chunk->size - chunk->used < size))
+    {
+    if (hdr + size > chunk_size)
+      chunk_size = hdr + size;
+
+    /* chunks are calloc'd and never reused, so what is carved is zeroed */
+    if ((chunk = (struct arena_chunk *)calloc(1, chunk_size)) == NULL)
+      return(NULL);
+
+    chunk->size = chunk_size;
+    chunk->used = hdr;
+
+    if ((arena->chunks != NULL) &&
+        (chunk_size > ARENA_CHUNK_SIZE))
+      {
+      /* keep carving from the partly used chunk */
+      chunk->next = arena->chunks->next;
+      arena->chunks->next = chunk;
+      }
+    else
+      {
+      chunk->next = arena->chunks;
+      arena->chunks = chunk;
+      }
+    }
+
+  mem = (char *)chunk + chunk->used;
+  chunk->used += size;
+
+  return(mem);
+  }  /* END arena_alloc() */
+
+
+
+
+/*
+ * attrlist_arena_create - create an empty arena
+ *
+ * Returns: the arena or NULL if out of memory
+ */
+
+attrlist_arena *attrlist_arena_create(void)
+
+  {
+  return((attrlist_arena *)calloc(1, sizeof(attrlist_arena)));
+  }  /* END attrlist_arena_create() */
+
+
+
+
+/*
+ * attrlist_arena_free - free an arena and every entry carved from it
+ *
+ * The entries must no longer be in use, although free_attrlist() may still
+ * be called on lists of them first.
+ */
+
+void attrlist_arena_free(
+
+  attrlist_arena *arena)
+
+  {
+  struct arena_chunk *chunk;
+
+  if (arena == NULL)
+    return;
+
+  while ((chunk = arena->chunks) != NULL)
+    {
+    arena->chunks = chunk->next;
+    free(chunk);
+    }
+
+  free(arena);
+  }  /* END attrlist_arena_free() */
+
+
+
+
+/*
+ * attrlist_use_arena - make arena the one attrlist_alloc() carves entries
+ * from on this thread, or stop using one if arena is NULL
+ *
+ * Returns: the arena that was in use before, so that it can be restored
+ */
+
+attrlist_arena *attrlist_use_arena(
+
+  attrlist_arena *arena)
+
+  {
+  attrlist_arena *previous;
+
+  pthread_once(&arena_key_once, make_arena_key);
+
+  previous = (attrlist_arena *)pthread_getspecific(arena_key);
+  pthread_setspecific(arena_key, arena);
+
+  return(previous);
+  }  /* END attrlist_use_arena() */
+
+
+
+
 /*
  * attrlist_alloc - allocate space for an svrattrl structure entry
  *
@@ -325,15 +451,21 @@ svrattrl *attrlist_alloc(
 
   {
   register size_t  tsize;
-  svrattrl        *pal;
+  svrattrl        *pal = NULL;
+  attrlist_arena  *arena;
 
   /* alloc memory block <SVRATTRL><NAME><RESC><VAL> */
 
   tsize = sizeof(svrattrl) + szname + szresc + szval;
 
-  pal = (svrattrl *)calloc(1, tsize);
+  pthread_once(&arena_key_once, make_arena_key);
 
-  if (pal == NULL)
+  if ((arena = (attrlist_arena *)pthread_getspecific(arena_key)) != NULL)
+    pal = (svrattrl *)arena_alloc(arena, tsize);
+
+  if (pal != NULL)
+    pal->al_arena = 1;
+  else if ((pal = (svrattrl *)calloc(1, tsize)) == NULL)
     {
     return(NULL);
     }
@@ -434,11 +566,30 @@ void free_attrlist(
     {
     nxpal = (struct svrattrl *)GET_NEXT(pal->al_link);
     delete_link(&pal->al_link);
-    (void)free(pal);
+    free_attrlist_entry(pal);
     pal = nxpal;
     }
   }
 
+
+
+
+/*
+ * free_attrlist_entry - free a single svrattrl entry that isn't in a list
+ *
+ * Entries carved from an arena are left for attrlist_arena_free().
+ */
+
+void free_attrlist_entry(
+
+  svrattrl *pal)
+
+  {
+  if ((pal != NULL) &&
+      (pal->al_arena == 0))
+    free(pal);
+  }  /* END free_attrlist_entry() */
+
 #if 0  /* This code is not used, but is too good to delete */
 /*
  * parse_equal_string - parse a string of the form:
@@ -11,7 +11,7 @@
 
 
 
-int disrsi_(
+static int disrsi_text(
 
   struct tcp_chan *chan,
   int             *negate,
@@ -126,7 +126,7 @@ int disrsi_(
           }
         }    /* END if (count > 1) */
 
-      return(disrsi_(chan, negate, value, ndigs, timeout));
+      return(disrsi_text(chan, negate, value, ndigs, timeout));
       break;
 
     case -1:
@@ -150,6 +150,36 @@ overflow:
   *value = UINT_MAX;
 
   return(DIS_OVERFLOW);
+  }  /* END disrsi_text() */
+
+
+
+/*
+ * disrsi_()
+ *
+ * Reads a signed integer's sign and magnitude in whichever encoding the
+ * channel is using.
+ */
+
+int disrsi_(
+
+  struct tcp_chan *chan,
+  int             *negate,
+  unsigned        *value,
+  unsigned         count,
+  unsigned int     timeout)
+
+  {
+  if (chan->dis_version == DIS_VERSION_BINARY)
+    {
+    if ((negate == NULL) ||
+        (value == NULL))
+      return(DIS_INVALID);
+
+    return(disrvi_(chan, negate, value, timeout));
+    }
+
+  return(disrsi_text(chan, negate, value, count, timeout));
   }  /* END disrsi_() */
 
 
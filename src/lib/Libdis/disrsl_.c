@@ -91,7 +91,7 @@
 static char *ulmax;
 unsigned ulmaxdigs = 0;
 
-int disrsl_(
+static int disrsl_text(
 
   struct tcp_chan *chan,
   int             *negate,
@@ -249,7 +249,7 @@ int disrsl_(
           }
         }
 
-      return(disrsl_(chan, negate, value, ndigs));
+      return(disrsl_text(chan, negate, value, ndigs));
 
       /*NOTREACHED*/
 
@@ -293,6 +293,32 @@ overflow:
   *value = ULONG_MAX;
 
   return(DIS_OVERFLOW);
+  }  /* END disrsl_text() */
+
+
+
+/*
+ * disrsl_()
+ *
+ * Reads a signed long's sign and magnitude in whichever encoding the
+ * channel is using.
+ */
+
+int disrsl_(
+
+  struct tcp_chan *chan,
+  int             *negate,
+  unsigned long   *value,
+  unsigned long    count)
+
+  {
+  assert(negate != NULL);
+  assert(value != NULL);
+
+  if (chan->dis_version == DIS_VERSION_BINARY)
+    return(disrv_(chan, negate, value, pbs_tcp_timeout));
+
+  return(disrsl_text(chan, negate, value, count));
   }  /* END disrsl_() */
 
 /* END disrsl_.c */
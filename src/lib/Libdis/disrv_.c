@@ -0,0 +1,176 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <limits.h>
+#include <stddef.h>
+
+#include "dis.h"
+#include "dis_internal.h"
+#include "tcp.h"
+
+/*
+ * Binary DIS integers
+ *
+ * A binary integer is a sign and a magnitude. The first byte holds the sign
+ * in bit 6 and the low 6 bits of the magnitude, each following byte holds the
+ * next 7 bits of the magnitude, and bit 7 of a byte is set when another byte
+ * follows. Values below 64 take a single byte and an unsigned long takes at
+ * most DIS_VARINT_MAX bytes.
+ */
+
+
+
+/*
+ * disrv_parse()
+ *
+ * Decodes a binary integer from buf.
+ *
+ * @param buf - the bytes to decode
+ * @param len - the number of bytes available in buf
+ * @param negate - set to TRUE if the integer is negative
+ * @param value - set to the magnitude of the integer
+ * @param used - set to the number of bytes the integer took
+ * @return DIS_SUCCESS, DIS_EOD if buf ends before the integer does, DIS_OVERFLOW
+ * if the magnitude doesn't fit in an unsigned long or DIS_PROTO if it is too long
+ */
+
+static int disrv_parse(
+
+  const unsigned char *buf,
+  size_t               len,
+  int                 *negate,
+  unsigned long       *value,
+  size_t              *used)
+
+  {
+  unsigned long locval;
+  unsigned long chunk;
+  unsigned      shift = 6;
+  size_t        i;
+
+  if (len == 0)
+    return(DIS_EOD);
+
+  *negate = (buf[0] & 0x40) != 0;
+  locval = buf[0] & 0x3f;
+
+  for (i = 1; buf[i - 1] & 0x80; i++)
+    {
+    if (i >= DIS_VARINT_MAX)
+      return(DIS_PROTO);
+
+    if (i >= len)
+      return(DIS_EOD);
+
+    chunk = buf[i] & 0x7f;
+
+    if ((chunk != 0) &&
+        ((shift >= sizeof(locval) * CHAR_BIT) ||
+         ((chunk >> (sizeof(locval) * CHAR_BIT - shift)) != 0)))
+      {
+      *value = ULONG_MAX;
+      return(DIS_OVERFLOW);
+      }
+
+    if (shift < sizeof(locval) * CHAR_BIT)
+      locval |= chunk << shift;
+
+    shift += 7;
+    }
+
+  *value = locval;
+  *used = i;
+
+  return(DIS_SUCCESS);
+  }  /* END disrv_parse() */
+
+
+
+/*
+ * disrv_()
+ *
+ * Reads a binary integer from chan. When the whole integer is already in the
+ * read buffer it is decoded in place, otherwise it is read a byte at a time.
+ * Like disrsl_(), the read is not committed.
+ *
+ * @param chan - the channel to read from
+ * @param negate - set to TRUE if the integer is negative
+ * @param value - set to the magnitude of the integer
+ * @param timeout - how long to wait for more data
+ * @return DIS_SUCCESS or a DIS error code
+ */
+
+int disrv_(
+
+  struct tcp_chan *chan,
+  int             *negate,
+  unsigned long   *value,
+  unsigned int     timeout)
+
+  {
+  struct tcpdisbuf *tp = &chan->readbuf;
+  unsigned char     bytes[DIS_VARINT_MAX];
+  size_t            len;
+  size_t            used = 0;
+  int               rc;
+
+  rc = disrv_parse((unsigned char *)tp->tdis_leadp, tp->tdis_eod - tp->tdis_leadp, negate, value, &used);
+
+  if (rc != DIS_EOD)
+    {
+    if (rc == DIS_SUCCESS)
+      tp->tdis_leadp += used;
+
+    return(rc);
+    }
+
+  for (len = 0; len < DIS_VARINT_MAX; len++)
+    {
+    /* tcp_getc() can't tell a byte of 0xff from an error, so use tcp_gets() */
+    if ((rc = tcp_gets(chan, (char *)bytes + len, 1, timeout)) != 1)
+      return((rc == -2) ? DIS_EOF : DIS_EOD);
+
+    if ((bytes[len] & 0x80) == 0)
+      break;
+    }
+
+  if (len == DIS_VARINT_MAX)
+    return(DIS_PROTO);
+
+  return(disrv_parse(bytes, len + 1, negate, value, &used));
+  }  /* END disrv_() */
+
+
+
+/*
+ * disrvi_()
+ *
+ * disrv_() for integers that must fit in an unsigned int.
+ */
+
+int disrvi_(
+
+  struct tcp_chan *chan,
+  int             *negate,
+  unsigned        *value,
+  unsigned int     timeout)
+
+  {
+  unsigned long locval;
+  int           rc;
+
+  rc = disrv_(chan, negate, &locval, timeout);
+
+  if ((rc == DIS_SUCCESS) &&
+      (locval > UINT_MAX))
+    rc = DIS_OVERFLOW;
+
+  if (rc == DIS_OVERFLOW)
+    *value = UINT_MAX;
+  else
+    *value = (unsigned)locval;
+
+  return(rc);
+  }  /* END disrvi_() */
+
+/* END disrv_.c */
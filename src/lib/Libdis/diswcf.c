@@ -0,0 +1,47 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "dis.h"
+#include "dis_internal.h"
+#include "tcp.h"
+
+/*
+ * diswcf()
+ *
+ * Sends nchars bytes of a file, starting at offset, as a counted string. The
+ * reader sees the same thing diswcs() would send, but the bytes go from the
+ * file to the socket when chan is flushed instead of through the write
+ * buffer, so fd must stay open until DIS_tcp_wflush() is called.
+ *
+ * @param chan - the channel to write to
+ * @param fd - the file to send
+ * @param offset - where in the file the string starts
+ * @param nchars - the length of the string
+ * @return DIS_SUCCESS or a DIS error code. On error nothing is sent.
+ */
+
+int diswcf(
+
+  struct tcp_chan *chan,
+  int              fd,
+  off_t            offset,
+  size_t           nchars)
+
+  {
+  int retval;
+
+  retval = diswui_(chan, (unsigned)nchars);
+
+  if ((retval == DIS_SUCCESS) &&
+      (DIS_tcp_put_file(chan, fd, offset, nchars) != 0))
+    {
+    retval = DIS_PROTO;
+    }
+
+  return ((tcp_wcommit(chan, retval == DIS_SUCCESS) < 0) ?  DIS_NOCOMMIT : retval);
+  }  /* END diswcf() */
+
+/* END diswcf.c */
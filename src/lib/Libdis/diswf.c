@@ -124,10 +124,14 @@ int diswf(
 
   if (value == 0.0)
     {
-    retval = tcp_puts(chan, "+0+0", 4) != 4 ?
-             DIS_PROTO : DIS_SUCCESS;
-    return ((tcp_wcommit(chan, retval == DIS_SUCCESS) < 0) ?
-            DIS_NOCOMMIT : retval);
+    if (tcp_puts(chan, "+0", 2) != 2)
+      {
+      tcp_wcommit(chan, FALSE);
+      return(DIS_PROTO);
+      }
+
+    /* the exponent is an integer, so it follows the channel's encoding */
+    return(diswsi(chan, 0));
     }
 
   /* Extract the sign from the coefficient.    */
@@ -140,17 +140,24 @@ int diswsi(
     c = '+';
     }
 
-  cp = discui_(&scratch[sizeof(scratch)-1], uval, &ndigs);
+  if (chan->dis_version == DIS_VERSION_BINARY)
+    {
+    retval = diswv_(chan, value < 0, uval);
+    }
+  else
+    {
+    cp = discui_(&scratch[sizeof(scratch)-1], uval, &ndigs);
 
-  *--cp = c;
+    *--cp = c;
 
-  while (ndigs > 1)
-    cp = discui_(cp, ndigs, &ndigs);
+    while (ndigs > 1)
+      cp = discui_(cp, ndigs, &ndigs);
 
-  retval = tcp_puts(
-             chan,
-             cp,
-             strlen(cp)) < 0 ?  DIS_PROTO : DIS_SUCCESS;
+    retval = tcp_puts(
+               chan,
+               cp,
+               strlen(cp)) < 0 ?  DIS_PROTO : DIS_SUCCESS;
+    }
 
   rc = (tcp_wcommit(chan, retval == DIS_SUCCESS) < 0) ?
        DIS_NOCOMMIT : retval;
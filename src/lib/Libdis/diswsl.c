@@ -135,16 +135,23 @@ int diswsl(
     c = '+';
     }
 
-  cp = discul_(&scratch[sizeof(scratch)-1], ulval, &ndigs);
+  if (chan->dis_version == DIS_VERSION_BINARY)
+    {
+    retval = diswv_(chan, value < 0, ulval);
+    }
+  else
+    {
+    cp = discul_(&scratch[sizeof(scratch)-1], ulval, &ndigs);
 
-  *--cp = c;
+    *--cp = c;
 
-  while (ndigs > 1)
-    cp = discui_(cp, ndigs, &ndigs);
+    while (ndigs > 1)
+      cp = discui_(cp, ndigs, &ndigs);
 
-  retval = tcp_puts(chan, cp,
-                       strlen(cp)) < 0 ?
-           DIS_PROTO : DIS_SUCCESS;
+    retval = tcp_puts(chan, cp,
+                         strlen(cp)) < 0 ?
+             DIS_PROTO : DIS_SUCCESS;
+    }
 
   return ((tcp_wcommit(chan, retval == DIS_SUCCESS) < 0) ?
           DIS_NOCOMMIT : retval);
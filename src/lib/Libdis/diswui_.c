@@ -95,6 +95,9 @@ int diswui_(
   unsigned ndigs;
   char  *cp = NULL;
   char  scratch[DIS_BUFSIZ];
+
+  if (chan->dis_version == DIS_VERSION_BINARY)
+    return(diswv_(chan, FALSE, value));
   
   memset(scratch, 0, sizeof(scratch));
 
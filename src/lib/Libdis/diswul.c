@@ -128,17 +128,24 @@ int diswul(
   int           rc;
   char          scratch[DIS_BUFSIZ];
 
-  memset(scratch, 0, sizeof(scratch));
-  cp = discul_(&scratch[sizeof(scratch)-1], value, &ndigs);
+  if (chan->dis_version == DIS_VERSION_BINARY)
+    {
+    retval = diswv_(chan, FALSE, value);
+    }
+  else
+    {
+    memset(scratch, 0, sizeof(scratch));
+    cp = discul_(&scratch[sizeof(scratch)-1], value, &ndigs);
 
-  *--cp = '+';
+    *--cp = '+';
 
-  while (ndigs > 1)
-    cp = discui_(cp, ndigs, &ndigs);
+    while (ndigs > 1)
+      cp = discui_(cp, ndigs, &ndigs);
 
-  retval = tcp_puts(chan, cp, strlen(cp)) < 0 ?
-           DIS_PROTO :
-           DIS_SUCCESS;
+    retval = tcp_puts(chan, cp, strlen(cp)) < 0 ?
+             DIS_PROTO :
+             DIS_SUCCESS;
+    }
 
   rc = tcp_wcommit(chan, retval == DIS_SUCCESS);
 
@@ -0,0 +1,48 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stddef.h>
+
+#include "dis.h"
+#include "dis_internal.h"
+#include "tcp.h"
+
+/*
+ * diswv_()
+ *
+ * Puts a binary integer into chan's write buffer. See disrv_.c for the
+ * encoding. Like diswui_(), the write is not committed.
+ *
+ * @param chan - the channel to write to
+ * @param negate - TRUE if the integer is negative
+ * @param value - the magnitude of the integer
+ * @return DIS_SUCCESS or DIS_PROTO
+ */
+
+int diswv_(
+
+  struct tcp_chan *chan,
+  int              negate,
+  unsigned long    value)
+
+  {
+  unsigned char bytes[DIS_VARINT_MAX];
+  int           len = 0;
+
+  bytes[0] = (value & 0x3f) | (negate ? 0x40 : 0);
+  value >>= 6;
+
+  while (value != 0)
+    {
+    bytes[len++] |= 0x80;
+    bytes[len] = value & 0x7f;
+    value >>= 7;
+    }
+
+  if (tcp_puts(chan, (char *)bytes, len + 1) < 0)
+    return(DIS_PROTO);
+
+  return(DIS_SUCCESS);
+  }  /* END diswv_() */
+
+/* END diswv_.c */
@@ -85,12 +85,54 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "libpbs.h"
 #include "dis.h"
 #include "mutex_mgr.hpp"
 #include "server_limits.h"
 
 
+
+/*
+ * add_dis_binary()
+ *
+ * Tells the server that replies to this request may use binary DIS by adding
+ * DIS_BINARY_EXTEND to the extension. Older servers ignore it. An extension
+ * ending in 'C' asks older servers for condensed output, so it is left alone.
+ *
+ * @return the extension to send, which the caller must free if it isn't extend
+ */
+
+static char *add_dis_binary(
+
+  char *extend)
+
+  {
+  char   *with_binary;
+  size_t  len;
+
+  if ((extend == NULL) ||
+      (*extend == '\0'))
+    return(strdup(DIS_BINARY_EXTEND));
+
+  len = strlen(extend);
+
+  if (extend[len - 1] == 'C')
+    return(extend);
+
+  len += strlen(DIS_BINARY_EXTEND) + 2;
+
+  if ((with_binary = (char *)calloc(1, len)) == NULL)
+    return(extend);
+
+  snprintf(with_binary, len, "%s,%s", extend, DIS_BINARY_EXTEND);
+
+  return(with_binary);
+  } /* END add_dis_binary() */
+
+
+
+
 int PBSD_status_put(
 
   int           c,
@@ -103,6 +145,7 @@ int PBSD_status_put(
   int rc = 0;
   int sock;
   struct tcp_chan *chan = NULL;
+  char *to_send = extend;
   
   if ((c < 0) || 
       (c >= PBS_NET_MAX_CONNECTIONS))
@@ -119,16 +162,27 @@ int PBSD_status_put(
     rc = PBSE_MEM_MALLOC;
     return rc;
     }
-  else if ((rc = encode_DIS_ReqHdr(chan, function, pbs_current_user)) ||
+
+  /* status replies are the largest, so ask for them in binary */
+  if (DIS_tcp_get_peer_version(sock) == DIS_VERSION_TEXT)
+    to_send = add_dis_binary(extend);
+
+  if ((rc = encode_DIS_ReqHdr(chan, function, pbs_current_user)) ||
       (rc = encode_DIS_Status(chan, id, attrib)) ||
-      (rc = encode_DIS_ReqExtend(chan, extend)))
+      (rc = encode_DIS_ReqExtend(chan, to_send)))
     {
     connection[c].ch_errtxt = strdup(dis_emsg[rc]);
 
+    if (to_send != extend)
+      free(to_send);
+
     DIS_tcp_cleanup(chan);
     return(PBSE_PROTOCOL);
     }
 
+  if (to_send != extend)
+    free(to_send);
+
   ch_mutex.unlock();
 
   if (DIS_tcp_wflush(chan))
@@ -82,6 +82,7 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <sys/stat.h>
 #include "portability.h"
 #include "libpbs.h"
 #include "dis.h"
@@ -438,25 +439,33 @@ int PBSD_scbuf(
 
 
 
-/* PBS_jscript.c
+/*
+ * PBSD_scfile()
  *
- * The Job Script subfunction of the Queue Job request
- * -- the function PBS_scbuf is called repeatedly to
- * transfer chunks of the script to the server.
-*/
-
-int PBSD_jscript(
-    
-  int   c,
-  const char *script_file,
-  const char *jobid)
+ * Like PBSD_scbuf(), but the chunk is len bytes of fd starting at offset,
+ * which go from the file to the socket without being copied into the
+ * request buffer.
+ */
+
+int PBSD_scfile(
+
+  int         c,       /* connection handle     */
+  int         reqtype, /* request type */
+  int         seq,     /* file chunk sequence number */
+  int         fd,      /* file the chunk is in */
+  off_t       offset,  /* where the chunk starts */
+  int         len,     /* length of chunk */
+  const char *jobid,   /* job id (for types 1 and 2 only) */
+  enum job_file which) /* standard file type, see libpbs.h */
 
   {
-  int  i;
-  int  fd;
-  int  cc;
-  int  rc;
-  char s_buf[SCRIPT_CHUNK_Z];
+
+  struct batch_reply *reply;
+
+  int                 rc;
+  int                 sock;
+  int                 local_errno = 0;
+  struct tcp_chan *chan = NULL;
   
   if ((c < 0) || 
       (c >= PBS_NET_MAX_CONNECTIONS))
@@ -464,25 +473,101 @@ int PBSD_jscript(
     return(PBSE_IVALREQ);
     }
 
-  if ((fd = open(script_file, O_RDONLY, 0)) < 0)
+  pthread_mutex_lock(connection[c].ch_mutex);
+  sock = connection[c].ch_socket;
+  pthread_mutex_unlock(connection[c].ch_mutex);
+
+  if ((chan = DIS_tcp_setup(sock)) == NULL)
+    {
+    return(PBSE_MEM_MALLOC);
+    }
+  else if (jobid == NULL)
+    jobid = (char *)""; /* use null string for null pointer */
+
+  if ((rc = encode_DIS_ReqHdr(chan, reqtype, pbs_current_user)) ||
+      (rc = encode_DIS_JobFile_fd(chan, seq, fd, offset, len, jobid, which)) ||
+      (rc = encode_DIS_ReqExtend(chan, NULL)))
+    {
+    pthread_mutex_lock(connection[c].ch_mutex);
+    connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+    pthread_mutex_unlock(connection[c].ch_mutex);
+    DIS_tcp_cleanup(chan);
+    return(PBSE_PROTOCOL);
+    }
+
+  if (DIS_tcp_wflush(chan))
     {
-    return (-1);
+    DIS_tcp_cleanup(chan);
+    return(PBSE_PROTOCOL);
     }
+  DIS_tcp_cleanup(chan);
 
-  i = 0;
+  /* read reply */
+
+  reply = PBSD_rdrpy(&local_errno, c);
+
+  PBSD_FreeReply(reply);
+
+  pthread_mutex_lock(connection[c].ch_mutex);
+  rc = connection[c].ch_errno;
+  pthread_mutex_unlock(connection[c].ch_mutex);
 
-  cc = read_ac_socket(fd, s_buf, SCRIPT_CHUNK_Z);
 
-  while ((cc > 0) && (PBSD_scbuf(c, PBS_BATCH_jobscript, i, s_buf, cc, jobid, JScript) == 0))
+  return(rc);
+  }  /* END PBSD_scfile() */
+
+
+
+
+
+/*
+ * PBSD_send_file()
+ *
+ * Sends the file at path in SCRIPT_CHUNK_Z chunks with PBSD_scfile(),
+ * stopping at the first chunk the server doesn't accept.
+ *
+ * @return the connection's error, or -1 if the file can't be read
+ */
+
+static int PBSD_send_file(
+
+  int           c,
+  int           req_type,
+  const char   *path,
+  const char   *jobid,
+  enum job_file which)
+
+  {
+  int         i;
+  int         fd;
+  int         rc;
+  int         len;
+  off_t       offset;
+  struct stat sb;
+
+  if ((fd = open(path, O_RDONLY, 0)) < 0)
     {
-    i++;
-    cc = read_ac_socket(fd, s_buf, SCRIPT_CHUNK_Z);
+    return(-1);
     }
 
-  close(fd);
+  if (fstat(fd, &sb) < 0)
+    {
+    close(fd);
+    return(-1);
+    }
 
-  if (cc < 0) /* read failed */
-    return (-1);
+  for (i = 0, offset = 0; offset < sb.st_size; i++, offset += len)
+    {
+    if (sb.st_size - offset > SCRIPT_CHUNK_Z)
+      len = SCRIPT_CHUNK_Z;
+    else
+      len = sb.st_size - offset;
+
+    if (PBSD_scfile(c, req_type, i, fd, offset, len, jobid, which) != 0)
+      break;
+    }
+
+  close(fd);
 
   pthread_mutex_lock(connection[c].ch_mutex);
 
@@ -491,61 +576,56 @@ int PBSD_jscript(
   pthread_mutex_unlock(connection[c].ch_mutex);
 
   return(rc);
-  }
+  }  /* END PBSD_send_file() */
+
+
+
+
 
 /* PBS_jscript.c
  *
  * The Job Script subfunction of the Queue Job request
- * -- the function PBS_scbuf is called repeatedly to
+ * -- the function PBSD_scfile is called repeatedly to
  * transfer chunks of the script to the server.
 */
 
-int PBSD_jscript2(
+int PBSD_jscript(
     
   int   c,
   const char *script_file,
   const char *jobid)
 
   {
-  int  i;
-  int  fd;
-  int  cc;
-  int  rc;
-  char s_buf[SCRIPT_CHUNK_Z];
-  
   if ((c < 0) || 
       (c >= PBS_NET_MAX_CONNECTIONS))
     {
     return(PBSE_IVALREQ);
     }
 
-  if ((fd = open(script_file, O_RDONLY, 0)) < 0)
-    {
-    return (-1);
-    }
+  return(PBSD_send_file(c, PBS_BATCH_jobscript, script_file, jobid, JScript));
+  }
 
-  i = 0;
+/* PBS_jscript.c
+ *
+ * The Job Script subfunction of the Queue Job request
+ * -- the function PBSD_scfile is called repeatedly to
+ * transfer chunks of the script to the server.
+*/
 
-  cc = read_ac_socket(fd, s_buf, SCRIPT_CHUNK_Z);
+int PBSD_jscript2(
+    
+  int   c,
+  const char *script_file,
+  const char *jobid)
 
-  while ((cc > 0) && (PBSD_scbuf(c, PBS_BATCH_jobscript2, i, s_buf, cc, jobid, JScript) == 0))
+  {
+  if ((c < 0) || 
+      (c >= PBS_NET_MAX_CONNECTIONS))
     {
-    i++;
-    cc = read_ac_socket(fd, s_buf, SCRIPT_CHUNK_Z);
+    return(PBSE_IVALREQ);
     }
 
-  close(fd);
-
-  if (cc < 0) /* read failed */
-    return (-1);
-
-  pthread_mutex_lock(connection[c].ch_mutex);
-
-  rc = connection[c].ch_errno;
-
-  pthread_mutex_unlock(connection[c].ch_mutex);
-
-  return(rc);
+  return(PBSD_send_file(c, PBS_BATCH_jobscript2, script_file, jobid, JScript));
   }
 
 
@@ -556,7 +636,7 @@ int PBSD_jscript2(
  *
  * The Job File function used to move files related to
  * a job between servers.
- * -- the function PBS_scbuf is called repeatedly to
+ * -- the function PBSD_scfile is called repeatedly to
  * transfer chunks of the script to the server.
 */
 
@@ -569,12 +649,6 @@ int PBSD_jobfile(
   enum job_file which)
 
   {
-  int   i;
-  int   cc;
-  int   rc;
-  int   fd;
-  char  s_buf[SCRIPT_CHUNK_Z];
-  
   if ((c < 0) || 
       (c >= PBS_NET_MAX_CONNECTIONS))
     {
@@ -584,37 +658,7 @@ int PBSD_jobfile(
   if (path[0] == '\0')
     return(PBSE_NONE);
 
-  if ((fd = open(path, O_RDONLY, 0)) < 0)
-    {
-    return(-1);
-    }
-
-  i = 0;
-
-  cc = read_ac_socket(fd, s_buf, SCRIPT_CHUNK_Z);
-
-  while ((cc > 0) &&
-         (PBSD_scbuf(c, req_type, i, s_buf, cc, jobid, which) == 0))
-    {
-    i++;
-
-    cc = read_ac_socket(fd, s_buf, SCRIPT_CHUNK_Z);
-    }
-
-  close(fd);
-
-  if (cc < 0) /* read failed */
-    {
-    return(-1);
-    }
-
-  pthread_mutex_lock(connection[c].ch_mutex);
-
-  rc = connection[c].ch_errno;
-
-  pthread_mutex_unlock(connection[c].ch_mutex);
-
-  return(rc);
+  return(PBSD_send_file(c, req_type, path, jobid, which));
   }  /* END PBSD_jobfile() */
 
 /* PBS_queuejob.c
@@ -87,11 +87,16 @@
  *
  * The next field is an unsigned integer which is 1 if there is an
  * extension string and zero if not.
+ *
+ * A client that understands binary DIS adds DIS_BINARY_EXTEND to the end of
+ * the extension. It is removed here and the reply is sent in binary.
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
 #include "libpbs.h"
 #include "list_link.h"
 #include "server_limits.h"
@@ -101,6 +106,55 @@
 #include "dis.h"
 #include "tcp.h" /* tcp_chan */
 
+
+
+/*
+ * strip_dis_binary()
+ *
+ * Removes DIS_BINARY_EXTEND from the end of preq's extension.
+ * @return TRUE if it was there
+ */
+
+static int strip_dis_binary(
+
+  struct batch_request *preq)
+
+  {
+  char   *extend = preq->rq_extend;
+  size_t  len;
+  size_t  token_len = strlen(DIS_BINARY_EXTEND);
+
+  if (extend == NULL)
+    return(FALSE);
+
+  len = strlen(extend);
+
+  if (len == token_len)
+    {
+    if (strcmp(extend, DIS_BINARY_EXTEND) != 0)
+      return(FALSE);
+
+    free(extend);
+    preq->rq_extend = NULL;
+
+    return(TRUE);
+    }
+
+  if ((len > token_len) &&
+      (extend[len - token_len - 1] == ',') &&
+      (strcmp(extend + len - token_len, DIS_BINARY_EXTEND) == 0))
+    {
+    extend[len - token_len - 1] = '\0';
+
+    return(TRUE);
+    }
+
+  return(FALSE);
+  } /* END strip_dis_binary() */
+
+
+
+
 int decode_DIS_ReqExtend(
 
   struct tcp_chan *chan,
@@ -117,6 +171,10 @@ int decode_DIS_ReqExtend(
     if (i != 0)
       {
       preq->rq_extend = disrst(chan, &rc);
+
+      if ((rc == 0) &&
+          (strip_dis_binary(preq) == TRUE))
+        DIS_tcp_set_reply_version(chan->sock, DIS_VERSION_BINARY);
       }
     }
 
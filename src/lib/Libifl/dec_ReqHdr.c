@@ -86,6 +86,9 @@
  *   Request Type (unsignded integer)
  *   User Name (string)
  *
+ * A version of PBS_BATCH_PROT_VER_BINARY switches chan to binary DIS for the
+ * rest of the request and for the reply to it.
+ *
  * Returns:  -1 on EOF (end of file on first read only)
  *     0 on success
  *    >0 a DIS error return, see dis.h
@@ -121,6 +124,14 @@ int decode_DIS_ReqHdr(
 
   if (rc == 0)
     {
+    if (*proto_ver == PBS_BATCH_PROT_VER_BINARY)
+      {
+      chan->dis_version = DIS_VERSION_BINARY;
+      DIS_tcp_set_reply_version(chan->sock, DIS_VERSION_BINARY);
+      }
+    else
+      DIS_tcp_set_reply_version(chan->sock, DIS_VERSION_TEXT);
+
     preq->rq_type = disrui(chan, &rc);
     }
 
@@ -121,6 +121,8 @@ int decode_DIS_replyCmd(
 
   /* first decode "header" consisting of protocol type and version */
 
+  chan->dis_version = DIS_VERSION_TEXT;
+
   i = disrui(chan, &rc);
 
   if (rc != 0)
@@ -140,7 +142,13 @@ int decode_DIS_replyCmd(
     return(rc);
     }
 
-  if (i != PBS_BATCH_PROT_VER)
+  if (i == PBS_BATCH_PROT_VER_BINARY)
+    {
+    /* the server understands binary DIS, so requests can use it too */
+    chan->dis_version = DIS_VERSION_BINARY;
+    DIS_tcp_set_peer_version(chan->sock, DIS_VERSION_BINARY);
+    }
+  else if (i != PBS_BATCH_PROT_VER)
     {
     return(DIS_PROTO);
     }
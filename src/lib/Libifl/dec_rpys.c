@@ -122,6 +122,8 @@ int decode_DIS_replySvr(
   /* first decode "header" consisting of protocol type and version */
   usleep(100);
 
+  chan->dis_version = DIS_VERSION_TEXT;
+
   i = disrui(chan, &rc);
 
   if (rc != 0) 
@@ -137,7 +139,14 @@ int decode_DIS_replySvr(
 
   if (rc != 0) return rc;
 
-  if (i != PBS_BATCH_PROT_VER) return DIS_PROTO;
+  if (i == PBS_BATCH_PROT_VER_BINARY)
+    {
+    /* the server understands binary DIS, so requests can use it too */
+    chan->dis_version = DIS_VERSION_BINARY;
+    DIS_tcp_set_peer_version(chan->sock, DIS_VERSION_BINARY);
+    }
+  else if (i != PBS_BATCH_PROT_VER)
+    return DIS_PROTO;
 
   /* next decode code, auxcode and choice (union type identifier) */
 
@@ -118,3 +118,38 @@ int encode_DIS_JobFile(
   return 0;
   }
 
+
+
+/*
+ * encode_DIS_JobFile_fd() - encode a Job Related File straight from a file
+ *
+ * The same data items as encode_DIS_JobFile(), but the data is len bytes of
+ * fd starting at offset, which is sent by DIS_tcp_wflush() without being
+ * copied into the write buffer. fd must stay open until chan is flushed.
+ */
+
+int encode_DIS_JobFile_fd(
+
+  struct tcp_chan *chan,
+  int              seq,
+  int              fd,
+  off_t            offset,
+  int              len,
+  const char      *jobid,
+  int              which)
+
+  {
+  int   rc;
+
+  if (jobid == (char *)0)
+    jobid = (char *)"";
+
+  if ((rc = diswui(chan, seq) != 0) ||
+      (rc = diswui(chan, which) != 0) ||
+      (rc = diswui(chan, len) != 0) ||
+      (rc = diswst(chan, jobid) != 0) ||
+      (rc = diswcf(chan, fd, offset, len) != 0))
+    return rc;
+
+  return 0;
+  }  /* END encode_DIS_JobFile_fd() */
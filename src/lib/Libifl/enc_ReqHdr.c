@@ -83,6 +83,9 @@
  *   Protocol Version (unsigned integer)
  *   Request Type (unsignded integer)
  *   User Name (string)
+ *
+ * The protocol ID and version are always text. If the server has shown it
+ * understands binary DIS, the version says so and the rest is binary.
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -98,10 +101,19 @@ int encode_DIS_ReqHdr(
   char *user)
   {
   int rc;
+  int version = DIS_tcp_get_peer_version(chan->sock);
+
+  chan->dis_version = DIS_VERSION_TEXT;
 
   if ((rc = diswui(chan, PBS_BATCH_PROT_TYPE)) ||
-      (rc = diswui(chan, PBS_BATCH_PROT_VER)) ||
-      (rc = diswui(chan, reqt))   ||
+      (rc = diswui(chan, (version == DIS_VERSION_BINARY) ? PBS_BATCH_PROT_VER_BINARY : PBS_BATCH_PROT_VER)))
+    {
+    return rc;
+    }
+
+  chan->dis_version = version;
+
+  if ((rc = diswui(chan, reqt))   ||
       (rc = diswst(chan, user)))
     {
     return rc;
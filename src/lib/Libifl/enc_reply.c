@@ -107,13 +107,19 @@ int encode_DIS_reply(
   struct brp_status  *pstat;
   svrattrl           *psvrl;
   int                 rc;
+  int                 version = DIS_tcp_get_reply_version(chan->sock);
 
   /* first encode "header" consisting of protocol type and version */
 
+  chan->dis_version = DIS_VERSION_TEXT;
+
   if ((rc = diswui(chan, PBS_BATCH_PROT_TYPE)) ||
-      (rc = diswui(chan, PBS_BATCH_PROT_VER)))
+      (rc = diswui(chan, (version == DIS_VERSION_BINARY) ? PBS_BATCH_PROT_VER_BINARY : PBS_BATCH_PROT_VER)))
     return rc;
 
+  /* the rest of the reply is in the encoding the client asked for */
+  chan->dis_version = version;
+
   /* next encode code, auxcode and choice (union type identifier) */
 
   if ((rc = diswsi(chan, reply->brp_code))  ||
@@ -183,6 +183,7 @@ int encode_DIS_JobCred(struct tcp_chan *chan, int type, char *cred, int len);
 
 /* enc_JobFile.c */
 int encode_DIS_JobFile(struct tcp_chan *chan, int seq, char *buf, int len, const char *jobid, int which);
+int encode_DIS_JobFile_fd(struct tcp_chan *chan, int seq, int fd, off_t offset, int len, const char *jobid, int which);
 
 /* enc_JobId.c */
 int encode_DIS_JobId(struct tcp_chan *chan, char *jobid);
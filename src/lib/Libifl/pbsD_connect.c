@@ -1434,6 +1434,9 @@ int pbs_original_connect(
       }
     } /* END if !use_unixsock */
 
+  /* a new server; requests are text until it shows it understands binary DIS */
+  DIS_tcp_set_peer_version(connection[out].ch_socket, DIS_VERSION_TEXT);
+
   pthread_mutex_unlock(connection[out].ch_mutex);
 
   return(out);
@@ -88,6 +88,13 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <fcntl.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h> /* TCP_CORK */
+#include <sys/socket.h>
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 #include "lib_ifl.h" /* DIS_tcp_setup, DIS_tcp_cleanup */
 
 
@@ -109,6 +116,16 @@
 #define MAX_SOCKETS 65536
 time_t pbs_tcp_timeout = 300;  
 
+/*
+ * The DIS encoding each connection has agreed to. peer_version is the
+ * encoding a client may send requests in, learned from the server's replies,
+ * and reply_version is the encoding a server replies in, learned from the
+ * client's requests. Both start out as DIS_VERSION_TEXT.
+ */
+
+static char peer_version[MAX_SOCKETS];
+static char reply_version[MAX_SOCKETS];
+
 
 
 void DIS_tcp_settimeout(
@@ -127,7 +144,6 @@ void DIS_tcp_settimeout(
  * tcp_pack_buff - pack existing data into front of buffer
  *
  * Moves "uncommited" data to front of buffer and adjusts pointers.
- * Does a character by character move since data may over lap.
  */
 
 static void tcp_pack_buff(
@@ -137,7 +153,6 @@ static void tcp_pack_buff(
   {
   size_t amt;
   size_t start;
-  size_t i;
 
   start = tp->tdis_trailp - tp->tdis_thebuf;
 
@@ -145,10 +160,9 @@ static void tcp_pack_buff(
     {
     amt  = tp->tdis_eod - tp->tdis_trailp;
 
-    for (i = 0;i < amt;++i)
-      {
-      *(tp->tdis_thebuf + i) = *(tp->tdis_thebuf + i + start);
-      }
+    if (amt != 0)
+      memmove(tp->tdis_thebuf, tp->tdis_trailp, amt);
+
     *(tp->tdis_thebuf + amt) = '\0';
 
     tp->tdis_leadp  -= start;
@@ -162,6 +176,65 @@ static void tcp_pack_buff(
 
 
 
+/*
+ * tcp_grow_buff()
+ *
+ * Makes sure tp has room for size more bytes after tdis_eod. If pack is set
+ * the committed data has been consumed, so the rest is packed to the front
+ * first and the buffer is only reallocated if that isn't enough. It at least
+ * doubles each time so that a large message is copied a bounded number of
+ * times, and realloc() can usually extend a large buffer without copying it.
+ *
+ * @return PBSE_NONE or PBSE_MEM_MALLOC
+ */
+
+static int tcp_grow_buff(
+
+  struct tcpdisbuf *tp,
+  size_t            size,
+  int               pack)
+
+  {
+  size_t  used;
+  size_t  newsize;
+  char   *ptr;
+  size_t  leadp;
+  size_t  trailp;
+
+  if ((size_t)(tp->tdis_thebuf + tp->tdis_bufsize - tp->tdis_eod) >= size)
+    return(PBSE_NONE);
+
+  if (pack == TRUE)
+    tcp_pack_buff(tp);
+
+  used = tp->tdis_eod - tp->tdis_thebuf;
+
+  if (tp->tdis_bufsize - used >= size)
+    return(PBSE_NONE);
+
+  newsize = tp->tdis_bufsize * 2;
+
+  if (newsize < used + size)
+    newsize = used + size;
+
+  leadp = tp->tdis_leadp - tp->tdis_thebuf;
+  trailp = tp->tdis_trailp - tp->tdis_thebuf;
+
+  /* one more byte so the data can always be terminated */
+  if ((ptr = (char *)realloc(tp->tdis_thebuf, newsize + 1)) == NULL)
+    return(PBSE_MEM_MALLOC);
+
+  tp->tdis_thebuf = ptr;
+  tp->tdis_bufsize = newsize;
+  tp->tdis_leadp = ptr + leadp;
+  tp->tdis_trailp = ptr + trailp;
+  tp->tdis_eod = ptr + used;
+
+  return(PBSE_NONE);
+  }  /* END tcp_grow_buff() */
+
+
+
 
 /*
  * tcp_read - read data from tcp stream to "fill" the buffer
@@ -182,28 +255,15 @@ int tcp_read(
 
   {
   int               rc = PBSE_NONE;
-  unsigned long     newsize;
-  char             *ptr;
-  int               tdis_buf_len = 0;
-  int               max_read_len = 0;
-  char             *new_data = NULL;
+  long long         pending = 0;
+  long long         bytes_read = 0;
   struct tcpdisbuf *tp;
-  int               tmp_leadp = 0;
-  int               tmp_trailp = 0;
-  int               tmp_eod = 0;
-  char              err_msg[1024];
-
 
   tp = &chan->readbuf;
 
-  /* must compact any uncommitted data into bottom of buffer */
-  tcp_pack_buff(tp);
-
   chan->IsTimeout = 0;
   chan->SelectErrno = 0;
   chan->ReadErrno = 0;
-  tdis_buf_len = tp->tdis_bufsize;
-  max_read_len = tp->tdis_bufsize - (tp->tdis_eod - tp->tdis_thebuf);
 
   /*
    * we don't want to be locked out by an attack on the port to
@@ -211,7 +271,19 @@ int tcp_read(
    * deliver promptly
    */
 
-  if ((rc = socket_read(chan->sock, &new_data, read_len, timeout)) != PBSE_NONE)
+  if ((rc = socket_wait_for_data(chan->sock, timeout, &pending)) == PBSE_NONE)
+    {
+    /* read straight into the buffer, after any data not yet consumed */
+    if (tcp_grow_buff(tp, pending, TRUE) != PBSE_NONE)
+      {
+      log_err(ENOMEM, __func__, "Could not allocate memory to read buffer");
+      return(PBSE_MEM_MALLOC);
+      }
+
+    rc = socket_read_force(chan->sock, tp->tdis_eod, pending, &bytes_read);
+    }
+
+  if (rc != PBSE_NONE)
     {
     switch (rc)
       {
@@ -229,71 +301,148 @@ int tcp_read(
         break;
       }
 
-    if (new_data != NULL)
-      free(new_data);
-
     return(rc);
     }
-  /* data read is less than buffer size */
-  else if (max_read_len > *read_len)
+
+  *read_len = bytes_read;
+  tp->tdis_eod += bytes_read;
+  *tp->tdis_eod = '\0';
+  *avail_len = tp->tdis_eod - tp->tdis_leadp;
+
+  return(rc);
+  }  /* END tcp_read() */
+
+
+
+
+
+/*
+ * tcp_write_all()
+ *
+ * Writes ct bytes from pb to chan's socket.
+ * @return 0 on success, -1 on error
+ */
+
+static int tcp_write_all(
+
+  struct tcp_chan *chan,
+  char            *pb,
+  size_t           ct)
+
+  {
+  ssize_t i;
+
+  while ((ct > 0) &&
+         ((i = write_ac_socket(chan->sock, pb, ct)) != (ssize_t)ct))
     {
-    memcpy(tp->tdis_eod, new_data, *read_len);
-    tp->tdis_eod += *read_len;
-    *tp->tdis_eod = '\0';
-    *avail_len = tp->tdis_eod - tp->tdis_leadp;
-    max_read_len = tp->tdis_eod - tp->tdis_thebuf;
+    if (i == -1)
+      {
+      if (errno == EINTR)
+        {
+        continue;
+        }
+
+      /* FAILURE */
 
-    if (max_read_len > tdis_buf_len)
+      if (getenv("PBSDEBUG") != NULL)
+        {
+        fprintf(stderr,
+          "TCP write of %d bytes (%.32s) [sock=%d] failed, errno=%d (%s)\n",
+          (int)ct, pb, chan->sock, errno, strerror(errno));
+        }
+      
+      return(-1);
+      }  /* END if (i == -1) */
+    else
       {
-      snprintf(err_msg, sizeof(err_msg),
-        "eod ptr BEYOND end of buffer!! (fit) Remaining buffer = %d, read_len = %lld",
-        max_read_len, *read_len);
-      log_err(PBSE_INTERNAL,__func__,err_msg);
+      ct -= i;
+      pb += i;
       }
+    }  /* END while (i) */
+
+  return(0);
+  }  /* END tcp_write_all() */
+
+
 
-    free(new_data);
+/*
+ * tcp_send_file()
+ *
+ * Sends len bytes of fd, starting at offset, to chan's socket. sendfile()
+ * moves them without copying them through this process; if the kernel can't
+ * do that for these descriptors they are read and written instead.
+ *
+ * @return 0 on success, -1 on error or if the file is shorter than len
+ */
+
+static int tcp_send_file(
+
+  struct tcp_chan *chan,
+  int              fd,
+  off_t            offset,
+  size_t           len)
+
+  {
+  char    buf[16384];
+  ssize_t amt;
+
+#ifdef HAVE_SYS_SENDFILE_H
+  while (len > 0)
+    {
+    if ((amt = sendfile(chan->sock, fd, &offset, len)) > 0)
+      len -= amt;
+    else if (amt == 0)
+      return(-1);
+    else if (errno == EINTR)
+      continue;
+    else if ((errno == EINVAL) ||
+             (errno == ENOSYS))
+      break;
+    else
+      return(-1);
     }
-  /* data read is greater than buffer size */
-  else if (max_read_len <= *read_len)
+#endif
+
+  while (len > 0)
     {
-    newsize = (tdis_buf_len + *read_len) * 2;
-    if ((ptr = (char *)calloc(1, newsize+1)) == NULL)
+    if ((amt = pread(fd, buf, (len < sizeof(buf)) ? len : sizeof(buf), offset)) <= 0)
       {
-      log_err(ENOMEM,__func__,"Could not allocate memory to read buffer");
-      rc = PBSE_MEM_MALLOC;
-      free(new_data);
-      return rc;
+      if ((amt < 0) &&
+          (errno == EINTR))
+        continue;
+
+      return(-1);
       }
 
-    tmp_leadp = tp->tdis_leadp - tp->tdis_thebuf;
-    tmp_trailp = tp->tdis_trailp - tp->tdis_thebuf;
-    tmp_eod = tp->tdis_eod - tp->tdis_thebuf;
+    if (tcp_write_all(chan, buf, amt) != 0)
+      return(-1);
 
-    snprintf(ptr, newsize, "%s%s", tp->tdis_thebuf, new_data);
-    free(tp->tdis_thebuf);
-    tp->tdis_thebuf = ptr;
-    tp->tdis_bufsize = newsize;
-    tp->tdis_eod = tp->tdis_thebuf + tmp_eod + *read_len;
-    tp->tdis_trailp = tp->tdis_thebuf + tmp_trailp;
-    tp->tdis_leadp = tp->tdis_thebuf + tmp_leadp;
-    *avail_len = tp->tdis_eod - tp->tdis_leadp;
+    offset += amt;
+    len -= amt;
+    }
 
-    max_read_len = tp->tdis_eod - tp->tdis_thebuf;
-    tdis_buf_len = newsize;
+  return(0);
+  }  /* END tcp_send_file() */
 
-    if (max_read_len > tdis_buf_len)
-      {
-      snprintf(err_msg, sizeof(err_msg), "eod ptr BEYOND end of buffer!!(expand) Remaining buffer = %d, read_len = %lld", max_read_len, *read_len);
-      log_err(PBSE_INTERNAL,__func__,err_msg);
-      }
 
-    free(new_data);
-    }
 
-  return(rc);
-  }  /* END tcp_read() */
+/*
+ * tcp_cork()
+ *
+ * Holds back partial packets while a message goes out in several writes, and
+ * sends what is left when released. Sockets that aren't tcp ignore this.
+ */
 
+static void tcp_cork(
 
+  struct tcp_chan *chan,
+  int              cork)
+
+  {
+#ifdef TCP_CORK
+  setsockopt(chan->sock, IPPROTO_TCP, TCP_CORK, &cork, sizeof(cork));
+#endif
+  }  /* END tcp_cork() */
 
 
 
@@ -302,6 +451,7 @@ int tcp_read(
  *
  * Writes "committed" data in buffer to file discriptor,
  * packs remaining data (if any), resets pointers
+ * If a file was put with DIS_tcp_put_file() it is sent where it was put.
  * Returns: 0 on success, -1 on error
  *      NOTE:  does not close fd
  *
@@ -312,41 +462,35 @@ int DIS_tcp_wflush(
   struct tcp_chan *chan)  /* I */
 
   {
-  int               i;
-  char             *pbs_debug = NULL;
-
+  int               rc;
   struct tcpdisbuf *tp = &chan->writebuf;
   char             *pb = tp->tdis_thebuf;
   size_t            ct = tp->tdis_trailp - tp->tdis_thebuf;
 
-  pbs_debug = getenv("PBSDEBUG");
+  if ((chan->file_len > 0) &&
+      (chan->file_committed == TRUE))
+    {
+    tcp_cork(chan, TRUE);
+
+    if (((rc = tcp_write_all(chan, pb, chan->file_at)) == 0) &&
+        ((rc = tcp_send_file(chan, chan->file_fd, chan->file_offset, chan->file_len)) == 0))
+      rc = tcp_write_all(chan, pb + chan->file_at, ct - chan->file_at);
 
-  while ((i = write_ac_socket(chan->sock, pb, ct)) != (ssize_t)ct)
+    tcp_cork(chan, FALSE);
+
+    chan->file_len = 0;
+    }
+  else
     {
-    if (i == -1)
-      {
-      if (errno == EINTR)
-        {
-        continue;
-        }
+    rc = tcp_write_all(chan, pb, ct);
 
-      /* FAILURE */
+    /* a file that isn't committed yet moves to the front with the data around it */
+    if (chan->file_len > 0)
+      chan->file_at -= ct;
+    }
 
-      if (pbs_debug != NULL)
-        {
-        fprintf(stderr,
-          "TCP write of %d bytes (%.32s) [sock=%d] failed, errno=%d (%s)\n",
-          (int)ct, pb, chan->sock, errno, strerror(errno));
-        }
-      
-      return(-1);
-      }  /* END if (i == -1) */
-    else
-      {
-      ct -= i;
-      pb += i;
-      }
-    }  /* END while (i) */
+  if (rc != 0)
+    return(-1);
 
   /* SUCCESS */
 
@@ -390,7 +534,10 @@ void DIS_tcp_reset(
   if (i == 0)
     DIS_tcp_clear(&chan->readbuf);
   else
+    {
     DIS_tcp_clear(&chan->writebuf);
+    chan->file_len = 0;
+    }
   return;
   }  /* END DIS_tcp_reset() */
 
@@ -501,16 +648,8 @@ int tcp_puts(
 
   {
   struct tcpdisbuf *tp = NULL;
-  char             *temp = NULL;
-  int               leadpct;
-  int               trailpct; 
-  size_t            newbufsize;
   char              log_buf[LOCAL_LOG_BUF_SIZE];
 
-  /* NOTE:  currently, failures may occur if THE_BUF_SIZE is not large enough */
-  /*        this should be changed to allow proper operation with degraded    */
-  /*        performance (how?) */
-
   tp = &chan->writebuf;
 
   if (tp->tdis_bufsize == 0)
@@ -523,38 +662,20 @@ int tcp_puts(
 
   if ((tp->tdis_thebuf + tp->tdis_bufsize - tp->tdis_leadp) < (ssize_t)ct)
     {
-    /* not enough room, reallocate the buffer */
-    leadpct = (int)(tp->tdis_thebuf - tp->tdis_leadp);
-    trailpct = (int)(tp->tdis_thebuf - tp->tdis_trailp);
-    newbufsize = tp->tdis_bufsize + THE_BUF_SIZE + ct*2;
-    temp = (char *)calloc(1, newbufsize+1);
-    if (!temp)
+    /* not enough room. The write buffer's data ends at tdis_leadp */
+    tp->tdis_eod = tp->tdis_leadp;
+
+    if (tcp_grow_buff(tp, ct, FALSE) != PBSE_NONE)
       {
       /* FAILURE */
       snprintf(log_buf,sizeof(log_buf),
-        "out of space in buffer and cannot calloc message buffer (bufsize=%ld, buflen=%d, ct=%d)\n",
+        "out of space in buffer and cannot realloc message buffer (bufsize=%ld, buflen=%d, ct=%d)\n",
         tp->tdis_bufsize,
         (int)(tp->tdis_leadp - tp->tdis_thebuf),
         (int)ct);
       log_err(ENOMEM, __func__, log_buf);
       return(-1);
       }
-
-    memcpy(temp, tp->tdis_thebuf, tp->tdis_bufsize);
-    if (strlen(tp->tdis_thebuf) > tp->tdis_bufsize)
-      {
-      snprintf(log_buf, sizeof(log_buf),
-          "line #%d, The length of the string is GREATER than the size of buf",
-          __LINE__);
-      log_err(ENOMEM, __func__, log_buf);
-      }
-    free(tp->tdis_thebuf);
-    tp->tdis_thebuf = temp;
-    tp->tdis_bufsize = newbufsize;
-    tp->tdis_leadp = tp->tdis_thebuf - leadpct;
-    tp->tdis_trailp = tp->tdis_thebuf - trailpct;
-    tp->tdis_eod = tp->tdis_thebuf + newbufsize;
-
     }
 
   memcpy(tp->tdis_leadp, (char *)str, ct);
@@ -622,15 +743,68 @@ int tcp_wcommit(
     /* commit by moving trailing up */
 
     tp->tdis_trailp = tp->tdis_leadp;
+
+    chan->file_committed = TRUE;
     }
   else
     {
     /* uncommit by moving leading back */
 
     tp->tdis_leadp = tp->tdis_trailp;
+
+    /* a file put since the last commit is taken back too */
+    if (chan->file_committed == FALSE)
+      chan->file_len = 0;
     }
   return(0);
-  }
+  }  /* END tcp_wcommit() */
+
+
+
+/*
+ * DIS_tcp_put_file()
+ *
+ * Puts len bytes of a file, starting at offset, into chan's write stream
+ * after what has been written so far. The bytes aren't copied into the
+ * write buffer; DIS_tcp_wflush() sends them straight from the file. fd must
+ * stay open until then. Like tcp_puts(), the file isn't committed.
+ *
+ * @param chan - the channel to write to
+ * @param fd - the file to send
+ * @param offset - where in the file to start
+ * @param len - how many bytes to send
+ * @return 0 on success, -1 on error
+ */
+
+int DIS_tcp_put_file(
+
+  struct tcp_chan *chan,
+  int              fd,
+  off_t            offset,
+  size_t           len)
+
+  {
+  struct tcpdisbuf *tp = &chan->writebuf;
+
+  if (len == 0)
+    return(0);
+
+  /* only one file can be waiting, so send the one before this one now */
+  if (chan->file_len > 0)
+    {
+    if ((chan->file_committed == FALSE) ||
+        (DIS_tcp_wflush(chan) != 0))
+      return(-1);
+    }
+
+  chan->file_committed = FALSE;
+  chan->file_fd = fd;
+  chan->file_offset = offset;
+  chan->file_len = len;
+  chan->file_at = tp->tdis_leadp - tp->tdis_thebuf;
+
+  return(0);
+  }  /* END DIS_tcp_put_file() */
 
 
 
@@ -752,4 +926,78 @@ void DIS_tcp_close(
     close(sock);
   }
 
+
+
+/*
+ * DIS_tcp_set_peer_version()
+ *
+ * Records the DIS encoding the other end of sock has shown it understands.
+ * Requests sent on sock are encoded this way from then on.
+ *
+ * @param sock - the connection
+ * @param version - DIS_VERSION_TEXT or DIS_VERSION_BINARY
+ */
+
+void DIS_tcp_set_peer_version(
+
+  int sock,
+  int version)
+
+  {
+  if ((sock >= 0) &&
+      (sock < MAX_SOCKETS))
+    peer_version[sock] = (char)version;
+  } // END DIS_tcp_set_peer_version()
+
+
+
+int DIS_tcp_get_peer_version(
+
+  int sock)
+
+  {
+  if ((sock < 0) ||
+      (sock >= MAX_SOCKETS))
+    return(DIS_VERSION_TEXT);
+
+  return(peer_version[sock]);
+  } // END DIS_tcp_get_peer_version()
+
+
+
+/*
+ * DIS_tcp_set_reply_version()
+ *
+ * Records the DIS encoding replies to the request being processed on sock
+ * should use.
+ *
+ * @param sock - the connection
+ * @param version - DIS_VERSION_TEXT or DIS_VERSION_BINARY
+ */
+
+void DIS_tcp_set_reply_version(
+
+  int sock,
+  int version)
+
+  {
+  if ((sock >= 0) &&
+      (sock < MAX_SOCKETS))
+    reply_version[sock] = (char)version;
+  } // END DIS_tcp_set_reply_version()
+
+
+
+int DIS_tcp_get_reply_version(
+
+  int sock)
+
+  {
+  if ((sock < 0) ||
+      (sock >= MAX_SOCKETS))
+    return(DIS_VERSION_TEXT);
+
+  return(reply_version[sock]);
+  } // END DIS_tcp_get_reply_version()
+
 /* END tcp_dis.c */
@@ -20,9 +20,19 @@
 #include <stdarg.h>
 #include <string.h>
 #include <string>
+#include <vector>
+#include <pthread.h>
+#include <time.h>
 
 #define MAX_RETRIES 5
 
+/* connections to pbs_server kept open between authorizations, see take_svr_conn().
+ * Each one holds a pbs_server worker thread while it is open, so they are kept
+ * only briefly */
+#define MAX_IDLE_SVR_CONNS   4
+#define SVR_CONN_IDLE_LIMIT  3 /* seconds, inside the server's 5 second first wait */
+#define SVR_CONN_REAP_PERIOD 1 /* seconds between checks for idle connections */
+
 char         *trq_addr = NULL;
 int           trq_addr_len;
 char         *trq_server_name = NULL;
@@ -35,6 +45,22 @@ pbs_net_t  trq_server_addr;
 char       trq_hostname[PBS_MAXSERVERNAME + 1];
 
 extern time_t pbs_tcp_timeout;
+
+class idle_svr_conn
+  {
+  public:
+  std::string server;
+  int         port;
+  int         sock;
+  std::string user;
+  time_t      last_used;
+  };
+
+std::vector<idle_svr_conn> idle_svr_conns;
+pthread_mutex_t            idle_svr_conns_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t             svr_conn_reaper_once = PTHREAD_ONCE_INIT;
+bool                       svr_conn_reaper_running = false;
+
 #ifdef UNIT_TEST
   int process_svr_conn_rc;
 #endif
@@ -834,6 +860,226 @@ void send_svr_disconnect(int sock, const char *user_name)
 
 
 
+/*
+ * close_idle_svr_conns()
+ *
+ * Disconnects the kept connections to pbs_server that have been idle for
+ * longer than SVR_CONN_IDLE_LIMIT.
+ *
+ * pbs_server gives a connection a worker thread that waits for the next
+ * request: 5 seconds at first, then, unless the server is busy, up to its
+ * tcp_timeout (300 seconds by default). A kept connection therefore holds one
+ * of the server's threads until it is closed. Closing it before the first wait
+ * runs out frees that thread at once, rather than leaving it waiting for the
+ * whole tcp_timeout. If tcp_timeout is set below SVR_CONN_IDLE_LIMIT, the
+ * server closes the connection first. A reuse then fails, and
+ * authorize_socket() moves on to a new connection.
+ *
+ * @param now - the current time
+ * @return the number of connections closed
+ */
+
+int close_idle_svr_conns(
+
+  time_t now)
+
+  {
+  std::vector<idle_svr_conn> expired;
+
+  pthread_mutex_lock(&idle_svr_conns_mutex);
+
+  for (int i = (int)idle_svr_conns.size() - 1; i >= 0; i--)
+    {
+    if (now - idle_svr_conns[i].last_used > SVR_CONN_IDLE_LIMIT)
+      {
+      expired.push_back(idle_svr_conns[i]);
+      idle_svr_conns.erase(idle_svr_conns.begin() + i);
+      }
+    }
+
+  pthread_mutex_unlock(&idle_svr_conns_mutex);
+
+  for (unsigned int i = 0; i < expired.size(); i++)
+    {
+    send_svr_disconnect(expired[i].sock, expired[i].user.c_str());
+    socket_close(expired[i].sock);
+    }
+
+  return((int)expired.size());
+  } /* END close_idle_svr_conns() */
+
+
+
+void *reap_idle_svr_conns(
+
+  void *vp)
+
+  {
+  while (true)
+    {
+    sleep(SVR_CONN_REAP_PERIOD);
+
+    close_idle_svr_conns(time(NULL));
+    }
+
+  /* NOTREACHED */
+  return(NULL);
+  } /* END reap_idle_svr_conns() */
+
+
+
+/*
+ * start_svr_conn_reaper()
+ *
+ * Starts the thread that closes idle connections. This happens on the first
+ * give_svr_conn(), so the thread starts in the daemonized trqauthd, not in the
+ * process that forked it.
+ */
+
+void start_svr_conn_reaper(void)
+
+  {
+  pthread_t      reaper;
+  pthread_attr_t attr;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  if (pthread_create(&reaper, &attr, reap_idle_svr_conns, NULL) == 0)
+    svr_conn_reaper_running = true;
+  else
+    log_record(PBSEVENT_CLIENTAUTH | PBSEVENT_FORCE, PBS_EVENTCLASS_TRQAUTHD, __func__,
+      "Could not start the idle connection thread, connections to pbs_server will not be kept");
+
+  pthread_attr_destroy(&attr);
+  } /* END start_svr_conn_reaper() */
+
+
+
+/*
+ * take_svr_conn()
+ *
+ * Takes a connection to pbs_server left open by an earlier authorization.
+ * pbs_server reads requests from a connection until it is closed, so one
+ * connection can carry many AuthenUser requests, which saves a privileged
+ * connect and the server's accept for every client command. Connections idle
+ * for longer than SVR_CONN_IDLE_LIMIT are left for close_idle_svr_conns().
+ *
+ * @param server_name - the server to connect to
+ * @param server_port - the server's port
+ * @return the connection's socket, or -1 if there is no open connection
+ */
+
+int take_svr_conn(
+
+  const char *server_name,
+  int         server_port)
+
+  {
+  time_t now = time(NULL);
+  int    sock = -1;
+
+  pthread_mutex_lock(&idle_svr_conns_mutex);
+
+  for (int i = (int)idle_svr_conns.size() - 1; i >= 0; i--)
+    {
+    idle_svr_conn &conn = idle_svr_conns[i];
+
+    if ((now - conn.last_used <= SVR_CONN_IDLE_LIMIT) &&
+        (conn.port == server_port) &&
+        (conn.server == server_name))
+      {
+      sock = conn.sock;
+      idle_svr_conns.erase(idle_svr_conns.begin() + i);
+      break;
+      }
+    }
+
+  pthread_mutex_unlock(&idle_svr_conns_mutex);
+
+  return(sock);
+  } /* END take_svr_conn() */
+
+
+
+/*
+ * give_svr_conn()
+ *
+ * Keeps a connection to pbs_server open for take_svr_conn(). It is
+ * disconnected instead if MAX_IDLE_SVR_CONNS connections are already open,
+ * or if there is no thread to close it once it goes idle.
+ *
+ * @param server_name - the server the connection is to
+ * @param server_port - the server's port
+ * @param sock - the connection's socket
+ * @param user_name - the user the connection last authorized
+ */
+
+void give_svr_conn(
+
+  const char *server_name,
+  int         server_port,
+  int         sock,
+  const char *user_name)
+
+  {
+  idle_svr_conn conn;
+
+  pthread_once(&svr_conn_reaper_once, start_svr_conn_reaper);
+
+  pthread_mutex_lock(&idle_svr_conns_mutex);
+
+  if ((svr_conn_reaper_running == true) &&
+      (idle_svr_conns.size() < MAX_IDLE_SVR_CONNS))
+    {
+    conn.server = server_name;
+    conn.port = server_port;
+    conn.sock = sock;
+    conn.user = user_name;
+    conn.last_used = time(NULL);
+
+    idle_svr_conns.push_back(conn);
+    sock = -1;
+    }
+
+  pthread_mutex_unlock(&idle_svr_conns_mutex);
+
+  if (sock >= 0)
+    {
+    send_svr_disconnect(sock, user_name);
+    socket_close(sock);
+    }
+  } /* END give_svr_conn() */
+
+
+
+/*
+ * get_svr_sock()
+ *
+ * @param reused - set to true if the socket is an open connection from
+ * take_svr_conn(), false if it is a new privileged socket to connect
+ * @return the socket, or -1 if no socket could be had
+ */
+
+int get_svr_sock(
+
+  const char *server_name,
+  int         server_port,
+  bool       &reused)
+
+  {
+  int sock = take_svr_conn(server_name, server_port);
+
+  reused = (sock >= 0);
+
+  if (reused == false)
+    sock = socket_get_tcp_priv();
+
+  return(sock);
+  } /* END get_svr_sock() */
+
+
+
 /*
  * authorize_socket()
  *
@@ -852,6 +1098,7 @@ int authorize_socket(
   {
   int          rc;
   bool         disconnect_svr = true;
+  bool         reused = false;
   int          server_port;
   int          auth_type = 0;
   int          svr_sock = -1;
@@ -897,6 +1144,12 @@ int authorize_socket(
       rc = PBSE_NONE;
       disconnect_svr = true;
 
+      if (trq_server_addr != NULL)
+        {
+        free(trq_server_addr);
+        trq_server_addr = NULL;
+        }
+
       if ((rc = validate_user(local_socket, *user_name_ptr, user_pid, msg_buf)) != PBSE_NONE)
         {
         log_record(PBSEVENT_CLIENTAUTH | PBSEVENT_FORCE, PBS_EVENTCLASS_TRQAUTHD, __func__, msg_buf);
@@ -912,7 +1165,7 @@ int authorize_socket(
         usleep(20000);
         continue;
         }
-      else if ((svr_sock = socket_get_tcp_priv()) < 0)
+      else if ((svr_sock = get_svr_sock(server_name, server_port, reused)) < 0)
         {
         rc = PBSE_SOCKET_FAULT;
         disconnect_svr = false;
@@ -920,7 +1173,8 @@ int authorize_socket(
         usleep(10000);
         continue;
         }
-      else if ((rc = socket_connect(svr_sock, trq_server_addr, trq_server_addr_len, server_port, AF_INET, 1, err_msg)) != PBSE_NONE)
+      else if ((reused == false) &&
+               ((rc = socket_connect(svr_sock, trq_server_addr, trq_server_addr_len, server_port, AF_INET, 1, err_msg)) != PBSE_NONE))
         {
         /* for now we only need ssh_key and sign_key as dummys */
         char *ssh_key = NULL;
@@ -958,16 +1212,28 @@ int authorize_socket(
         socket_close(svr_sock);
         disconnect_svr = false;
         rc = PBSE_SOCKET_WRITE;
-        retries++;
-        usleep(50000);
+
+        /* the server may have dropped a reused connection, so go straight
+         * to a new one */
+        if (reused == false)
+          {
+          retries++;
+          usleep(50000);
+          }
+
         continue;
         }
       else if ((rc = parse_response_svr(svr_sock, err_msg)) != PBSE_NONE)
         {
         socket_close(svr_sock);
         disconnect_svr = false;
-        retries++;
-        usleep(50000);
+
+        if (reused == false)
+          {
+          retries++;
+          usleep(50000);
+          }
+
         continue;
         }
       else
@@ -991,10 +1257,7 @@ int authorize_socket(
     }
 
   if (disconnect_svr == true)
-    {
-    send_svr_disconnect(svr_sock, *user_name_ptr);
-    socket_close(svr_sock);
-    }
+    give_svr_conn(*server_name_ptr, server_port, svr_sock, *user_name_ptr);
 
   if (trq_server_addr != NULL)
     free(trq_server_addr);
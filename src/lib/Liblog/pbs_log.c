@@ -88,6 +88,8 @@
  * log_close()
  * log_roll()
  * log_size()
+ * log_async_start()
+ * log_async_stop()
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
@@ -112,6 +114,8 @@
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
+#include <sys/uio.h>
+#include <string>
 
 #include "log.h"
 #if SYSLOG
@@ -174,10 +178,66 @@ static const char *class_names[] =
   "mom"
   };
 
+/*
+ * The date and time of a second, formatted once and reused for every message
+ * logged during that second.
+ */
+
+typedef struct log_time_cache
+  {
+  time_t sec;
+  int    yday;
+  char   stamp[72]; /* MM/DD/YYYY HH:MM:SS, with room for any int in each field */
+  } log_time_cache;
+
+static log_time_cache log_time;  /* for synchronous logging, under log_mutex */
+
+/*
+ * Asynchronous logging
+ *
+ * Once log_async_start() is called, log_record() formats each message and
+ * copies it into a ring owned by the calling thread instead of writing it
+ * itself. Only that thread moves the ring's tail and only the drainer moves
+ * its head, so neither needs a lock. A writer thread drains all of the rings
+ * with one writev() while holding log_mutex, so anything else that holds
+ * log_mutex, such as log_roll(), can drain the rings itself and knows the
+ * writer is out of the way. A message that doesn't fit in its ring is
+ * dropped and counted, and the count is logged once there is room.
+ */
+
+#define LOG_RING_SIZE       (256 * 1024) /* must be a power of 2 */
+#define LOG_ASYNC_WAIT_MS   100          /* longest the writer sleeps with data waiting */
+#define LOG_IOV_MAX         64
+
+typedef struct log_ring
+  {
+  char            *buf;
+  size_t           head;     /* bytes drained so far, moved only by the drainer */
+  size_t           tail;     /* bytes put so far, moved only by the owning thread */
+  unsigned long    dropped;  /* messages that didn't fit */
+  int              orphaned; /* the owning thread has exited */
+  log_time_cache   time;
+  struct log_ring *next;
+  } log_ring;
+
+static log_ring        *log_rings = NULL;
+static pthread_mutex_t  log_ring_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t    log_ring_key;
+static pthread_once_t   log_ring_key_once = PTHREAD_ONCE_INIT;
+static pthread_cond_t   log_async_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t  log_async_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t        log_async_thread;
+static volatile int     log_async_running = 0;
+static pid_t            log_async_pid = 0;    /* the process that started the writer */
+
 /* External functions called */
 
 /* local prototypes */
 const char *log_get_severity_string(int);
+static void log_record_sync(int, int, const char *, const char *);
+static log_ring *log_get_ring(void);
+static void log_ring_put(log_ring *, const char *, size_t);
+static size_t log_async_drain(void);
 
 
 /*
@@ -401,7 +461,7 @@ int log_open(
   else
     snprintf(buf2, sizeof(buf2), "Log opened");
 
-  log_record(
+  log_record_sync(
     PBSEVENT_SYSTEM,
     PBS_EVENTCLASS_SERVER,
     "Log",
@@ -748,6 +808,114 @@ bool log_available(int eventtype)
   }
 
 
+/*
+ * log_update_time_cache()
+ *
+ * Makes tc hold the date and time for now, calling localtime_r() only when
+ * the second has changed.
+ */
+
+static void log_update_time_cache(
+
+  log_time_cache *tc,
+  time_t          now)
+
+  {
+  struct tm  tmpPtm;
+  struct tm *ptm;
+
+  if ((now == tc->sec) &&
+      (tc->stamp[0] != '\0'))
+    return;
+
+  ptm = localtime_r(&now, &tmpPtm);
+
+  snprintf(tc->stamp, sizeof(tc->stamp), "%02d/%02d/%04d %02d:%02d:%02d",
+    ptm->tm_mon + 1,
+    ptm->tm_mday,
+    ptm->tm_year + 1900,
+    ptm->tm_hour,
+    ptm->tm_min,
+    ptm->tm_sec);
+
+  tc->sec = now;
+  tc->yday = ptm->tm_yday;
+  }  /* END log_update_time_cache() */
+
+
+
+/*
+ * log_format_message()
+ *
+ * Appends the log lines for a message to out. The text is split on its
+ * newlines, with "\r\n" counting as one, and each piece after the first is
+ * marked as continued. When stamp is NULL the lines use the trqauthd format,
+ * which starts with trq_stamp.
+ */
+
+static void log_format_message(
+
+  std::string &out,
+  const char  *stamp,
+  int          milliseconds,
+  const char  *trq_stamp,
+  int          eventtype,
+  pid_t        thr_id,
+  int          objclass,
+  const char  *objname,
+  const char  *text)
+
+  {
+  char        head[128];
+  const char *start = text;
+  const char *end;
+
+  if (stamp != NULL)
+    {
+    snprintf(head, sizeof(head), "%s.%03d;%02d;%10.10s.%d;%s;",
+      stamp,
+      milliseconds,
+      (eventtype & ~PBSEVENT_FORCE),
+      msg_daemonname,
+      thr_id,
+      class_names[objclass]);
+    }
+
+  while (1)
+    {
+    for (end = start; *end != '\n' && *end != '\r' && *end != '\0'; end++)
+      ;
+
+    if (stamp != NULL)
+      {
+      out += head;
+      out += objname;
+      out += ';';
+      }
+    else
+      {
+      out += trq_stamp;
+      out += ' ';
+      }
+
+    if (start != text)
+      out += "[continued]";
+
+    out.append(start, end - start);
+    out += '\n';
+
+    if (*end == '\r' && *(end + 1) == '\n')
+      end++;
+
+    if (*end == '\0')
+      break;
+
+    start = end + 1;
+    }
+  }  /* END log_format_message() */
+
+
+
 /*
  * log_record - log a message to the log file
  * The log file must have been opened by log_open().
@@ -756,6 +924,9 @@ bool log_available(int eventtype)
  *
  * The caller should ensure proper formating of the message if "text"
  * is to contain "continuation lines".
+ *
+ * After log_async_start() the message is queued for the log writer thread
+ * instead of being written before this returns.
  */
 
 void log_record(
@@ -765,20 +936,69 @@ void log_record(
   const char *objname,    /* I */
   const char *text)       /* I */
 
+  {
+  log_ring       *ring;
+  struct timeval  mytime;
+  int             eventclass = 0;
+  std::string     msg;
+
+  if ((log_async_running == 0) ||
+      (eventtype & PBSEVENT_SYSLOG))
+    {
+    log_record_sync(eventtype, objclass, objname, text);
+    return;
+    }
+
+  log_get_set_eventclass(&eventclass, GETV);
+
+  if ((eventclass == PBS_EVENTCLASS_TRQAUTHD) ||
+      ((ring = log_get_ring()) == NULL))
+    {
+    log_record_sync(eventtype, objclass, objname, text);
+    return;
+    }
+
+  if (log_opened < 1)
+    return;
+
+  gettimeofday(&mytime, NULL);
+  log_update_time_cache(&ring->time, mytime.tv_sec);
+
+  log_format_message(msg, ring->time.stamp, mytime.tv_usec / 1000, NULL,
+    eventtype, syscall(SYS_gettid), objclass, objname, text);
+
+  log_ring_put(ring, msg.c_str(), msg.length());
+
+  return;
+  }  /* END log_record() */
+
+
+
+
+/*
+ * log_record_sync()
+ *
+ * Writes a message to the log file before returning. This is how every
+ * message is logged until log_async_start() is called.
+ */
+
+static void log_record_sync(
+
+  int         eventtype,  /* I */
+  int         objclass,   /* I */
+  const char *objname,    /* I */
+  const char *text)       /* I */
+
   {
   int tryagain = 2;
-  time_t now;
   pid_t  thr_id = -1;
 
-  struct tm *ptm;
-  struct tm  tmpPtm;
   struct timeval mytime;
   int    rc = 0;
   FILE  *savlog;
-  char  *start = NULL, *end = NULL;
-  size_t nchars;
   int eventclass = 0;
   char time_formatted_str[64];
+  std::string msg;
 
   thr_id = syscall(SYS_gettid);
   pthread_mutex_lock(&log_mutex);
@@ -803,19 +1023,15 @@ void log_record(
     return;
     }
 
-  now = time((time_t *)0); /* get time for message */
-
-  ptm = localtime_r(&now,&tmpPtm);
-
-  /* mytime used to calculate milliseconds */
+  /* get time for message, mytime is also used to calculate milliseconds */
 
   gettimeofday(&mytime, NULL);
 
-  int milliseconds = mytime.tv_usec/1000;
+  log_update_time_cache(&log_time, mytime.tv_sec);
 
   /* Do we need to switch the log? */
 
-  if (log_auto_switch && (ptm->tm_yday != log_open_day))
+  if (log_auto_switch && (log_time.yday != log_open_day))
     {
     log_close(1);
 
@@ -828,85 +1044,39 @@ void log_record(
       }
     }
 
-  time_formatted_str[0] = 0;
   log_get_set_eventclass(&eventclass, GETV);
   if (eventclass == PBS_EVENTCLASS_TRQAUTHD)
     {
     log_format_trq_timestamp(time_formatted_str, sizeof(time_formatted_str));
-    }
-
-  /*
-   * Looking for the newline characters and splitting the output message
-   * on them.  Sequence "\r\n" is mapped to the single newline.
-   */
-  start = (char *)text;
 
-  while (1)
+    log_format_message(msg, NULL, 0, time_formatted_str, eventtype, thr_id, objclass, objname, text);
+    }
+  else
     {
-    for (end = start; *end != '\n' && *end != '\r' && *end != '\0'; end++)
-      ;
-
-    nchars = end - start;
+    log_format_message(msg, log_time.stamp, mytime.tv_usec / 1000, NULL,
+      eventtype, thr_id, objclass, objname, text);
+    }
 
-    if (*end == '\r' && *(end + 1) == '\n')
-      end++;
+  while (tryagain)
+    {
+    rc = fputs(msg.c_str(), logfile);
 
-    while (tryagain)
+    if ((rc < 0) &&
+        (errno == EPIPE) &&
+        (tryagain == 2))
       {
-      if (eventclass != PBS_EVENTCLASS_TRQAUTHD)
-        {
-        rc = fprintf(logfile,
-              "%02d/%02d/%04d %02d:%02d:%02d.%03d;%02d;%10.10s.%d;%s;%s;%s%.*s\n",
-              ptm->tm_mon + 1,
-              ptm->tm_mday,
-              ptm->tm_year + 1900,
-              ptm->tm_hour,
-              ptm->tm_min,
-              ptm->tm_sec,
-			        milliseconds,
-              (eventtype & ~PBSEVENT_FORCE),
-              msg_daemonname,
-              thr_id,
-              class_names[objclass],
-              objname,
-              (text == start ? "" : "[continued]"),
-              (int)nchars,
-              start);
-        }
-      else
-        {
-        rc = fprintf(logfile,
-              "%s %s%.*s\n",
-              time_formatted_str,
-              (text == start ? "" : "[continued]"),
-              (int)nchars,
-              start);
-        }
-      if ((rc < 0) &&
-          (errno == EPIPE) &&
-          (tryagain == 2))
-        {
-        /* the log file descriptor has been changed--it now points to a socket!
-         * reopen log and leave the previous file descriptor alone--do not close it */
+      /* the log file descriptor has been changed--it now points to a socket!
+       * reopen log and leave the previous file descriptor alone--do not close it */
 
-        log_opened = 0;
-        log_open(NULL, log_directory);
-        tryagain--;
-        }
-      else
-        {
-        tryagain = 0;
-        }
+      log_opened = 0;
+      log_open(NULL, log_directory);
+      tryagain--;
       }
-
-    if (rc < 0)
-      break;
-
-    if (*end == '\0')
-      break;
-
-    start = end + 1;
-    }  /* END while (1) */
+    else
+      {
+      tryagain = 0;
+      }
+    }
 
   fflush(logfile);
 
@@ -932,7 +1102,7 @@ void log_record(
   pthread_mutex_unlock(&log_mutex);
 
   return;
-  }  /* END log_record() */
+  }  /* END log_record_sync() */
 
 
 
@@ -951,6 +1121,11 @@ void log_close(
     {
     log_auto_switch = 0;
 
+    /* queued messages belong in this file */
+    pthread_mutex_lock(&log_mutex);
+    log_async_drain();
+    pthread_mutex_unlock(&log_mutex);
+
     if (msg)
       {
       if (log_host_port[0])
@@ -959,7 +1134,7 @@ void log_close(
         snprintf(buf, sizeof(buf), "Log closed");
 
       pthread_mutex_unlock(&log_mutex);
-      log_record(
+      log_record_sync(
         PBSEVENT_SYSTEM,
         PBS_EVENTCLASS_SERVER,
         "Log",
@@ -976,6 +1151,487 @@ void log_close(
   return;
   }  /* END log_close() */
 
+/*
+ * log_ring_orphan()
+ *
+ * Called when a thread that has a ring exits. The ring is freed once the
+ * writer has drained it.
+ */
+
+static void log_ring_orphan(
+
+  void *arg)
+
+  {
+  log_ring *ring = (log_ring *)arg;
+
+  __atomic_store_n(&ring->orphaned, 1, __ATOMIC_RELEASE);
+  }  /* END log_ring_orphan() */
+
+
+
+static void log_ring_key_init(void)
+
+  {
+  pthread_key_create(&log_ring_key, log_ring_orphan);
+  }  /* END log_ring_key_init() */
+
+
+
+/*
+ * log_get_ring()
+ *
+ * @return the calling thread's ring, creating it the first time, or NULL if
+ * there isn't memory for one
+ */
+
+static log_ring *log_get_ring(void)
+
+  {
+  log_ring *ring;
+
+  pthread_once(&log_ring_key_once, log_ring_key_init);
+
+  if ((ring = (log_ring *)pthread_getspecific(log_ring_key)) != NULL)
+    return(ring);
+
+  if ((ring = (log_ring *)calloc(1, sizeof(log_ring))) == NULL)
+    return(NULL);
+
+  if ((ring->buf = (char *)malloc(LOG_RING_SIZE)) == NULL)
+    {
+    free(ring);
+    return(NULL);
+    }
+
+  pthread_mutex_lock(&log_ring_mutex);
+  ring->next = log_rings;
+  log_rings = ring;
+  pthread_mutex_unlock(&log_ring_mutex);
+
+  pthread_setspecific(log_ring_key, ring);
+
+  return(ring);
+  }  /* END log_get_ring() */
+
+
+
+/*
+ * log_ring_put()
+ *
+ * Copies a formatted message into ring, or counts it as dropped if it
+ * doesn't fit. Only the ring's own thread calls this.
+ */
+
+static void log_ring_put(
+
+  log_ring   *ring,
+  const char *data,
+  size_t      len)
+
+  {
+  size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  size_t tail = ring->tail;
+  size_t at = tail & (LOG_RING_SIZE - 1);
+  size_t first;
+
+  if (len > LOG_RING_SIZE - (tail - head))
+    {
+    __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+    return;
+    }
+
+  first = LOG_RING_SIZE - at;
+
+  if (first > len)
+    first = len;
+
+  memcpy(ring->buf + at, data, first);
+  memcpy(ring->buf, data + first, len - first);
+
+  __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+
+  /* the writer may be asleep if nothing was waiting */
+  if (head == tail)
+    pthread_cond_signal(&log_async_cond);
+  }  /* END log_ring_put() */
+
+
+
+/*
+ * log_writev_all()
+ *
+ * writev() that keeps going after a partial write.
+ *
+ * @return 0 on success, -1 on error with errno set
+ */
+
+static int log_writev_all(
+
+  int           fd,
+  struct iovec *iov,
+  int           count)
+
+  {
+  ssize_t written;
+
+  while (count > 0)
+    {
+    if ((written = writev(fd, iov, count)) < 0)
+      {
+      if (errno == EINTR)
+        continue;
+
+      return(-1);
+      }
+
+    while ((count > 0) &&
+           ((size_t)written >= iov->iov_len))
+      {
+      written -= iov->iov_len;
+      iov++;
+      count--;
+      }
+
+    if (count > 0)
+      {
+      iov->iov_base = (char *)iov->iov_base + written;
+      iov->iov_len -= written;
+      }
+    }
+
+  return(0);
+  }  /* END log_writev_all() */
+
+
+
+/*
+ * log_async_drain()
+ *
+ * Writes everything queued in the rings to the log file, a batch of rings
+ * per writev(). Messages are discarded if the log isn't open, just as
+ * log_record() discards them. The caller must hold log_mutex.
+ *
+ * @return the number of bytes taken from the rings
+ */
+
+static size_t log_async_drain(void)
+
+  {
+  size_t         drained = 0;
+  struct iovec   iov[LOG_IOV_MAX];
+  log_ring      *batch[LOG_IOV_MAX / 2];
+  size_t         batch_tail[LOG_IOV_MAX / 2];
+  char           notes[LOG_IOV_MAX / 2][256];
+  int            iov_count = 0;
+  int            batch_count = 0;
+  log_ring      *ring;
+  log_ring     **prev;
+  unsigned long  dropped;
+  struct timeval now;
+  log_time_cache tc;
+
+  pthread_mutex_lock(&log_ring_mutex);
+
+  if (log_rings == NULL)
+    {
+    pthread_mutex_unlock(&log_ring_mutex);
+    return(0);
+    }
+
+  pthread_mutex_unlock(&log_ring_mutex);
+
+  /* switch to the new day's log before taking anything from the rings */
+  gettimeofday(&now, NULL);
+  memset(&tc, 0, sizeof(tc));
+  log_update_time_cache(&tc, now.tv_sec);
+
+  if ((log_opened > 0) &&
+      (log_auto_switch) &&
+      (tc.yday != log_open_day))
+    {
+    log_close(1);
+    log_open(NULL, log_directory);
+    }
+
+  pthread_mutex_lock(&log_ring_mutex);
+
+  ring = log_rings;
+
+  while (ring != NULL)
+    {
+    size_t head = ring->head;
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t at = head & (LOG_RING_SIZE - 1);
+    size_t len = tail - head;
+
+    if ((dropped = __atomic_exchange_n(&ring->dropped, 0, __ATOMIC_RELAXED)) != 0)
+      {
+      snprintf(notes[batch_count], sizeof(notes[batch_count]),
+        "%s.%03d;%02d;%10.10s.%d;%s;Log;%lu messages were dropped because the log writer fell behind\n",
+        tc.stamp,
+        (int)(now.tv_usec / 1000),
+        PBSEVENT_SYSTEM,
+        msg_daemonname,
+        (int)syscall(SYS_gettid),
+        class_names[PBS_EVENTCLASS_SERVER],
+        dropped);
+
+      iov[iov_count].iov_base = notes[batch_count];
+      iov[iov_count++].iov_len = strlen(notes[batch_count]);
+      }
+
+    if (len > LOG_RING_SIZE - at)
+      {
+      iov[iov_count].iov_base = ring->buf + at;
+      iov[iov_count++].iov_len = LOG_RING_SIZE - at;
+      iov[iov_count].iov_base = ring->buf;
+      iov[iov_count++].iov_len = len - (LOG_RING_SIZE - at);
+      }
+    else if (len > 0)
+      {
+      iov[iov_count].iov_base = ring->buf + at;
+      iov[iov_count++].iov_len = len;
+      }
+
+    batch[batch_count] = ring;
+    batch_tail[batch_count++] = tail;
+    drained += len;
+
+    ring = ring->next;
+
+    /* each ring takes at most 3 entries */
+    if ((ring == NULL) ||
+        (iov_count + 3 > LOG_IOV_MAX) ||
+        (batch_count == LOG_IOV_MAX / 2))
+      {
+      if ((iov_count > 0) &&
+          (log_opened > 0))
+        {
+        if ((log_writev_all(fileno(logfile), iov, iov_count) != 0) &&
+            (errno == EPIPE))
+          {
+          /* see log_record_sync() */
+          log_opened = 0;
+          log_open(NULL, log_directory);
+          }
+        }
+
+      for (int i = 0; i < batch_count; i++)
+        __atomic_store_n(&batch[i]->head, batch_tail[i], __ATOMIC_RELEASE);
+
+      iov_count = 0;
+      batch_count = 0;
+      }
+    }
+
+  /* free the rings of threads that have exited */
+  prev = &log_rings;
+
+  while ((ring = *prev) != NULL)
+    {
+    if ((__atomic_load_n(&ring->orphaned, __ATOMIC_ACQUIRE)) &&
+        (ring->head == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) &&
+        (ring->dropped == 0))
+      {
+      *prev = ring->next;
+      free(ring->buf);
+      free(ring);
+      }
+    else
+      prev = &ring->next;
+    }
+
+  pthread_mutex_unlock(&log_ring_mutex);
+
+  return(drained);
+  }  /* END log_async_drain() */
+
+
+
+/*
+ * log_async_writer()
+ *
+ * The log writer thread. It keeps draining the rings while there is
+ * anything in them, then sleeps until a thread queues a message into an
+ * empty ring, or for at most LOG_ASYNC_WAIT_MS.
+ */
+
+static void *log_async_writer(
+
+  void *arg)
+
+  {
+  struct timespec until;
+  size_t          drained = 0;
+
+  while (log_async_running)
+    {
+    if (drained > 0)
+      {
+      pthread_mutex_lock(&log_mutex);
+      drained = log_async_drain();
+      pthread_mutex_unlock(&log_mutex);
+
+      continue;
+      }
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += LOG_ASYNC_WAIT_MS * 1000000L;
+
+    if (until.tv_nsec >= 1000000000L)
+      {
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000L;
+      }
+
+    pthread_mutex_lock(&log_async_mutex);
+
+    if (log_async_running)
+      pthread_cond_timedwait(&log_async_cond, &log_async_mutex, &until);
+
+    pthread_mutex_unlock(&log_async_mutex);
+
+    pthread_mutex_lock(&log_mutex);
+    drained = log_async_drain();
+    pthread_mutex_unlock(&log_mutex);
+    }
+
+  return(NULL);
+  }  /* END log_async_writer() */
+
+
+
+/*
+ * fork() handlers. The forking thread holds log_mutex and log_ring_mutex
+ * across the fork so no other thread has them mid-update, and the child
+ * reinitializes them since its thread isn't the one that owns them.
+ */
+
+static void log_async_prepare(void)
+
+  {
+  pthread_mutex_lock(&log_mutex);
+  pthread_mutex_lock(&log_ring_mutex);
+  }  /* END log_async_prepare() */
+
+
+
+static void log_async_parent(void)
+
+  {
+  pthread_mutex_unlock(&log_ring_mutex);
+  pthread_mutex_unlock(&log_mutex);
+  }  /* END log_async_parent() */
+
+
+
+/*
+ * A forked child doesn't have the writer thread, so it logs synchronously.
+ * The messages still queued are the parent's to write; the child lets go of
+ * the rings without touching them.
+ */
+
+static void log_async_child(void)
+
+  {
+  pthread_mutexattr_t attr;
+
+  log_async_running = 0;
+  log_rings = NULL;
+
+  pthread_setspecific(log_ring_key, NULL);
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&log_mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  pthread_mutex_init(&log_ring_mutex, NULL);
+  }  /* END log_async_child() */
+
+
+
+static void log_async_flush_at_exit(void)
+
+  {
+  /* a forked child inherits this handler, but not the parent's messages */
+  if (getpid() != log_async_pid)
+    return;
+
+  pthread_mutex_lock(&log_mutex);
+  log_async_drain();
+  pthread_mutex_unlock(&log_mutex);
+  }  /* END log_async_flush_at_exit() */
+
+
+
+/*
+ * log_async_start()
+ *
+ * Starts the log writer thread. From then on log_record() only queues each
+ * message, so threads that log don't wait on each other or on the disk.
+ *
+ * @return PBSE_NONE, or PBSE_SYSTEM if the thread can't be started, in which
+ * case messages are still written synchronously
+ */
+
+int log_async_start(void)
+
+  {
+  static int registered = FALSE;
+
+  if (log_async_running)
+    return(PBSE_NONE);
+
+  log_async_running = 1;
+  log_async_pid = getpid();
+
+  if (pthread_create(&log_async_thread, NULL, log_async_writer, NULL) != 0)
+    {
+    log_async_running = 0;
+    return(PBSE_SYSTEM);
+    }
+
+  if (registered == FALSE)
+    {
+    /* log_async_child() clears the forking thread's ring */
+    pthread_once(&log_ring_key_once, log_ring_key_init);
+    pthread_atfork(log_async_prepare, log_async_parent, log_async_child);
+    atexit(log_async_flush_at_exit);
+    registered = TRUE;
+    }
+
+  return(PBSE_NONE);
+  }  /* END log_async_start() */
+
+
+
+/*
+ * log_async_stop()
+ *
+ * Stops the log writer thread after writing everything that was queued.
+ * Messages are written synchronously again afterwards.
+ */
+
+void log_async_stop(void)
+
+  {
+  if (log_async_running == 0)
+    return;
+
+  pthread_mutex_lock(&log_async_mutex);
+  log_async_running = 0;
+  pthread_cond_signal(&log_async_cond);
+  pthread_mutex_unlock(&log_async_mutex);
+
+  pthread_join(log_async_thread, NULL);
+
+  log_async_flush_at_exit();
+  }  /* END log_async_stop() */
+
+
+
 /*
  * job_log_close - close the current open job log file
  */
@@ -26,6 +26,10 @@ int log_remove_old(char *DirPath, unsigned long ExpireTime);
 
 void log_roll(int max_depth);
 
+int log_async_start(void);
+
+void log_async_stop(void);
+
 long log_size(void);
 
 long job_log_size(void);
@@ -46,6 +46,7 @@ int socket_wait_for_read(int socket, unsigned int timeout);
 void socket_read_flush(int socket);
 int socket_write(int socket, const char *data, int data_len);
 int socket_read_force(int socket, char *the_str, long long avail_bytes, long long *byte_count);
+int socket_wait_for_data(int socket, unsigned int timeout, long long *avail_bytes);
 int socket_read(int socket, char **the_str, long long *str_len, unsigned int timeout);
 int socket_read_num(int socket, long long *the_num);
 int socket_read_str(int socket, char **the_str, long long *str_len);
@@ -82,8 +83,10 @@ int check_trqauthd_unix_domain_port(const char *);
 int ping_trqauthd(const char *);
 int thread_func(int active_sockets, fd_set *select_set);
 int wait_request(time_t waittime, long *SState);
+void idle_wheel_add(int sock, time_t deadline);
+void expire_idle_connections(time_t now);
 /* static void accept_conn(void *new_conn); */
-void globalset_add_sock(int sock);
+int globalset_add_sock(int sock, u_long addr, u_long port);
 void globalset_del_sock(int sock);
 int add_conn(int, enum conn_type, pbs_net_t, unsigned int, unsigned int, void *(*func)(void *));
 int add_scheduler_conn(int, enum conn_type, pbs_net_t, unsigned int, unsigned int, void *(*func)(void *));
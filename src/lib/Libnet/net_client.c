@@ -91,6 +91,7 @@
 #include "net_connect.h"
 #include "mcom.h"
 #include "log.h"
+#include "dis.h"
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -331,6 +332,9 @@ retry:  /* retry goto added (rentec) */
     return(PBS_NET_RC_FATAL);
     }
 
+  /* a new peer; requests are text until it shows it understands binary DIS */
+  DIS_tcp_set_peer_version(sock, DIS_VERSION_TEXT);
+
   if (sock >= PBS_NET_MAX_CONNECTIONS)
     {
     if (EMsg != NULL)
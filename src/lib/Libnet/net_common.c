@@ -731,6 +731,46 @@ int socket_read_force(
 
 
 
+/*
+ * socket_wait_for_data()
+ *
+ * Waits until socket has data to read.
+ *
+ * @param socket - the socket to wait on
+ * @param timeout - how long to wait
+ * @param avail_bytes - set to the number of bytes that can be read
+ * @return PBSE_NONE, or PBSE_SOCKET_READ if the socket was closed
+ */
+
+int socket_wait_for_data(
+
+  int           socket,
+  unsigned int  timeout,
+  long long    *avail_bytes)
+
+  {
+  int rc = PBSE_NONE;
+
+  *avail_bytes = socket_avail_bytes_on_descriptor(socket);
+
+  while (*avail_bytes == 0)
+    {
+    if ((rc = socket_wait_for_read(socket, timeout)) != PBSE_NONE)
+      break;
+    *avail_bytes = socket_avail_bytes_on_descriptor(socket);
+    if (*avail_bytes == 0)
+      {
+      rc = PBSE_SOCKET_READ;
+      break;
+      }
+    }
+
+  return(rc);
+  } /* END socket_wait_for_data() */
+
+
+
+
 int socket_read(
     
   int            socket,
@@ -740,25 +780,13 @@ int socket_read(
 
   {
   int       rc = PBSE_NONE;
-  long long avail_bytes = socket_avail_bytes_on_descriptor(socket);
+  long long avail_bytes = 0;
   long long byte_count = 0;
 
   if ((the_str == NULL) || (str_len == NULL))
     return PBSE_INTERNAL;
 
-  while (avail_bytes == 0)
-    {
-    if ((rc = socket_wait_for_read(socket, timeout)) != PBSE_NONE)
-      break;
-    avail_bytes = socket_avail_bytes_on_descriptor(socket);
-    if (avail_bytes == 0)
-      {
-      rc = PBSE_SOCKET_READ;
-      break;
-      }
-    }
-
-  if (rc != PBSE_NONE)
+  if ((rc = socket_wait_for_data(socket, timeout, &avail_bytes)) != PBSE_NONE)
     {
     }
   else if ((*the_str = (char *)calloc(1, avail_bytes+1)) == NULL)
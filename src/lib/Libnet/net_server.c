@@ -109,6 +109,14 @@
 #include <arpa/inet.h>
 #endif
 #include <pthread.h>
+#include <vector>
+
+/* wait_request() uses epoll when it is available. Define NET_USE_SELECT to
+ * build the select() based loop instead */
+#if defined(HAVE_SYS_EPOLL_H) && !defined(NET_USE_SELECT)
+#define NET_USE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 
 
@@ -158,6 +166,29 @@ static u_long   *GlobalSocketAddrSet = NULL;
 static u_long   *GlobalSocketPortSet = NULL;
 pthread_mutex_t *global_sock_read_mutex = NULL;
 
+#ifdef NET_USE_EPOLL
+/* maximum number of ready sockets harvested by one epoll_wait() */
+#define MAX_EPOLL_EVENTS 256
+
+static int       epoll_fd = -1;
+#endif
+
+/*
+ * Idle client connections are expired from a timer wheel instead of sweeping
+ * every connection on every pass of wait_request(). Each slot holds the
+ * sockets whose idle deadline falls inside one IDLE_WHEEL_SPAN second tick.
+ * Entries are lazy: when a tick expires each socket's cn_lasttime is checked
+ * and the socket is either closed or filed again under its new deadline.
+ * IDLE_WHEEL_SLOTS * IDLE_WHEEL_SPAN must exceed PBS_NET_MAXCONNECTIDLE.
+ */
+#define IDLE_WHEEL_SLOTS 64
+#define IDLE_WHEEL_SPAN  16
+
+static std::vector<int>  idle_wheel[IDLE_WHEEL_SLOTS];
+static short            *idle_wheel_slot = NULL; /* per socket slot, -1 if not in the wheel */
+static time_t            idle_wheel_tick = 0;    /* last tick that was expired */
+pthread_mutex_t         *idle_wheel_mutex = NULL;
+
 void *(*read_func[2])(void *);
 
 pthread_mutex_t *nc_list_mutex  = NULL;
@@ -167,6 +198,7 @@ pbs_net_t        pbs_server_addr;
 /* Private function within this file */
 
 void *accept_conn(void *);
+void  idle_wheel_add(int sock, time_t deadline);
 
 
 static struct netcounter nc_list[60];
@@ -344,6 +376,21 @@ int init_network(
 
     num_connections_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
     pthread_mutex_init(num_connections_mutex,&t_attr);
+
+    idle_wheel_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+    pthread_mutex_init(idle_wheel_mutex, NULL);
+    idle_wheel_slot = (short *)malloc(sizeof(short) * PBS_NET_MAX_CONNECTIONS);
+    memset(idle_wheel_slot, -1, sizeof(short) * PBS_NET_MAX_CONNECTIONS);
+    idle_wheel_tick = time(NULL) / IDLE_WHEEL_SPAN;
+
+#ifdef NET_USE_EPOLL
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+      {
+      log_err(errno, __func__, "Unable to create the epoll descriptor");
+
+      return(-1);
+      }
+#endif
     
     type = Primary;
     }
@@ -645,6 +692,258 @@ int check_network_port(
 
 
 
+/*
+ * idle_wheel_add - file sock in the idle timer wheel under the tick containing
+ * deadline. A socket is only ever in the wheel once.
+ */
+
+void idle_wheel_add(
+
+  int    sock,
+  time_t deadline)
+
+  {
+  if ((idle_wheel_mutex == NULL) ||
+      (sock < 0) ||
+      (sock >= PBS_NET_MAX_CONNECTIONS))
+    return;
+
+  pthread_mutex_lock(idle_wheel_mutex);
+
+  if (idle_wheel_slot[sock] == -1)
+    {
+    int slot = (deadline / IDLE_WHEEL_SPAN) % IDLE_WHEEL_SLOTS;
+
+    idle_wheel[slot].push_back(sock);
+    idle_wheel_slot[sock] = slot;
+    }
+
+  pthread_mutex_unlock(idle_wheel_mutex);
+  } /* END idle_wheel_add() */
+
+
+
+/*
+ * expire_idle_connections - close the client connections that have been idle
+ * longer than PBS_NET_MAXCONNECTIDLE. Only the wheel slots for ticks that
+ * have fully passed since the last call are examined.
+ */
+
+void expire_idle_connections(
+
+  time_t now)
+
+  {
+  time_t           tick = now / IDLE_WHEEL_SPAN;
+  std::vector<int> expiring;
+  char             tmpLine[1024];
+
+  if (idle_wheel_mutex == NULL)
+    return;
+
+  pthread_mutex_lock(idle_wheel_mutex);
+
+  /* a full turn of the wheel covers every slot */
+  if (tick - idle_wheel_tick > IDLE_WHEEL_SLOTS)
+    idle_wheel_tick = tick - IDLE_WHEEL_SLOTS;
+
+  while (idle_wheel_tick < tick)
+    {
+    int slot = idle_wheel_tick % IDLE_WHEEL_SLOTS;
+
+    for (unsigned int i = 0; i < idle_wheel[slot].size(); i++)
+      {
+      idle_wheel_slot[idle_wheel[slot][i]] = -1;
+      expiring.push_back(idle_wheel[slot][i]);
+      }
+
+    idle_wheel[slot].clear();
+    idle_wheel_tick++;
+    }
+
+  pthread_mutex_unlock(idle_wheel_mutex);
+
+  for (unsigned int j = 0; j < expiring.size(); j++)
+    {
+    int                i = expiring[j];
+    struct connection *cp = &svr_conn[i];
+
+    pthread_mutex_lock(cp->cn_mutex);
+
+    if (cp->cn_active != FromClientDIS)
+      {
+      pthread_mutex_unlock(cp->cn_mutex);
+
+      continue;
+      }
+
+    if (((now - cp->cn_lasttime) <= PBS_NET_MAXCONNECTIDLE) ||
+        (cp->cn_authen & PBS_NET_CONN_NOTIMEOUT))
+      {
+      /* still in use (or never times out) - check it again later */
+      time_t deadline = cp->cn_lasttime + PBS_NET_MAXCONNECTIDLE + 1;
+
+      if (deadline <= now)
+        deadline = now + PBS_NET_MAXCONNECTIDLE;
+
+      idle_wheel_add(i, deadline);
+
+      pthread_mutex_unlock(cp->cn_mutex);
+  
+      continue;
+      }
+
+    /* NOTE:  add info about node associated with connection - NYI */
+
+    {
+    char buf[80];
+
+    snprintf(tmpLine, sizeof(tmpLine), "connection %d to host %s has timed out after %d seconds - closing stale connection\n",
+      i,
+      netaddr_long(cp->cn_addr, buf),
+      PBS_NET_MAXCONNECTIDLE);
+    }
+    
+    log_err(-1, __func__, tmpLine);
+
+    /* locate node associated with interface, mark node as down until node responds */
+
+    /* NYI */
+
+    close_conn(i, TRUE);
+
+    pthread_mutex_unlock(cp->cn_mutex);
+    }
+  } /* END expire_idle_connections() */
+
+
+
+/*
+ * dispatch_ready_socket - invoke the processing routine for socket i, which
+ * has data to read, or clean it up if it is no longer an active connection
+ */
+
+void dispatch_ready_socket(
+
+  int    i,
+  u_long addr,
+  u_long port)
+
+  {
+  char tmpLine[1024];
+
+  pthread_mutex_lock(svr_conn[i].cn_mutex);
+
+  svr_conn[i].cn_lasttime = time(NULL);
+
+  if (svr_conn[i].cn_active != Idle)
+    {
+    void *(*func)(void *) = svr_conn[i].cn_func;
+
+    netcounter_incr();
+
+    pthread_mutex_unlock(svr_conn[i].cn_mutex);
+
+    if (func != NULL)
+      {
+      int args[3];
+
+      args[0] = i;
+      args[1] = (int)addr;
+      args[2] = (int)port;
+      func((void *)args);
+      }
+    }
+  else
+    {
+    pthread_mutex_unlock(svr_conn[i].cn_mutex);
+
+    globalset_del_sock(i);
+    close_conn(i, FALSE);
+
+    pthread_mutex_lock(num_connections_mutex);
+
+    sprintf(tmpLine, "closed connections to fd %d - num_connections=%d (select bad socket)",
+      i,
+      num_connections);
+
+    pthread_mutex_unlock(num_connections_mutex);
+    log_err(-1, __func__, tmpLine);
+    }
+  } /* END dispatch_ready_socket() */
+
+
+
+#ifdef NET_USE_EPOLL
+
+/*
+ * wait_request - wait for a request (socket with data to read)
+ * This routine waits on the epoll set of sockets, and the processing
+ * routine associated with each ready socket is invoked. The cost of a
+ * pass depends on the number of ready sockets, not on the number of
+ * open descriptors.
+ */
+
+int wait_request(
+
+  time_t  waittime,   /* I (seconds) */
+  long   *SState)     /* I (optional) */
+
+  {
+  int                n;
+  long               OrigState = 0;
+  struct epoll_event events[MAX_EPOLL_EVENTS];
+  u_long             addrs[MAX_EPOLL_EVENTS];
+  u_long             ports[MAX_EPOLL_EVENTS];
+
+  if (SState != NULL)
+    OrigState = *SState;
+
+  n = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS, waittime * 1000);
+
+  if (n == -1)
+    {
+    if (errno != EINTR)
+      {
+      log_err(errno, __func__, "Unable to wait on sockets to read requests");
+
+      return(-1);
+      }
+
+    n = 0; /* interrupted, cycle around */
+    }
+
+  /* snapshot the peer information for the whole batch under one lock */
+  pthread_mutex_lock(global_sock_read_mutex);
+
+  for (int j = 0; j < n; j++)
+    {
+    addrs[j] = GlobalSocketAddrSet[events[j].data.fd];
+    ports[j] = GlobalSocketPortSet[events[j].data.fd];
+    }
+
+  pthread_mutex_unlock(global_sock_read_mutex);
+
+  for (int j = 0; j < n; j++)
+    {
+    dispatch_ready_socket(events[j].data.fd, addrs[j], ports[j]);
+
+    /* NOTE:  breakout if state changed (probably received shutdown request) */
+
+    if ((SState != NULL) && 
+        (OrigState != *SState))
+      return(0);
+    }
+
+  /* have any connections timed out ?? */
+
+  expire_idle_connections(time(NULL));
+
+  return(PBSE_NONE);
+  }  /* END wait_request() */
+
+#else
+
 /*
  * wait_request - wait for a request (socket with data to read)
  * This routine does a select on the readset of sockets,
@@ -660,7 +959,6 @@ int wait_request(
   {
   int             i;
   int             n;
-  time_t          now;
 
   fd_set          *SelectSet = NULL;
   int             SelectSetSize = 0;
@@ -670,7 +968,6 @@ int wait_request(
   u_long          *SocketPortSet = NULL;
 
 
-  char            tmpLine[1024];
   struct timeval  timeout;
   long            OrigState = 0;
 
@@ -754,52 +1051,16 @@ int wait_request(
     {
     if (FD_ISSET(i, SelectSet))
       {
-      pthread_mutex_lock(svr_conn[i].cn_mutex);
       /* this socket has data */
       n--;
 
-      svr_conn[i].cn_lasttime = time(NULL);
-
-      if (svr_conn[i].cn_active != Idle)
-        {
-        void *(*func)(void *) = svr_conn[i].cn_func;
-
-        netcounter_incr();
-
-        pthread_mutex_unlock(svr_conn[i].cn_mutex);
-
-        if (func != NULL)
-          {
-          int args[3];
-
-          args[0] = i;
-          args[1] = (int)SocketAddrSet[i];
-          args[2] = (int)SocketPortSet[i];
-          func((void *)args);
-          }
-
-        /* NOTE:  breakout if state changed (probably received shutdown request) */
-
-        if ((SState != NULL) && 
-            (OrigState != *SState))
-          break;
-        }
-      else
-        {
-        pthread_mutex_unlock(svr_conn[i].cn_mutex);
-
-        globalset_del_sock(i);
-        close_conn(i, FALSE);
-
-        pthread_mutex_lock(num_connections_mutex);
+      dispatch_ready_socket(i, SocketAddrSet[i], SocketPortSet[i]);
 
-        sprintf(tmpLine, "closed connections to fd %d - num_connections=%d (select bad socket)",
-          i,
-          num_connections);
+      /* NOTE:  breakout if state changed (probably received shutdown request) */
 
-        pthread_mutex_unlock(num_connections_mutex);
-        log_err(-1, __func__, tmpLine);
-        }
+      if ((SState != NULL) && 
+          (OrigState != *SState))
+        break;
       }
     } /* END for i */
 
@@ -814,62 +1075,13 @@ int wait_request(
 
   /* have any connections timed out ?? */
 
-  now = time((time_t *)0);
-
-  for (i = 0;i < max_connection;i++)
-    {
-    struct connection *cp;
-
-    pthread_mutex_lock(svr_conn[i].cn_mutex);
-
-    cp = &svr_conn[i];
-
-    if (cp->cn_active != FromClientDIS)
-      {
-      pthread_mutex_unlock(svr_conn[i].cn_mutex);
-
-      continue;
-      }
-
-    if ((now - cp->cn_lasttime) <= PBS_NET_MAXCONNECTIDLE)
-      {
-      pthread_mutex_unlock(svr_conn[i].cn_mutex);
-  
-      continue;
-      }
-
-    if (cp->cn_authen & PBS_NET_CONN_NOTIMEOUT)
-      {
-      pthread_mutex_unlock(svr_conn[i].cn_mutex);
-  
-      continue; /* do not time-out this connection */
-      }
-
-    /* NOTE:  add info about node associated with connection - NYI */
-
-    {
-    char buf[80];
-
-    snprintf(tmpLine, sizeof(tmpLine), "connection %d to host %s has timed out after %d seconds - closing stale connection\n",
-      i,
-      netaddr_long(cp->cn_addr, buf),
-      PBS_NET_MAXCONNECTIDLE);
-    }
-    
-    log_err(-1, __func__, tmpLine);
-
-    /* locate node associated with interface, mark node as down until node responds */
-
-    /* NYI */
-
-    close_conn(i, TRUE);
-
-    pthread_mutex_unlock(svr_conn[i].cn_mutex);
-    }  /* END for (i) */
+  expire_idle_connections(time(NULL));
 
   return(PBSE_NONE);
   }  /* END wait_request() */
 
+#endif /* NET_USE_EPOLL */
+
 
 
 
@@ -938,13 +1150,14 @@ void *accept_conn(
   else
     {
     /* add the new socket to the select set and connection structure */
-    add_conn(
-      newsock,
-      FromClientDIS,
-      (pbs_net_t)ntohl(from.sin_addr.s_addr),
-      (unsigned int)ntohs(from.sin_port),
-      sock_type,
-      read_func[cn_active]);
+    if (add_conn(
+          newsock,
+          FromClientDIS,
+          (pbs_net_t)ntohl(from.sin_addr.s_addr),
+          (unsigned int)ntohs(from.sin_port),
+          sock_type,
+          read_func[cn_active]) != PBSE_NONE)
+      close(newsock);
     }
 
 
@@ -954,7 +1167,18 @@ void *accept_conn(
 
 
 
-void globalset_add_sock(
+/*
+ * globalset_add_sock()
+ *
+ * Adds sock to the set of sockets wait_request() reads from.
+ *
+ * @param sock - the socket to add
+ * @param addr - the address of the host sock is connected to
+ * @param port - the port of the host sock is connected to
+ * @return PBSE_NONE, or PBSE_SYSTEM if sock can't be polled
+ */
+
+int globalset_add_sock(
 
   int sock,
   u_long addr,
@@ -962,10 +1186,36 @@ void globalset_add_sock(
 
   {
   pthread_mutex_lock(global_sock_read_mutex);
+#ifdef NET_USE_EPOLL
+  struct epoll_event ev;
+  int                rc;
+
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = sock;
+
+  if (((rc = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev)) != 0) &&
+      (errno == EEXIST))
+    rc = epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sock, &ev);
+
+  if (rc != 0)
+    {
+    char log_buf[LOCAL_LOG_BUF_SIZE];
+
+    snprintf(log_buf, sizeof(log_buf), "Unable to poll socket %d for requests", sock);
+    log_err(errno, __func__, log_buf);
+    pthread_mutex_unlock(global_sock_read_mutex);
+
+    return(PBSE_SYSTEM);
+    }
+#else
   FD_SET(sock, GlobalSocketReadSet);
+#endif
   GlobalSocketAddrSet[sock] = addr;
   GlobalSocketPortSet[sock] = port;
   pthread_mutex_unlock(global_sock_read_mutex);
+
+  return(PBSE_NONE);
   } /* END globalset_add_sock() */
 
 
@@ -977,7 +1227,12 @@ void globalset_del_sock(
 
   {
   pthread_mutex_lock(global_sock_read_mutex);
+#ifdef NET_USE_EPOLL
+  /* may fail harmlessly if sock was never added */
+  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, NULL);
+#else
   FD_CLR(sock, GlobalSocketReadSet);
+#endif
   GlobalSocketAddrSet[sock] = 0;
   GlobalSocketPortSet[sock] = 0;
   pthread_mutex_unlock(global_sock_read_mutex);
@@ -1025,7 +1280,16 @@ int add_connection(
 
   if (add_wait_request)
     {
-    globalset_add_sock(sock,(u_long)addr,port);
+    int rc = globalset_add_sock(sock,(u_long)addr,port);
+
+    if (rc != PBSE_NONE)
+      {
+      pthread_mutex_lock(num_connections_mutex);
+      num_connections--;
+      pthread_mutex_unlock(num_connections_mutex);
+
+      return(rc);
+      }
     }
   else
     {
@@ -1072,6 +1336,10 @@ int add_connection(
 
   pthread_mutex_unlock(svr_conn[sock].cn_mutex);
 
+  /* only client connections are timed out for being idle */
+  if (type == FromClientDIS)
+    idle_wheel_add(sock, time(NULL) + PBS_NET_MAXCONNECTIDLE + 1);
+
   return(PBSE_NONE);
   }  /* END add_connection() */
 
@@ -1192,6 +1460,8 @@ void close_conn(
 
   close(sd);
 
+  DIS_tcp_set_peer_version(sd, DIS_VERSION_TEXT);
+
   svr_conn[sd].cn_addr = 0;
   svr_conn[sd].cn_handle = -1;
   svr_conn[sd].cn_active = Idle;
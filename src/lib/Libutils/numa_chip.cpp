@@ -30,8 +30,8 @@ using namespace std;
 
 Chip::Chip() : id(0), totalCores(0), totalThreads(0), availableCores(0), availableThreads(0),
                total_gpus(0), available_gpus(0), total_mics(0), available_mics(0),
-               chip_exclusive(false), memory(0), available_memory(0), cores(), devices(),
-               allocations()
+               chip_exclusive(false), memory(0), available_memory(0), cores(),
+               free_cores(hwloc_bitmap_alloc()), core_of_unit(), devices(), allocations()
 
   {
   memset(chip_cpuset_string, 0, sizeof(chip_cpuset_string));
@@ -46,7 +46,9 @@ Chip::Chip(
                        total_mics(other.total_mics), available_mics(other.available_mics),
                        chip_exclusive(other.chip_exclusive), memory(other.memory),
                        available_memory(other.available_memory), cores(other.cores),
-                       devices(other.devices), allocations(other.allocations)
+                       free_cores(hwloc_bitmap_dup(other.free_cores)),
+                       core_of_unit(other.core_of_unit), devices(other.devices),
+                       allocations(other.allocations)
 
   {
   // Don't copy the hwloc_const_* types as they aren't needed
@@ -73,6 +75,8 @@ Chip &Chip::operator =(
   this->memory = other.memory;
   this->available_memory = other.available_memory;
   this->cores = other.cores;
+  hwloc_bitmap_copy(this->free_cores, other.free_cores);
+  this->core_of_unit = other.core_of_unit;
   this->devices = other.devices;
   this->allocations = other.allocations;
   
@@ -89,7 +93,8 @@ Chip::Chip(
   int  execution_slots,
   int &es_remainder,
   int &per_numa_remainder) : id(0),total_gpus(0), available_gpus(0), total_mics(0), available_mics(0), 
-                             chip_exclusive(false), memory(0), available_memory(0), cores(), devices(),
+                             chip_exclusive(false), memory(0), available_memory(0), cores(),
+                             free_cores(hwloc_bitmap_alloc()), core_of_unit(), devices(),
                              allocations()
 
   {
@@ -117,10 +122,90 @@ Chip::Chip(
 
     this->cores.push_back(c);
     }
+
+  this->index_cores();
   } // END constructor for Cray
 
 
 
+/*
+ * index_cores()
+ *
+ * Rebuilds the bitmap of free cores and the map from processing unit to core.
+ * Must be called whenever cores are added.
+ */
+
+void Chip::index_cores()
+
+  {
+  hwloc_bitmap_zero(this->free_cores);
+  this->core_of_unit.clear();
+
+  for (unsigned int i = 0; i < this->cores.size(); i++)
+    {
+    if (this->cores[i].is_free() == true)
+      hwloc_bitmap_set(this->free_cores, i);
+
+    for (unsigned int j = 0; j < this->cores[i].indices.size(); j++)
+      {
+      int os_index = this->cores[i].indices[j];
+
+      if (os_index < 0)
+        continue;
+
+      if (os_index >= (int)this->core_of_unit.size())
+        this->core_of_unit.resize(os_index + 1, -1);
+
+      // the first core with this processing unit owns it
+      if (this->core_of_unit[os_index] == -1)
+        this->core_of_unit[os_index] = i;
+      }
+    }
+  } // END index_cores()
+
+
+
+/*
+ * update_core_state()
+ *
+ * Records whether or not the core at core_index is completely free. Must be
+ * called after any of the core's processing units are reserved or freed.
+ */
+
+void Chip::update_core_state(
+
+  int core_index)
+
+  {
+  if (this->cores[core_index].is_free() == true)
+    hwloc_bitmap_set(this->free_cores, core_index);
+  else
+    hwloc_bitmap_clr(this->free_cores, core_index);
+  } // END update_core_state()
+
+
+
+/*
+ * find_core_of_unit()
+ *
+ * @param os_index - the os index of a processing unit
+ * @return the index in cores of the core that has this processing unit, or -1
+ */
+
+int Chip::find_core_of_unit(
+
+  int os_index) const
+
+  {
+  if ((os_index < 0) ||
+      (os_index >= (int)this->core_of_unit.size()))
+    return(-1);
+
+  return(this->core_of_unit[os_index]);
+  } // END find_core_of_unit()
+
+
+
 /*
  * parse_values_from_json_string()
  */
@@ -219,6 +304,7 @@ void Chip::initialize_cores_from_strings(
     this->cores.push_back(c);
     }
   
+  this->index_cores();
   this->totalCores = this->cores.size();
   this->availableCores = this->totalCores;
   this->availableThreads = this->totalThreads;
@@ -383,25 +469,25 @@ void Chip::reserve_allocation_resources(
   // reserve each cpu
   for (unsigned int j = 0; j < a.cpu_indices.size(); j++)
     {
-    for (unsigned int c = 0; c < this->cores.size(); c++)
+    int c = this->find_core_of_unit(a.cpu_indices[j]);
+
+    if ((c >= 0) &&
+        (this->cores[c].reserve_processing_unit(a.cpu_indices[j]) == true))
       {
-      if (this->cores[c].reserve_processing_unit(a.cpu_indices[j]) == true)
+      this->update_core_state(c);
+
+      if (a.cores_only == true)
         {
-        if (a.cores_only == true)
-          {
-          this->availableCores--;
-          this->availableThreads -= this->cores[c].totalThreads;
-          a.threads += this->cores[c].totalThreads;
-          a.cores++;
-          a.cpus++;
-          }
-        else
-          {
-          this->availableThreads--;
-          a.threads++;
-          }
-        
-        break;
+        this->availableCores--;
+        this->availableThreads -= this->cores[c].totalThreads;
+        a.threads += this->cores[c].totalThreads;
+        a.cores++;
+        a.cpus++;
+        }
+      else
+        {
+        this->availableThreads--;
+        a.threads++;
         }
       }
     }
@@ -529,8 +615,9 @@ Chip::Chip(
   std::vector<std::string> &valid_ids) : id(0), totalCores(0), totalThreads(0), availableCores(0),
                                          availableThreads(0), total_gpus(0), available_gpus(0),
                                          total_mics(0), available_mics(0), chip_exclusive(false),
-                                         memory(0), available_memory(0), cores(), devices(),
-                                         allocations()
+                                         memory(0), available_memory(0), cores(),
+                                         free_cores(hwloc_bitmap_alloc()), core_of_unit(),
+                                         devices(), allocations()
 
   {
   memset(chip_cpuset_string, 0, MAX_CPUSET_SIZE);
@@ -558,6 +645,7 @@ Chip::Chip(
 Chip::~Chip()
   {
   id = -1;
+  hwloc_bitmap_free(this->free_cores);
   }
 
 /* initializeNonNUMAChip will initialize an instance of a NUMA Chip and then populate
@@ -592,6 +680,7 @@ int Chip::initializeNonNUMAChip(hwloc_obj_t socket_obj, hwloc_topology_t topolog
     prev = core_obj;
     }
 
+  this->index_cores();
   this->totalCores = this->cores.size();
   this->availableCores = this->totalCores;
   this->availableThreads = this->totalThreads;
@@ -640,6 +729,7 @@ int Chip::initializeChip(hwloc_obj_t chip_obj, hwloc_topology_t topology)
     prev = core_obj;
     }
 
+  this->index_cores();
   this->initializePCIDevices(chip_obj, topology);
 
   return(PBSE_NONE);
@@ -915,10 +1005,10 @@ void Chip::make_core(
   c.free = true;
   c.indices.push_back(id);
   c.indices.push_back(id + 16);
-  c.is_index_busy.push_back(false);
-  c.is_index_busy.push_back(false);
+  c.busy_units = 0;
   c.processing_units_open = 2;
   this->cores.push_back(c);
+  this->index_cores();
   }
 
 
@@ -973,12 +1063,7 @@ void Chip::aggregate_allocation(
 int Chip::free_core_count() const
 
   {
-  int free_count = 0;
-  for (size_t i = 0; i < this->cores.size(); i++)
-    if (this->cores[i].is_free())
-      free_count++;
-
-  return(free_count);
+  return(hwloc_bitmap_weight(this->free_cores));
   } // END free_core_count()
 
 
@@ -1098,17 +1183,18 @@ bool Chip::getOpenThreadVector(
   // Get the thread indices we will use
   do
     {
-    for (unsigned int x = 0; x < this->cores[j].indices.size(); x++)
+    const Core    &c = this->cores[j];
+    unsigned long  open_units = ~c.busy_units & c.all_units();
+
+    while (open_units != 0)
       {
-      int thread_index;
-      if (this->cores[j].is_index_busy[x] == true)
-        continue;
+      unsigned int x = __builtin_ctzl(open_units);
 
-      thread_index = this->cores[j].indices[x];
+      open_units &= open_units - 1;
 
-      slots.push_back(thread_index);
+      slots.push_back(c.indices[x]);
       i--;
-      if ((i == 0) || ((x + 1) == this->cores[j].indices.size()))
+      if ((i == 0) || ((x + 1) == c.indices.size()))
         {
         /* We fit if all of the execution slots have been filled
            or it we have used all the chip */
@@ -1158,7 +1244,7 @@ bool Chip::getContiguousThreadVector(
 
       /* if this thread is busy and we have already started creating a list,
            clear the list and start over; otherwise, continue to the next thread */
-      if (this->cores[j].is_index_busy[x] == true)
+      if (this->cores[j].is_unit_busy(x) == true)
         {
         if (slots.size() > 0)
           {
@@ -1196,7 +1282,7 @@ bool Chip::getContiguousThreadVector(
       for (unsigned int x = 0; x < this->cores[j].indices.size(); x++)
         {
         int thread_index;
-        if (this->cores[j].is_index_busy[x] == true)
+        if (this->cores[j].is_unit_busy(x) == true)
           continue;
 
         thread_index = this->cores[j].indices[x];
@@ -1236,9 +1322,9 @@ bool Chip::getContiguousCoreVector(
   int               execution_slots_per_task)
 
   {
-  unsigned int j = 0;
-  int i = execution_slots_per_task;
-  bool fits = false;
+  int  last_core = (int)this->cores.size() - 1;
+  int  run_start = -1;
+  int  prev = -1;
 
   /* this makes it so users can request gpus and mics 
      from numanodes which are not where the cores or threads
@@ -1246,50 +1332,42 @@ bool Chip::getContiguousCoreVector(
   if (execution_slots_per_task == 0)
     return(true);
 
-  /* First try to get contiguous cores */
-  do
+  /* First try to get contiguous cores. Only the free cores are visited. */
+  for (int j = hwloc_bitmap_first(this->free_cores);
+       (j != -1) && (j <= last_core);
+       j = hwloc_bitmap_next(this->free_cores, j))
     {
-    if (this->cores[j].is_free() == true)
-      {
-      slots.push_back(j);
-      i--;
-      j++;
-      if ((i ==0) || (j == this->cores.size()))
-        {
-        /* We fit if all of the execution slots have been filled
-           or it we have used all the chip */
-        fits = true;
-        }
-      }
-    else
+    if ((run_start == -1) ||
+        (j != prev + 1))
+      run_start = j;
+
+    prev = j;
+
+    /* We fit if all of the execution slots have been filled
+       or it we have used all the chip */
+    if ((j - run_start + 1 == execution_slots_per_task) ||
+        (j == last_core))
       {
-      i = execution_slots_per_task;
-      j++;
-      slots.clear();
+      for (int k = run_start; k <= j; k++)
+        slots.push_back(k);
+
+      return(true);
       }
-    }while((i != 0) && (j < this->cores.size()));
+    }
 
-  if (fits == false)
+  /* Can't get contiguous cores. Just get them where you can find them */
+  // Get the core indices we will use
+  int needed = execution_slots_per_task;
+
+  for (int j = hwloc_bitmap_first(this->free_cores);
+       (j != -1) && (j <= last_core) && (needed > 0);
+       j = hwloc_bitmap_next(this->free_cores, j))
     {
-    /* Can't get contiguous cores. Just get them where you can find them */
-    // Get the core indices we will use
-    j = 0;
-    for (int i = 0; i < execution_slots_per_task; i++)
-      {
-      while (j < this->cores.size())
-        {
-        if (this->cores[j].is_free() == true)
-          {
-          slots.push_back(j);
-          j++;
-          break;
-          }
-        else
-          j++;
-        }
-      }
+    slots.push_back(j);
+    needed--;
     }
-  return(fits);
+
+  return(false);
   }
 
 
@@ -1488,6 +1566,8 @@ bool Chip::reserve_chip_core(
     while ( this->cores[core_index].get_open_processing_unit() != -1 )
       continue;
 
+    this->update_core_state(core_index);
+
     this->availableCores--;
     this->availableThreads -= this->cores[core_index].totalThreads;
     a.cpu_place_indices.push_back(os_index);
@@ -1522,6 +1602,8 @@ bool Chip::reserve_core(
     while ( this->cores[core_index].get_open_processing_unit() != -1 )
       continue;
 
+    this->update_core_state(core_index);
+
     this->availableCores--;
     this->availableThreads -= this->cores[core_index].totalThreads;
     a.cpu_indices.push_back(os_index);
@@ -1542,18 +1624,19 @@ bool Chip::reserve_place_thread(
   allocation &a)
 
   {
+  int i = this->find_core_of_unit(thread_index);
 
-  for (unsigned int i = 0; i < this->cores.size(); i++)
+  if ((i >= 0) &&
+      (this->cores[i].reserve_processing_unit(thread_index) == true))
     {
-     if (this->cores[i].reserve_processing_unit(thread_index) == true)
-       {
-       a.threads++;
-       a.cpus++;
-       a.cpu_indices.push_back(thread_index);
-       this->availableThreads--;
-       return(true);
-       }
+    this->update_core_state(i);
+    a.threads++;
+    a.cpus++;
+    a.cpu_indices.push_back(thread_index);
+    this->availableThreads--;
+    return(true);
     }
+
   return(false);
   }
 
@@ -1564,16 +1647,18 @@ bool Chip::reserve_chip_place_thread(
   allocation &a)
 
   {
-  for (unsigned int i = 0; i < this->cores.size(); i++)
+  int i = this->find_core_of_unit(thread_index);
+
+  if ((i >= 0) &&
+      (this->cores[i].reserve_processing_unit(thread_index) == true))
     {
-    if (this->cores[i].reserve_processing_unit(thread_index) == true)
-      {
-      a.threads++;
-      a.cpu_place_indices.push_back(thread_index);
-      this->availableThreads--;
-      return(true);
-      }
+    this->update_core_state(i);
+    a.threads++;
+    a.cpu_place_indices.push_back(thread_index);
+    this->availableThreads--;
+    return(true);
     }
+
   return(false);
   }
 
@@ -1598,6 +1683,8 @@ bool Chip::reserve_thread(
   {
   int index = this->cores[core_index].get_open_processing_unit();
 
+  this->update_core_state(core_index);
+
   if (index >= 0)
     {
     a.threads++;
@@ -1629,6 +1716,8 @@ bool Chip::reserve_chip_thread(
   {
   int index = this->cores[core_index].get_open_processing_unit();
 
+  this->update_core_state(core_index);
+
   if (index >= 0)
     {
     a.threads++;
@@ -2419,33 +2508,42 @@ void Chip::free_cpu_index(
 
   {
   bool core_is_now_free = false;
+
+  if (increment_available_cores == false)
+    {
+    int i = this->find_core_of_unit(index);
+
+    if ((i >= 0) &&
+        (this->cores[i].free == false))
+      {
+      this->cores[i].free_pu_index(index, core_is_now_free);
+      this->update_core_state(i);
+      }
+
+    return;
+    }
+
   for (unsigned int i = 0; i < this->cores.size(); i++)
     {
     if (this->cores[i].free == true)
       continue;
       
-    if (increment_available_cores == true)
+    // For cores_only, the passed-in index should be the core's index
+    if (this->cores[i].get_id() != index)
+      continue;
+
+    // Free the entire core (including all its threads)
+    for( unsigned int j = 0; j < this->cores[i].indices.size(); j++)
       {
-      // For cores_only, the passed-in index should be the core's index
-      if (this->cores[i].get_id() != index)
-        continue;
+      this->cores[i].free_pu_index(this->cores[i].indices[j], core_is_now_free);
+      }
 
-      // Free the entire core (including all its threads)
-      for( unsigned int j = 0; j < this->cores[i].indices.size(); j++)
-        {
-        this->cores[i].free_pu_index(this->cores[i].indices[j], core_is_now_free);
-        }
+    this->update_core_state(i);
 
-      if (core_is_now_free == true)
-        {
-        this->availableCores++;
-        return;
-        }
-      }
-    else
+    if (core_is_now_free == true)
       {
-      if (this->cores[i].free_pu_index(index, core_is_now_free) == true)
-        return;
+      this->availableCores++;
+      return;
       }
     }
 
@@ -20,7 +20,7 @@ using namespace std;
 const int CORE = 0;
 const int THREAD = 1;
 
-Core::Core() : id(-1), totalThreads(0), free(true), indices(), is_index_busy(),
+Core::Core() : id(-1), totalThreads(0), free(true), indices(), busy_units(0),
                processing_units_open(0)
   {
   memset(core_cpuset_string, 0, MAX_CPUSET_SIZE);
@@ -44,9 +44,11 @@ int Core::initializeCore(hwloc_obj_t core_obj, hwloc_topology_t topology)
   hwloc_bitmap_list_snprintf(this->core_nodeset_string, MAX_NODESET_SIZE, this->core_nodeset);
   translate_range_string_to_vector(this->core_cpuset_string, this->indices);
 
-  // Add one of these for each index
-  for (unsigned int i = 0; i < this->indices.size(); i++)
-    this->is_index_busy.push_back(false);
+  // busy_units has one bit per index
+  if (this->indices.size() > MAX_PROCESSING_UNITS_PER_CORE)
+    this->indices.resize(MAX_PROCESSING_UNITS_PER_CORE);
+
+  this->busy_units = 0;
   
   this->totalThreads = hwloc_get_nbobjs_inside_cpuset_by_type(topology, this->core_cpuset, HWLOC_OBJ_PU);
   this->processing_units_open = this->totalThreads;
@@ -79,6 +81,40 @@ int Core::initializeCore(hwloc_obj_t core_obj, hwloc_topology_t topology)
 
 
 
+/*
+ * all_units()
+ *
+ * @return a mask with one bit set for each of this core's processing units
+ */
+
+unsigned long Core::all_units() const
+
+  {
+  if (this->indices.size() >= MAX_PROCESSING_UNITS_PER_CORE)
+    return(~0UL);
+
+  return((1UL << this->indices.size()) - 1);
+  } // END all_units()
+
+
+
+/*
+ * is_unit_busy()
+ *
+ * @param which - the position of the processing unit in this core, not its os index
+ * @return true if the processing unit is in use
+ */
+
+bool Core::is_unit_busy(
+
+  int which) const
+
+  {
+  return((this->busy_units & (1UL << which)) != 0);
+  } // END is_unit_busy()
+
+
+
 /*
  * reserve_processing_unit()
  *
@@ -98,7 +134,7 @@ bool Core::reserve_processing_unit(
     {
     if (this->indices[i] == index)
       {
-      this->is_index_busy[i] = true;
+      this->busy_units |= 1UL << i;
       this->free = false;
       this->processing_units_open--;
       match = true;
@@ -114,17 +150,16 @@ bool Core::reserve_processing_unit(
 int Core::get_open_processing_unit()
 
   {
-  int open_index = -1;
+  int           open_index = -1;
+  unsigned long open_units = ~this->busy_units & this->all_units();
 
-  for (unsigned int i = 0; i < this->is_index_busy.size(); i++)
+  if (open_units != 0)
     {
-    if (this->is_index_busy[i] == false)
-      {
-      this->is_index_busy[i] = true;
-      open_index = this->indices[i];
-      this->processing_units_open--;
-      break;
-      }
+    int i = __builtin_ctzl(open_units);
+
+    this->busy_units |= 1UL << i;
+    open_index = this->indices[i];
+    this->processing_units_open--;
     }
 
   this->free = false;
@@ -163,9 +198,9 @@ bool Core::free_pu_index(
 
     for (unsigned int i = 0; i < this->indices.size(); i++)
       {
-      if (this->indices[i] == index && this->is_index_busy[i] == true)
+      if (this->indices[i] == index && this->is_unit_busy(i) == true)
         {
-        this->is_index_busy[i] = false;
+        this->busy_units &= ~(1UL << i);
         this->processing_units_open++;
         if (this->totalThreads == this->processing_units_open)
           {
@@ -206,9 +241,10 @@ int Core::add_processing_unit(
 
     this->id = os_index;
     }
+  else if (this->indices.size() >= MAX_PROCESSING_UNITS_PER_CORE)
+    return(-1);
 
   this->indices.push_back(os_index);
-  this->is_index_busy.push_back(false);
   this->processing_units_open++;
   this->totalThreads++;
 
@@ -241,8 +277,7 @@ void Core::unit_test_init()
 
   {
   this->totalThreads = 2;
-  this->is_index_busy.push_back(false);
-  this->is_index_busy.push_back(false);
+  this->busy_units = 0;
   this->indices.push_back(0);
   this->indices.push_back(8);
   this->processing_units_open = 2;
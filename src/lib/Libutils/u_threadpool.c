@@ -98,6 +98,94 @@ threadpool_t *async_pool;
 static void *work_thread(void *);
 
 
+
+/*
+ * elapsed_usecs()
+ *
+ * @return the number of microseconds from start to end
+ */
+
+static unsigned long elapsed_usecs(
+
+  struct timespec *start,
+  struct timespec *end)
+
+  {
+  long long usecs = (end->tv_sec - start->tv_sec) * 1000000LL +
+                    (end->tv_nsec - start->tv_nsec) / 1000;
+
+  if (usecs < 0)
+    usecs = 0;
+
+  return((unsigned long)usecs);
+  } /* END elapsed_usecs() */
+
+
+
+/*
+ * dequeue_work()
+ *
+ * Removes the next piece of work from tp. Lanes are served in priority order
+ * except that work which has waited longer than TP_LANE_MAX_WAIT_SECS in a
+ * lower lane is taken first so that no lane is starved.
+ *
+ * NOTE: this function should only be called when the lock on tp is already held
+ * @param tp - the threadpool to take work from
+ * @return the work, or NULL if there is none
+ */
+
+static tp_work_t *dequeue_work(
+
+  threadpool_t *tp)
+
+  {
+  tp_lane_queue_t *lane = NULL;
+  tp_work_t       *work;
+  struct timespec  now;
+  unsigned long    wait;
+
+  if (tp->tp_queued == 0)
+    return(NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  /* look for a starved lane, lowest priority first */
+  for (int i = TP_NUM_LANES - 1; i > 0; i--)
+    {
+    if ((tp->tp_lanes[i].first != NULL) &&
+        (now.tv_sec - tp->tp_lanes[i].first->enqueued.tv_sec > TP_LANE_MAX_WAIT_SECS))
+      {
+      lane = tp->tp_lanes + i;
+      break;
+      }
+    }
+
+  for (int i = 0; (lane == NULL) && (i < TP_NUM_LANES); i++)
+    {
+    if (tp->tp_lanes[i].first != NULL)
+      lane = tp->tp_lanes + i;
+    }
+
+  work = lane->first;
+  lane->first = work->next;
+
+  if (lane->last == work)
+    lane->last = NULL;
+
+  lane->depth--;
+  tp->tp_queued--;
+
+  wait = elapsed_usecs(&work->enqueued, &now);
+  lane->dequeued++;
+  lane->total_wait_usecs += wait;
+
+  if (wait > lane->max_wait_usecs)
+    lane->max_wait_usecs = wait;
+
+  return(work);
+  } /* END dequeue_work() */
+
+
 /*
  * create_work_thread()
  *
@@ -157,7 +245,7 @@ static void work_thread_cleanup(
     if (create_work_thread(tp) == 0)
       tp->tp_nthreads++;
     }
-  else if ((tp->tp_first != NULL) &&
+  else if ((tp->tp_queued > 0) &&
            (tp->tp_nthreads < tp->tp_min_threads) &&
            (create_work_thread(tp) == 0))
     {
@@ -262,7 +350,7 @@ static void *work_thread(
       }
 
 
-    while ((tp->tp_first == NULL) &&
+    while ((tp->tp_queued == 0) &&
            (!(tp->tp_flags & POOL_DESTROY)))
       {
       if ((tp->tp_nthreads <= tp->tp_min_threads) ||
@@ -298,15 +386,11 @@ static void *work_thread(
     if (tp->tp_flags & POOL_DESTROY)
       break;
 
-    if ((mywork = tp->tp_first) != NULL)
+    if ((mywork = dequeue_work(tp)) != NULL)
       {
       func = mywork->work_func;
       arg  = mywork->work_arg;
 
-      tp->tp_first = mywork->next;
-      if (tp->tp_last == mywork)
-        tp->tp_last = NULL;
-
       working.next = tp->tp_active;
       tp->tp_active = &working;
 
@@ -417,8 +501,32 @@ int enqueue_threadpool_request(
   threadpool_t *tp)
 
   {
-  tp_work_t *work = NULL;
-/*  char              log_buf[LOCAL_LOG_BUF_SIZE];*/
+  return(enqueue_threadpool_request_lane(func, arg, tp, TP_LANE_CLIENT));
+  } /* END enqueue_threadpool_request() */
+
+
+
+/*
+ * enqueue_threadpool_request_lane()
+ *
+ * queues func(arg) to be run by tp at the priority of lane
+ * @return 0 on success, ENOMEM, or PBSE_BAD_PARAMETER for an invalid lane
+ */
+
+int enqueue_threadpool_request_lane(
+
+  void         *(*func)(void *),
+  void         *arg,
+  threadpool_t *tp,
+  int           lane)
+
+  {
+  tp_work_t       *work = NULL;
+  tp_lane_queue_t *lq;
+
+  if ((lane < 0) ||
+      (lane >= TP_NUM_LANES))
+    return(PBSE_BAD_PARAMETER);
 
   if ((work = (tp_work_t *)calloc(1, sizeof(tp_work_t))) == NULL)
     {
@@ -428,15 +536,23 @@ int enqueue_threadpool_request(
   work->next = NULL;
   work->work_func = func;
   work->work_arg  = arg;
+  clock_gettime(CLOCK_MONOTONIC, &work->enqueued);
 
   pthread_mutex_lock(&tp->tp_mutex);
 
-  if (tp->tp_first == NULL)
-    tp->tp_first = work;
+  lq = tp->tp_lanes + lane;
+
+  if (lq->first == NULL)
+    lq->first = work;
   else
-    tp->tp_last->next = work;
+    lq->last->next = work;
   
-  tp->tp_last = work;
+  lq->last = work;
+
+  if (++lq->depth > lq->max_depth)
+    lq->max_depth = lq->depth;
+
+  tp->tp_queued++;
 
   if (tp->tp_idle_threads > 0)
     pthread_cond_signal(&tp->tp_waiting_work);
@@ -447,7 +563,40 @@ int enqueue_threadpool_request(
   pthread_mutex_unlock(&tp->tp_mutex);
 
   return(0);
-  } /* END enqueue_threadpool_request() */
+  } /* END enqueue_threadpool_request_lane() */
+
+
+
+/*
+ * threadpool_get_lane_stats()
+ *
+ * copies the queue depth and wait time counters for one of tp's lanes into
+ * stats. The work pointers in stats are cleared.
+ * @return PBSE_NONE, or PBSE_BAD_PARAMETER for an invalid lane
+ */
+
+int threadpool_get_lane_stats(
+
+  threadpool_t    *tp,
+  int              lane,
+  tp_lane_queue_t *stats)
+
+  {
+  if ((tp == NULL) ||
+      (stats == NULL) ||
+      (lane < 0) ||
+      (lane >= TP_NUM_LANES))
+    return(PBSE_BAD_PARAMETER);
+
+  pthread_mutex_lock(&tp->tp_mutex);
+  *stats = tp->tp_lanes[lane];
+  pthread_mutex_unlock(&tp->tp_mutex);
+
+  stats->first = NULL;
+  stats->last = NULL;
+
+  return(PBSE_NONE);
+  } /* END threadpool_get_lane_stats() */
 
 
 
@@ -518,11 +667,19 @@ void destroy_request_pool(
   pthread_mutex_unlock(&tp->tp_mutex);
 
   /* free pending work */
-  while ((work = tp->tp_first) != NULL)
+  for (int i = 0; i < TP_NUM_LANES; i++)
     {
-    tp->tp_first = work->next;
-    free(work);
+    while ((work = tp->tp_lanes[i].first) != NULL)
+      {
+      tp->tp_lanes[i].first = work->next;
+      free(work);
+      }
+
+    tp->tp_lanes[i].last = NULL;
+    tp->tp_lanes[i].depth = 0;
     }
+
+  tp->tp_queued = 0;
   } /* END destroy_request_pool() */
 
 
@@ -112,11 +112,15 @@
 #define TRUE 1
 #endif /* TRUE */
 
-static char    procfs[] = "/proc";
+char           procfs[MAXPATHLEN] = "/proc";
 static DIR    *pdir = NULL;
 int     pagesize;
 
 pid2procarrayindex_map_t pid2procarrayindex_map;
+jobsid2procarrayindex_map_t jobsid2procarrayindex_map;
+#ifdef PENABLE_LINUX_CGROUPS
+jobid2procarrayindices_map_t jobid2procarrayindices_map;
+#endif
 
 extern char *ret_string;
 
@@ -506,7 +510,8 @@ proc_stat_t *get_proc_stat(
 
   struct stat         sb;
 
-  sprintf(path, "/proc/%d/stat",
+  sprintf(path, "%s/%d/stat",
+          procfs,
           pid);
 
   if ((fd = fopen(path, "r")) == NULL)
@@ -1112,6 +1117,85 @@ bool injob(
   }  /* END injob() */
 
 
+
+/*
+ * get_job_proc_indices()
+ *
+ * Appends the proc_array index of every sampled process that belongs to
+ * pjob to indices. The job's session ids come from ji_job_pid_set and its
+ * tasks; each one is looked up in jobsid2procarrayindex_map, so the cost is
+ * proportional to the job's own processes rather than to every job process
+ * on the node.
+ *
+ * With cgroups the job's processes are the ones listed in its cgroup, which
+ * also catches processes that left the job's sessions. mom_get_sample() reads
+ * each job's cgroup once per sample; the session ids are used if the job's
+ * cgroup couldn't be read.
+ *
+ * @param pjob - the job whose processes we want (I)
+ * @param indices - the proc_array indices of the job's processes (O)
+ */
+
+void get_job_proc_indices(
+
+  job              *pjob,
+  std::vector<int> &indices)
+
+  {
+  typedef jobsid2procarrayindex_map_t::const_iterator sid_iter;
+
+  std::pair<sid_iter, sid_iter> range;
+
+#ifdef PENABLE_LINUX_CGROUPS
+  jobid2procarrayindices_map_t::const_iterator cg_iter = jobid2procarrayindices_map.find(pjob->ji_qs.ji_jobid);
+
+  if (cg_iter != jobid2procarrayindices_map.end())
+    {
+    indices.insert(indices.end(), cg_iter->second.begin(), cg_iter->second.end());
+
+    return;
+    }
+#endif
+
+  for (job_pid_set_t::const_iterator it = pjob->ji_job_pid_set->begin();
+       it != pjob->ji_job_pid_set->end();
+       it++)
+    {
+    range = jobsid2procarrayindex_map.equal_range(*it);
+
+    for (sid_iter iter = range.first; iter != range.second; iter++)
+      indices.push_back(iter->second);
+    }
+
+  for (unsigned int i = 0; i < pjob->ji_tasks->size(); i++)
+    {
+    pid_t sid = pjob->ji_tasks->at(i)->ti_qs.ti_sid;
+    bool  seen = false;
+
+    /* don't count a session twice if it is also in the pid set or an earlier task */
+    if (pjob->ji_job_pid_set->find(sid) != pjob->ji_job_pid_set->end())
+      continue;
+
+    for (unsigned int j = 0; j < i; j++)
+      {
+      if (pjob->ji_tasks->at(j)->ti_qs.ti_sid == sid)
+        {
+        seen = true;
+        break;
+        }
+      }
+
+    if (seen == true)
+      continue;
+
+    range = jobsid2procarrayindex_map.equal_range(sid);
+
+    for (sid_iter iter = range.first; iter != range.second; iter++)
+      indices.push_back(iter->second);
+    }
+  }  /* END get_job_proc_indices() */
+
+
 /*
  * Internal session CPU time decoding routine.
  *
@@ -1127,51 +1211,27 @@ unsigned long cput_sum(
   job *pjob)  /* I */
 
   {
-  ulong          cputime;
-  int            nps = 0;
-  proc_stat_t   *ps;
+  ulong             cputime;
+  int               nps = 0;
+  proc_stat_t      *ps;
+  std::vector<int>  indices;
 
   cputime = 0;
 
   if (LOGLEVEL >= 6)
     {
-    sprintf(log_buffer, "pid2jobsid_map loop start - jobid = %s",
+    sprintf(log_buffer, "job process loop start - jobid = %s",
             pjob->ji_qs.ji_jobid);
 
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
-  /* iterate over pids of all job session ids */
-  for (pid2jobsid_map_t::const_iterator iter = pid2jobsid_map.begin();
-       iter != pid2jobsid_map.end();
-       iter++)
-    {
-    int index;
-    pid_t pid;
-
-    pid = iter->first;
-
-    if (!injob(pjob, pid))
-      {
-      continue;
-      }
-    
-    /* pid is in the job */
-
-    /* get the index of this pid in the proc_array */
-
-    /* see if pid is in the map */
-    pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(pid);
-    if (pa_iter == pid2procarrayindex_map.end())
-      {
-      /* not in map so skip */
-      continue;
-      }
-
-    /* assign index to the index of the pid in proc_array */
-    index = pa_iter->second;
+  get_job_proc_indices(pjob, indices);
 
-    ps = &proc_array[index];
+  /* iterate over the processes of the job's sessions */
+  for (unsigned int i = 0; i < indices.size(); i++)
+    {
+    ps = &proc_array[indices[i]];
 
     nps++;
 
@@ -1210,8 +1270,6 @@ unsigned long cput_sum(
 
   {
   ulong        cputime = 0; 
-  std::string  full_cgroup_path;
-  int          fd;
   int          rc;
   char         buf[LOCAL_BUF_SIZE];
 
@@ -1256,45 +1314,21 @@ unsigned long cput_sum(
     pjob->ji_flags &= ~MOM_NO_PROC;
     }
 
-    /* This is not a -L request */
-
-    full_cgroup_path = cg_cpuacct_path + pjob->ji_qs.ji_jobid + "/cpuacct.usage";
-
-    fd = open(full_cgroup_path.c_str(), O_RDONLY);
-    if (fd <= 0)
-      {
-      if (pjob->ji_cgroups_created == true)
-        {
-        sprintf(buf, "failed to open %s: %s", full_cgroup_path.c_str(), strerror(errno));
-        log_err(-1, __func__, buf);
-        }
-      return(0);
-      }
-
-    rc = read(fd, buf, LOCAL_BUF_SIZE);
-    if (rc == -1)
+  /* the job cgroup (v1 or v2) holds the whole job's usage, so none of
+   * the job's processes need to be looked at */
+  rc = trq_cg_get_job_cput_stats(pjob->ji_qs.ji_jobid, cputime);
+  if (rc != PBSE_NONE)
+    {
+    if (pjob->ji_cgroups_created == true)
       {
-      sprintf(buf, "failed to read %s: %s", full_cgroup_path.c_str(), strerror(errno));
+      sprintf(buf, "failed to read the cpu usage of the cgroup for job %s", pjob->ji_qs.ji_jobid);
       log_err(-1, __func__, buf);
-      close(fd);
-      return(0);
       }
-    else if (rc != 0) /* if rc is 0 something is not right but it is not a critical error. Don't do anything */
-    {
-    ulong nano_seconds;
-    /* successful read. Should be a number in nano-seconds */
 
-    nano_seconds = atol(buf);
-    cputime += nano_seconds;
+    return(0);
     }
 
-    /* convert the nano seconds to seconds */
-    cputime = cputime/NANO_SECONDS;
-
-    pjob->ji_flags &= ~MOM_NO_PROC;
-
-    close(fd);
-    
+  pjob->ji_flags &= ~MOM_NO_PROC;
 
   return(cputime);
   
@@ -1313,41 +1347,16 @@ int overcpu_proc(
   unsigned long  limit)  /* I */
 
   {
-  ulong          cputime;
+  ulong             cputime;
+  proc_stat_t      *ps;
+  std::vector<int>  indices;
 
-  proc_stat_t   *ps;
+  get_job_proc_indices(pjob, indices);
 
-  /* iterate over pids of all job session ids */
-  for (pid2jobsid_map_t::const_iterator iter = pid2jobsid_map.begin();
-       iter != pid2jobsid_map.end();
-       iter++)
+  /* iterate over the processes of the job's sessions */
+  for (unsigned int i = 0; i < indices.size(); i++)
     {
-    int index;
-    pid_t pid;
-
-    pid = iter->first;
-
-    if (!injob(pjob, pid))
-      {
-      continue;
-      }
-
-    /* pid is in the job */
-
-    /* get the index of this pid in the proc_array */
-
-    /* see if pid is in the map */
-    pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(pid);
-    if (pa_iter == pid2procarrayindex_map.end())
-      {
-      /* not in map so skip */
-      continue;
-      }
-
-    /* assign index to the index of the pid in proc_array */
-    index = pa_iter->second;
-
-    ps = &proc_array[index];
+    ps = &proc_array[indices[i]];
 
     /* change from ps->cutime to ps->utime, and ps->cstime to ps->stime */
 
@@ -1378,47 +1387,23 @@ unsigned long long mem_sum(
   {
   unsigned long long  segadd;
   proc_stat_t        *ps;
+  std::vector<int>    indices;
 
   segadd = 0;
 
   if (LOGLEVEL >= 6)
     {
-    sprintf(log_buffer, "pid2jobsid_map loop start - jobid = %s",
+    sprintf(log_buffer, "job process loop start - jobid = %s",
             pjob->ji_qs.ji_jobid);
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
-  /* iterate over pids of all job session ids */
-  for (pid2jobsid_map_t::const_iterator iter = pid2jobsid_map.begin();
-       iter != pid2jobsid_map.end();
-       iter++)
-    {
-    int index;
-    pid_t pid;
-
-    pid = iter->first;
-
-    if (!injob(pjob, pid))
-      {
-      continue;
-      }
-
-    /* pid is in the job */
-
-    /* get the index of this pid in the proc_array */
-
-    /* see if pid is in the map */
-    pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(pid);
-    if (pa_iter == pid2procarrayindex_map.end())
-      {
-      /* not in map so skip */
-      continue;
-      }
-
-    /* assign index to the index of the pid in proc_array */
-    index = pa_iter->second;
+  get_job_proc_indices(pjob, indices);
 
-    ps = &proc_array[index];
+  /* iterate over the processes of the job's sessions */
+  for (unsigned int i = 0; i < indices.size(); i++)
+    {
+    ps = &proc_array[indices[i]];
 
     segadd += ps->vsize;
 
@@ -1455,6 +1440,7 @@ unsigned long long resi_sum(
   {
   unsigned long long  resisize;
   proc_stat_t        *ps;
+  std::vector<int>    indices;
 #ifdef USELIBMEMACCT
   long long                w_rss;
 #endif
@@ -1468,39 +1454,12 @@ unsigned long long resi_sum(
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
-  /* iterate over pids of all job session ids */
-  for (pid2jobsid_map_t::const_iterator iter = pid2jobsid_map.begin();
-       iter != pid2jobsid_map.end();
-       iter++)
-    {
-    int index;
-    pid_t pid;
-
-    /* get the pid (key) from the map */
-    pid = iter->first;
-
-    if (!injob(pjob, pid))
-      {
-      /* pid is not in job */
-      continue;
-      }
-
-    /* pid is in the job */
-
-    /* get the index of this pid in the proc_array */
+  get_job_proc_indices(pjob, indices);
 
-    /* see if pid is in the map */
-    pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(pid);
-    if (pa_iter == pid2procarrayindex_map.end())
-      {
-      /* not in map so skip */
-      continue;
-      }
-
-    /* assign index to the index of the pid in proc_array */
-    index = pa_iter->second;
-
-    ps = &proc_array[index];
+  /* iterate over the processes of the job's sessions */
+  for (unsigned int i = 0; i < indices.size(); i++)
+    {
+    ps = &proc_array[indices[i]];
 
 
 #ifdef USELIBMEMACCT
@@ -1556,10 +1515,9 @@ unsigned long long resi_sum(
 
   {
   unsigned long long resisize = 0;
-  std::string  full_cgroup_path;
-  char         buf[LOCAL_BUF_SIZE];
-  int          fd;
-  int          rc;
+  unsigned long long mem_read;
+  char               buf[LOCAL_BUF_SIZE];
+  int                rc;
 
   pbs_attribute *pattr;
   pattr = &pjob->ji_wattr[JOB_ATR_req_information];
@@ -1600,44 +1558,22 @@ unsigned long long resi_sum(
       }
     }
 
-  full_cgroup_path = cg_memory_path + pjob->ji_qs.ji_jobid + "/memory.max_usage_in_bytes";
-
-  fd = open(full_cgroup_path.c_str(), O_RDONLY);
-  if (fd <= 0)
+  rc = trq_cg_get_job_memory_stats(pjob->ji_qs.ji_jobid, mem_read);
+  if (rc != PBSE_NONE)
     {
     if (pjob->ji_cgroups_created == true)
       {
-      sprintf(buf, "failed to open %s: %s", full_cgroup_path.c_str(), strerror(errno));
+      sprintf(buf, "failed to read the memory usage of the cgroup for job %s", pjob->ji_qs.ji_jobid);
       log_err(-1, __func__, buf);
       }
 
     return(0);
     }
 
-  rc = read(fd, buf, LOCAL_BUF_SIZE);
-  if (rc == -1)
-    {
-    sprintf(buf, "failed to read %s: %s", full_cgroup_path.c_str(), strerror(errno));
-    log_err(-1, __func__, buf);
-    close(fd);
-    return(0);
-    }
-  else if (rc != 0) 
-    {
-    int hardwareStyle;
-    unsigned long long mem_read;
-
-    mem_read = strtoull(buf, NULL, 10);
-
-    hardwareStyle = this_node.getHardwareStyle();
-
-    if (hardwareStyle == AMD) /* AMD adds everything up in the parent cgroup hierarchy and Intel does not */
-      resisize = mem_read;
-    else
-      resisize += mem_read;
-    }
-
-  close(fd);
+  if (this_node.getHardwareStyle() == AMD) /* AMD adds everything up in the parent cgroup hierarchy and Intel does not */
+    resisize = mem_read;
+  else
+    resisize += mem_read;
 
   return(resisize);
   }
@@ -1656,46 +1592,22 @@ int overmem_proc(
 
   {
   proc_stat_t        *ps;
+  std::vector<int>    indices;
 
   if (LOGLEVEL >= 6)
     {
-    sprintf(log_buffer, "pid2jobsid_map loop start - jobid = %s",
+    sprintf(log_buffer, "job process loop start - jobid = %s",
             pjob->ji_qs.ji_jobid);
 
     log_record(PBSEVENT_DEBUG, 0, __func__, log_buffer);
     }
 
-  /* iterate over pids of all job session ids */
-  for (pid2jobsid_map_t::const_iterator iter = pid2jobsid_map.begin();
-       iter != pid2jobsid_map.end();
-       iter++)
-    {
-    int index;
-    pid_t pid;
-
-    pid = iter->first;
-
-    if (!injob(pjob, pid))
-      {
-      continue;
-      }
-
-    /* pid is in the job */
-
-    /* get the index of this pid in the proc_array */
-
-    /* see if pid is in the map */
-    pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(pid);
-    if (pa_iter == pid2procarrayindex_map.end())
-      {
-      /* not in map so skip */
-      continue;
-      }
-
-    /* assign index to the index of the pid in proc_array */
-    index = pa_iter->second;
+  get_job_proc_indices(pjob, indices);
 
-    ps = &proc_array[index];
+  /* iterate over the processes of the job's sessions */
+  for (unsigned int i = 0; i < indices.size(); i++)
+    {
+    ps = &proc_array[indices[i]];
 
     if (ps->vsize > limit)
       {
@@ -2366,6 +2278,53 @@ int get_job_sid_from_pid(pid_t pid)
   }
 
 
+#ifdef PENABLE_LINUX_CGROUPS
+/*
+ * sample_job_cgroup_procs()
+ *
+ * Reads the pid list of every job with a cgroup once per sample and maps it
+ * to proc_array indices, so get_job_proc_indices() doesn't read cgroup.procs
+ * again for each usage rollup. Jobs whose cgroup can't be read are left out
+ * and fall back to their sessions.
+ *
+ * NOTE:  populates global 'jobid2procarrayindices_map' map (job id to the proc_array
+ *        indices of the processes in its cgroup).
+ */
+
+void sample_job_cgroup_procs(void)
+
+  {
+  std::vector<pid_t> pids;
+
+  jobid2procarrayindices_map.clear();
+
+  for (std::list<job *>::iterator iter = alljobs_list.begin(); iter != alljobs_list.end(); iter++)
+    {
+    job *pjob = *iter;
+
+    if (pjob->ji_cgroups_created != true)
+      continue;
+
+    pids.clear();
+
+    if (trq_cg_get_job_pids(pjob->ji_qs.ji_jobid, pids) != PBSE_NONE)
+      continue;
+
+    std::vector<int> &indices = jobid2procarrayindices_map[pjob->ji_qs.ji_jobid];
+
+    for (unsigned int i = 0; i < pids.size(); i++)
+      {
+      pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(pids[i]);
+
+      if (pa_iter != pid2procarrayindex_map.end())
+        indices.push_back(pa_iter->second);
+      }
+    }
+  }  /* END sample_job_cgroup_procs() */
+#endif
+
+
+
 /*
  * Declare start of polling loop.
  *
@@ -2386,6 +2345,10 @@ int get_job_sid_from_pid(pid_t pid)
  * NOTE:  reallocs proc_array[] as needed to accomodate processes.
  * NOTE:  populates global 'pid2jobsid_map' map (pid to owning job session id mapping for all pids).
  * NOTE:  populates global 'pid2procarrayindex_map' map (pid to index in proc_array map).
+ * NOTE:  populates global 'jobsid2procarrayindex_map' multimap (job session id to the proc_array
+ *        indices of its processes) so per-job rollups only visit the job's own processes.
+ * NOTE:  with cgroups, populates global 'jobid2procarrayindices_map' through
+ *        sample_job_cgroup_procs().
  *
  * @see mom_open_poll() - allocs proc_array table.
  * @see mom_close_poll() - frees procs_array.
@@ -2415,6 +2378,7 @@ int mom_get_sample(void)
   /* clear the maps */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
 
   pi = proc_array;
 
@@ -2537,6 +2501,7 @@ int mom_get_sample(void)
     if (it != global_job_sid_set.end())
       {
       pid2jobsid_map[proc_array[i].pid] = proc_array[i].session;
+      jobsid2procarrayindex_map.insert(std::make_pair(proc_array[i].session, i));
       continue;
       }
 
@@ -2544,12 +2509,17 @@ int mom_get_sample(void)
     if ((job_sid = get_job_sid_from_pid(proc_array[i].ppid)) != -1)
       {
       pid2jobsid_map[proc_array[i].pid] = job_sid;
+      jobsid2procarrayindex_map.insert(std::make_pair(job_sid, i));
       continue;
       }
 
     /* If we get to here the proc_array entry does not belong to a current job */
     }
 
+#ifdef PENABLE_LINUX_CGROUPS
+  sample_job_cgroup_procs();
+#endif
+
   return(PBSE_NONE);
   }  /* END mom_get_sample() */
 
@@ -9390,7 +9390,8 @@ int read_status_strings(
   if ((rc == DIS_SUCCESS) ||
       (rc == DIS_EOF))
     {
-    /* SUCCESS */
+    /* SUCCESS - the sender always sends full updates through us: we keep
+     * only its latest status and a delta needs the one before it */
     write_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER, IS_STATUS, PBSE_NONE);
     updates_waiting_to_send++;
   
@@ -244,6 +244,7 @@
 #include "mom_func.h"
 #include <string>
 #include <vector>
+#include <map>
 #include "container.hpp"
 #include <arpa/inet.h>
 #include <boost/tokenizer.hpp>
@@ -264,6 +265,7 @@
 #define MAX_SERVER_UPDATE_SPACING         40
 #define NO_SERVER_CONFIGURED             -1
 #define COULD_NOT_CONTACT_SERVER         -2
+#define FULL_STATUS_UPDATE_INTERVAL       10 /* deltas sent between two full updates */
 
 #ifdef NUMA_SUPPORT
 extern int numa_index;
@@ -314,6 +316,17 @@ extern container::item_container<received_node *> received_statuses;
 std::vector<std::string>   global_gpu_status;
 std::vector<std::string>   mom_status;
 
+/* the last status the server confirmed. Updates are sent as deltas against it */
+std::vector<std::string>   acked_status;
+unsigned long              acked_status_version = 0;
+unsigned long              status_version = 0;
+int                        deltas_since_full_status = 0;
+bool                       server_accepts_status_deltas = false;
+int                        last_status_reply = PBSE_NONE;
+
+/* sent in every delta, changed or not, since the server acts on them each time */
+const char                *always_sent_status[] = { "state", "message", "jobs", NULL };
+
 
 extern struct config *rm_search(struct config *where, const char *what);
 
@@ -1195,6 +1208,132 @@ void generate_server_status(
 
 
 
+/*
+ * map_status_units()
+ *
+ * Splits a status into the units a delta is made of. A gpu or mic section is
+ * one unit; any other string is named by what comes before its '=', and
+ * strings with the same name make up one unit.
+ *
+ * @param status - the status to split
+ * @param units - the strings of each unit, by name (output)
+ * @param order - the unit names in the order they first appear (output)
+ */
+
+void map_status_units(
+
+  const std::vector<std::string>                    &status,
+  std::map<std::string, std::vector<std::string> > &units,
+  std::vector<std::string>                          &order)
+
+  {
+  for (size_t i = 0; i < status.size(); i++)
+    {
+    std::string key;
+    size_t      last = i;
+
+    if ((status[i] == START_GPU_STATUS) ||
+        (status[i] == START_MIC_STATUS))
+      {
+      const char *end_marker = (status[i] == START_GPU_STATUS) ? END_GPU_STATUS : END_MIC_STATUS;
+
+      key = status[i];
+
+      while ((last + 1 < status.size()) &&
+             (status[last] != end_marker))
+        last++;
+      }
+    else
+      key = status[i].substr(0, status[i].find('='));
+
+    std::vector<std::string> &unit = units[key];
+
+    if (unit.size() == 0)
+      order.push_back(key);
+
+    unit.insert(unit.end(), status.begin() + i, status.begin() + last + 1);
+    i = last;
+    }
+  } /* END map_status_units() */
+
+
+
+bool is_always_sent_status(
+
+  const std::string &key)
+
+  {
+  for (int i = 0; always_sent_status[i] != NULL; i++)
+    {
+    if (key == always_sent_status[i])
+      return(true);
+    }
+
+  return(false);
+  } /* END is_always_sent_status() */
+
+
+
+/*
+ * build_status_delta()
+ *
+ * Builds an update with only the parts of the status that changed since the
+ * status the server last confirmed, plus the parts the server acts on every
+ * time. Parts that are gone are unset.
+ *
+ * @param acked - the status the server last confirmed
+ * @param current - the status now
+ * @param base - the version of acked
+ * @param version - the version of this update
+ * @param delta - the strings to send (output)
+ */
+
+void build_status_delta(
+
+  const std::vector<std::string> &acked,
+  const std::vector<std::string> &current,
+  unsigned long                   base,
+  unsigned long                   version,
+  std::vector<std::string>       &delta)
+
+  {
+  std::map<std::string, std::vector<std::string> >                 acked_units;
+  std::map<std::string, std::vector<std::string> >                 current_units;
+  std::map<std::string, std::vector<std::string> >::const_iterator it;
+  std::vector<std::string>                                          acked_order;
+  std::vector<std::string>                                          current_order;
+  std::stringstream                                                 ss;
+
+  map_status_units(acked, acked_units, acked_order);
+  map_status_units(current, current_units, current_order);
+
+  ss << STATUS_VERSION_EQUALS << version;
+  delta.push_back(ss.str());
+  ss.str("");
+  ss << STATUS_BASE_EQUALS << base;
+  delta.push_back(ss.str());
+
+  for (size_t i = 0; i < current_order.size(); i++)
+    {
+    const std::vector<std::string> &unit = current_units[current_order[i]];
+
+    it = acked_units.find(current_order[i]);
+
+    if ((it == acked_units.end()) ||
+        (it->second != unit) ||
+        (is_always_sent_status(current_order[i]) == true))
+      delta.insert(delta.end(), unit.begin(), unit.end());
+    }
+
+  for (size_t i = 0; i < acked_order.size(); i++)
+    {
+    if (current_units.find(acked_order[i]) == current_units.end())
+      delta.push_back(std::string(STATUS_UNSET_EQUALS) + acked_order[i]);
+    }
+  } /* END build_status_delta() */
+
+
+
 int should_request_cluster_addrs()
 
   {
@@ -1456,6 +1595,14 @@ int mom_server_update_stat(
     else
       {
       read_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER, IS_STATUS, &ret);
+
+      /* a server that takes versioned updates says how to send the next one */
+      if ((ret == STATUS_DELTAS_OK) ||
+          (ret == STATUS_RESYNC))
+        {
+        last_status_reply = ret;
+        ret = DIS_SUCCESS;
+        }
       }
 
     if (chan != NULL)
@@ -1716,6 +1863,112 @@ void update_mom_status()
   } /* update_mom_status() */
 
 
+
+/*
+ * should_send_status_delta()
+ *
+ * @return true if the next update can be a delta: the server takes them, it
+ * confirmed a status we can diff against and a full update isn't due.
+ */
+
+bool should_send_status_delta()
+
+  {
+#ifdef NUMA_SUPPORT
+  /* each node board is a separate status; they are always sent in full */
+  return(false);
+#else
+  return((server_accepts_status_deltas == true) &&
+         (acked_status.size() > 0) &&
+         (deltas_since_full_status < FULL_STATUS_UPDATE_INTERVAL));
+#endif
+  } /* END should_send_status_delta() */
+
+
+
+/*
+ * version_mom_status()
+ *
+ * Turns the status just generated into the update to send: a delta against the
+ * status the server last confirmed, or the whole status. The whole status is
+ * marked with its version only if the server said it takes versioned updates;
+ * older servers would keep the marker as part of the node's status.
+ *
+ * @param send_delta - true if the update should be a delta
+ * @param full_status - the whole status is moved here (output)
+ */
+
+void version_mom_status(
+
+  bool                      send_delta,
+  std::vector<std::string> &full_status)
+
+  {
+  full_status.swap(mom_status);
+  mom_status.clear();
+
+  if (send_delta == true)
+    build_status_delta(acked_status, full_status, acked_status_version, status_version, mom_status);
+  else if (server_accepts_status_deltas == true)
+    {
+    std::stringstream ss;
+
+    ss << STATUS_VERSION_EQUALS << status_version;
+    mom_status.push_back(ss.str());
+    mom_status.insert(mom_status.end(), full_status.begin(), full_status.end());
+    }
+  else
+    mom_status = full_status;
+  } /* END version_mom_status() */
+
+
+
+/*
+ * update_acked_status()
+ *
+ * Records how the last update was acknowledged. A confirmed versioned status is
+ * kept to diff the next updates against; anything else means the next update
+ * is full. An unversioned update was versioned only if the server had already
+ * said it takes versioned updates.
+ *
+ * @param rc - PBSE_NONE if the update was sent
+ * @param reply - the reply to the update
+ * @param sent_delta - true if the update was a delta
+ * @param full_status - the whole status the update was made from
+ */
+
+void update_acked_status(
+
+  int                       rc,
+  int                       reply,
+  bool                      sent_delta,
+  std::vector<std::string> &full_status)
+
+  {
+  bool sent_version = (sent_delta == true) || (server_accepts_status_deltas == true);
+
+  server_accepts_status_deltas = (reply == STATUS_DELTAS_OK) || (reply == STATUS_RESYNC);
+
+  if ((rc == PBSE_NONE) &&
+      (reply == STATUS_DELTAS_OK) &&
+      (sent_version == true))
+    {
+    acked_status.swap(full_status);
+    acked_status_version = status_version;
+
+    if (sent_delta == true)
+      deltas_since_full_status++;
+    else
+      deltas_since_full_status = 0;
+    }
+  else
+    {
+    acked_status.clear();
+    deltas_since_full_status = 0;
+    }
+  } /* END update_acked_status() */
+
+
 int send_status_through_hierarchy()
 
   {
@@ -1763,7 +2016,10 @@ void mom_server_all_update_stat(void)
   int          fd_pipe[2];
   int          rc;
   char         buf[LOCAL_LOG_BUF_SIZE];
-  size_t       len;
+  ssize_t      len;
+  bool         send_delta;
+  std::string  child_output;
+  std::vector<std::string> full_status;
 
   time_now = time(NULL);
 
@@ -1827,6 +2083,9 @@ void mom_server_all_update_stat(void)
       log_err(-1, __func__, buf);
       }
 
+    send_delta = should_send_status_delta();
+    status_version++;
+
     pid = fork();
 
     if (pid < 0)
@@ -1855,17 +2114,49 @@ void mom_server_all_update_stat(void)
       delete iter;
       received_statuses.unlock();
 
-      len = read(fd_pipe[0], buf, LOCAL_LOG_BUF_SIZE);
+      /* the child writes its rc, the reply and the size of what follows: the
+       * status the server confirmed, one NUL-terminated string at a time */
+      int           child_rc = -1;
+      int           reply = PBSE_NONE;
+      unsigned long status_size = 0;
+      size_t        pos = std::string::npos;
+
+      while ((len = read(fd_pipe[0], buf, LOCAL_LOG_BUF_SIZE)) > 0)
+        {
+        child_output.append(buf, len);
+
+        if ((pos == std::string::npos) &&
+            ((pos = child_output.find('\0')) != std::string::npos))
+          sscanf(child_output.c_str(), "%d %d %lu", &child_rc, &reply, &status_size);
+
+        if ((pos != std::string::npos) &&
+            (child_output.size() >= pos + 1 + status_size))
+          break;
+        }
 
       close(fd_pipe[0]);
 
-      if (len <= 0)
+      if (pos == std::string::npos)
         {
         log_err(-1, __func__, "read of pipe failed for status update");
+        update_acked_status(-1, PBSE_NONE, send_delta, full_status);
         return;
         }
 
-      if (buf[0] != '0')
+      while (pos + 1 < child_output.size())
+        {
+        size_t next = child_output.find('\0', pos + 1);
+
+        if (next == std::string::npos)
+          break;
+
+        full_status.push_back(child_output.substr(pos + 1, next - pos - 1));
+        pos = next;
+        }
+
+      update_acked_status(child_rc, reply, send_delta, full_status);
+
+      if (child_rc != PBSE_NONE)
         num_stat_update_failures++;
       else
         {
@@ -1889,14 +2180,29 @@ void mom_server_all_update_stat(void)
 #endif /* NUMA_SUPPORT */
       {
       update_mom_status();
+#ifndef NUMA_SUPPORT
+      version_mom_status(send_delta, full_status);
+#endif
+
+      last_status_reply = PBSE_NONE;
   
       if (send_status_through_hierarchy() != PBSE_NONE)
         rc = send_update_to_a_server();
       }
 
-    sprintf(buf, "%d", rc);
-    len = strlen(buf);
-    write(fd_pipe[1], buf, len);
+    if (last_status_reply == STATUS_DELTAS_OK)
+      {
+      for (size_t i = 0; i < full_status.size(); i++)
+        {
+        child_output += full_status[i];
+        child_output += '\0';
+        }
+      }
+
+    sprintf(buf, "%d %d %lu", rc, last_status_reply, (unsigned long)child_output.size());
+    child_output.insert(0, buf, strlen(buf) + 1);
+
+    write_buffer((char *)child_output.c_str(), child_output.size(), fd_pipe[1]);
 
     exit_called = true;
   
@@ -70,6 +70,14 @@ void mom_server_update_gpustat(mom_server *pms, char *status_strings);
 void get_device_indices(const char *device_str, std::vector<unsigned int> &device_indices, const char *suffix);
 void generate_server_status(std::vector<std::string>& status);
 
+void build_status_delta(const std::vector<std::string> &acked, const std::vector<std::string> &current, unsigned long base, unsigned long version, std::vector<std::string> &delta);
+
+bool should_send_status_delta();
+
+void version_mom_status(bool send_delta, std::vector<std::string> &full_status);
+
+void update_acked_status(int rc, int reply, bool sent_delta, std::vector<std::string> &full_status);
+
 #ifdef NVML_API
 void generate_server_gpustatus_nvml(std::vector<std::string>& gpu_status);
 #endif /* NVML_API */
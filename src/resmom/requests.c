@@ -588,7 +588,7 @@ static void add_bad_list(
 
 
 
-#define RT_BLK_SZ 4096
+#define RT_BLK_SZ SCRIPT_CHUNK_Z
 
 int return_file(
 
@@ -599,7 +599,8 @@ int return_file(
 
   {
   int                   amt;
-  char                  buf[RT_BLK_SZ];
+  off_t                 offset;
+  struct stat           sb;
   int                   fds;
   char                 *filename;
 
@@ -638,23 +639,32 @@ int return_file(
     return(errno);
     }
 
+  if (fstat(fds, &sb) < 0)
+    {
+    rc = errno;
+    free_br(prq);
+    close(fds);
+    return(rc);
+    }
+
   strcpy(prq->rq_host, mom_host);
 
   strcpy(prq->rq_ind.rq_jobfile.rq_jobid, pjob->ji_qs.ji_jobid);
 
-  while ((amt = read_ac_socket(fds, buf, RT_BLK_SZ)) > 0)
+  /* each block goes from the file to the socket without being copied here */
+  for (offset = 0; offset < sb.st_size; offset += amt)
     {
-    /* prq->rq_ind.rq_jobfile.rq_sequence = seq++; */
-    /* prq->rq_ind.rq_jobfile.rq_type = (int)which; */
-    /* prq->rq_ind.rq_jobfile.rq_size = amt; */
-    /* prq->rq_ind.rq_jobfile.rq_data = buf; */
+    if (sb.st_size - offset > RT_BLK_SZ)
+      amt = RT_BLK_SZ;
+    else
+      amt = sb.st_size - offset;
 
     if ((chan = DIS_tcp_setup(sock)) == NULL)
       {
       break;
       }
     else if ((rc = encode_DIS_ReqHdr(chan, PBS_BATCH_MvJobFile, pbs_current_user)) ||
-             (rc = encode_DIS_JobFile(chan, seq++, buf, amt, pjob->ji_qs.ji_jobid, which)) ||
+             (rc = encode_DIS_JobFile_fd(chan, seq++, fds, offset, amt, pjob->ji_qs.ji_jobid, which)) ||
              (rc = encode_DIS_ReqExtend(chan, NULL)))
       {
       DIS_tcp_cleanup(chan);
@@ -663,7 +673,15 @@ int return_file(
       break;
       }
 
-    DIS_tcp_wflush(chan);
+    if (DIS_tcp_wflush(chan) != 0)
+      {
+      rc = -1;
+
+      DIS_tcp_cleanup(chan);
+      chan = NULL;
+
+      break;
+      }
 
     if ((DIS_reply_read(chan, &prq->rq_reply) != 0) ||
         (prq->rq_reply.brp_code != 0))
@@ -678,7 +696,7 @@ int return_file(
 
     DIS_tcp_cleanup(chan);
     chan = NULL;
-    }    /* END while ((amt = read()) */
+    }    /* END for (offset) */
 
   free_br(prq);
 
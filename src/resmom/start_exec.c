@@ -94,10 +94,13 @@ extern "C"
 #include <sys/wait.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <poll.h>
 #if IBM_SP2==2 /* IBM SP with PSSP 3.1 */
   #include <st_client.h>
 #endif /* IBM SP */
 #include <map>
+#include <deque>
 
 #include "libpbs.h"
 #include "portability.h"
@@ -200,6 +203,11 @@ typedef enum
 
 
 #define KB  1024
+
+#define JOIN_JOB_MAX_IN_FLIGHT 128 /* sisters sent the join job at once */
+#define JOIN_JOB_TIMEOUT       5   /* seconds a sister has to take its join */
+#define JOIN_JOB_ATTEMPTS      5
+#define JOIN_JOB_RETRY_USECS   10000 /* wait before the second attempt, doubled for each one after */
 /* Global Variables */
 extern node_internals internal_layout;
 
@@ -6896,6 +6904,53 @@ void sister_job_nodes(
 
 
 
+/*
+ * encode_join_job()
+ *
+ * Writes an IM_JOIN_JOB request for a sister into chan's buffer without
+ * flushing it.
+ */
+
+int encode_join_job(
+
+  job        *pjob,
+  tcp_chan   *chan,
+  eventent   *ep,
+  tlist_head  phead,
+  int         node_id)
+
+  {
+  int ret;
+
+  if ((ret = im_compose(chan, pjob->ji_qs.ji_jobid,
+          pjob->ji_wattr[JOB_ATR_Cookie].at_val.at_str, IM_JOIN_JOB,
+          ep->ee_event, TM_NULL_TASK)) != DIS_SUCCESS)
+    {
+    }
+  else if ((ret = diswsi(chan, node_id)) != DIS_SUCCESS)
+    {
+    }
+  else if ((ret = diswsi(chan, pjob->ji_numnodes)) != DIS_SUCCESS)
+    {
+    }
+  else if ((ret = diswsi(chan, pjob->ji_portout)) != DIS_SUCCESS)
+    {
+    }
+  else if ((ret = diswsi(chan, pjob->ji_porterr)) != DIS_SUCCESS)
+    {
+    }
+  else
+    {
+    svrattrl *psatl = (svrattrl *)GET_NEXT(phead);
+
+    ret = encode_DIS_svrattrl(chan, psatl);
+    }
+
+  return(ret);
+  } /* END encode_join_job() */
+
+
+
 int send_join_job_to_a_sister(
 
   job        *pjob,
@@ -6910,40 +6965,310 @@ int send_join_job_to_a_sister(
 
   if (chan != NULL)
     {
-    if ((ret = im_compose(chan, pjob->ji_qs.ji_jobid,
-            pjob->ji_wattr[JOB_ATR_Cookie].at_val.at_str, IM_JOIN_JOB,
-            ep->ee_event, TM_NULL_TASK)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = diswsi(chan, node_id)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = diswsi(chan, pjob->ji_numnodes)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = diswsi(chan, pjob->ji_portout)) != DIS_SUCCESS)
-      {
-      }
-    else if ((ret = diswsi(chan, pjob->ji_porterr)) != DIS_SUCCESS)
-      {
-      }
-    else
+    if ((ret = encode_join_job(pjob, chan, ep, phead, node_id)) == DIS_SUCCESS)
+      ret = DIS_tcp_wflush(chan);
+
+    DIS_tcp_cleanup(chan);
+    }
+
+  return(ret);
+  } /* END send_join_job_to_a_sister() */
+
+
+
+/*
+ * build_join_job_message()
+ *
+ * Encodes the IM_JOIN_JOB request for a sister so that it can be written to
+ * a nonblocking socket as the socket is ready for it.
+ *
+ * @param msg - the encoded request (output)
+ */
+
+int build_join_job_message(
+
+  job         *pjob,
+  int          stream,
+  eventent    *ep,
+  tlist_head   phead,
+  int          node_id,
+  std::string &msg)
+
+  {
+  tcp_chan *chan = DIS_tcp_setup(stream);
+  int       ret = DIS_NOMALLOC;
+
+  if (chan != NULL)
+    {
+    if ((ret = encode_join_job(pjob, chan, ep, phead, node_id)) == DIS_SUCCESS)
       {
-      svrattrl *psatl = (svrattrl *)GET_NEXT(phead);
+      struct tcpdisbuf *tp = &chan->writebuf;
 
-      if ((ret = encode_DIS_svrattrl(chan, psatl)) == DIS_SUCCESS)
-        {
-        ret = DIS_tcp_wflush(chan);
-        }
+      msg.assign(tp->tdis_thebuf, tp->tdis_trailp - tp->tdis_thebuf);
       }
 
     DIS_tcp_cleanup(chan);
     }
 
   return(ret);
-  } /* END send_join_job_to_a_sister() */
+  } /* END build_join_job_message() */
+
+
+
+/*
+ * join_latency_histogram()
+ *
+ * @param latencies - how long each sister took to take its join, in microseconds
+ * @param histogram - the latencies counted by order of magnitude (output)
+ */
+
+void join_latency_histogram(
+
+  const std::vector<long> &latencies,
+  std::string             &histogram)
+
+  {
+  static const long  bounds[] = { 1000, 10000, 100000, 1000000, 10000000 };
+  static const char *labels[] = { "<1ms", "<10ms", "<100ms", "<1s", "<10s", ">=10s" };
+  const int          bucket_count = sizeof(labels) / sizeof(labels[0]);
+  int                counts[bucket_count];
+  long               max = 0;
+  std::stringstream  ss;
+
+  memset(counts, 0, sizeof(counts));
+
+  for (size_t i = 0; i < latencies.size(); i++)
+    {
+    int b = 0;
+
+    while ((b < bucket_count - 1) &&
+           (latencies[i] >= bounds[b]))
+      b++;
+
+    counts[b]++;
+
+    if (latencies[i] > max)
+      max = latencies[i];
+    }
+
+  for (int b = 0; b < bucket_count; b++)
+    ss << labels[b] << ":" << counts[b] << " ";
+
+  ss << "max:" << max / 1000 << "ms";
+
+  histogram = ss.str();
+  } /* END join_latency_histogram() */
+
+
+
+/*
+ * join_request
+ *
+ * A join job on its way to one sister.
+ */
+
+class join_request
+  {
+  public:
+  int            node_id;
+  int            stream;
+  int            attempts;
+  bool           connected;
+  std::string    msg;
+  size_t         sent;
+  struct timeval first_try;  /* for the latency */
+  struct timeval next_try;   /* the next attempt waits until then */
+  time_t         deadline;   /* of this attempt */
+
+  join_request() : node_id(-1), stream(-1), attempts(0), connected(false), msg(), sent(0),
+                   first_try(), next_try(), deadline(0)
+    {
+    }
+  };
+
+
+
+/*
+ * join_retry_wait()
+ *
+ * @return the microseconds until jr may be tried again, 0 if it may be now
+ */
+
+long join_retry_wait(
+
+  const join_request   &jr,
+  const struct timeval &now)
+
+  {
+  long wait = (jr.next_try.tv_sec - now.tv_sec) * 1000000 + (jr.next_try.tv_usec - now.tv_usec);
+
+  return((wait > 0) ? wait : 0);
+  } /* END join_retry_wait() */
+
+
+
+/*
+ * retry_join_request()
+ *
+ * Puts jr back in line after a failed attempt. Like tcp_connect_sockaddr(),
+ * it waits a little before trying again, and longer after each failure.
+ *
+ * @return true if jr will be tried again, false if it is out of attempts
+ */
+
+bool retry_join_request(
+
+  join_request    &jr,
+  std::deque<int> &waiting)
 
+  {
+  long backoff;
+
+  if (jr.attempts >= JOIN_JOB_ATTEMPTS)
+    return(false);
+
+  backoff = JOIN_JOB_RETRY_USECS << (jr.attempts - 1);
+
+  gettimeofday(&jr.next_try, NULL);
+  jr.next_try.tv_sec += backoff / 1000000;
+  jr.next_try.tv_usec += backoff % 1000000;
+
+  if (jr.next_try.tv_usec >= 1000000)
+    {
+    jr.next_try.tv_sec++;
+    jr.next_try.tv_usec -= 1000000;
+    }
+
+  waiting.push_back(jr.node_id);
+
+  return(true);
+  } /* END retry_join_request() */
+
+
+
+/*
+ * start_join_request()
+ *
+ * Gets a privileged socket for a sister, starts connecting it without waiting
+ * and encodes the join job to send once it's connected.
+ *
+ * @return PBSE_NONE if the request is under way or TRANSIENT_SOCKET_FAIL. Like
+ * tcp_connect_sockaddr(), a refused or timed out connect is transient: the
+ * sister's mom may just be restarting.
+ */
+
+int start_join_request(
+
+  job          *pjob,
+  tlist_head    phead,
+  join_request &jr)
+
+  {
+  hnodent  *np = &pjob->ji_hosts[jr.node_id];
+  eventent *ep;
+
+  if (jr.attempts++ == 0)
+    gettimeofday(&jr.first_try, NULL);
+
+  jr.sent = 0;
+  jr.connected = false;
+  jr.deadline = time(NULL) + JOIN_JOB_TIMEOUT;
+
+  /* the socket comes back nonblocking */
+  if ((jr.stream = socket_get_tcp_priv()) < 0)
+    {
+    jr.stream = -1;
+    return(TRANSIENT_SOCKET_FAIL);
+    }
+
+  if (connect(jr.stream, (struct sockaddr *)&np->sock_addr, sizeof(np->sock_addr)) == 0)
+    jr.connected = true;
+  else if ((errno != EINPROGRESS) &&
+           (errno != EINTR))
+    {
+    close(jr.stream);
+    jr.stream = -1;
+    return(TRANSIENT_SOCKET_FAIL);
+    }
 
+  ep = event_alloc(IM_JOIN_JOB, np, TM_NULL_EVENT, TM_NULL_TASK);
+
+  if (build_join_job_message(pjob, jr.stream, ep, phead, jr.node_id, jr.msg) != DIS_SUCCESS)
+    {
+    close(jr.stream);
+    jr.stream = -1;
+    return(TRANSIENT_SOCKET_FAIL);
+    }
+
+  return(PBSE_NONE);
+  } /* END start_join_request() */
+
+
+
+/*
+ * continue_join_request()
+ *
+ * Moves a join job along once poll() says its socket is ready.
+ *
+ * @return PBSE_NONE when all of it has been written, -EAGAIN if there's more
+ * to do, or TRANSIENT_SOCKET_FAIL
+ */
+
+int continue_join_request(
+
+  join_request &jr,
+  short         revents)
+
+  {
+  ssize_t written;
+
+  if (jr.connected == false)
+    {
+    int       sock_errno = 0;
+    socklen_t len = sizeof(sock_errno);
+
+    if ((getsockopt(jr.stream, SOL_SOCKET, SO_ERROR, &sock_errno, &len) != 0) ||
+        (sock_errno != 0))
+      {
+      errno = sock_errno;
+      return(TRANSIENT_SOCKET_FAIL);
+      }
+
+    if ((revents & POLLOUT) == 0)
+      return(-EAGAIN);
+
+    jr.connected = true;
+    }
+  else if ((revents & (POLLERR | POLLHUP)) != 0)
+    return(TRANSIENT_SOCKET_FAIL);
+
+  while (jr.sent < jr.msg.size())
+    {
+    written = write(jr.stream, jr.msg.c_str() + jr.sent, jr.msg.size() - jr.sent);
+
+    if (written > 0)
+      jr.sent += written;
+    else if ((written < 0) &&
+             ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
+      return(-EAGAIN);
+    else
+      return(TRANSIENT_SOCKET_FAIL);
+    }
+
+  return(PBSE_NONE);
+  } /* END continue_join_request() */
+
+
+
+/*
+ * send_join_job_to_sisters()
+ *
+ * Sends the join job to every sister. Up to JOIN_JOB_MAX_IN_FLIGHT sisters are
+ * contacted at once over nonblocking sockets, so one slow node doesn't hold
+ * up the others. A sister that fails or doesn't take its join within
+ * JOIN_JOB_TIMEOUT seconds is retried after a short backoff, up to
+ * JOIN_JOB_ATTEMPTS times in all.
+ */
 
 int send_join_job_to_sisters(
 
@@ -6952,17 +7277,18 @@ int send_join_job_to_sisters(
   tlist_head  phead)
 
   {
-  int            i;
-  int            retry_count;
-  int            stream;
-  int            ret = PBSE_NONE;
-  eventent      *ep;
-  hnodent       *np;
-  int            send_failed_size = nodenum * sizeof(int);
-  int           *send_failed = (int *)calloc(nodenum, sizeof(int));
-  int            unsent_count = nodenum - 1;
-  bool           permanent_fail = false;
-  std::set<int>  sisters_contacted;
+  int                       i;
+  int                       ret = PBSE_NONE;
+  int                       unsent_count = nodenum - 1;
+  long                      wait_usecs;
+  std::set<int>             sisters_contacted;
+  std::vector<join_request> requests(nodenum);
+  std::deque<int>           waiting;
+  std::vector<int>          in_flight;
+  std::vector<struct pollfd> pfds;
+  std::vector<long>         latencies;
+  struct timeval            start;
+  struct timeval            now;
 
   errno = 0;
 
@@ -6972,64 +7298,148 @@ int send_join_job_to_sisters(
     log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_JOB,pjob->ji_qs.ji_jobid,log_buffer);
     }
 
-  memset(send_failed, -1, send_failed_size);
+  gettimeofday(&start, NULL);
+
   for (i = 1; i < nodenum; i++)
-    send_failed[i] = i;
+    {
+    requests[i].node_id = i;
+    waiting.push_back(i);
+    }
 
-  for (retry_count = 0; retry_count < 5 && permanent_fail == false; retry_count++)
+  while ((waiting.size() > 0) ||
+         (in_flight.size() > 0))
     {
-    if (unsent_count == 0)
-      break;
+    gettimeofday(&now, NULL);
 
-    for (i = 1; i < nodenum; i++)
+    /* fill the window with the sisters whose backoff is over */
+    for (size_t w = waiting.size();
+         (w > 0) && (in_flight.size() < JOIN_JOB_MAX_IN_FLIGHT);
+         w--)
       {
-      if (send_failed[i] == DIS_SUCCESS)
-        continue;
+      join_request &jr = requests[waiting.front()];
 
-      np = &pjob->ji_hosts[i];
+      waiting.pop_front();
+
+      if (join_retry_wait(jr, now) > 0)
+        {
+        waiting.push_back(jr.node_id);
+        continue;
+        }
 
       if (LOGLEVEL >= 7)
         {
-        sprintf(log_buffer,"Sending join job to %s.",pjob->ji_hosts[i].hn_host);
+        sprintf(log_buffer,"Sending join job to %s.",pjob->ji_hosts[jr.node_id].hn_host);
         log_record(PBSEVENT_SYSTEM, PBS_EVENTCLASS_JOB,pjob->ji_qs.ji_jobid,log_buffer);
         }
 
-      log_buffer[0] = '\0';
+      if ((ret = start_join_request(pjob, phead, jr)) == PBSE_NONE)
+        in_flight.push_back(jr.node_id);
+      else
+        retry_join_request(jr, waiting);
+      }
 
-      ret = -1;
-      stream = tcp_connect_sockaddr((struct sockaddr *)&np->sock_addr,sizeof(np->sock_addr), false);
+    /* wake up when the next backoff is over, if there's room to start it */
+    wait_usecs = 100000;
 
-      if (IS_VALID_STREAM(stream))
-        {
-        ep = event_alloc(IM_JOIN_JOB, np, TM_NULL_EVENT, TM_NULL_TASK);
+    if (in_flight.size() < JOIN_JOB_MAX_IN_FLIGHT)
+      {
+      gettimeofday(&now, NULL);
 
-        ret = send_join_job_to_a_sister(pjob, stream, ep, phead, i);
+      for (size_t w = 0; w < waiting.size(); w++)
+        wait_usecs = MIN(wait_usecs, join_retry_wait(requests[waiting[w]], now));
+      }
 
-        close(stream);
-        }
-      else if (stream == PERMANENT_SOCKET_FAIL)
+    if (in_flight.size() == 0)
+      {
+      if (waiting.size() > 0)
+        usleep(wait_usecs);
+
+      continue;
+      }
+
+    pfds.resize(in_flight.size());
+
+    for (size_t j = 0; j < in_flight.size(); j++)
+      {
+      pfds[j].fd = requests[in_flight[j]].stream;
+      pfds[j].events = POLLOUT;
+      pfds[j].revents = 0;
+      }
+
+    if ((poll(&pfds[0], pfds.size(), (wait_usecs + 999) / 1000) < 0) &&
+        (errno != EINTR))
+      {
+      log_err(errno, __func__, "poll failed");
+      break;
+      }
+
+    time_t poll_time = time(NULL);
+
+    for (size_t j = 0; j < in_flight.size(); )
+      {
+      join_request &jr = requests[in_flight[j]];
+
+      if (pfds[j].revents != 0)
+        ret = continue_join_request(jr, pfds[j].revents);
+      else if (poll_time >= jr.deadline)
+        ret = TRANSIENT_SOCKET_FAIL;
+      else
+        ret = -EAGAIN;
+
+      if (ret == -EAGAIN)
         {
-        permanent_fail = true;
-        break;
+        j++;
+        continue;
         }
 
-      if (ret == DIS_SUCCESS)
+      close(jr.stream);
+      jr.stream = -1;
+
+      if (ret == PBSE_NONE)
         {
-        sisters_contacted.insert(i);
-        send_failed[i] = DIS_SUCCESS;
+        gettimeofday(&now, NULL);
+        latencies.push_back((now.tv_sec - jr.first_try.tv_sec) * 1000000 +
+                            (now.tv_usec - jr.first_try.tv_usec));
+
+        sisters_contacted.insert(jr.node_id);
         unsent_count--;
         }
       else
         {
         if (LOGLEVEL >= 7)
           {
-          sprintf(log_buffer,"Sending join job to %s failed with error code %d.",pjob->ji_hosts[i].hn_host,ret);
+          sprintf(log_buffer,"Sending join job to %s failed with error code %d.",pjob->ji_hosts[jr.node_id].hn_host,ret);
           log_err(errno, __func__,log_buffer);
           }
-        log_buffer[0] = '\0';
+
+        retry_join_request(jr, waiting);
         }
-      } /* END for each node */
-    } /* END for 5 retries */
+
+      /* pfds is rebuilt next time around, so keep the two lined up */
+      in_flight[j] = in_flight.back();
+      in_flight.pop_back();
+      pfds[j] = pfds.back();
+      pfds.pop_back();
+      }
+    } /* END while sisters left */
+
+  for (size_t j = 0; j < in_flight.size(); j++)
+    close(requests[in_flight[j]].stream);
+
+  if (LOGLEVEL >= 3)
+    {
+    std::string histogram;
+
+    gettimeofday(&now, NULL);
+    join_latency_histogram(latencies, histogram);
+
+    snprintf(log_buffer, sizeof(log_buffer),
+      "join job sent to %d of %d sisters in %ldms, latency %s",
+      (int)latencies.size(), nodenum - 1,
+      (long)((now.tv_sec - start.tv_sec) * 1000 + (now.tv_usec - start.tv_usec) / 1000),
+      histogram.c_str());
+    log_record(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buffer);
+    }
 
   if (unsent_count > 0)
     {
@@ -7044,7 +7454,7 @@ int send_join_job_to_sisters(
 
       for (i = 1; i < nodenum; i++)
         {
-        if (send_failed[i] != DIS_SUCCESS)
+        if (sisters_contacted.find(i) == sisters_contacted.end())
           {
           if (ds.length() != 0)
             ds += ", ";
@@ -7069,8 +7479,6 @@ int send_join_job_to_sisters(
   else
     ret = PBSE_NONE;
 
-  free(send_failed);
-
   return(ret);
   } /* END send_join_job_to_sisters() */
 
@@ -823,6 +823,194 @@ unsigned long long trq_cg_read_numeric_value(
 
 
 
+/*
+ * trq_cg_read_cput_from_dir()
+ *
+ * Reads the cpu time charged to the cgroup at dir from its cpuacct.usage.
+ *
+ * @param dir   - the cgroup directory, without a trailing slash
+ * @param nanos - the cpu time used in nanoseconds (O)
+ * @return PBSE_NONE on success, PBSE_SYSTEM if the file could not be read or
+ * PBSE_CAN_NOT_OPEN_FILE if the cgroup doesn't exist
+ */
+
+int trq_cg_read_cput_from_dir(
+
+  const string       &dir,
+  unsigned long long &nanos)
+
+  {
+  string      path = dir + "/cpuacct.usage";
+  struct stat stat_buf;
+  bool        error = false;
+
+  nanos = 0;
+
+  if (stat(path.c_str(), &stat_buf) != 0)
+    return(PBSE_CAN_NOT_OPEN_FILE);
+
+  nanos = trq_cg_read_numeric_value(path, error);
+
+  if (error)
+    return(PBSE_SYSTEM);
+
+  return(PBSE_NONE);
+  } // END trq_cg_read_cput_from_dir()
+
+
+
+/*
+ * trq_cg_read_peak_memory_from_dir()
+ *
+ * Reads the peak memory charged to the cgroup at dir from its
+ * memory.max_usage_in_bytes.
+ *
+ * @param dir      - the cgroup directory, without a trailing slash
+ * @param mem_used - the memory used in bytes (O)
+ * @return PBSE_NONE on success, PBSE_SYSTEM if the file could not be read or
+ * PBSE_CAN_NOT_OPEN_FILE if the cgroup doesn't exist
+ */
+
+int trq_cg_read_peak_memory_from_dir(
+
+  const string       &dir,
+  unsigned long long &mem_used)
+
+  {
+  string      path = dir + "/memory.max_usage_in_bytes";
+  struct stat stat_buf;
+  bool        error = false;
+
+  mem_used = 0;
+
+  if (stat(path.c_str(), &stat_buf) != 0)
+    return(PBSE_CAN_NOT_OPEN_FILE);
+
+  mem_used = trq_cg_read_numeric_value(path, error);
+
+  if (error)
+    return(PBSE_SYSTEM);
+
+  return(PBSE_NONE);
+  } // END trq_cg_read_peak_memory_from_dir()
+
+
+
+/*
+ * trq_cg_get_job_cput_stats
+ *
+ * Get the cpu time used by the whole job from its cgroup, without
+ * looking at any of the job's processes.
+ *
+ * @param job_id    - id of job
+ * @param cput_used - cpu time used in seconds (O)
+ * @return PBSE_NONE on success, PBSE_CAN_NOT_OPEN_FILE if the job has no
+ * cpu accounting cgroup, PBSE_SYSTEM if it could not be read
+ */
+
+int trq_cg_get_job_cput_stats(
+
+  const char    *job_id,
+  unsigned long &cput_used)
+
+  {
+  unsigned long long nanos;
+  int                rc;
+
+  rc = trq_cg_read_cput_from_dir(cg_cpuacct_path + job_id, nanos);
+
+  cput_used = nanos / NANO_SECONDS;
+
+  return(rc);
+  } // END trq_cg_get_job_cput_stats()
+
+
+
+/*
+ * trq_cg_get_job_memory_stats
+ *
+ * Get the peak resident memory used by the whole job from its cgroup,
+ * without looking at any of the job's processes.
+ *
+ * @param job_id   - id of job
+ * @param mem_used - memory used in bytes (O)
+ * @return PBSE_NONE on success, PBSE_CAN_NOT_OPEN_FILE if the job has no
+ * memory cgroup, PBSE_SYSTEM if it could not be read
+ */
+
+int trq_cg_get_job_memory_stats(
+
+  const char         *job_id,
+  unsigned long long &mem_used)
+
+  {
+  return(trq_cg_read_peak_memory_from_dir(cg_memory_path + job_id, mem_used));
+  } // END trq_cg_get_job_memory_stats()
+
+
+
+/*
+ * trq_cg_read_cgroup_procs()
+ *
+ * Appends the pids listed in dir/cgroup.procs to pids.
+ */
+
+void trq_cg_read_cgroup_procs(
+
+  const string       &dir,
+  std::vector<pid_t> &pids)
+
+  {
+  std::ifstream iFile((dir + "/cgroup.procs").c_str(), std::ifstream::in);
+  pid_t         pid;
+
+  while (iFile >> pid)
+    pids.push_back(pid);
+  } // END trq_cg_read_cgroup_procs()
+
+
+
+/*
+ * trq_cg_get_job_pids()
+ *
+ * Collects the pids of every process in the job's cgroup, including the
+ * R<req>.t<task> cgroups below it. Unlike the job's session ids, this also
+ * finds job processes that started a session of their own.
+ *
+ * @param job_id - id of job
+ * @param pids - the pids found (O)
+ * @return PBSE_NONE, or PBSE_CAN_NOT_OPEN_FILE if the job has no cgroup
+ */
+
+int trq_cg_get_job_pids(
+
+  const char         *job_id,
+  std::vector<pid_t> &pids)
+
+  {
+  DIR           *job_dir;
+  struct dirent *task_dent;
+  string         job_path = cg_cpuacct_path + job_id;
+
+  if ((job_dir = opendir(job_path.c_str())) == NULL)
+    return(PBSE_CAN_NOT_OPEN_FILE);
+
+  trq_cg_read_cgroup_procs(job_path, pids);
+
+  while ((task_dent = readdir(job_dir)) != NULL)
+    {
+    if ((task_dent->d_name[0] == 'R') &&
+        (task_dent->d_type == DT_DIR))
+      trq_cg_read_cgroup_procs(job_path + "/" + task_dent->d_name, pids);
+    }
+
+  closedir(job_dir);
+
+  return(PBSE_NONE);
+  } // END trq_cg_get_job_pids()
+
+
+
 /* 
  * trq_cg_get_task_memory_stats
  *
@@ -847,15 +1035,12 @@ int trq_cg_get_task_memory_stats(
 
   {
   char               req_and_task[256];
-  int                rc = PBSE_NONE;
+  int                rc;
 
   /* get memory first */
-  sprintf(req_and_task, "/%s/R%u.t%u/memory.max_usage_in_bytes", job_id, req_index, task_index);
+  sprintf(req_and_task, "%s/R%u.t%u", job_id, req_index, task_index);
 
-  string  cgroup_path = cg_memory_path + req_and_task;
-  bool    error;
-
-  mem_used = trq_cg_read_numeric_value(cgroup_path, error);
+  rc = trq_cg_read_peak_memory_from_dir(cg_memory_path + req_and_task, mem_used);
   
 /*  if (mem_used == 0)
     {
@@ -864,7 +1049,8 @@ int trq_cg_get_task_memory_stats(
     log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, __func__, log_buffer);
     }*/
 
-  if (error)
+  /* the task cgroup was created with the job, so it must be there */
+  if (rc == PBSE_CAN_NOT_OPEN_FILE)
     rc = PBSE_SYSTEM;
 
   return(rc);
@@ -895,16 +1081,16 @@ int trq_cg_get_task_cput_stats(
   unsigned long      &cput_used)
 
   {
-  char   req_and_task[256];
-  int    rc = PBSE_NONE;
-  bool   error = PBSE_NONE;
+  char               req_and_task[256];
+  int                rc;
+  unsigned long long nanos;
 
   /* get cpu time used */
-  sprintf(req_and_task, "/%s/R%u.t%u/cpuacct.usage", job_id, req_index, task_index);
+  sprintf(req_and_task, "%s/R%u.t%u", job_id, req_index, task_index);
 
-  string cgroup_path = cg_cpuacct_path + req_and_task;
+  rc = trq_cg_read_cput_from_dir(cg_cpuacct_path + req_and_task, nanos);
 
-  cput_used = trq_cg_read_numeric_value(cgroup_path, error);
+  cput_used = nanos;
 
 /*  if (cput_used == 0)
     {
@@ -913,9 +1099,10 @@ int trq_cg_get_task_cput_stats(
     log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, __func__, log_buffer);
     }*/
 
-  if (error)
+  /* the task cgroup was created with the job, so it must be there */
+  if (rc == PBSE_CAN_NOT_OPEN_FILE)
     rc = PBSE_SYSTEM;
-  
+
   return(rc);
   } // END trq_cg_get_task_cput_stats()
 
@@ -214,7 +214,7 @@ int is_ok_to_run_job(int pbs_sd, server_info *sinfo, queue_info *qinfo,
 int check_server_max_user_run(server_info *sinfo, char *account)
   {
   if (sinfo -> max_user_run == INFINITY_VAL ||
-      count_by_user(sinfo -> running_jobs, account) < sinfo -> max_user_run)
+      running_job_count(sinfo -> user_running, account) < sinfo -> max_user_run)
     return 0;
 
   return SERVER_USER_LIMIT_REACHED;
@@ -236,7 +236,7 @@ int check_server_max_user_run(server_info *sinfo, char *account)
 int check_queue_max_user_run(queue_info *qinfo, char *account)
   {
   if (qinfo -> max_user_run == INFINITY_VAL ||
-      count_by_user(qinfo -> running_jobs, account) < qinfo -> max_user_run)
+      running_job_count(qinfo -> user_running, account) < qinfo -> max_user_run)
     return 0;
 
   return QUEUE_USER_LIMIT_REACHED;
@@ -258,7 +258,7 @@ int check_queue_max_user_run(queue_info *qinfo, char *account)
 int check_queue_max_group_run(queue_info *qinfo, char *group)
   {
   if (qinfo -> max_group_run == INFINITY_VAL ||
-      count_by_group(qinfo -> running_jobs, group) < qinfo -> max_group_run)
+      running_job_count(qinfo -> group_running, group) < qinfo -> max_group_run)
     return 0;
 
   return QUEUE_GROUP_LIMIT_REACHED;
@@ -280,7 +280,7 @@ int check_queue_max_group_run(queue_info *qinfo, char *group)
 int check_server_max_group_run(server_info *sinfo, char *group)
   {
   if (sinfo -> max_group_run == INFINITY_VAL ||
-      count_by_group(sinfo -> running_jobs, group) < sinfo -> max_group_run)
+      running_job_count(sinfo -> group_running, group) < sinfo -> max_group_run)
     return 0;
 
   return SERVER_GROUP_LIMIT_REACHED;
@@ -422,6 +422,105 @@ int count_by_group(job_info **jobs, char *group)
   return count;
   }
 
+/*
+ *
+ * count_running_jobs - build the per user and per group counts of a running
+ *        job array so the run limits can be checked without
+ *        scanning the array for every job
+ *
+ *   jobs - array of running jobs
+ *   users - set to the running job count of each user
+ *   groups - set to the running job count of each group
+ *
+ * returns nothing
+ *
+ */
+void count_running_jobs(job_info **jobs, run_counts **users, run_counts **groups)
+  {
+  int i;
+
+  *users = new run_counts();
+  *groups = new run_counts();
+
+  if (jobs != NULL)
+    {
+    for (i = 0; jobs[i] != NULL; i++)
+      {
+      if (jobs[i] -> account != NULL)
+        (**users)[jobs[i] -> account]++;
+
+      if (jobs[i] -> group != NULL)
+        (**groups)[jobs[i] -> group]++;
+      }
+    }
+  }
+
+/*
+ *
+ * running_job_count - look up how many jobs a user or group has running
+ *
+ *   counts - the counts built by count_running_jobs()
+ *   name - the user or group name
+ *
+ * returns the count
+ *
+ */
+int running_job_count(run_counts *counts, const char *name)
+  {
+  run_counts::iterator it;
+
+  if ((counts == NULL) || (name == NULL))
+    return 0;
+
+  if ((it = counts -> find(name)) == counts -> end())
+    return 0;
+
+  return it -> second;
+  }
+
+/*
+ *
+ * add_running_job - add a job that was just run to a running job array
+ *     and to the counts kept with it
+ *
+ *   jobs - the running job array
+ *   users - the running job count of each user
+ *   groups - the running job count of each group
+ *   jinfo - the job that was run
+ *
+ * returns the running job array, which may have moved, or NULL on error
+ *
+ */
+job_info **add_running_job(job_info **jobs, run_counts *users, run_counts *groups, job_info *jinfo)
+  {
+  job_info **tmp;
+  int count = 0;
+
+  if (jobs != NULL)
+    {
+    while (jobs[count] != NULL)
+      count++;
+    }
+
+  if ((tmp = (job_info **)realloc(jobs, (count + 2) * sizeof(job_info *))) == NULL)
+    {
+    free(jobs);
+    perror("Memory Allocation Error");
+    return NULL;
+    }
+
+  tmp[count] = jinfo;
+  tmp[count + 1] = NULL;
+
+  if ((users != NULL) && (jinfo -> account != NULL))
+    (*users)[jinfo -> account]++;
+
+  if ((groups != NULL) && (jinfo -> group != NULL))
+    (*groups)[jinfo -> group]++;
+
+  return tmp;
+  }
+
 /*
  *
  * check_ded_time_boundry  - check to see if a job would cross into
@@ -135,6 +135,23 @@ int check_queue_max_user_run(queue_info *qinfo, char *account);
  */
 int count_by_group(job_info **jobs, char *group);
 
+/*
+ *      count_running_jobs - build the per user and per group counts of
+ *                           a running job array
+ */
+void count_running_jobs(job_info **jobs, run_counts **users, run_counts **groups);
+
+/*
+ *      running_job_count - look up how many jobs a user or group has running
+ */
+int running_job_count(run_counts *counts, const char *name);
+
+/*
+ *      add_running_job - add a job that was just run to a running job array
+ *                        and its counts
+ */
+job_info **add_running_job(job_info **jobs, run_counts *users, run_counts *groups, job_info *jinfo);
+
 
 /*
  *      check_server_max_user_run - check if the user is within server
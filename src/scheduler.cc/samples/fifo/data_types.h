@@ -81,6 +81,8 @@
 #define DATA_TYPES_H
 
 #include <time.h>
+#include <string>
+#include <boost/unordered_map.hpp>
 #include "pbs_ifl.h"
 #include "constant.h"
 #include "config.h"
@@ -131,6 +133,9 @@ typedef struct prev_job_info prev_job_info;
 
 typedef struct token token;
 
+/* number of running jobs keyed by user or group name */
+typedef boost::unordered_map<std::string, int> run_counts;
+
 typedef RESOURCE_TYPE sch_resource_t;
 /* since resource values and usage values are linked */
 typedef sch_resource_t usage_t;
@@ -170,6 +175,8 @@ struct server_info
   queue_info **queues;  /* array of queues */
   job_info **jobs;  /* array of jobs on the server */
   job_info **running_jobs; /* array of jobs in the running state */
+  run_counts *user_running; /* running jobs per user */
+  run_counts *group_running; /* running jobs per group */
   node_info **nodes;  /* array of nodes associated with the server */
   node_info **timesharing_nodes;/* array of timesharing nodes */
   token **tokens;               /* array of tokens */
@@ -204,6 +211,8 @@ unsigned dedtime_queue:
   struct resource *qres; /* list of resources on the queue */
   job_info **jobs;  /* array of jobs that reside in queue */
   job_info **running_jobs; /* array of jobs in the running state */
+  run_counts *user_running; /* running jobs per user */
+  run_counts *group_running; /* running jobs per group */
   };
 
 struct job_info
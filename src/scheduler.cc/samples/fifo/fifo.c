@@ -718,16 +718,6 @@ int run_update_job(int pbs_sd, server_info *sinfo, queue_info *qinfo,
 
     if (cstat.fair_share)
       update_usage_on_run(jinfo);
-
-    free(sinfo -> running_jobs);
-
-    sinfo -> running_jobs = job_filter(sinfo -> jobs, sinfo -> sc.total,
-                                       check_run_job, NULL);
-
-    free(qinfo -> running_jobs);
-
-    qinfo -> running_jobs = job_filter(qinfo -> jobs, qinfo -> sc.total,
-                                       check_run_job, NULL);
     }
   else
     {
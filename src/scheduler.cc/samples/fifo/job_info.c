@@ -81,6 +81,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <algorithm>
 #include "pbs_ifl.h"
 #include "queue_info.h"
 #include "job_info.h"
@@ -93,35 +97,268 @@
 #include "lib_ifl.h"
 
 
+/* a job as the server last reported it */
+
+struct cached_job
+  {
+  struct batch_status *status;
+  const char          *queue;  /* points into status */
+  long                 qrank;  /* the job's queue_rank, 0 if not reported */
+  };
+
+/* orders job ids the way the server numbers them: 9.host before 10.host and
+ * 10[2].host before 10[10].host
+ */
+
+struct job_id_less
+  {
+  bool operator()(const std::string &a, const std::string &b) const
+    {
+    char *a_end;
+    char *b_end;
+    long  a_num = strtol(a.c_str(), &a_end, 10);
+    long  b_num = strtol(b.c_str(), &b_end, 10);
+
+    if (a_num != b_num)
+      return(a_num < b_num);
+
+    if ((*a_end == '[') &&
+        (*b_end == '['))
+      {
+      a_num = strtol(a_end + 1, &a_end, 10);
+      b_num = strtol(b_end + 1, &b_end, 10);
+
+      if (a_num != b_num)
+        return(a_num < b_num);
+      }
+
+    return(strcmp(a_end, b_end) < 0);
+    }
+  };
+
+/* orders a queue's jobs the way the server keeps them: by queue_rank, and by
+ * job id for jobs with the same rank (or when the ranks aren't readable)
+ */
+
+struct cached_job_rank_less
+  {
+  bool operator()(const std::pair<const std::string, cached_job> *a,
+                  const std::pair<const std::string, cached_job> *b) const
+    {
+    if (a -> second.qrank != b -> second.qrank)
+      return(a -> second.qrank < b -> second.qrank);
+
+    return(job_id_less()(a -> first, b -> first));
+    }
+  };
+
+typedef std::map<std::string, cached_job, job_id_less> job_cache_map;
+typedef std::map<std::string, std::vector<job_cache_map::value_type *> > queue_jobs_map;
+
+/* the jobs are kept between cycles so that the server only has to send the
+ * ones which changed, see update_job_cache()
+ */
+static job_cache_map  job_cache;
+static std::string    job_cache_generation;
+
+/* each queue's jobs in the server's order, rebuilt by update_job_cache() */
+static queue_jobs_map job_cache_queues;
+
+
 /*
  *
- * query_jobs - create an array of jobs in a specified queue
+ * free_cached_status - free one entry taken off a batch_status list
  *
- *   pbs_sd - connection to pbs_server
- *   qinfo  - queue to get jobs from
+ */
+static void free_cached_status(struct batch_status *bs)
+  {
+  bs -> next = NULL;
+  pbs_statfree(bs);
+  }
+
+
+static void clear_job_cache()
+  {
+  job_cache_map::iterator it;
+
+  for (it = job_cache.begin(); it != job_cache.end(); it++)
+    free_cached_status(it -> second.status);
+
+  job_cache.clear();
+  job_cache_queues.clear();
+  job_cache_generation.clear();
+  }
+
+
+static const char *find_status_value(struct batch_status *bs, const char *name)
+  {
+  struct attrl *attrp;
+
+  for (attrp = bs -> attribs; attrp != NULL; attrp = attrp -> next)
+    {
+    if (!strcmp(attrp -> name, name))
+      return attrp -> value;
+    }
+
+  return NULL;
+  }
+
+
+/*
  *
- * returns pointer to the head of a list of jobs
+ * index_job_cache - group the cached jobs by queue in one pass and put each
+ *      queue's jobs in queue_rank order, so query_jobs() sees them
+ *      in the order the server keeps them (qorder and qmove
+ *      change the ranks)
  *
  */
-job_info **query_jobs(int pbs_sd, queue_info *qinfo)
+static void index_job_cache()
   {
-  /* pbs_selstat() takes a linked list of attropl structs which tell it
-   * what information about what jobs to return.  We want all jobs which are
-   * in a specified queue
-   */
+  job_cache_map::iterator  it;
+  queue_jobs_map::iterator q_it;
+
+  job_cache_queues.clear();
 
-  struct attropl opl =
+  for (it = job_cache.begin(); it != job_cache.end(); it++)
     {
-    NULL, (char *)ATTR_q, NULL, NULL, EQ
-    };
+    if (it -> second.queue != NULL)
+      job_cache_queues[it -> second.queue].push_back(&(*it));
+    }
 
-  /* linked list of jobs returned from pbs_selstat() */
+  for (q_it = job_cache_queues.begin(); q_it != job_cache_queues.end(); q_it++)
+    std::stable_sort(q_it -> second.begin(), q_it -> second.end(), cached_job_rank_less());
+  }
 
-  struct batch_status *jobs;
 
-  /* current job in jobs linked list */
+/*
+ *
+ * update_job_cache - bring the scheduler's copy of the server's jobs up to
+ *      date.  Only the jobs changed since the last cycle are asked
+ *      for, along with the ids of the jobs that left the server.
+ *      A server that can't answer that way sends every job, which
+ *      replaces the whole copy.
+ *
+ *   pbs_sd - connection to pbs_server
+ *
+ * returns 0 on success, -1 if the jobs couldn't be queried
+ *
+ */
+int update_job_cache(int pbs_sd)
+  {
 
+  struct batch_status *jobs;
   struct batch_status *cur_job;
+  struct batch_status *next_job;
+  struct batch_status *marker = NULL;
+  char                 extend[128];
+  const char          *value;
+  int                  local_errno = 0;
+
+  /* a made up start time makes the server send everything */
+  snprintf(extend, sizeof(extend), "%s%s", SINCEGENERATION,
+    (job_cache_generation.size() > 0) ? job_cache_generation.c_str() : "0.0");
+
+  if ((jobs = pbs_statjob_err(pbs_sd, (char *)"", NULL, extend, &local_errno)) == NULL)
+    {
+    clear_job_cache();
+
+    if (local_errno > 0)
+      {
+      fprintf(stderr, "pbs_statjob failed: %d\n", local_errno);
+      return -1;
+      }
+
+    return 0;
+    }
+
+  for (cur_job = jobs; cur_job != NULL; cur_job = cur_job -> next)
+    {
+    if (!strcmp(cur_job -> name, GENERATION_STATUS_NAME))
+      marker = cur_job;
+    }
+
+  if ((marker == NULL) ||
+      (find_status_value(marker, GENERATION_RESYNC) != NULL))
+    {
+    /* every job was sent */
+    clear_job_cache();
+    }
+  else if ((value = find_status_value(marker, GENERATION_REMOVED)) != NULL)
+    {
+    std::string removed(value);
+    size_t      start = 0;
+    size_t      end;
+
+    while (start < removed.size())
+      {
+      if ((end = removed.find(',', start)) == std::string::npos)
+        end = removed.size();
+
+      job_cache_map::iterator it = job_cache.find(removed.substr(start, end - start));
+
+      if (it != job_cache.end())
+        {
+        free_cached_status(it -> second.status);
+        job_cache.erase(it);
+        }
+
+      start = end + 1;
+      }
+    }
+
+  for (cur_job = jobs; cur_job != NULL; cur_job = next_job)
+    {
+    next_job = cur_job -> next;
+
+    if (cur_job == marker)
+      continue;
+
+    cached_job &entry = job_cache[cur_job -> name];
+
+    if (entry.status != NULL)
+      free_cached_status(entry.status);
+
+    cur_job -> next = NULL;
+    entry.status = cur_job;
+    entry.queue = find_status_value(cur_job, ATTR_queue);
+
+    /* the rank is only readable by managers; without it the jobs keep job id order */
+    value = find_status_value(cur_job, ATTR_qrank);
+    entry.qrank = (value != NULL) ? strtol(value, NULL, 10) : 0;
+    }
+
+  if (marker != NULL)
+    {
+    value = find_status_value(marker, GENERATION_ATTR);
+    job_cache_generation = (value != NULL) ? value : "";
+    free_cached_status(marker);
+    }
+  else
+    job_cache_generation.clear();
+
+  index_job_cache();
+
+  return 0;
+  }
+
+
+/*
+ *
+ * query_jobs - create an array of jobs in a specified queue
+ *
+ *   pbs_sd - connection to pbs_server
+ *   qinfo  - queue to get jobs from
+ *
+ * returns pointer to the head of a list of jobs
+ *
+ * NOTE: the jobs come from the copy made by update_job_cache(), in the
+ *       server's queue_rank order
+ *
+ */
+job_info **query_jobs(int pbs_sd, queue_info *qinfo)
+  {
+  /* the queue's jobs in the cache */
+  queue_jobs_map::iterator q_it;
 
   /* array of internal scheduler structures for jobs */
   job_info **jinfo_arr;
@@ -132,41 +369,29 @@ job_info **query_jobs(int pbs_sd, queue_info *qinfo)
   /* number of jobs in jinfo_arr */
   int num_jobs = 0;
   int i;
-  int local_errno = 0;
-
-  opl.value = qinfo -> name;
-
-  if ((jobs = pbs_selstat_err(pbs_sd, &opl, NULL, &local_errno)) == NULL)
-    {
-    if (local_errno > 0)
-      fprintf(stderr, "pbs_selstat failed: %d\n", local_errno);
 
+  if ((q_it = job_cache_queues.find(qinfo -> name)) == job_cache_queues.end())
     return NULL;
-    }
 
-  cur_job = jobs;
+  std::vector<job_cache_map::value_type *> &qjobs = q_it -> second;
 
-  while (cur_job != NULL)
-    {
-    num_jobs++;
-    cur_job = cur_job -> next;
-    }
+  num_jobs = qjobs.size();
+
+  if (num_jobs == 0)
+    return NULL;
 
   /* allocate enough space for all the jobs and the NULL sentinal */
   if ((jinfo_arr = (job_info **) malloc(sizeof(jinfo) * (num_jobs + 1))) == NULL)
     {
     perror("Memory allocation error");
-    pbs_statfree(jobs);
     return NULL;
     }
 
-  cur_job = jobs;
-
-  for (i = 0; cur_job != NULL; i++)
+  for (i = 0; i < num_jobs; i++)
     {
-    if ((jinfo = query_job_info(cur_job, qinfo)) == NULL)
+    if ((jinfo = query_job_info(qjobs[i] -> second.status, qinfo)) == NULL)
       {
-      pbs_statfree(jobs);
+      jinfo_arr[i] = NULL;
       free_jobs(jinfo_arr);
       return NULL;
       }
@@ -182,14 +407,10 @@ job_info **query_jobs(int pbs_sd, queue_info *qinfo)
       jinfo -> can_not_run = 1;
 
     jinfo_arr[i] = jinfo;
-
-    cur_job = cur_job -> next;
     }
 
   jinfo_arr[i] = NULL;
 
-  pbs_statfree(jobs);
-
   return jinfo_arr;
   }
 
@@ -83,6 +83,12 @@
 #include "pbs_ifl.h"
 #include "data_types.h"
 
+/*
+ *      update_job_cache - bring the scheduler's copy of the server's jobs
+ *                         up to date
+ */
+int update_job_cache(int pbs_sd);
+
 /*
  *      query_jobs - create an array of jobs in a specified queue
  */
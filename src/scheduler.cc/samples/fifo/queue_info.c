@@ -194,6 +194,8 @@ queue_info **query_queues(int pbs_sd, server_info *sinfo)
 
     qinfo -> running_jobs = job_filter(qinfo -> jobs, qinfo -> sc.total, check_run_job, NULL);
 
+    count_running_jobs(qinfo -> running_jobs, &(qinfo -> user_running), &(qinfo -> group_running));
+
     res = qinfo -> qres;
 
     while (res != NULL)
@@ -386,6 +388,10 @@ queue_info *new_queue_info()
 
   qinfo -> running_jobs  = NULL;
 
+  qinfo -> user_running  = NULL;
+
+  qinfo -> group_running = NULL;
+
   qinfo -> server  = NULL;
 
   return qinfo;
@@ -487,6 +493,9 @@ void update_queue_on_run(queue_info *qinfo, job_info *jinfo)
   qinfo -> sc.running++;
   qinfo -> sc.queued--;
 
+  qinfo -> running_jobs = add_running_job(qinfo -> running_jobs, qinfo -> user_running,
+                                          qinfo -> group_running, jinfo);
+
   resreq = jinfo -> resreq;
 
   while (resreq != NULL)
@@ -521,6 +530,10 @@ void free_queue_info(queue_info *qinfo)
   if (qinfo -> running_jobs != NULL)
     free(qinfo -> running_jobs);
 
+  delete qinfo -> user_running;
+
+  delete qinfo -> group_running;
+
   free(qinfo);
   }
 
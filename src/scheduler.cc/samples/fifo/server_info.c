@@ -89,6 +89,7 @@
 #include "misc.h"
 #include "config.h"
 #include "node_info.h"
+#include "check.h"
 #include "lib_ifl.h"
 
 
@@ -129,6 +130,14 @@ server_info *query_server(int pbs_sd)
   /* get the nodes, if any */
   sinfo -> nodes = query_nodes(pbs_sd, sinfo);
 
+  /* catch up on the jobs that changed since the last cycle */
+  if (update_job_cache(pbs_sd) != 0)
+    {
+    pbs_statfree(server);
+    free_server(sinfo, 0);
+    return NULL;
+    }
+
   /* get the queues */
   if ((sinfo -> queues = query_queues(pbs_sd, sinfo)) == NULL)
     {
@@ -161,6 +170,8 @@ server_info *query_server(int pbs_sd)
   sinfo -> running_jobs =
     job_filter(sinfo -> jobs, sinfo -> sc.total, check_run_job, NULL);
 
+  count_running_jobs(sinfo -> running_jobs, &(sinfo -> user_running), &(sinfo -> group_running));
+
   res = sinfo -> res;
 
   while (res != NULL)
@@ -369,6 +380,10 @@ void free_server_info(server_info *sinfo)
   if (sinfo -> running_jobs != NULL)
     free(sinfo -> running_jobs);
 
+  delete sinfo -> user_running;
+
+  delete sinfo -> group_running;
+
   if (sinfo -> timesharing_nodes != NULL)
     free(sinfo -> timesharing_nodes);
 
@@ -443,6 +458,10 @@ server_info *new_server_info()
 
   sinfo -> running_jobs = NULL;
 
+  sinfo -> user_running = NULL;
+
+  sinfo -> group_running = NULL;
+
   sinfo -> nodes = NULL;
 
   sinfo -> timesharing_nodes = NULL;
@@ -576,6 +595,9 @@ void update_server_on_run(server_info *sinfo, queue_info *qinfo, job_info *jinfo
   sinfo -> sc.running++;
   sinfo -> sc.queued--;
 
+  sinfo -> running_jobs = add_running_job(sinfo -> running_jobs, sinfo -> user_running,
+                                          sinfo -> group_running, jinfo);
+
   resreq = jinfo -> resreq;
 
   while (resreq != NULL)
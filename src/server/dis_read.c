@@ -131,6 +131,10 @@ int dis_request_read(
   int   rc;  /* return code */
   char  log_buf[LOCAL_LOG_BUF_SIZE];
 
+  /* the header says whether the rest of the request is binary */
+  chan->dis_version = DIS_VERSION_TEXT;
+  DIS_tcp_set_reply_version(chan->sock, DIS_VERSION_TEXT);
+
 #ifdef PBS_MOM
   /* NYI: talk to Ken about this. This is necessary due to the changes to 
    * decode_DIS_ReqHdr */
@@ -156,7 +160,8 @@ int dis_request_read(
     return(PBSE_DISPROTO);
     }
 
-  if (proto_ver != PBS_BATCH_PROT_VER)
+  if ((proto_ver != PBS_BATCH_PROT_VER) &&
+      (proto_ver != PBS_BATCH_PROT_VER_BINARY))
     {
     sprintf(log_buf, "conflicting version numbers, %d detected, %d expected",
             proto_ver,
@@ -96,6 +96,9 @@
 
 const int SHORT_TIMEOUT = 5;
 
+/* process_pbs_server_port() handed the connection to process_is_request() */
+const int IS_REQUEST_QUEUED = -2;
+
 char *netaddr(struct sockaddr_in *ap);
 void netcounter_incr();
 
@@ -136,6 +139,33 @@ int get_protocol_type(
 
 
 
+/*
+ * process_is_request()
+ *
+ * Handles a MOM's IS_PROTOCOL request on the TP_LANE_MOM_STATUS lane.
+ * svr_is_request() closes the connection, and the connection's accept
+ * arguments are freed here rather than by start_process_pbs_server_port().
+ *
+ * @param vp - an is_request_info allocated by process_pbs_server_port()
+ */
+
+void *process_is_request(
+
+  void *vp)
+
+  {
+  is_request_info *isr = (is_request_info *)vp;
+
+  svr_is_request(isr);
+
+  free(isr->args);
+  free(isr);
+
+  return(NULL);
+  } /* END process_is_request() */
+
+
+
 int process_pbs_server_port(
      
   int   sock,
@@ -169,18 +199,36 @@ int process_pbs_server_port(
       // always close the socket for is requests 
       rc = PBSE_SOCKET_CLOSE;
 
-      is_request_info isr;
+      is_request_info *isr;
 
-      isr.chan = chan;
-      isr.args = args;
-  
-      if (threadpool_is_too_busy(request_pool, ATR_DFLAG_MGRD) == false)
-        svr_is_request(&isr);
-      else
+      if (threadpool_is_too_busy(request_pool, ATR_DFLAG_MGRD) == true)
         {
         write_tcp_reply(chan, IS_PROTOCOL, IS_PROTOCOL_VER, IS_STATUS, PBSE_SERVER_BUSY);
         DIS_tcp_cleanup(chan);
         }
+      else if ((isr = (is_request_info *)calloc(1, sizeof(is_request_info))) == NULL)
+        {
+        is_request_info local_isr;
+
+        local_isr.chan = chan;
+        local_isr.args = args;
+        svr_is_request(&local_isr);
+        }
+      else
+        {
+        /* move the status off the client lane so client bursts can't hold
+         * up node updates. process_is_request() owns the socket from here */
+        isr->chan = chan;
+        isr->args = args;
+
+        if (enqueue_threadpool_request_lane(process_is_request, isr, request_pool, TP_LANE_MOM_STATUS) == PBSE_NONE)
+          rc = IS_REQUEST_QUEUED;
+        else
+          {
+          svr_is_request(isr);
+          free(isr);
+          }
+        }
 
       // don't let this get cleaned up below
       chan = NULL;
@@ -268,6 +316,10 @@ void *start_process_pbs_server_port(
     netcounter_incr();
 
     rc = process_pbs_server_port(sock, FALSE, args);
+
+    /* process_is_request() owns the socket and args now */
+    if (rc == IS_REQUEST_QUEUED)
+      return(NULL);
     }
 
   free(new_sock);
@@ -92,6 +92,8 @@
 #include <errno.h>
 #include <string.h>
 #include <sys/types.h>
+#include <pthread.h>
+#include <vector>
 #include "dis.h"
 #include "libpbs.h"
 #include "server_limits.h"
@@ -427,6 +429,95 @@ int que_to_local_svr(struct batch_request *preq)                     /* I */
 
 
 
+/* requests waiting for handle_local_requests(), and its lock */
+static std::vector<batch_request *> local_requests;
+static pthread_mutex_t              local_requests_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/*
+ * handle_local_requests()
+ *
+ * Work task which handles every request queued by que_to_local_svr_batch(),
+ * in the order they were queued. Requests queued while it runs are picked up
+ * by the task that queueing them started.
+ */
+
+void handle_local_requests(
+
+  struct work_task *pwt)
+
+  {
+  std::vector<batch_request *> requests;
+
+  pthread_mutex_lock(&local_requests_mutex);
+  requests.swap(local_requests);
+  pthread_mutex_unlock(&local_requests_mutex);
+
+  for (unsigned int i = 0; i < requests.size(); i++)
+    {
+    /* the reply frees the request */
+    handle_local_request(PBS_LOCAL_CONNECTION, requests[i]);
+    }
+
+  free(pwt->wt_mutex);
+  free(pwt);
+  }  /* END handle_local_requests() */
+
+
+
+/*
+ * que_to_local_svr_batch()
+ *
+ * Queues requests for this server to be handled in order on another thread.
+ * Unlike que_to_local_svr(), the server's address isn't looked up and no
+ * connection is made for each request: all of them are dispatched directly by
+ * a single work task, which is only started when none is pending.
+ *
+ * @param requests - the requests to queue. On success they are owned by the
+ * task and requests is emptied.
+ * @return PBSE_NONE, or PBSE_SYSTEM if the task couldn't be started, in which
+ * case the caller still owns the requests
+ */
+
+int que_to_local_svr_batch(
+
+  std::vector<batch_request *> &requests)
+
+  {
+  bool start_task;
+
+  if (requests.size() == 0)
+    return(PBSE_NONE);
+
+  for (unsigned int i = 0; i < requests.size(); i++)
+    {
+    requests[i]->rq_fromsvr = 1;
+    requests[i]->rq_perm = ATR_DFLAG_MGRD | ATR_DFLAG_MGWR | ATR_DFLAG_SvWR;
+    }
+
+  pthread_mutex_lock(&local_requests_mutex);
+
+  start_task = local_requests.empty();
+
+  if ((start_task == true) &&
+      (set_task(WORK_Immed, 0, handle_local_requests, NULL, FALSE) == NULL))
+    {
+    pthread_mutex_unlock(&local_requests_mutex);
+    return(PBSE_SYSTEM);
+    }
+
+  /* the task can't take the queue until the lock is released */
+  local_requests.insert(local_requests.end(), requests.begin(), requests.end());
+  requests.clear();
+
+  pthread_mutex_unlock(&local_requests_mutex);
+
+  return(PBSE_NONE);
+  }  /* END que_to_local_svr_batch() */
+
+
+
 
 
 /*
@@ -2,6 +2,8 @@
 #define _ISSUE_REQUEST_H
 #include "license_pbs.h" /* See here for the software license */
 
+#include <vector>
+
 #include "pbs_job.h" /* job */
 #include "work_task.h" /* work_task */
 #include "batch_request.h" /* batch_request */
@@ -12,6 +14,10 @@ void reissue_to_svr(struct work_task *);
 
 int handle_local_request(int conn, batch_request *request);
 
+void handle_local_requests(struct work_task *pwt);
+
+int que_to_local_svr_batch(std::vector<batch_request *> &requests);
+
 void release_req(struct work_task *pwt);
 
 #endif /* _ISSUE_REQUEST_H */
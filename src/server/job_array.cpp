@@ -23,6 +23,155 @@ const int DEFAULT_IDLE_SLOT_LIMIT = 300;
 
 
 
+/*
+ * parse()
+ *
+ * Reads a range string in the form of %d[[-%d][,%d[-%d]]...] without expanding it.
+ *
+ * @param range_str - the string specifying the ranges
+ * @param above - only the indices greater than this are kept
+ * @return PBSE_NONE, or -1 if range_str isn't a valid range string
+ */
+
+int array_index_ranges::parse(
+
+  const char *range_str,
+  int         above)
+
+  {
+  const char *ptr = range_str;
+
+  this->clear();
+
+  while (is_whitespace(*ptr))
+    ptr++;
+
+  while (*ptr != '\0')
+    {
+    char *end;
+    int   first = strtol(ptr, &end, 10);
+    int   last = first;
+
+    if (end == ptr)
+      {
+      // *ptr wasn't numeric
+      this->clear();
+      return(-1);
+      }
+
+    ptr = end;
+
+    if (*ptr == '-')
+      {
+      ptr++;
+      last = strtol(ptr, &end, 10);
+      ptr = end;
+      }
+
+    while ((*ptr == ',') ||
+           (is_whitespace(*ptr)))
+      ptr++;
+
+    if (first <= above)
+      first = above + 1;
+
+    if (first > last)
+      continue;
+
+    this->ranges.push_back(std::pair<int, int>(first, last));
+    this->remaining += last - first + 1;
+    }
+
+  if (this->ranges.size() > 0)
+    this->next = this->ranges[0].first;
+
+  return(PBSE_NONE);
+  } // END parse()
+
+
+
+/*
+ * front()
+ *
+ * @return the next index, or -1 if every index has been consumed
+ */
+
+int array_index_ranges::front() const
+
+  {
+  if (this->remaining == 0)
+    return(-1);
+
+  return(this->next);
+  } // END front()
+
+
+
+void array_index_ranges::pop_front()
+
+  {
+  if (this->remaining == 0)
+    return;
+
+  this->remaining--;
+
+  if (this->next < this->ranges[this->current].second)
+    this->next++;
+  else if (++this->current < this->ranges.size())
+    this->next = this->ranges[this->current].first;
+  else
+    this->next = -1;
+  } // END pop_front()
+
+
+
+/*
+ * highest()
+ *
+ * @return the largest index in any of the ranges, or -1 if there are none
+ */
+
+int array_index_ranges::highest() const
+
+  {
+  int highest = -1;
+
+  for (size_t i = 0; i < this->ranges.size(); i++)
+    {
+    if (this->ranges[i].second > highest)
+      highest = this->ranges[i].second;
+    }
+
+  return(highest);
+  } // END highest()
+
+
+
+/*
+ * size()
+ *
+ * @return the number of indices that haven't been consumed
+ */
+
+size_t array_index_ranges::size() const
+
+  {
+  return(this->remaining);
+  } // END size()
+
+
+
+void array_index_ranges::clear()
+
+  {
+  this->ranges.clear();
+  this->current = 0;
+  this->next = -1;
+  this->remaining = 0;
+  } // END clear()
+
+
+
 // array_info empty constructor
 array_info::array_info() : struct_version(ARRAY_QS_STRUCT_VERSION), array_size(0), num_jobs(0),
                            slot_limit(NO_SLOT_LIMIT), jobs_running(0), jobs_done(0), num_cloned(0),
@@ -238,16 +387,18 @@ int job_array::parse_array_request(
   int  rc = PBSE_NONE;
   long max_array_size;
   char log_buf[LOCAL_LOG_BUF_SIZE];
-  this->uncreated_ids.clear();
 
-  if ((rc = translate_range_string_to_vector(request, this->uncreated_ids)) != PBSE_NONE)
+  if ((rc = this->uncreated_ids.parse(request, -1)) != PBSE_NONE)
     return(rc);
 
+  if (this->uncreated_ids.size() == 0)
+    return(-1);
+
   this->ai_qs.range_str = request;
   this->ai_qs.num_jobs = this->uncreated_ids.size();
 
   // size of array is the biggest index + 1
-  this->ai_qs.array_size = this->uncreated_ids[this->uncreated_ids.size() - 1] + 1;
+  this->ai_qs.array_size = this->uncreated_ids.highest() + 1;
 
   if (get_svr_attr_l(SRV_ATR_MaxArraySize, &max_array_size) == PBSE_NONE)
     {
@@ -284,18 +435,14 @@ bool job_array::need_to_update_slot_limits() const
  *
  * Determines the index of the next subjob that should be created
  *
- * @param internal_index - the index of uncreated_ids that corresponds to the subjob index returned
  * @return the index of the next subjob to be created, or -1 if no job should be created
  * at this time.
  */
 
-int job_array::get_next_index_to_create(
-    
-  int &internal_index)
+int job_array::get_next_index_to_create()
 
   {
   int index = -1;
-  internal_index = -1;
 
   // Don't instantiate new jobs after we've been deleted
   if (this->being_deleted == false)
@@ -303,15 +450,7 @@ int job_array::get_next_index_to_create(
     if ((this->ai_qs.idle_slot_limit == NO_SLOT_LIMIT) ||
         (this->ai_qs.num_idle < this->ai_qs.idle_slot_limit))
       {
-      for (size_t i = 0; i < this->uncreated_ids.size(); i++)
-        {
-        if (this->uncreated_ids[i] != -1)
-          {
-          index = this->uncreated_ids[i];
-          internal_index = i;
-          break;
-          }
-        }
+      index = this->uncreated_ids.front();
       }
     }
 
@@ -329,8 +468,7 @@ int job_array::get_next_index_to_create(
 void job_array::create_job_if_needed()
 
   {
-  int  uncreated_ids_index;
-  int  next_index = this->get_next_index_to_create(uncreated_ids_index);
+  int  next_index = this->get_next_index_to_create();
 
   if (next_index >= 0)
     {
@@ -364,9 +502,11 @@ void job_array::create_job_if_needed()
       int rc = create_and_queue_array_subjob(this, array_mgr, template_job, template_mgr,
                                              next_index, prev_id, false);
 
-      if (rc == PBSE_NONE)
+      // the array was unlocked while queueing, so another thread may have taken this index
+      if ((rc == PBSE_NONE) &&
+          (this->uncreated_ids.front() == next_index))
         {
-        this->uncreated_ids[uncreated_ids_index] = -1;
+        this->uncreated_ids.pop_front();
         this->ai_qs.highest_id_created = next_index;
         }
       }
@@ -544,16 +684,7 @@ void job_array::update_array_values(
 void job_array::initialize_uncreated_ids()
 
   {
-  std::vector<int> temp;
-  translate_range_string_to_vector(this->ai_qs.range_str.c_str(), temp);
-
-  this->uncreated_ids.clear();
-
-  for (size_t i = 0; i < temp.size(); i++)
-    {
-    if (temp[i] > this->ai_qs.highest_id_created)
-      this->uncreated_ids.push_back(temp[i]);
-    }
+  this->uncreated_ids.parse(this->ai_qs.range_str.c_str(), this->ai_qs.highest_id_created);
   }
 
 
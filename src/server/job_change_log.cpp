@@ -0,0 +1,145 @@
+#include "job_change_log.hpp"
+
+
+
+job_change_log::job_change_log(
+
+  size_t max) : start_time(time(NULL)), generation(0), removed_floor(0), removed(),
+                max_removed(max)
+
+  {
+  pthread_mutex_init(&this->mutex, NULL);
+  }
+
+
+
+job_change_log::~job_change_log()
+
+  {
+  pthread_mutex_destroy(&this->mutex);
+  }
+
+
+
+time_t job_change_log::started() const
+
+  {
+  return(this->start_time);
+  } // END started()
+
+
+
+/*
+ * current()
+ *
+ * @return the generation of the most recent change
+ */
+
+unsigned long job_change_log::current()
+
+  {
+  unsigned long gen;
+
+  pthread_mutex_lock(&this->mutex);
+  gen = this->generation;
+  pthread_mutex_unlock(&this->mutex);
+
+  return(gen);
+  } // END current()
+
+
+
+/*
+ * mark_changed()
+ *
+ * Starts a new generation for a job that was just changed.
+ * @return the generation to store in the job's ji_status_generation
+ */
+
+unsigned long job_change_log::mark_changed()
+
+  {
+  unsigned long gen;
+
+  pthread_mutex_lock(&this->mutex);
+  gen = ++this->generation;
+  pthread_mutex_unlock(&this->mutex);
+
+  return(gen);
+  } // END mark_changed()
+
+
+
+/*
+ * mark_removed()
+ *
+ * Records that a job left the server. The oldest removal is forgotten once
+ * max_removed are held, after which older generations can't be answered.
+ */
+
+void job_change_log::mark_removed(
+
+  const char *jobid)
+
+  {
+  pthread_mutex_lock(&this->mutex);
+
+  this->removed.push_back(std::pair<unsigned long, std::string>(++this->generation, jobid));
+
+  while (this->removed.size() > this->max_removed)
+    {
+    this->removed_floor = this->removed.front().first;
+    this->removed.pop_front();
+    }
+
+  pthread_mutex_unlock(&this->mutex);
+  } // END mark_removed()
+
+
+
+/*
+ * removed_since()
+ *
+ * Finds the jobs removed after generation since.
+ *
+ * @param since_start - the start time that came with since
+ * @param since - the last generation the caller has seen
+ * @param jobids - the ids of the removed jobs are appended here
+ * @return false if the caller must start over with a full status, because
+ * since is from a previous run of the server or from before the oldest
+ * remembered removal.
+ */
+
+bool job_change_log::removed_since(
+
+  time_t                    since_start,
+  unsigned long             since,
+  std::vector<std::string> &jobids)
+
+  {
+  bool complete = true;
+
+  pthread_mutex_lock(&this->mutex);
+
+  if ((since_start != this->start_time) ||
+      (since < this->removed_floor) ||
+      (since > this->generation))
+    complete = false;
+  else
+    {
+    std::deque<std::pair<unsigned long, std::string> >::reverse_iterator it;
+
+    // newest first, so the walk stops at the first removal the caller has seen
+    for (it = this->removed.rbegin(); it != this->removed.rend(); it++)
+      {
+      if (it->first <= since)
+        break;
+
+      jobids.push_back(it->second);
+      }
+    }
+
+  pthread_mutex_unlock(&this->mutex);
+
+  return(complete);
+  } // END removed_since()
@@ -337,13 +337,12 @@ job *find_job_by_array(
     return(NULL);
     }
 
+  /* the sharded index lets us find the job without serializing on the
+   * container's mutex. If the caller already holds it, use the container */
   if (locked == false)
-    aj->lock();
-  
-  pj = aj->find(job_id);
-
-  if (locked == false)
-    aj->unlock();
+    pj = aj->lookup(job_id);
+  else
+    pj = aj->find(job_id);
 
   if (pj != NULL)
     {
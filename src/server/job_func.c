@@ -1416,13 +1416,11 @@ void *job_clone_wt(
 
   template_job_mgr.unlock();
 
-  for (size_t i = 0; i < pa->uncreated_ids.size(); i++)
+  while (pa->uncreated_ids.size() > 0)
     {
-    if (pa->uncreated_ids[i] == -1)
-      continue;
+    int index = pa->uncreated_ids.front();
 
-    int index = pa->uncreated_ids[i];
-    pa->uncreated_ids[i] = -1;
+    pa->uncreated_ids.pop_front();
     pa->ai_qs.highest_id_created = index;
 
     /* This job already exists. This can happen when trying to recover a job
@@ -1442,7 +1440,7 @@ void *job_clone_wt(
     if ((pa->ai_qs.idle_slot_limit != NO_SLOT_LIMIT) &&
         (pa->ai_qs.idle_slot_limit <= pa->ai_qs.num_idle))
       break;
-    }  /* END for (i) */
+    }  /* END while (uncreated_ids) */
 
   array_save(pa);
 
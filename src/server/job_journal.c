@@ -0,0 +1,1243 @@
+#include "license_pbs.h" /* See here for the software license */
+/*
+ * job_journal.c - an append-only journal of job image changes.
+ *
+ * Rewriting a job's XML file on every state change is the largest source
+ * of disk writes in the server. When the job_journal server attribute is
+ * set, job_save() appends a binary record to path_jobs/job_journal instead:
+ *
+ *  - quick saves record the jobfix structure plus the attributes that
+ *    have changed (ATR_VFLAG_MODIFY) and the ones svr_setjobstate() updates
+ *    directly
+ *  - full saves record the jobfix structure and every attribute
+ *  - new jobs still get an XML file, followed by a RESET record
+ *
+ * Records are written while the job's mutex is held and are made durable by
+ * a commit thread that fdatasync()s the journal every
+ * JOB_JOURNAL_COMMIT_USECS, so many saves share one sync.
+ *
+ * Once the journal is large or old enough, the commit thread renames it to
+ * job_journal.old and starts a new one. A background task then writes a
+ * fresh XML file for each job that had records in the old journal, appends
+ * a RESET record for it and removes job_journal.old. If the server stops
+ * before that finishes, both files are replayed at startup, so no change
+ * is lost.
+ *
+ * At startup job_journal_load() reads the journal into memory, and
+ * job_recov() applies each job's records after reading its XML file. A torn
+ * or corrupt record ends the replay of that file.
+ *
+ * Records use host byte order and struct layout. The journal is only read
+ * back by the server that wrote it.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "pbs_ifl.h"
+#include "pbs_error.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "pbs_job.h"
+#include "log.h"
+#include "../lib/Liblog/pbs_log.h"
+#include "../lib/Liblog/log_event.h"
+#include "svrfunc.h"
+#include "threadpool.h"
+#include "ji_mutex.h"
+#include "job_recov.h"
+#include "job_journal.h"
+
+extern int LOGLEVEL;
+
+void      decode_attribute(svrattrl *pal, job **pjob, bool freeExisting);
+svrattrl *fill_svrattr_info(const char *aname, const char *avalue, const char *rname, char *log_buf, size_t buf_len);
+void      translate_dependency_to_string(pbs_attribute *pattr, std::string &value);
+
+typedef struct journal_rec_header
+  {
+  uint32_t jr_magic;
+  uint16_t jr_type;
+  uint16_t jr_pad;
+  uint32_t jr_len;      /* length of the payload following the header */
+  uint32_t jr_checksum; /* covers the type, length and payload */
+  } journal_rec_header;
+
+typedef struct journal_record
+  {
+  int         type;
+  std::string payload;
+  } journal_record;
+
+/* entry operations */
+#define JOURNAL_ATTR_SET   'S'
+#define JOURNAL_ATTR_UNSET 'U'
+
+pthread_mutex_t        journal_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t         journal_cond = PTHREAD_COND_INITIALIZER;
+int                    journal_fd = -1;
+off_t                  journal_bytes = 0;
+bool                   journal_dirty = false;
+bool                   journal_checkpointing = false;
+time_t                 journal_oldest = 0;   /* time of the first record since the last rotation */
+std::string            journal_path;
+std::string            journal_old_path;
+std::set<std::string>  journaled_jobs;       /* jobs with records in the current journal */
+std::set<std::string>  checkpoint_jobs;      /* jobs with records in the old journal */
+
+/* records read at startup, by job id. Only those after the last RESET are kept. */
+std::map<std::string, std::vector<journal_record> > journal_pending;
+pthread_mutex_t                                     journal_pending_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * The attributes svr_setjobstate() and job_save() change without setting
+ * ATR_VFLAG_MODIFY. They are part of every delta.
+ */
+
+static const int journal_state_attrs[] =
+  {
+  JOB_ATR_state,
+  JOB_ATR_substate,
+  JOB_ATR_etime,
+  JOB_ATR_mtime
+  };
+
+
+
+static uint32_t journal_checksum(
+
+  uint16_t    type,
+  uint32_t    len,
+  const char *payload)
+
+  {
+  uint32_t             hash = 2166136261U; /* 32-bit FNV-1a */
+  const unsigned char *p;
+
+  p = (const unsigned char *)&type;
+  for (size_t i = 0; i < sizeof(type); i++)
+    hash = (hash ^ p[i]) * 16777619U;
+
+  p = (const unsigned char *)&len;
+  for (size_t i = 0; i < sizeof(len); i++)
+    hash = (hash ^ p[i]) * 16777619U;
+
+  p = (const unsigned char *)payload;
+  for (uint32_t i = 0; i < len; i++)
+    hash = (hash ^ p[i]) * 16777619U;
+
+  return(hash);
+  } /* END journal_checksum() */
+
+
+
+static void append_u32(
+
+  std::string &buf,
+  uint32_t     val)
+
+  {
+  buf.append((const char *)&val, sizeof(val));
+  }
+
+
+
+static void append_entry(
+
+  std::string &buf,
+  char         op,
+  unsigned int flags,
+  const char  *name,
+  const char  *resc,
+  const char  *value)
+
+  {
+  buf += op;
+  append_u32(buf, flags);
+  buf.append(name, strlen(name) + 1);
+  buf.append(resc, strlen(resc) + 1);
+  buf.append(value, strlen(value) + 1);
+  } /* END append_entry() */
+
+
+
+/*
+ * encode_journal_attrs()
+ *
+ * Appends the entries for the job's attributes to payload. Deltas hold the
+ * modified attributes plus journal_state_attrs, with an unset entry for each
+ * one that is no longer set. Images hold every attribute that is set.
+ * ATR_VFLAG_MODIFY is cleared the same way add_encoded_attributes() does.
+ *
+ * @return the number of entries added, or -1 on an encode failure
+ */
+
+static int encode_journal_attrs(
+
+  job         *pjob,
+  int          type,
+  std::string &payload)
+
+  {
+  pbs_attribute *pattr = pjob->ji_wattr;
+  int            count = 0;
+  tlist_head     lhead;
+  svrattrl      *pal;
+  bool           wanted[JOB_ATR_LAST];
+
+  for (int i = 0; i < JOB_ATR_LAST; i++)
+    {
+    if (type == JOURNAL_REC_IMAGE)
+      wanted[i] = (pattr[i].at_flags & ATR_VFLAG_SET) != 0;
+    else
+      wanted[i] = (pattr[i].at_flags & ATR_VFLAG_MODIFY) != 0;
+    }
+
+  if (type == JOURNAL_REC_DELTA)
+    {
+    for (size_t i = 0; i < sizeof(journal_state_attrs) / sizeof(journal_state_attrs[0]); i++)
+      wanted[journal_state_attrs[i]] = true;
+    }
+
+  CLEAR_HEAD(lhead);
+
+  for (int i = 0; i < JOB_ATR_LAST; i++)
+    {
+    if ((wanted[i] == false) ||
+        (job_attr_def[i].at_type == ATR_TYPE_ACL))
+      continue;
+
+    if ((pattr[i].at_flags & ATR_VFLAG_SET) == 0)
+      {
+      append_entry(payload, JOURNAL_ATTR_UNSET, 0, job_attr_def[i].at_name, "", "");
+      count++;
+      continue;
+      }
+
+    if ((i != JOB_ATR_resource) &&
+        (i != JOB_ATR_resc_used) &&
+        (i != JOB_ATR_req_information))
+      {
+      std::string value;
+
+      if (i == JOB_ATR_depend)
+        translate_dependency_to_string(pattr + i, value);
+      else
+        attr_to_str(value, job_attr_def + i, pattr[i], true);
+
+      if (value.size() == 0)
+        {
+        if (type == JOURNAL_REC_DELTA)
+          {
+          append_entry(payload, JOURNAL_ATTR_UNSET, 0, job_attr_def[i].at_name, "", "");
+          count++;
+          }
+
+        continue;
+        }
+
+      append_entry(payload, JOURNAL_ATTR_SET, pattr[i].at_flags,
+        job_attr_def[i].at_name, "", value.c_str());
+      count++;
+      }
+    else
+      {
+      int found = 0;
+
+      if (job_attr_def[i].at_encode(pattr + i,
+            &lhead,
+            job_attr_def[i].at_name,
+            NULL,
+            ATR_ENCODE_SAVE,
+            ATR_DFLAG_ACCESS) < 0)
+        return(-1);
+
+      while ((pal = (svrattrl *)GET_NEXT(lhead)) != NULL)
+        {
+        append_entry(payload, JOURNAL_ATTR_SET, pal->al_flags, pal->al_name,
+          (pal->al_resc != NULL) ? pal->al_resc : "",
+          (pal->al_value != NULL) ? pal->al_value : "");
+        found++;
+
+        delete_link(&pal->al_link);
+        free(pal);
+        }
+
+      if ((found == 0) &&
+          (type == JOURNAL_REC_DELTA))
+        {
+        append_entry(payload, JOURNAL_ATTR_UNSET, 0, job_attr_def[i].at_name, "", "");
+        found++;
+        }
+
+      count += found;
+      }
+
+    pattr[i].at_flags &= ~ATR_VFLAG_MODIFY;
+    }
+
+  return(count);
+  } /* END encode_journal_attrs() */
+
+
+
+/*
+ * encode_journal_record()
+ *
+ * Builds a complete record, header included, for pjob.
+ *
+ * @param pjob - the job to record
+ * @param type - JOURNAL_REC_DELTA, JOURNAL_REC_IMAGE or JOURNAL_REC_RESET
+ * @param rec - set to the encoded record
+ * @return PBSE_NONE on success or -1 if the attributes could not be encoded
+ */
+
+int encode_journal_record(
+
+  job         *pjob,
+  int          type,
+  std::string &rec)
+
+  {
+  journal_rec_header  hdr;
+  std::string         payload;
+
+  payload.append(pjob->ji_qs.ji_jobid, strlen(pjob->ji_qs.ji_jobid) + 1);
+
+  if (type != JOURNAL_REC_RESET)
+    {
+    std::string attrs;
+    int         count;
+
+    append_u32(payload, sizeof(pjob->ji_qs));
+    payload.append((const char *)&pjob->ji_qs, sizeof(pjob->ji_qs));
+
+    if ((count = encode_journal_attrs(pjob, type, attrs)) < 0)
+      return(-1);
+
+    append_u32(payload, count);
+    payload += attrs;
+    }
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.jr_magic = JOB_JOURNAL_REC_MAGIC;
+  hdr.jr_type = type;
+  hdr.jr_len = payload.size();
+  hdr.jr_checksum = journal_checksum(hdr.jr_type, hdr.jr_len, payload.c_str());
+
+  rec.assign((const char *)&hdr, sizeof(hdr));
+  rec += payload;
+
+  return(PBSE_NONE);
+  } /* END encode_journal_record() */
+
+
+
+/*
+ * journal_write()
+ *
+ * Appends an encoded record to the current journal. A partial write is
+ * truncated away so the journal never holds a torn record in the middle.
+ *
+ * @return PBSE_NONE on success, -1 if the journal isn't open or the write failed
+ */
+
+static int journal_write(
+
+  const char        *jobid,
+  const std::string &rec)
+
+  {
+  size_t written = 0;
+  int    rc = PBSE_NONE;
+
+  pthread_mutex_lock(&journal_mutex);
+
+  if (journal_fd < 0)
+    {
+    pthread_mutex_unlock(&journal_mutex);
+    return(-1);
+    }
+
+  while (written < rec.size())
+    {
+    ssize_t len = write(journal_fd, rec.c_str() + written, rec.size() - written);
+
+    if (len < 0)
+      {
+      if (errno == EINTR)
+        continue;
+
+      log_err(errno, __func__, "could not write to the job journal");
+
+      if (ftruncate(journal_fd, journal_bytes) != 0)
+        log_err(errno, __func__, "could not truncate a partial journal record");
+
+      lseek(journal_fd, journal_bytes, SEEK_SET);
+      rc = -1;
+      break;
+      }
+
+    written += len;
+    }
+
+  if (rc == PBSE_NONE)
+    {
+    if (journaled_jobs.size() == 0)
+      journal_oldest = time(NULL);
+
+    journal_bytes += rec.size();
+    journal_dirty = true;
+    journaled_jobs.insert(jobid);
+
+    if (journal_bytes > JOB_JOURNAL_CHECKPOINT_BYTES)
+      pthread_cond_signal(&journal_cond);
+    }
+
+  pthread_mutex_unlock(&journal_mutex);
+
+  return(rc);
+  } /* END journal_write() */
+
+
+
+bool job_journal_active()
+
+  {
+  bool active;
+
+  pthread_mutex_lock(&journal_mutex);
+  active = (journal_fd >= 0);
+  pthread_mutex_unlock(&journal_mutex);
+
+  return(active);
+  } /* END job_journal_active() */
+
+
+
+/*
+ * job_journal_append()
+ *
+ * Records a save of pjob in the journal.
+ *
+ * @param pjob - the job being saved. Its mutex must be held.
+ * @param updatetype - SAVEJOB_QUICK records a delta, anything else an image
+ * @return PBSE_NONE on success, -1 if the caller should write the XML file instead
+ */
+
+int job_journal_append(
+
+  job *pjob,
+  int  updatetype)
+
+  {
+  std::string rec;
+  int         type = (updatetype == SAVEJOB_QUICK) ? JOURNAL_REC_DELTA : JOURNAL_REC_IMAGE;
+
+  if (encode_journal_record(pjob, type, rec) != PBSE_NONE)
+    return(-1);
+
+  return(journal_write(pjob->ji_qs.ji_jobid, rec));
+  } /* END job_journal_append() */
+
+
+
+/*
+ * job_journal_reset()
+ *
+ * Records that pjob's XML file has just been written, so the records
+ * before this one no longer need to be replayed.
+ */
+
+int job_journal_reset(
+
+  job *pjob)
+
+  {
+  std::string rec;
+
+  encode_journal_record(pjob, JOURNAL_REC_RESET, rec);
+
+  return(journal_write(pjob->ji_qs.ji_jobid, rec));
+  } /* END job_journal_reset() */
+
+
+
+/*
+ * parse_journal_buffer()
+ *
+ * Reads the records in buf into journal_pending. Parsing stops at the
+ * first record that is incomplete or fails its checksum.
+ *
+ * @param buf - the journal contents after the file magic
+ * @param len - the length of buf
+ * @param consumed - set to the number of bytes of valid records
+ * @return the number of records read
+ */
+
+int parse_journal_buffer(
+
+  const char *buf,
+  size_t      len,
+  size_t     &consumed)
+
+  {
+  size_t pos = 0;
+  int    records = 0;
+
+  while (pos + sizeof(journal_rec_header) <= len)
+    {
+    journal_rec_header hdr;
+
+    memcpy(&hdr, buf + pos, sizeof(hdr));
+
+    if ((hdr.jr_magic != JOB_JOURNAL_REC_MAGIC) ||
+        (hdr.jr_len > len - pos - sizeof(hdr)))
+      break;
+
+    const char *payload = buf + pos + sizeof(hdr);
+    const char *end;
+
+    if (journal_checksum(hdr.jr_type, hdr.jr_len, payload) != hdr.jr_checksum)
+      break;
+
+    if ((end = (const char *)memchr(payload, '\0', hdr.jr_len)) == NULL)
+      break;
+
+    std::vector<journal_record> &recs = journal_pending[std::string(payload, end - payload)];
+
+    if (hdr.jr_type == JOURNAL_REC_RESET)
+      recs.clear();
+    else
+      {
+      journal_record jr;
+
+      /* an image replaces everything recorded before it */
+      if (hdr.jr_type == JOURNAL_REC_IMAGE)
+        recs.clear();
+
+      jr.type = hdr.jr_type;
+      jr.payload.assign(payload, hdr.jr_len);
+      recs.push_back(jr);
+      }
+
+    pos += sizeof(hdr) + hdr.jr_len;
+    records++;
+    }
+
+  consumed = pos;
+
+  return(records);
+  } /* END parse_journal_buffer() */
+
+
+
+static int load_journal_file(
+
+  const char *path)
+
+  {
+  int          fd;
+  struct stat  sb;
+  std::string  contents;
+  char         log_buf[LOCAL_LOG_BUF_SIZE];
+  size_t       magic_len = strlen(JOB_JOURNAL_MAGIC);
+
+  if ((fd = open(path, O_RDONLY)) < 0)
+    return(PBSE_NONE);
+
+  if (fstat(fd, &sb) == 0)
+    {
+    contents.resize(sb.st_size);
+
+    size_t got = 0;
+
+    while (got < contents.size())
+      {
+      ssize_t len = read(fd, &contents[got], contents.size() - got);
+
+      if (len <= 0)
+        {
+        if ((len < 0) &&
+            (errno == EINTR))
+          continue;
+
+        break;
+        }
+
+      got += len;
+      }
+
+    contents.resize(got);
+    }
+
+  close(fd);
+
+  if ((contents.size() < magic_len) ||
+      (memcmp(contents.c_str(), JOB_JOURNAL_MAGIC, magic_len)))
+    {
+    snprintf(log_buf, sizeof(log_buf), "%s is not a job journal, ignoring it", path);
+    log_err(-1, __func__, log_buf);
+    return(-1);
+    }
+
+  size_t consumed = 0;
+  int    records = parse_journal_buffer(contents.c_str() + magic_len,
+                                        contents.size() - magic_len,
+                                        consumed);
+
+  if (consumed + magic_len < contents.size())
+    {
+    snprintf(log_buf, sizeof(log_buf),
+      "job journal %s has %lu trailing bytes that are not a complete record, ignoring them",
+      path, (unsigned long)(contents.size() - magic_len - consumed));
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+    }
+
+  snprintf(log_buf, sizeof(log_buf), "read %d records from job journal %s", records, path);
+  log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+
+  return(PBSE_NONE);
+  } /* END load_journal_file() */
+
+
+
+/*
+ * job_journal_load()
+ *
+ * Reads the journal files left in jobs_path so job_recov() can replay them.
+ * The old journal, if a checkpoint was interrupted, comes first.
+ */
+
+int job_journal_load(
+
+  const char *jobs_path)
+
+  {
+  journal_path = std::string(jobs_path) + JOB_JOURNAL_FILE;
+  journal_old_path = std::string(jobs_path) + JOB_JOURNAL_OLD_FILE;
+
+  journal_pending.clear();
+
+  load_journal_file(journal_old_path.c_str());
+  load_journal_file(journal_path.c_str());
+
+  return(PBSE_NONE);
+  } /* END job_journal_load() */
+
+
+
+/*
+ * apply_journal_record()
+ *
+ * Applies one delta or image record to pjob.
+ *
+ * @return PBSE_NONE on success, -1 if the record is malformed
+ */
+
+static int apply_journal_record(
+
+  job                  *pjob,
+  const journal_record &jr)
+
+  {
+  const char *p = jr.payload.c_str();
+  const char *end = p + jr.payload.size();
+  uint32_t    fixsize;
+  uint32_t    count;
+  char        log_buf[LOCAL_LOG_BUF_SIZE];
+  bool        seen[JOB_ATR_LAST];
+
+  p += strlen(p) + 1; /* the job id */
+
+  if (p + sizeof(fixsize) > end)
+    return(-1);
+
+  memcpy(&fixsize, p, sizeof(fixsize));
+  p += sizeof(fixsize);
+
+  if ((fixsize != sizeof(pjob->ji_qs)) ||
+      (p + fixsize + sizeof(count) > end))
+    return(-1);
+
+  memcpy(&pjob->ji_qs, p, fixsize);
+  p += fixsize;
+
+  memcpy(&count, p, sizeof(count));
+  p += sizeof(count);
+
+  if (jr.type == JOURNAL_REC_IMAGE)
+    {
+    for (int i = 0; i < JOB_ATR_LAST; i++)
+      {
+      job_attr_def[i].at_free(&pjob->ji_wattr[i]);
+      pjob->ji_wattr[i].at_flags = 0;
+      }
+    }
+
+  memset(seen, 0, sizeof(seen));
+
+  for (uint32_t i = 0; i < count; i++)
+    {
+    char         op;
+    unsigned int flags;
+    const char  *name;
+    const char  *resc;
+    const char  *value;
+    int          index;
+
+    if (p + 1 + sizeof(flags) > end)
+      return(-1);
+
+    op = *p++;
+    memcpy(&flags, p, sizeof(flags));
+    p += sizeof(flags);
+
+    name = p;
+    if ((p = (const char *)memchr(p, '\0', end - p)) == NULL)
+      return(-1);
+    resc = ++p;
+    if ((p = (const char *)memchr(p, '\0', end - p)) == NULL)
+      return(-1);
+    value = ++p;
+    if ((p = (const char *)memchr(p, '\0', end - p)) == NULL)
+      return(-1);
+    p++;
+
+    if ((index = find_attr(job_attr_def, name, JOB_ATR_LAST)) < 0)
+      index = JOB_ATR_UNKN;
+
+    if (op == JOURNAL_ATTR_UNSET)
+      {
+      job_attr_def[index].at_free(&pjob->ji_wattr[index]);
+      pjob->ji_wattr[index].at_flags &= ~(ATR_VFLAG_SET | ATR_VFLAG_MODIFY);
+      }
+    else
+      {
+      svrattrl *pal;
+
+      if ((pal = fill_svrattr_info(name, value, (*resc != '\0') ? resc : NULL,
+                                   log_buf, sizeof(log_buf))) == NULL)
+        return(-1);
+
+      pal->al_flags = flags;
+
+      /* the first entry replaces the old value, later ones add resources */
+      decode_attribute(pal, &pjob, seen[index] == false);
+      seen[index] = true;
+
+      free(pal);
+      }
+    }
+
+  return(PBSE_NONE);
+  } /* END apply_journal_record() */
+
+
+
+/*
+ * job_journal_replay()
+ *
+ * Applies the journal records read at startup to a job just recovered from
+ * its XML file. Jobs are recovered in parallel, so this may be called from
+ * several threads at once.
+ *
+ * @param pjob - the recovered job
+ * @return PBSE_NONE. A malformed record is logged and ends the replay.
+ */
+
+int job_journal_replay(
+
+  job *pjob)
+
+  {
+  std::map<std::string, std::vector<journal_record> >::iterator it;
+  std::vector<journal_record>                                    recs;
+  char log_buf[LOCAL_LOG_BUF_SIZE];
+
+  pthread_mutex_lock(&journal_pending_mutex);
+
+  if ((it = journal_pending.find(pjob->ji_qs.ji_jobid)) != journal_pending.end())
+    {
+    recs.swap(it->second);
+    journal_pending.erase(it);
+    }
+
+  pthread_mutex_unlock(&journal_pending_mutex);
+
+  if (recs.size() == 0)
+    return(PBSE_NONE);
+
+  for (size_t i = 0; i < recs.size(); i++)
+    {
+    if (apply_journal_record(pjob, recs[i]) != PBSE_NONE)
+      {
+      snprintf(log_buf, sizeof(log_buf),
+        "journal record %lu for this job is malformed, ignoring it and any later records",
+        (unsigned long)i);
+      log_event(PBSEVENT_ERROR | PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buf);
+      break;
+      }
+    }
+
+  if (LOGLEVEL >= 7)
+    {
+    snprintf(log_buf, sizeof(log_buf), "replayed %lu job journal records",
+      (unsigned long)recs.size());
+    log_event(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid, log_buf);
+    }
+
+  return(PBSE_NONE);
+  } /* END job_journal_replay() */
+
+
+
+static int open_journal_file(
+
+  const char *path)
+
+  {
+  int fd;
+
+  if ((fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600)) < 0)
+    {
+    log_err(errno, __func__, "could not create the job journal");
+    return(-1);
+    }
+
+  if (write(fd, JOB_JOURNAL_MAGIC, strlen(JOB_JOURNAL_MAGIC)) != (ssize_t)strlen(JOB_JOURNAL_MAGIC))
+    {
+    log_err(errno, __func__, "could not write the job journal header");
+    close(fd);
+    unlink(path);
+    return(-1);
+    }
+
+  return(fd);
+  } /* END open_journal_file() */
+
+
+
+/*
+ * append_to_old_journal()
+ *
+ * Copies the records in the current journal to the end of the old one and
+ * empties the current journal. Used instead of the rename when a failed
+ * checkpoint left the old journal behind: it still holds the only records
+ * of some jobs. Called with journal_mutex held so nothing is written while
+ * the records are copied.
+ *
+ * @return PBSE_NONE on success, -1 if the records could not be copied
+ */
+
+static int append_to_old_journal()
+
+  {
+  std::string contents;
+  size_t      magic_len = strlen(JOB_JOURNAL_MAGIC);
+  size_t      done = 0;
+  char        buf[8192];
+  ssize_t     len;
+  int         fd;
+
+  if ((fd = open(journal_path.c_str(), O_RDONLY)) < 0)
+    {
+    log_err(errno, __func__, "could not read the job journal");
+    return(-1);
+    }
+
+  while ((len = read(fd, buf, sizeof(buf))) != 0)
+    {
+    if (len < 0)
+      {
+      if (errno == EINTR)
+        continue;
+
+      log_err(errno, __func__, "could not read the job journal");
+      close(fd);
+      return(-1);
+      }
+
+    contents.append(buf, len);
+    }
+
+  close(fd);
+
+  if ((fd = open(journal_old_path.c_str(), O_WRONLY | O_APPEND)) < 0)
+    {
+    log_err(errno, __func__, "could not open the old job journal");
+    return(-1);
+    }
+
+  if (contents.size() > magic_len)
+    done = magic_len;
+  else
+    done = contents.size();
+
+  while (done < contents.size())
+    {
+    len = write(fd, contents.c_str() + done, contents.size() - done);
+
+    if (len < 0)
+      {
+      if (errno == EINTR)
+        continue;
+
+      /* a torn record at the end of the old journal is ignored when it is loaded */
+      log_err(errno, __func__, "could not append to the old job journal");
+      close(fd);
+      return(-1);
+      }
+
+    done += len;
+    }
+
+  fdatasync(fd);
+  close(fd);
+
+  if (ftruncate(journal_fd, magic_len) != 0)
+    {
+    /* the records are now in both journals. Replaying them twice is harmless. */
+    log_err(errno, __func__, "could not empty the job journal");
+    return(-1);
+    }
+
+  return(PBSE_NONE);
+  } /* END append_to_old_journal() */
+
+
+
+/*
+ * rotate_journal()
+ *
+ * Moves the current journal aside and starts a new one. The caller then
+ * checkpoints the jobs listed in checkpoint_jobs. If the last checkpoint
+ * failed, the current journal's records are added to the old journal
+ * instead, so the records it kept aren't overwritten.
+ *
+ * @return true if the journal was rotated
+ */
+
+static bool rotate_journal()
+
+  {
+  struct stat sb;
+  int         old_fd;
+  int         new_fd;
+
+  if (stat(journal_old_path.c_str(), &sb) == 0)
+    {
+    bool rotated = false;
+
+    pthread_mutex_lock(&journal_mutex);
+
+    if (append_to_old_journal() == PBSE_NONE)
+      {
+      journal_bytes = strlen(JOB_JOURNAL_MAGIC);
+      journal_dirty = false;
+      journal_oldest = 0;
+      checkpoint_jobs.swap(journaled_jobs);
+      journaled_jobs.clear();
+      journal_checkpointing = true;
+      rotated = true;
+      }
+
+    pthread_mutex_unlock(&journal_mutex);
+
+    return(rotated);
+    }
+
+  if (rename(journal_path.c_str(), journal_old_path.c_str()) != 0)
+    {
+    log_err(errno, __func__, "could not rename the job journal");
+    return(false);
+    }
+
+  if ((new_fd = open_journal_file(journal_path.c_str())) < 0)
+    {
+    rename(journal_old_path.c_str(), journal_path.c_str());
+    return(false);
+    }
+
+  pthread_mutex_lock(&journal_mutex);
+
+  old_fd = journal_fd;
+  journal_fd = new_fd;
+  journal_bytes = strlen(JOB_JOURNAL_MAGIC);
+  journal_dirty = false;
+  journal_oldest = 0;
+  checkpoint_jobs.swap(journaled_jobs);
+  journaled_jobs.clear();
+  journal_checkpointing = true;
+
+  pthread_mutex_unlock(&journal_mutex);
+
+  fdatasync(old_fd);
+  close(old_fd);
+
+  return(true);
+  } /* END rotate_journal() */
+
+
+
+/*
+ * job_journal_checkpoint()
+ *
+ * Writes a fresh XML file for each job that has records in the old
+ * journal and then removes it. Runs as a background threadpool task.
+ */
+
+void *job_journal_checkpoint(
+
+  void *vp)
+
+  {
+  std::set<std::string> jobs;
+  int                   saved = 0;
+  char                  log_buf[LOCAL_LOG_BUF_SIZE];
+  struct timeval        start;
+  struct timeval        end;
+
+  gettimeofday(&start, NULL);
+
+  pthread_mutex_lock(&journal_mutex);
+  jobs.swap(checkpoint_jobs);
+  pthread_mutex_unlock(&journal_mutex);
+
+  for (std::set<std::string>::iterator it = jobs.begin(); it != jobs.end(); it++)
+    {
+    job *pjob;
+
+    if ((pjob = svr_find_job(it->c_str(), FALSE)) == NULL)
+      continue;
+
+    if (job_save_xml(pjob, 0) == PBSE_NONE)
+      {
+      job_journal_reset(pjob);
+      saved++;
+      }
+    else if (job_journal_append(pjob, SAVEJOB_FULL) != PBSE_NONE)
+      {
+      /* keep the old journal - it is this job's only record. This job and
+       * the ones not checkpointed yet go back to journaled_jobs so the next
+       * checkpoint tries them again. */
+      unlock_ji_mutex(pjob, __func__, NULL, LOGLEVEL);
+      log_err(-1, __func__, "could not checkpoint the job journal, keeping the old journal");
+
+      pthread_mutex_lock(&journal_mutex);
+
+      if (journaled_jobs.size() == 0)
+        journal_oldest = time(NULL);
+
+      journaled_jobs.insert(it, jobs.end());
+      journal_checkpointing = false;
+
+      pthread_mutex_unlock(&journal_mutex);
+
+      return(NULL);
+      }
+
+    unlock_ji_mutex(pjob, __func__, NULL, LOGLEVEL);
+    }
+
+  unlink(journal_old_path.c_str());
+
+  pthread_mutex_lock(&journal_mutex);
+  journal_checkpointing = false;
+  pthread_mutex_unlock(&journal_mutex);
+
+  gettimeofday(&end, NULL);
+
+  if (LOGLEVEL >= 3)
+    {
+    snprintf(log_buf, sizeof(log_buf), "job journal checkpoint wrote %d jobs in %ld ms",
+      saved,
+      (long)((end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000));
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+    }
+
+  return(NULL);
+  } /* END job_journal_checkpoint() */
+
+
+
+/*
+ * journal_commit_thread()
+ *
+ * Group commit: syncs the journal at most every JOB_JOURNAL_COMMIT_USECS
+ * and starts a checkpoint when the journal is large or old enough.
+ */
+
+static void *journal_commit_thread(
+
+  void *vp)
+
+  {
+  pthread_mutex_lock(&journal_mutex);
+
+  for (;;)
+    {
+    struct timespec wake;
+    struct timeval  now;
+    bool            checkpoint;
+    int             fd;
+
+    gettimeofday(&now, NULL);
+    wake.tv_sec = now.tv_sec;
+    wake.tv_nsec = (now.tv_usec + JOB_JOURNAL_COMMIT_USECS) * 1000;
+
+    if (wake.tv_nsec >= 1000000000)
+      {
+      wake.tv_sec += wake.tv_nsec / 1000000000;
+      wake.tv_nsec %= 1000000000;
+      }
+
+    pthread_cond_timedwait(&journal_cond, &journal_mutex, &wake);
+
+    checkpoint = (journal_checkpointing == false) &&
+                 (journaled_jobs.size() != 0) &&
+                 ((journal_bytes > JOB_JOURNAL_CHECKPOINT_BYTES) ||
+                  (time(NULL) - journal_oldest > JOB_JOURNAL_CHECKPOINT_SECS));
+
+    if (journal_dirty == true)
+      {
+      fd = journal_fd;
+      journal_dirty = false;
+
+      /* writers may append while we sync; they are picked up next time */
+      pthread_mutex_unlock(&journal_mutex);
+      fdatasync(fd);
+      pthread_mutex_lock(&journal_mutex);
+      }
+
+    if (checkpoint == true)
+      {
+      pthread_mutex_unlock(&journal_mutex);
+
+      if ((rotate_journal() == true) &&
+          (enqueue_threadpool_request_lane(job_journal_checkpoint, NULL, task_pool, TP_LANE_BACKGROUND) != PBSE_NONE))
+        {
+        /* the old journal stays until a later checkpoint gets to run */
+        pthread_mutex_lock(&journal_mutex);
+
+        if (journaled_jobs.size() == 0)
+          journal_oldest = time(NULL);
+
+        journaled_jobs.insert(checkpoint_jobs.begin(), checkpoint_jobs.end());
+        checkpoint_jobs.clear();
+        journal_checkpointing = false;
+
+        pthread_mutex_unlock(&journal_mutex);
+        }
+
+      pthread_mutex_lock(&journal_mutex);
+      }
+    }
+
+  /* NOTREACHED */
+  return(NULL);
+  } /* END journal_commit_thread() */
+
+
+
+/*
+ * job_journal_start()
+ *
+ * Called once jobs have been recovered. Every recovered job was rewritten
+ * to XML by job_recov(), so the old journal files are no longer needed.
+ * If enabled, a new journal is opened and the commit thread started.
+ */
+
+int job_journal_start(
+
+  const char *jobs_path,
+  bool        enabled)
+
+  {
+  pthread_attr_t attr;
+  pthread_t      tid;
+  int            fd;
+
+  journal_path = std::string(jobs_path) + JOB_JOURNAL_FILE;
+  journal_old_path = std::string(jobs_path) + JOB_JOURNAL_OLD_FILE;
+
+  journal_pending.clear();
+  unlink(journal_old_path.c_str());
+
+  if (enabled == false)
+    {
+    unlink(journal_path.c_str());
+    return(PBSE_NONE);
+    }
+
+  if ((fd = open_journal_file(journal_path.c_str())) < 0)
+    return(-1);
+
+  pthread_mutex_lock(&journal_mutex);
+  journal_fd = fd;
+  journal_bytes = strlen(JOB_JOURNAL_MAGIC);
+  journal_dirty = false;
+  journal_checkpointing = false;
+  journaled_jobs.clear();
+  checkpoint_jobs.clear();
+  pthread_mutex_unlock(&journal_mutex);
+
+  if ((pthread_attr_init(&attr) != 0) ||
+      (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) != 0) ||
+      (pthread_create(&tid, &attr, journal_commit_thread, NULL) != 0))
+    {
+    log_err(-1, __func__, "could not start the job journal commit thread, not using the journal");
+
+    pthread_mutex_lock(&journal_mutex);
+    close(journal_fd);
+    journal_fd = -1;
+    pthread_mutex_unlock(&journal_mutex);
+
+    unlink(journal_path.c_str());
+    return(-1);
+    }
+
+  log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, "job journal enabled");
+
+  return(PBSE_NONE);
+  } /* END job_journal_start() */
+
+
+
+/*
+ * job_journal_flush()
+ *
+ * Syncs the journal at shutdown. The journal stays open: a save made after
+ * this must still go to the journal or the next startup would replay older
+ * records over it.
+ */
+
+void job_journal_flush()
+
+  {
+  pthread_mutex_lock(&journal_mutex);
+
+  if (journal_fd >= 0)
+    {
+    fdatasync(journal_fd);
+    journal_dirty = false;
+    }
+
+  pthread_mutex_unlock(&journal_mutex);
+  } /* END job_journal_flush() */
@@ -0,0 +1,50 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _JOB_JOURNAL_H
+#define _JOB_JOURNAL_H
+
+#include <string>
+#include "pbs_job.h" /* job */
+
+/*
+ * The job journal is an append-only log of job image changes kept in
+ * path_jobs. While it is active, job_save() appends a record here instead of
+ * rewriting the job's XML file. The XML files are refreshed by a periodic
+ * checkpoint, after which the journal records they cover are discarded.
+ */
+
+#define JOB_JOURNAL_FILE      "job_journal"
+#define JOB_JOURNAL_OLD_FILE  "job_journal.old"
+
+#define JOB_JOURNAL_MAGIC     "TRQJRNL1"
+#define JOB_JOURNAL_REC_MAGIC 0x4c4e524aU /* "JRNL" */
+
+/* record types */
+enum journal_record_type
+  {
+  JOURNAL_REC_DELTA = 1, /* jobfix and the attributes that changed */
+  JOURNAL_REC_IMAGE,     /* jobfix and every attribute that is set */
+  JOURNAL_REC_RESET      /* the XML file is current - drop earlier records */
+  };
+
+/* fsync the journal this often if it has been written to */
+#define JOB_JOURNAL_COMMIT_USECS      10000
+/* checkpoint when the journal grows past this size */
+#define JOB_JOURNAL_CHECKPOINT_BYTES  (64 * 1024 * 1024)
+/* or when it has records older than this */
+#define JOB_JOURNAL_CHECKPOINT_SECS   300
+
+int   job_journal_load(const char *jobs_path);
+int   job_journal_replay(job *pjob);
+int   job_journal_start(const char *jobs_path, bool enabled);
+void  job_journal_flush();
+bool  job_journal_active();
+
+int   job_journal_append(job *pjob, int updatetype);
+int   job_journal_reset(job *pjob);
+
+void *job_journal_checkpoint(void *vp);
+
+int   encode_journal_record(job *pjob, int type, std::string &rec);
+int   parse_journal_buffer(const char *buf, size_t len, size_t &consumed);
+
+#endif /* _JOB_JOURNAL_H */
@@ -129,6 +129,10 @@
 #include "ji_mutex.h"
 #include "job_recov.h"
 #include "policy_values.h"
+#ifndef PBS_MOM
+#include "job_journal.h"
+#include "job_change_log.hpp"
+#endif
 
 #ifndef TRUE
 #define TRUE 1
@@ -1174,42 +1178,19 @@ int saveJobToXML(
 
 
 /*
- * job_save() - Saves (or updates) a job structure image on disk
- *
- * Save does either - a quick update for state changes only,
- *    - a full update for an existing file, or
- *    - a full write for a new job
- *
- * For a quick update, the data written is less than a disk block
- * size and no size change occurs; so it is rewritten in place.
- *
- * For a full update (usually following modify job request), to
- * insure no data is ever lost due to system crash:
- * 1. write new image to a new file using a temp name
- * 2. unlink the old (image) file
- * 3. link the correct name to the new file
- * 4. unlink the temp name
- *
- * For a new file write, first time, the data is written directly to
- * the file.
- *
- *      RETURN:  0 - success, -1 - failure
+ * job_save_paths() - build the names of a job's image file and the temporary
+ * copy written before it is linked into place
  */
 
-int job_save(
+void job_save_paths(
 
-  job *pjob,  /* pointer to job structure */
-  int  updatetype, /* 0=quick, 1=full, 2=new     */
-  int  mom_port)   /* if 0 ignore otherwise append to end of job name. this is for multi-mom mode */
+  job  *pjob,      /* I */
+  int   mom_port,  /* I */
+  char *namebuf1,  /* O - the job file, MAXPATHLEN long */
+  char *namebuf2)  /* O - the temporary copy, MAXPATHLEN long */
 
   {
-  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, 0);
-
-  char    namebuf1[MAXPATHLEN];
-  char    namebuf2[MAXPATHLEN];
   const char   *tmp_ptr = NULL;
-
-  time_t  time_now = time(NULL);
 #ifndef PBS_MOM
   // get the adjusted path_jobs path
   std::string   adjusted_path_jobs = get_path_jobdata(pjob->ji_qs.ji_jobid, path_jobs);
@@ -1253,13 +1234,32 @@ int job_save(
         adjusted_path_jobs.c_str(), pjob->ji_qs.ji_fileprefix, JOB_FILE_COPY);
 #endif
     }
+  } /* END job_save_paths() */
 
-  /* if ji_modified is set, ie an pbs_attribute changed, then update mtime */
 
-  if (pjob->ji_modified)
-    {
-    pjob->ji_wattr[JOB_ATR_mtime].at_val.at_long = time_now;
-    }
+
+/*
+ * job_save_xml() - write the job's complete image to its XML file
+ *
+ * To insure no data is ever lost due to system crash:
+ * 1. write new image to a new file using a temp name
+ * 2. unlink the old (image) file
+ * 3. link the correct name to the new file
+ * 4. unlink the temp name
+ *
+ *      RETURN:  0 - success, -1 - failure
+ */
+
+int job_save_xml(
+
+  job *pjob,      /* pointer to job structure */
+  int  mom_port)  /* if 0 ignore otherwise append to end of job name. this is for multi-mom mode */
+
+  {
+  char    namebuf1[MAXPATHLEN];
+  char    namebuf2[MAXPATHLEN];
+
+  job_save_paths(pjob, mom_port, namebuf1, namebuf2);
 
   if (!(saveJobToXML(pjob, namebuf2)))
     {
@@ -1282,13 +1282,85 @@ int job_save(
     {
     log_event(PBSEVENT_ERROR | PBSEVENT_SECURITY, PBS_EVENTCLASS_JOB, pjob->ji_qs.ji_jobid,
       "call to saveJobToXML in job_save failed");
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, 0);
     return -1;
     }
 
+  return(PBSE_NONE);
+  } /* END job_save_xml() */
+
+
+
+/*
+ * job_save() - Saves (or updates) a job structure image on disk
+ *
+ * Save does either - a quick update for state changes only,
+ *    - a full update for an existing file, or
+ *    - a full write for a new job
+ *
+ * Normally every type rewrites the job's XML file (see job_save_xml()).
+ *
+ * On the server, when the job journal is active, quick and full updates
+ * of a job that already has a file are appended to the journal instead (see
+ * job_journal.c). Anything written to the XML file is followed by a journal
+ * RESET record so the older records are not replayed over it.
+ *
+ *      RETURN:  0 - success, -1 - failure
+ */
+
+int job_save(
+
+  job *pjob,  /* pointer to job structure */
+  int  updatetype, /* 0=quick, 1=full, 2=new     */
+  int  mom_port)   /* if 0 ignore otherwise append to end of job name. this is for multi-mom mode */
+
+  {
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, 0);
+
+  time_t  time_now = time(NULL);
+  int     rc;
+
+  /* if ji_modified is set, ie an pbs_attribute changed, then update mtime */
+
+  if (pjob->ji_modified)
+    {
+    pjob->ji_wattr[JOB_ATR_mtime].at_val.at_long = time_now;
+    }
+
+#ifndef PBS_MOM
+  /* anything saved is a change the scheduler's copy of the job needs */
+  pjob->ji_status_generation = job_changes.mark_changed();
+
+  bool journal = job_journal_active();
+
+  if ((journal == true) &&
+      (updatetype != SAVEJOB_NEW))
+    {
+    char namebuf1[MAXPATHLEN];
+    char namebuf2[MAXPATHLEN];
+
+    job_save_paths(pjob, mom_port, namebuf1, namebuf2);
+
+    /* records are only replayed onto a job file, so the first save must create one */
+    if ((access(namebuf1, F_OK) == 0) &&
+        (job_journal_append(pjob, updatetype) == PBSE_NONE))
+      {
+      pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, 0);
+      return(PBSE_NONE);
+      }
+    }
+#endif
+
+  rc = job_save_xml(pjob, mom_port);
+
+#ifndef PBS_MOM
+  if ((rc == PBSE_NONE) &&
+      (journal == true))
+    job_journal_reset(pjob);
+#endif
+
   pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, 0);
 
-  return(PBSE_NONE);
+  return(rc);
   }  /* END job_save() */
 
 
@@ -1733,19 +1805,21 @@ int job_recov_binary(
 
 
 /*
- * job_recov() - recover (read in) a job from its save file
- *
- * This function is only needed upon server start up.
+ * job_recov_parse() - read a job from its save file
  *
  * The job structure, its attributes strings, and its dependencies
  * are recovered from the disk.  Space to hold the above is
- * calloc-ed as needed.
+ * calloc-ed as needed. On the server, the job journal records for the
+ * job are applied as well.
  *
- * Returns: job pointer to new job structure or a
+ * This only touches the new job, so the server calls it from several
+ * threads at once during startup.
+ *
+ * Returns: job pointer to new, locked job structure or a
  *   null pointer on an error.
 */
 
-job *job_recov(
+job *job_recov_parse(
 
   const char *filename) /* I */   /* pathname to job save file */
 
@@ -1782,11 +1856,11 @@ job *job_recov(
       (rc == PBSE_INVALID_SYNTAX))
     rc = job_recov_binary(filename, &pj, log_buf, logBufLen);
 
+  /* apply the changes journaled since the file was last written */
   if (rc == PBSE_NONE)
-    rc = set_array_job_ids(&pj, log_buf, logBufLen);
+    rc = job_journal_replay(pj);
 #endif
 
-
   if (rc != PBSE_NONE) 
     {
     if (rc == -1) 
@@ -1798,10 +1872,78 @@ job *job_recov(
 #else
       free(pj);
 #endif
-      } /* sometime pjob is freed by abt_job() */
+      }
     return(NULL);
     }
-  
+
+  return(pj);
+  }  /* END job_recov_parse() */
+
+
+
+#ifndef PBS_MOM
+/*
+ * job_recov_fixup() - link a job read by job_recov_parse() to its array
+ *
+ * This touches the server's arrays, so it must not run concurrently with
+ * itself.
+ *
+ * Returns: PBSE_NONE, or an error after which the job must not be used
+ */
+
+int job_recov_fixup(
+
+  job **pjob) /* M */
+
+  {
+  char  log_buf[LOCAL_LOG_BUF_SIZE];
+  int   rc;
+
+  if ((rc = set_array_job_ids(pjob, log_buf, sizeof(log_buf))) != PBSE_NONE)
+    {
+    if (rc == -1)
+      {
+      log_err(errno, __func__, log_buf);
+
+      delete *pjob;
+      } /* sometime pjob is freed by abt_job() */
+
+    *pjob = NULL;
+    }
+
+  return(rc);
+  }  /* END job_recov_fixup() */
+#endif
+
+
+
+/*
+ * job_recov() - recover (read in) a job from its save file
+ *
+ * This function is only needed upon server start up.
+ *
+ * Reads the file with job_recov_parse(), links the job to its array on the
+ * server, and then rewrites the file.
+ *
+ * Returns: job pointer to new job structure or a
+ *   null pointer on an error.
+*/
+
+job *job_recov(
+
+  const char *filename) /* I */   /* pathname to job save file */
+
+  {
+  job  *pj;
+
+  if ((pj = job_recov_parse(filename)) == NULL)
+    return(NULL);
+
+#ifndef PBS_MOM
+  if (job_recov_fixup(&pj) != PBSE_NONE)
+    return(NULL);
+#endif
+
   pj->ji_commit_done = 1;
 
   /* all done recovering the job */
@@ -6,8 +6,14 @@
 
 
 int job_save(job *pjob, int updatetype, int mom_port);
+int job_save_xml(job *pjob, int mom_port);
+void job_save_paths(job *pjob, int mom_port, char *namebuf1, char *namebuf2);
 
 job *job_recov(const char *);
+job *job_recov_parse(const char *filename);
+#ifndef PBS_MOM
+int  job_recov_fixup(job **pjob);
+#endif
 
 void   add_fix_fields(xmlNodePtr *rnode, const job *pjob);
 void   add_union_fields(xmlNodePtr *rnode, const job *pjob);
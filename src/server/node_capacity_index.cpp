@@ -0,0 +1,334 @@
+#include <algorithm>
+
+#include "node_capacity_index.hpp"
+
+
+node_capacity_index::node_capacity_index() : nodes(), by_property(), available_by_free_slots(),
+                                             node_board_count(0)
+
+  {
+  pthread_mutex_init(&this->mutex, NULL);
+  }
+
+
+
+node_capacity_index::~node_capacity_index()
+
+  {
+  pthread_mutex_destroy(&this->mutex);
+  }
+
+
+
+/*
+ * remove_entry()
+ *
+ * Takes a node out of every part of the index. The mutex must be held.
+ */
+
+void node_capacity_index::remove_entry(
+
+  int id)
+
+  {
+  std::map<int, node_capacity>::iterator it = this->nodes.find(id);
+
+  if (it == this->nodes.end())
+    return;
+
+  node_capacity &old = it->second;
+
+  for (size_t i = 0; i < old.properties.size(); i++)
+    {
+    std::map<std::string, std::set<int> >::iterator pit = this->by_property.find(old.properties[i]);
+
+    if (pit != this->by_property.end())
+      {
+      pit->second.erase(id);
+
+      if (pit->second.size() == 0)
+        this->by_property.erase(pit);
+      }
+    }
+
+  if (old.available == true)
+    {
+    std::map<int, std::set<int> >::iterator fit = this->available_by_free_slots.find(old.free_slots);
+
+    if (fit != this->available_by_free_slots.end())
+      {
+      fit->second.erase(id);
+
+      if (fit->second.size() == 0)
+        this->available_by_free_slots.erase(fit);
+      }
+    }
+
+  if (old.has_node_boards == true)
+    this->node_board_count--;
+
+  this->nodes.erase(it);
+  } // END remove_entry()
+
+
+
+/*
+ * update()
+ *
+ * Records the current capacity of a node, replacing what was known about it.
+ * @param nc - the node's capacity. nc.id must be valid.
+ */
+
+void node_capacity_index::update(
+
+  const node_capacity &nc)
+
+  {
+  if (nc.id < 0)
+    return;
+
+  pthread_mutex_lock(&this->mutex);
+
+  this->remove_entry(nc.id);
+
+  this->nodes[nc.id] = nc;
+
+  for (size_t i = 0; i < nc.properties.size(); i++)
+    this->by_property[nc.properties[i]].insert(nc.id);
+
+  if (nc.available == true)
+    this->available_by_free_slots[nc.free_slots].insert(nc.id);
+
+  if (nc.has_node_boards == true)
+    this->node_board_count++;
+
+  pthread_mutex_unlock(&this->mutex);
+  } // END update()
+
+
+
+void node_capacity_index::remove(
+
+  int id)
+
+  {
+  pthread_mutex_lock(&this->mutex);
+  this->remove_entry(id);
+  pthread_mutex_unlock(&this->mutex);
+  } // END remove()
+
+
+
+void node_capacity_index::clear()
+
+  {
+  pthread_mutex_lock(&this->mutex);
+  this->nodes.clear();
+  this->by_property.clear();
+  this->available_by_free_slots.clear();
+  this->node_board_count = 0;
+  pthread_mutex_unlock(&this->mutex);
+  } // END clear()
+
+
+
+/*
+ * has_node_boards()
+ *
+ * @return true if any indexed node is split into node boards. Those are
+ * placed board by board, which the index doesn't track.
+ */
+
+bool node_capacity_index::has_node_boards()
+
+  {
+  bool boards;
+
+  pthread_mutex_lock(&this->mutex);
+  boards = this->node_board_count > 0;
+  pthread_mutex_unlock(&this->mutex);
+
+  return(boards);
+  } // END has_node_boards()
+
+
+
+size_t node_capacity_index::size()
+
+  {
+  size_t count;
+
+  pthread_mutex_lock(&this->mutex);
+  count = this->nodes.size();
+  pthread_mutex_unlock(&this->mutex);
+
+  return(count);
+  } // END size()
+
+
+
+/*
+ * smallest_property_set()
+ *
+ * @return the ids of the nodes with the rarest of props, or NULL if some
+ * property isn't on any node. The mutex must be held and props not empty.
+ */
+
+const std::set<int> *node_capacity_index::smallest_property_set(
+
+  const std::vector<std::string> &props) const
+
+  {
+  const std::set<int> *smallest = NULL;
+
+  for (size_t i = 0; i < props.size(); i++)
+    {
+    std::map<std::string, std::set<int> >::const_iterator it = this->by_property.find(props[i]);
+
+    if (it == this->by_property.end())
+      return(NULL);
+
+    if ((smallest == NULL) ||
+        (it->second.size() < smallest->size()))
+      smallest = &it->second;
+    }
+
+  return(smallest);
+  } // END smallest_property_set()
+
+
+
+bool node_capacity_index::has_properties(
+
+  int                             id,
+  const std::vector<std::string> &props) const
+
+  {
+  for (size_t i = 0; i < props.size(); i++)
+    {
+    std::map<std::string, std::set<int> >::const_iterator it = this->by_property.find(props[i]);
+
+    if ((it == this->by_property.end()) ||
+        (it->second.find(id) == it->second.end()))
+      return(false);
+    }
+
+  return(true);
+  } // END has_properties()
+
+
+
+/*
+ * find_candidates()
+ *
+ * Finds the available nodes that have every property in props and at least
+ * slots free execution slots.
+ *
+ * @param props - the properties required
+ * @param slots - the free execution slots required
+ * @param ids - the node ids found are appended here, in ascending order
+ * @return the number of node ids found
+ */
+
+int node_capacity_index::find_candidates(
+
+  const std::vector<std::string> &props,
+  int                             slots,
+  std::vector<int>               &ids)
+
+  {
+  size_t start = ids.size();
+
+  pthread_mutex_lock(&this->mutex);
+
+  if (props.size() == 0)
+    {
+    std::map<int, std::set<int> >::iterator it = this->available_by_free_slots.lower_bound(slots);
+
+    for (; it != this->available_by_free_slots.end(); it++)
+      ids.insert(ids.end(), it->second.begin(), it->second.end());
+
+    std::sort(ids.begin() + start, ids.end());
+    }
+  else
+    {
+    const std::set<int> *seed = this->smallest_property_set(props);
+
+    if (seed != NULL)
+      {
+      for (std::set<int>::const_iterator it = seed->begin(); it != seed->end(); it++)
+        {
+        const node_capacity &nc = this->nodes[*it];
+
+        if ((nc.available == true) &&
+            (nc.free_slots >= slots) &&
+            (this->has_properties(*it, props) == true))
+          ids.push_back(*it);
+        }
+      }
+    }
+
+  pthread_mutex_unlock(&this->mutex);
+
+  return(ids.size() - start);
+  } // END find_candidates()
+
+
+
+/*
+ * count_eligible()
+ *
+ * Counts the nodes that could ever take a req, in use or not.
+ *
+ * @param props - the properties required
+ * @param slots - the execution slots required
+ * @param gpus - the gpus required
+ * @param mics - the mics required
+ * @return the number of nodes that have the properties and are big enough
+ */
+
+int node_capacity_index::count_eligible(
+
+  const std::vector<std::string> &props,
+  int                             slots,
+  int                             gpus,
+  int                             mics)
+
+  {
+  int count = 0;
+
+  pthread_mutex_lock(&this->mutex);
+
+  if (props.size() == 0)
+    {
+    for (std::map<int, node_capacity>::iterator it = this->nodes.begin(); it != this->nodes.end(); it++)
+      {
+      if ((it->second.total_slots >= slots) &&
+          (it->second.gpus >= gpus) &&
+          (it->second.mics >= mics))
+        count++;
+      }
+    }
+  else
+    {
+    const std::set<int> *seed = this->smallest_property_set(props);
+
+    if (seed != NULL)
+      {
+      for (std::set<int>::const_iterator it = seed->begin(); it != seed->end(); it++)
+        {
+        const node_capacity &nc = this->nodes[*it];
+
+        if ((nc.total_slots >= slots) &&
+            (nc.gpus >= gpus) &&
+            (nc.mics >= mics) &&
+            (this->has_properties(*it, props) == true))
+          count++;
+        }
+      }
+    }
+
+  pthread_mutex_unlock(&this->mutex);
+
+  return(count);
+  } // END count_eligible()
@@ -890,6 +890,8 @@ void effective_node_delete(
     ipaddrs = AVL_delete_node(pnode->nd_addrs[i], pnode->nd_mom_port, ipaddrs);
     }
 
+  node_index.remove(pnode->nd_id);
+
   delete pnode;
 
   *ppnode = NULL;
@@ -82,6 +82,7 @@
 
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -1522,7 +1523,7 @@ void check_nodes(
   struct work_task *ptask)  /* I (modified) */
 
   {
-  int rc = enqueue_threadpool_request(check_nodes_work, ptask, task_pool);
+  int rc = enqueue_threadpool_request_lane(check_nodes_work, ptask, task_pool, TP_LANE_BACKGROUND);
 
   if (rc)
     {
@@ -1717,7 +1718,7 @@ void *write_node_power_state_work(
 void write_node_state(void)
 
   {
-  int rc = enqueue_threadpool_request(write_node_state_work, NULL, task_pool);
+  int rc = enqueue_threadpool_request_lane(write_node_state_work, NULL, task_pool, TP_LANE_BACKGROUND);
 
   if (rc)
     {
@@ -1728,7 +1729,7 @@ void write_node_state(void)
 void write_node_power_state(void)
 
   {
-  int rc = enqueue_threadpool_request(write_node_power_state_work,NULL,task_pool);
+  int rc = enqueue_threadpool_request_lane(write_node_power_state_work, NULL, task_pool, TP_LANE_BACKGROUND);
 
   if (rc)
     {
@@ -1851,7 +1852,7 @@ void node_unreserve(
   resource_t handle)
 
   {
-  int rc = enqueue_threadpool_request(node_unreserve_work, NULL, task_pool);
+  int rc = enqueue_threadpool_request_lane(node_unreserve_work, NULL, task_pool, TP_LANE_BACKGROUND);
 
   if (rc)
     {
@@ -3043,6 +3044,116 @@ int select_nodes_using_hostlist(
 
 
 
+/*
+ * get_marked_properties()
+ *
+ * Copies the names of the properties a req needs, as hasprop() sees them
+ */
+
+void get_marked_properties(
+
+  std::vector<prop>        &plist,
+  std::vector<std::string> &names)
+
+  {
+  for (unsigned int i = 0; i < plist.size(); i++)
+    {
+    if (plist[i].mark != 0)
+      names.push_back(plist[i].name);
+    }
+  } /* END get_marked_properties() */
+
+
+
+/*
+ * select_from_indexed_nodes()
+ *
+ * Selects nodes the way select_from_all_nodes() does, but only locks the nodes node_index
+ * says are available with enough free slots and the right properties for some req. The
+ * candidates are visited in node id order, the order the nodes were created in, and each is
+ * checked under its lock since the index may have changed since it was read.
+ *
+ * Nodes that aren't candidates can't satisfy a req, but they still count as eligible, so if
+ * the reqs can't all be satisfied eligible_nodes is taken from the index.
+ *
+ * @pre-cond: all_reqs, eligible_nodes, and first_node_name must all be valid parameters
+ * @post-cond: the nodes in the list are saved in naji to be added for the job later
+ */
+
+int select_from_indexed_nodes(
+
+  complete_spec_data            &all_reqs,        /* I */
+  std::list<node_job_add_info>  *naji_list,       /* O (optional) */
+  int                           *eligible_nodes,  /* O */
+  alps_req_data                **ard_array,       /* O (optional) */
+  int                            first_node_id,   /* I */
+  int                            num_alps_reqs,   /* I */
+  enum job_types                 job_type,        /* I */
+  char                          *ProcBMStr,       /* I (optional) */
+  bool                           job_is_exclusive)
+
+  {
+  std::vector<int>  candidates;
+  struct pbsnode   *pnode;
+  int               num = 0;
+  int               indexed_eligible = 0;
+
+  for (int i = 0; i < all_reqs.num_reqs; i++)
+    {
+    single_spec_data         &req = all_reqs.reqs[i];
+    std::vector<std::string>  props;
+
+    if (req.nodes <= 0)
+      continue;
+
+    get_marked_properties(req.plist, props);
+
+    node_index.find_candidates(props, req.ppn, candidates);
+    indexed_eligible += node_index.count_eligible(props, req.ppn, req.gpu, req.mic);
+    }
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+  for (unsigned int c = 0; c < candidates.size(); c++)
+    {
+    if ((pnode = find_nodebyid(candidates[c])) == NULL)
+      continue;
+
+    /* check each req against this node to see if it satisfies it */
+    for (int i = 0; i < all_reqs.num_reqs; i++)
+      {
+      single_spec_data &req = all_reqs.reqs[i];
+
+      if (req.nodes > 0)
+        {
+        if (node_is_spec_acceptable(pnode, req, ProcBMStr, eligible_nodes,job_is_exclusive) == true)
+          {
+          record_fitting_node(num, pnode, naji_list, req, first_node_id, req.req_id, num_alps_reqs, job_type, all_reqs, ard_array);
+
+          /* are all reqs satisfied? */
+          if (all_reqs.total_nodes == 0)
+            break;
+          }
+        }
+      }
+
+    pnode->unlock_node(__func__, NULL, LOGLEVEL);
+
+    /* are all reqs satisfied? */
+    if (all_reqs.total_nodes == 0)
+      break;
+    }
+
+  if ((all_reqs.total_nodes > 0) &&
+      (*eligible_nodes < indexed_eligible))
+    *eligible_nodes = indexed_eligible;
+
+  return(num);
+  } /* END select_from_indexed_nodes() */
+
+
+
 /*
  * select_from_all_nodes()
  *
@@ -3050,6 +3161,9 @@ int select_nodes_using_hostlist(
  * node(s) that we are searching for. This is O(N) with respect to the number of nodes in the system
  * as each request is checked against each node at locking time.
  *
+ * When node_index can answer the query - there are no node boards, cray nodes or geometry
+ * requests - select_from_indexed_nodes() is used instead.
+ *
  * @pre-cond: all_reqs, eligible_nodes, and first_node_name must all be valid parameters
  * @post-cond: the nodes in the list are saved in naji to be added for the job later
  */
@@ -3070,6 +3184,15 @@ int select_from_all_nodes(
   node_iterator   iter;
   struct pbsnode *pnode = NULL;
   int             num = 0;
+
+  if ((cray_enabled != true) &&
+      ((ProcBMStr == NULL) ||
+       (ProcBMStr[0] == '\0')) &&
+      (node_index.has_node_boards() == false))
+    {
+    return(select_from_indexed_nodes(all_reqs, naji_list, eligible_nodes, ard_array, first_node_id,
+                                     num_alps_reqs, job_type, ProcBMStr, job_is_exclusive));
+    }
   
   reinitialize_node_iterator(&iter);
 
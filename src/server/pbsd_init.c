@@ -126,6 +126,8 @@
 #include "login_nodes.h"
 #include "track_alps_reservations.hpp"
 #include "job_func.h" /* svr_job_purge */
+#include "job_journal.h" /* job_journal_load, job_journal_start */
+#include "job_recov.h" /* job_recov_parse, job_recov_fixup */
 #include "net_cache.h"
 #include "ji_mutex.h"
 #include "user_info.h"
@@ -137,6 +139,7 @@
 #include "id_map.hpp"
 #include "exiting_jobs.h"
 #include "mom_hierarchy_handler.h"
+#include "job_change_log.hpp"
 
 
 /*#ifndef SIGKILL*/
@@ -204,7 +207,7 @@ extern char *path_pbs_environment;
 extern int                      queue_rank;
 extern char                     server_name[];
 extern tlist_head               svr_newnodes;
-extern std::list<timed_task>   *task_list_timed;
+extern timed_task_heap        *task_list_timed;
 extern pthread_mutex_t          task_list_timed_mutex;
 task_recycler                   tr;
 extern all_jobs                alljobs;
@@ -230,6 +233,8 @@ extern pthread_mutex_t         *check_tasks_mutex;
 extern pthread_mutex_t         *reroute_job_mutex;
 //extern mom_hierarchy_t         *mh;
 id_map                          node_mapper;
+node_capacity_index             node_index;
+job_change_log                  job_changes;
 
 extern int a_opt_init;
 extern int paused;
@@ -272,7 +277,9 @@ void  resume_net_move(struct work_task *);
 void  rm_files(char *);
 void  stop_me(int);
 void  change_logs_handler(int sig);
-int   process_jobs_dirent(const char *);
+int   process_jobs_dirent(const char *, const char *, std::vector<std::string> &);
+void  log_startup_phase(const char *, struct timeval *);
+void  recover_jobs(std::vector<std::string> &, struct timeval *);
 int   process_arrays_dirent(const char *, int);
 long  jobid_to_long(std::string);
 bool  is_array_job(std::string);
@@ -321,6 +328,19 @@ struct sort_string_by_number
 std::map<std::string, job *, sort_string_by_number> JobArray;
 int recovered_job_count; /* Count of recovered jobs */
 
+/* the most threads used to read job files at startup */
+#define JOB_RECOVERY_THREADS_MAX 16
+
+/* shared by the startup job recovery threads */
+typedef struct job_recovery_work
+  {
+  std::vector<std::string> *files;
+  std::vector<job *>       *jobs;   /* the job parsed from each file, or NULL */
+  size_t                    next;   /* the next index to claim */
+  bool                      saving; /* false: parse the files, true: rewrite the jobs */
+  pthread_mutex_t           mutex;
+  } job_recovery_work;
+
 #define CHANGE_STATE 1
 #define KEEP_STATE   0
 
@@ -978,7 +998,7 @@ int initialize_data_structures_and_mutexes()
 
   initialize_recycler();
 
-  task_list_timed = new std::list<timed_task>();
+  task_list_timed = new timed_task_heap();
   pthread_mutex_init(&task_list_timed_mutex, NULL);
 
   initialize_task_recycler();
@@ -1669,6 +1689,10 @@ int handle_job_recovery(
   time_t            time_now = time(NULL);
   char              basen[MAXPATHLEN+1];
   bool              use_jobs_subdirs = false;
+  std::vector<std::string> job_files;
+  struct timeval    start;
+
+  gettimeofday(&start, NULL);
 
   JobArray.clear();
   recovered_job_count = 0;
@@ -1756,9 +1780,11 @@ int handle_job_recovery(
           }
         else
           {
+          std::string sub_path = std::string(path_jobs) + pdirent->d_name + "/";
+
           while ((pdirent_sub = readdir(dir_sub)) != NULL)
             {
-            process_jobs_dirent(pdirent_sub->d_name);
+            process_jobs_dirent(pdirent_sub->d_name, sub_path.c_str(), job_files);
             }
 
           closedir(dir_sub);
@@ -1779,7 +1805,7 @@ int handle_job_recovery(
         }
       else
         {
-        process_jobs_dirent(pdirent->d_name);
+        process_jobs_dirent(pdirent->d_name, path_jobs, job_files);
         }
       }
 
@@ -1787,6 +1813,10 @@ int handle_job_recovery(
     log_event(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
     closedir(dir);
 
+    log_startup_phase("scan job directory", &start);
+
+    recover_jobs(job_files, &start);
+
     int Index = 0;
     std::map<std::string, job *>::iterator JobArray_iter;
     /*for (Index = 0; Index < JobArray.AppendIndex; Index++)*/
@@ -1863,6 +1893,8 @@ int handle_job_recovery(
         Index = 0;
       }
 
+    log_startup_phase("initialize jobs", &start);
+
     sprintf(log_buf, "%s:1", __func__);
     lock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
 
@@ -1904,22 +1936,24 @@ int handle_job_recovery(
 
 /**
  * Process a jobs directory entry
- * @param dirent_name - name of the entry
+ * @param dirent_name - name of the entry, relative to the current directory
+ * @param dir_path - path of the current directory, ending in '/'
+ * @param job_files - job and array template files are appended here
  */
 
 int process_jobs_dirent(
 
-  const char *dirent_name)
+  const char               *dirent_name,
+  const char               *dir_path,
+  std::vector<std::string> &job_files)
 
   {
   char              log_buf[LOCAL_LOG_BUF_SIZE];
   int               rc = PBSE_NONE;
   int               baselen = 0;
-  job              *pjob;
   char             *psuffix;
   const char       *job_suffix = JOB_FILE_SUFFIX;
   int               job_suf_len = strlen(job_suffix);
-  char              basen[MAXPATHLEN+1];
 
   recovered_job_count++;
   if ((recovered_job_count % 1000) == 0)
@@ -1930,56 +1964,245 @@ int process_jobs_dirent(
 
   if (chk_save_file(dirent_name) == 0)
     {
-    /* recover the jobs */
     baselen = strlen(dirent_name) - job_suf_len;
 
     psuffix = (char *)dirent_name + baselen;
-    if (!strcmp(psuffix, JOB_FILE_TMP_SUFFIX))
-      {
-      if ((pjob = job_recov(dirent_name)) != NULL)
-        {
-        pjob->ji_is_array_template = true;
 
+    if ((!strcmp(psuffix, JOB_FILE_TMP_SUFFIX)) ||
+        (!strcmp(psuffix, job_suffix)))
+      job_files.push_back(std::string(dir_path) + dirent_name);
+    }
+
+  return(rc);
+  } /* END process_jobs_dirent() */
+
+
+
+/*
+ * log_startup_phase()
+ *
+ * Logs how long a phase of server startup took and restarts the timer
+ * for the next phase.
+ *
+ * @param phase - the name of the phase that just finished
+ * @param start - when it started. Set to now.
+ */
+
+void log_startup_phase(
+
+  const char     *phase,
+  struct timeval *start)
+
+  {
+  struct timeval now;
+  long           elapsed_ms;
+  char           log_buf[LOCAL_LOG_BUF_SIZE];
+
+  gettimeofday(&now, NULL);
+
+  elapsed_ms = (now.tv_sec - start->tv_sec) * 1000 + (now.tv_usec - start->tv_usec) / 1000;
+
+  snprintf(log_buf, sizeof(log_buf), "startup phase '%s' took %ld.%03ld seconds",
+    phase, elapsed_ms / 1000, elapsed_ms % 1000);
+  log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, msg_daemonname, log_buf);
 
-        JobArray[pjob->ji_qs.ji_jobid] = pjob;
+  *start = now;
+  } /* END log_startup_phase() */
 
+
+
+/*
+ * recover_job_files()
+ *
+ * The body of the startup job recovery threads. Each thread takes the next
+ * unclaimed index and either parses that job file or rewrites that job.
+ */
+
+void *recover_job_files(
+
+  void *vp)
+
+  {
+  job_recovery_work *work = (job_recovery_work *)vp;
+
+  while (true)
+    {
+    size_t i;
+
+    pthread_mutex_lock(&work->mutex);
+    i = work->next++;
+    pthread_mutex_unlock(&work->mutex);
+
+    if (i >= work->files->size())
+      break;
+
+    if (work->saving == false)
+      {
+      job *pjob = job_recov_parse(work->files->at(i).c_str());
+
+      if (pjob != NULL)
         unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
-        }
 
-      return(rc);
+      work->jobs->at(i) = pjob;
       }
+    else if (work->jobs->at(i) != NULL)
+      {
+      job *pjob = work->jobs->at(i);
 
-    if (strcmp(psuffix, job_suffix))
-      return(rc);
+      lock_ji_mutex(pjob, __func__, NULL, LOGLEVEL);
+      job_save(pjob, SAVEJOB_FULL, 0);
+      unlock_ji_mutex(pjob, __func__, "2", LOGLEVEL);
+      }
+    }
+
+  return(NULL);
+  } /* END recover_job_files() */
+
+
+
+/*
+ * run_job_recovery_threads()
+ *
+ * Runs recover_job_files() on up to JOB_RECOVERY_THREADS_MAX threads,
+ * including this one, and waits for them to finish.
+ */
 
-    if ((pjob = job_recov(dirent_name)) != NULL)
+void run_job_recovery_threads(
+
+  job_recovery_work *work)
+
+  {
+  std::vector<pthread_t> threads;
+  long                   count = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (count > JOB_RECOVERY_THREADS_MAX)
+    count = JOB_RECOVERY_THREADS_MAX;
+
+  if ((size_t)count > work->files->size())
+    count = work->files->size();
+
+  work->next = 0;
+
+  for (long i = 1; i < count; i++)
+    {
+    pthread_t tid;
+
+    if (pthread_create(&tid, NULL, recover_job_files, work) != 0)
       {
-      JobArray[pjob->ji_qs.ji_jobid] = pjob;
+      log_err(errno, __func__, "could not start a job recovery thread");
+      break;
+      }
 
-      unlock_ji_mutex(pjob, __func__, "2", LOGLEVEL);
+    threads.push_back(tid);
+    }
+
+  recover_job_files(work);
+
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+  } /* END run_job_recovery_threads() */
+
+
+
+/*
+ * recover_jobs()
+ *
+ * Recovers the job files found by handle_job_recovery() into JobArray:
+ * 1. the files are parsed in parallel
+ * 2. the jobs are linked to their arrays in job id order on this thread
+ * 3. the job files are rewritten in parallel
+ *
+ * @param job_files - the job and array template files to recover
+ * @param start - the startup phase timer
+ */
+
+void recover_jobs(
+
+  std::vector<std::string> &job_files,
+  struct timeval           *start)
+
+  {
+  std::vector<job *>  jobs(job_files.size(), (job *)NULL);
+  job_recovery_work   work;
+  char                log_buf[LOCAL_LOG_BUF_SIZE];
+  char                basen[MAXPATHLEN+1];
+
+  work.files = &job_files;
+  work.jobs = &jobs;
+  work.saving = false;
+  pthread_mutex_init(&work.mutex, NULL);
+
+  run_job_recovery_threads(&work);
+
+  log_startup_phase("parse job files", start);
+
+  for (size_t i = 0; i < job_files.size(); i++)
+    {
+    const char *path = job_files[i].c_str();
+    bool        array_template = !strcmp(path + job_files[i].size() - strlen(JOB_FILE_TMP_SUFFIX), JOB_FILE_TMP_SUFFIX);
+
+    if (jobs[i] != NULL)
+      {
+      if (array_template == true)
+        jobs[i]->ji_is_array_template = true;
+
+      JobArray[jobs[i]->ji_qs.ji_jobid] = jobs[i];
       }
-    else
+    else if (array_template == false)
       {
-      sprintf(log_buf, msg_init_badjob, dirent_name);
+      sprintf(log_buf, msg_init_badjob, path);
 
       log_err(-1, __func__, log_buf);
 
       /* remove corrupt job */
-      snprintf(basen, sizeof(basen), "%s%s", dirent_name, JOB_BAD_SUFFIX);
+      snprintf(basen, sizeof(basen), "%s%s", path, JOB_BAD_SUFFIX);
 
-      if (link(dirent_name, basen) < 0)
+      if (link(path, basen) < 0)
         {
         log_err(errno, __func__, "failed to link corrupt .JB file to .BD");
         }
       else
         {
-        unlink(dirent_name);
+        unlink(path);
         }
       }
     }
 
-  return(rc);
-  } /* END process_jobs_dirent() */
+  /* linking jobs to arrays isn't thread safe, so it is done in job id order here */
+  std::map<std::string, job *, sort_string_by_number>::iterator it = JobArray.begin();
+
+  while (it != JobArray.end())
+    {
+    job *pjob = it->second;
+
+    lock_ji_mutex(pjob, __func__, NULL, LOGLEVEL);
+
+    if (job_recov_fixup(&pjob) != PBSE_NONE)
+      {
+      for (size_t i = 0; i < jobs.size(); i++)
+        {
+        if (jobs[i] == it->second)
+          jobs[i] = NULL;
+        }
+
+      JobArray.erase(it++);
+      continue;
+      }
+
+    pjob->ji_commit_done = 1;
+    unlock_ji_mutex(pjob, __func__, "1", LOGLEVEL);
+    it++;
+    }
+
+  log_startup_phase("link jobs to arrays", start);
+
+  work.saving = true;
+  run_job_recovery_threads(&work);
+
+  pthread_mutex_destroy(&work.mutex);
+
+  log_startup_phase("rewrite job files", start);
+  } /* END recover_jobs() */
 
 
 int cleanup_recovered_arrays()
@@ -2095,8 +2318,11 @@ int handle_job_and_array_recovery(
   int type)
 
   {
-  int rc;
-  int tmp_rc;
+  int  rc;
+  int  tmp_rc;
+  bool journal = false;
+
+  job_journal_load(path_jobs);
 
   rc = handle_array_recovery(type);
   
@@ -2111,6 +2337,10 @@ int handle_job_and_array_recovery(
   if (rc == PBSE_NONE)
     rc = tmp_rc;
 
+  /* every recovered job has been rewritten, so the journal can start over */
+  get_svr_attr_b(SRV_ATR_JobJournal, &journal);
+  job_journal_start(path_jobs, journal);
+
   return(rc);
   } /* END handle_job_and_array_recovery() */
 
@@ -2249,6 +2479,11 @@ int pbsd_init(
   int               ret = PBSE_NONE;
   gid_t             gid;
   char              log_buf[LOCAL_LOG_BUF_SIZE];
+  struct timeval    phase_start;
+  struct timeval    init_start;
+
+  gettimeofday(&init_start, NULL);
+  phase_start = init_start;
 
   try
     {
@@ -2305,10 +2540,14 @@ int pbsd_init(
     if ((ret = setup_server_attrs(type)) != PBSE_NONE)
       return(ret);
 
+    log_startup_phase("server attributes", &phase_start);
+
     /* Open and read in node list if one exists */
     if ((ret = initialize_nodes()) != PBSE_NONE)
       return(ret);
 
+    log_startup_phase("nodes", &phase_start);
+
     /* the functions we're calling assume this mutex is locked */
     sprintf(log_buf, "%s:1", __func__);
     lock_sv_qs_mutex(server.sv_qs_mutex, log_buf);
@@ -2316,8 +2555,12 @@ int pbsd_init(
     if ((ret = handle_queue_recovery(type)) != PBSE_NONE)
       return(ret);
 
+    log_startup_phase("queues", &phase_start);
+
     handle_job_and_array_recovery(type);
 
+    log_startup_phase("jobs and arrays", &phase_start);
+
 #ifdef PENABLE_LINUX_CGROUPS
     if ((ret = load_node_usages()) != PBSE_NONE)
       {
@@ -2347,6 +2590,9 @@ int pbsd_init(
 #endif
 
 
+    log_startup_phase("tracking and hierarchy", &phase_start);
+    log_startup_phase("server initialization", &init_start);
+
     /* allow the threadpool to start processing */
     if (paused == TRUE)
       start_request_pool(request_pool);
@@ -142,6 +142,7 @@
 #include "tcp.h" /* tcp_chan */
 #include "ji_mutex.h"
 #include "job_route.h" /* queue_route */
+#include "job_journal.h" /* job_journal_flush */
 #include "exiting_jobs.h"
 #include "server_comm.h"
 #include "node_func.h"
@@ -155,6 +156,7 @@
 #define TSERVER_HA_CHECK_TIME    1  /* 1 second sleep time between checks on the lock file for high availability */
 #define UPDATE_TIMEOUT_INTERVAL  10
 #define UPDATE_LOGLEVEL_INTERVAL 10
+#define LANE_STATS_INTERVAL      300 /* seconds between request pool lane logs */
 
 /* external functions called */
 
@@ -1256,6 +1258,41 @@ void start_exiting_retry_thread()
 
 
 
+/*
+ * log_request_pool_lanes()
+ *
+ * Logs the queue counters of each of request_pool's lanes, so a lane that
+ * backs up shows in the server log.
+ */
+
+void log_request_pool_lanes()
+
+  {
+  static const char *lane_names[TP_NUM_LANES] = { "client", "mom status", "background" };
+  tp_lane_queue_t    stats;
+  char               log_buf[LOCAL_LOG_BUF_SIZE];
+
+  for (int lane = 0; lane < TP_NUM_LANES; lane++)
+    {
+    if (threadpool_get_lane_stats(request_pool, lane, &stats) != PBSE_NONE)
+      continue;
+
+    snprintf(log_buf, sizeof(log_buf),
+      "request pool %s lane: %d queued (most %d), %lu dequeued, average wait %llu usecs, longest %lu usecs",
+      lane_names[lane],
+      stats.depth,
+      stats.max_depth,
+      stats.dequeued,
+      (stats.dequeued > 0) ? stats.total_wait_usecs / stats.dequeued : 0ULL,
+      stats.max_wait_usecs);
+
+    log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, __func__, log_buf);
+    }
+  } /* END log_request_pool_lanes() */
+
+
+
+
 void monitor_accept_thread()
   {
   if (accept_thread_active == false)
@@ -1288,6 +1325,7 @@ void main_loop(void)
   time_t        time_now = time(NULL);
 //  time_t        try_hellos = 0;
   time_t        update_loglevel = 0;
+  time_t        log_lane_stats = time_now + LANE_STATS_INTERVAL;
 
   extern char  *msg_startup2; /* log message   */
   char          log_buf[LOCAL_LOG_BUF_SIZE];
@@ -1422,6 +1460,13 @@ void main_loop(void)
       LOGLEVEL = log;
       }
 
+    if ((LOGLEVEL >= 6) &&
+        (time_now > log_lane_stats))
+      {
+      log_lane_stats = time_now + LANE_STATS_INTERVAL;
+      log_request_pool_lanes();
+      }
+
     /* 
      * Can we comment this out? Would anything above change the
      * server state without setting the 'state' variable? 
@@ -1464,6 +1509,8 @@ void main_loop(void)
 
   track_save(NULL);                     /* save tracking data */
 
+  job_journal_flush();
+
   /* let any array jobs that might still be cloning finish */
   int sem_val;
   do
@@ -1882,6 +1929,10 @@ int main(
   log_open(log_file, path_log);
   pthread_mutex_unlock(&log_mutex);
 
+  /* from here on the worker threads queue their log messages for a writer thread */
+  if (log_async_start() != PBSE_NONE)
+    log_err(-1, msg_daemonname, "could not start the log writer thread, logging synchronously");
+
   sprintf(log_buf, msg_startup1, server_name, server_init_type);
 
   log_event(
@@ -1951,6 +2002,8 @@ int main(
 
   acct_close(false);
 
+  log_async_stop();
+
   pthread_mutex_lock(&log_mutex);
   log_close(1);
   pthread_mutex_unlock(&log_mutex);
@@ -23,6 +23,7 @@ pbsnode::pbsnode() : nd_error(0), nd_properties(), nd_version(0), nd_plugin_gene
                      nd_plugin_generic_metrics(), nd_plugin_varattrs(), nd_plugin_features(),
                      nd_proximal_failures(0), nd_consecutive_successes(0),
                      nd_mutex(), nd_id(-1), nd_f_st(), nd_addrs(), nd_prop(NULL), nd_status(),
+                     nd_status_entries(), nd_status_version(0),
                      nd_note(),
                      nd_stream(-1),
                      nd_flag(okay), nd_mom_port(PBS_MOM_SERVICE_PORT),
@@ -42,7 +43,7 @@ pbsnode::pbsnode() : nd_error(0), nd_properties(), nd_version(0), nd_plugin_gene
                      nd_is_alps_login(0), nd_ms_jobs(NULL), alps_subnodes(NULL),
                      max_subnode_nppn(0), nd_power_state(0),
                      nd_power_state_change_time(0), nd_acl(NULL),
-                     nd_requestid(), nd_tmp_unlock_count(0)
+                     nd_requestid(), nd_tmp_unlock_count(0), nd_capacity()
 #ifdef PENABLE_LINUX_CGROUPS
                     , nd_layout()
 #endif
@@ -71,6 +72,7 @@ pbsnode::pbsnode(
                                      nd_plugin_varattrs(), nd_plugin_features(),
                                      nd_proximal_failures(0), nd_consecutive_successes(0),
                                      nd_mutex(), nd_f_st(), nd_prop(NULL), nd_status(),
+                                     nd_status_entries(), nd_status_version(0),
                                      nd_note(),
                                      nd_stream(-1),
                                      nd_flag(okay),
@@ -91,7 +93,7 @@ pbsnode::pbsnode(
                                      nd_is_alps_login(0), nd_ms_jobs(NULL), alps_subnodes(NULL),
                                      max_subnode_nppn(0), nd_power_state(0),
                                      nd_power_state_change_time(0), nd_acl(NULL),
-                                     nd_requestid(), nd_tmp_unlock_count(0)
+                                     nd_requestid(), nd_tmp_unlock_count(0), nd_capacity()
 #ifdef PENABLE_LINUX_CGROUPS
                                      , nd_layout()
 #endif
@@ -181,6 +183,8 @@ pbsnode &pbsnode::operator =(
   this->nd_prop = copy_arst(other.nd_prop);
 
   this->nd_status = other.nd_status;
+  this->nd_status_entries = other.nd_status_entries;
+  this->nd_status_version = other.nd_status_version;
 
   this->nd_note = other.nd_note;
   this->nd_addrs = other.nd_addrs;
@@ -268,6 +272,8 @@ pbsnode::pbsnode(
                           nd_proximal_failures(other.nd_proximal_failures),
                           nd_consecutive_successes(other.nd_consecutive_successes), nd_mutex(),
                           nd_id(other.nd_id), nd_addrs(other.nd_addrs), nd_status(other.nd_status),
+                          nd_status_entries(other.nd_status_entries),
+                          nd_status_version(other.nd_status_version),
                           nd_note(other.nd_note), nd_stream(other.nd_stream),
                           nd_flag(other.nd_flag), nd_mom_port(other.nd_mom_port),
                           nd_mom_rm_port(other.nd_mom_rm_port), nd_sock_addr(), nd_nprops(0),
@@ -298,7 +304,7 @@ pbsnode::pbsnode(
                           nd_power_state(other.nd_power_state),
                           nd_power_state_change_time(other.nd_power_state_change_time),
                           nd_requestid(other.nd_requestid),
-                          nd_tmp_unlock_count(other.nd_tmp_unlock_count)
+                          nd_tmp_unlock_count(other.nd_tmp_unlock_count), nd_capacity()
 #ifdef PENABLE_LINUX_CGROUPS
                           , nd_layout(other.nd_layout)
 #endif
@@ -403,6 +409,8 @@ int pbsnode::unlock_node(
     log_record(PBSEVENT_DEBUG, PBS_EVENTCLASS_NODE, __func__, err_msg);
     }
 
+  this->update_capacity_index();
+
   if (pthread_mutex_unlock(&this->nd_mutex) != 0)
     {
     if (logging >= 10)
@@ -419,6 +427,57 @@ int pbsnode::unlock_node(
 
 
 
+/*
+ * update_capacity_index()
+ *
+ * Brings this node's entry in node_index up to date. This is called as the
+ * node is unlocked, so the index reflects every change made under the lock.
+ */
+
+void pbsnode::update_capacity_index()
+
+  {
+  node_capacity nc;
+
+  if (this->nd_id < 0)
+    return;
+
+  nc.id = this->nd_id;
+  nc.available = ((this->nd_state & (INUSE_OFFLINE | INUSE_NOT_READY | INUSE_RESERVE | INUSE_JOB)) == 0) &&
+                 (this->nd_power_state == POWER_STATE_RUNNING);
+  nc.has_node_boards = (this->num_node_boards > 0);
+  nc.total_slots = this->nd_slots.get_total_execution_slots();
+  nc.free_slots = this->nd_slots.get_number_free();
+  nc.mics = this->nd_nmics;
+
+  // the same gpus gpu_count() counts
+  if (((this->nd_state & (INUSE_OFFLINE | INUSE_UNKNOWN | INUSE_NOT_READY)) == 0) &&
+      (this->nd_power_state == POWER_STATE_RUNNING))
+    {
+    if (this->nd_gpus_real)
+      {
+      for (int i = 0; i < this->nd_ngpus && i < (int)this->nd_gpusn.size(); i++)
+        {
+        if (this->nd_gpusn[i].state != gpu_unavailable)
+          nc.gpus++;
+        }
+      }
+    else
+      nc.gpus = this->nd_ngpus;
+    }
+
+  if ((nc.same_counts(this->nd_capacity) == true) &&
+      (this->nd_properties == this->nd_capacity.properties))
+    return;
+
+  nc.properties = this->nd_properties;
+  this->nd_capacity = nc;
+
+  node_index.update(nc);
+  } /* END update_capacity_index() */
+
+
+
 int pbsnode::tmp_unlock_node(
 
   const char     *id,
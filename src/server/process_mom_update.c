@@ -82,6 +82,8 @@
 #include <algorithm>
 #include <string>
 #include <vector>
+#include <set>
+#include <map>
 #include <sstream>
 
 #include "pbs_config.h"
@@ -223,6 +225,30 @@ int process_mic_status(
 
 
 
+/*
+ * clear_mic_status()
+ *
+ * Drops the mic status a node reported once it no longer reports mics. The
+ * mic count is left alone since it can also come from the nodes file.
+ *
+ * @param pnode - the node whose mic status is cleared
+ */
+
+void clear_mic_status(
+
+  struct pbsnode *pnode)
+
+  {
+  pbs_attribute temp;
+
+  memset(&temp, 0, sizeof(temp));
+  temp.at_type = ATR_TYPE_ARST;
+
+  node_micstatus_list(&temp, pnode, ATR_ACTION_ALTER);
+  } /* END clear_mic_status() */
+
+
+
 
 /*
  * switches the current node to the desired
@@ -728,6 +754,180 @@ int save_node_status(
 
 
 
+/*
+ * status_section
+ *
+ * What one node's section of a status update carried: its entries, and for
+ * versioned updates the version, the version it is a delta against, and the
+ * entries the mom no longer reports.
+ */
+
+class status_section
+  {
+  public:
+  std::vector<std::string> entries;
+  std::set<std::string>    unset;
+  unsigned long            version;
+  unsigned long            base;
+  bool                     delta;
+
+  status_section() : entries(), unset(), version(0), base(0), delta(false)
+    {
+    }
+
+  void clear()
+    {
+    this->entries.clear();
+    this->unset.clear();
+    this->version = 0;
+    this->base = 0;
+    this->delta = false;
+    }
+  };
+
+
+
+/*
+ * status_entry_key()
+ *
+ * @return the name of a status entry - everything before the '='
+ */
+
+std::string status_entry_key(
+
+  const std::string &entry)
+
+  {
+  return(entry.substr(0, entry.find('=')));
+  } /* END status_entry_key() */
+
+
+
+/*
+ * merge_status_delta()
+ *
+ * Applies a delta to the entries a node reported before. Changed entries
+ * replace the old ones where they were, unset entries are dropped and entries
+ * that are new are appended.
+ *
+ * @param stored - the node's entries (modified)
+ * @param changed - the entries carried by the delta
+ * @param unset - the names of the entries the node no longer reports
+ */
+
+void merge_status_delta(
+
+  std::vector<std::string>       &stored,
+  const std::vector<std::string> &changed,
+  const std::set<std::string>    &unset)
+
+  {
+  std::map<std::string, std::vector<std::string> >           by_key;
+  std::map<std::string, std::vector<std::string> >::iterator it;
+  std::vector<std::string>                                    merged;
+
+  for (size_t i = 0; i < changed.size(); i++)
+    by_key[status_entry_key(changed[i])].push_back(changed[i]);
+
+  merged.reserve(stored.size() + changed.size());
+
+  for (size_t i = 0; i < stored.size(); i++)
+    {
+    std::string key(status_entry_key(stored[i]));
+
+    if ((it = by_key.find(key)) != by_key.end())
+      {
+      merged.insert(merged.end(), it->second.begin(), it->second.end());
+      it->second.clear();
+      }
+    else if (unset.find(key) == unset.end())
+      merged.push_back(stored[i]);
+    }
+
+  for (size_t i = 0; i < changed.size(); i++)
+    {
+    it = by_key.find(status_entry_key(changed[i]));
+
+    merged.insert(merged.end(), it->second.begin(), it->second.end());
+    it->second.clear();
+    }
+
+  stored.swap(merged);
+  } /* END merge_status_delta() */
+
+
+
+/*
+ * save_status_section()
+ *
+ * Stores the entries of one node's section of a status update as the node's
+ * status. A delta is merged into what the node reported before; anything else
+ * replaces it.
+ *
+ * @param np - the node the section is for
+ * @param section - the section. It is cleared for the next node.
+ * @return STATUS_RESYNC if a delta wasn't against the last version applied,
+ * STATUS_DELTAS_OK for other versioned updates and for unversioned ones from
+ * moms that can version them, PBSE_NONE otherwise
+ */
+
+int save_status_section(
+
+  struct pbsnode *np,
+  status_section &section)
+
+  {
+  int         rc = PBSE_NONE;
+  std::string status;
+
+  if (section.delta == true)
+    {
+    /* apply it anyway - what it carries is still the newest we know of the
+     * node. The mom sends everything again when told to resync */
+    if (section.base != np->nd_status_version)
+      rc = STATUS_RESYNC;
+    else
+      rc = STATUS_DELTAS_OK;
+
+    merge_status_delta(np->nd_status_entries, section.entries, section.unset);
+
+    /* gpu and mic sections aren't kept with the entries, they live in the
+     * node's gpu and mic data */
+    if (section.unset.find(START_GPU_STATUS) != section.unset.end())
+      clear_nvidia_gpus(np);
+
+    if (section.unset.find(START_MIC_STATUS) != section.unset.end())
+      clear_mic_status(np);
+    }
+  else
+    {
+    np->nd_status_entries.swap(section.entries);
+
+    /* older moms take any reply but PBSE_NONE as a failed update */
+    if ((section.version != 0) ||
+        (np->get_version() >= STATUS_DELTAS_MOM_VERSION))
+      rc = STATUS_DELTAS_OK;
+    }
+
+  np->nd_status_version = section.version;
+
+  for (size_t i = 0; i < np->nd_status_entries.size(); i++)
+    {
+    if (i != 0)
+      status += ",";
+
+    status += np->nd_status_entries[i];
+    }
+
+  save_node_status(np, status);
+
+  section.clear();
+
+  return(rc);
+  } /* END save_status_section() */
+
+
+
 #ifdef PENABLE_LINUX_CGROUPS
 /*
  * update_layout_if_needed()
@@ -807,7 +1007,9 @@ int process_status_info(
   int             dont_change_state = FALSE;
   int             rc = PBSE_NONE;
   bool            send_hello = false;
-  std::string     temp;
+  int             version_rc = PBSE_NONE;
+  struct pbsnode *reporter;
+  status_section  section;
 
   get_svr_attr_b(SRV_ATR_MomJobSync, &mom_job_sync);
   get_svr_attr_b(SRV_ATR_AutoNodeNP, &auto_np);
@@ -818,6 +1020,9 @@ int process_status_info(
   if ((current = find_nodebyname(nd_name)) == NULL)
     return(PBSE_NONE);
 
+  /* only the reporting mom's own section decides how it should update next */
+  reporter = current;
+
   //A node we put to sleep is up and running.
   if (current->nd_power_state != POWER_STATE_RUNNING)
     {
@@ -841,8 +1046,10 @@ int process_status_info(
       /* if we've already processed some, save this before moving on */
       if (i != 0)
         {
-        save_node_status(current, temp);
-        temp.clear();
+        int section_rc = save_status_section(current, section);
+
+        if (current == reporter)
+          version_rc = section_rc;
         }
       
       dont_change_state = FALSE;
@@ -857,8 +1064,10 @@ int process_status_info(
       /* if we've already processed some, save this before moving on */
       if (i != 0)
         {
-        save_node_status(current, temp);
-        temp.clear();
+        int section_rc = save_status_section(current, section);
+
+        if (current == reporter)
+          version_rc = section_rc;
         }
 
       dont_change_state = FALSE;
@@ -884,7 +1093,24 @@ int process_status_info(
         }
       }
 
-    /* add the info to the "temp" pbs_attribute */
+    else if (!strncmp(str, STATUS_VERSION_EQUALS, strlen(STATUS_VERSION_EQUALS)))
+      {
+      section.version = strtoul(str + strlen(STATUS_VERSION_EQUALS), NULL, 10);
+      continue;
+      }
+    else if (!strncmp(str, STATUS_BASE_EQUALS, strlen(STATUS_BASE_EQUALS)))
+      {
+      section.base = strtoul(str + strlen(STATUS_BASE_EQUALS), NULL, 10);
+      section.delta = true;
+      continue;
+      }
+    else if (!strncmp(str, STATUS_UNSET_EQUALS, strlen(STATUS_UNSET_EQUALS)))
+      {
+      section.unset.insert(str + strlen(STATUS_UNSET_EQUALS));
+      continue;
+      }
+
+    /* add the info to the node's status entries */
     else if (!strcmp(str, START_GPU_STATUS))
       {
       is_gpustat_get(current, i, status_info);
@@ -917,7 +1143,7 @@ int process_status_info(
       sji->sync_jobs = mom_job_sync;
         
       // sji is freed in sync_node_jobs()
-      enqueue_threadpool_request(sync_node_jobs, sji, task_pool);
+      enqueue_threadpool_request_lane(sync_node_jobs, sji, task_pool, TP_LANE_MOM_STATUS);
 
       continue;
       }
@@ -932,9 +1158,6 @@ int process_status_info(
       }
     else 
       {
-      if (temp.size() > 0)
-        temp += ",";
-
       if (!strncmp(str, "message=", 8))
         {
         std::string no_newlines(str);
@@ -946,10 +1169,10 @@ int process_status_info(
           pos = no_newlines.find('\n');
           }
 
-        temp += no_newlines;
+        section.entries.push_back(no_newlines);
         }
       else
-        temp += str;
+        section.entries.push_back(str);
       }
 
     if (!strncmp(str, "state", 5))
@@ -1000,13 +1223,19 @@ int process_status_info(
 
   if (current != NULL)
     {
-    save_node_status(current, temp);
+    int section_rc = save_status_section(current, section);
+
+    if (current == reporter)
+      version_rc = section_rc;
+
     current->unlock_node(__func__, NULL, LOGLEVEL);
     }
   
   if ((rc == PBSE_NONE) &&
       (send_hello == true))
     rc = SEND_HELLO;
+  else if (rc == PBSE_NONE)
+    rc = version_rc;
     
   return(rc);
   } /* END process_status_info() */
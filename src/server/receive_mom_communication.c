@@ -522,6 +522,11 @@ void *svr_is_request(
           write_tcp_reply(chan,IS_PROTOCOL,IS_PROTOCOL_VER,IS_STATUS,ret);
         }
 
+      /* these only tell the mom how to send its next update */
+      if ((ret == STATUS_DELTAS_OK) ||
+          (ret == STATUS_RESYNC))
+        ret = DIS_SUCCESS;
+
       if (ret != DIS_SUCCESS)
         {
         if (LOGLEVEL >= 1)
@@ -283,6 +283,12 @@ void reply_free(
     free(prep->brp_un.brp_rescq.brq_down);
     }
 
+  if (prep->brp_arena != NULL)
+    {
+    attrlist_arena_free(prep->brp_arena);
+    prep->brp_arena = NULL;
+    }
+
   prep->brp_choice = BATCH_REPLY_CHOICE_NULL;
 
   return;
@@ -114,6 +114,7 @@
 #include "threadpool.h"
 #include "mutex_mgr.hpp"
 #include <string>
+#include "job_change_log.hpp"
 
 #define CHK_HOLD 1
 #define CHK_CONT 2
@@ -1342,6 +1343,9 @@ int modify_job_attr(
       }
     }    /* END for (i) */
 
+  /* mom updates of resources_used aren't always saved, so mark the change here */
+  pjob->ji_status_generation = job_changes.mark_changed();
+
   /* note, the newattr[] attributes are on the stack, they go away automatically */
 
   pjob->ji_modified = 1;
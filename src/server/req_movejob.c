@@ -366,6 +366,8 @@ int req_orderjob(
       {
       mutex_mgr pque1_mutex = mutex_mgr(pque1->qu_mutex, true);
       swap_jobs(pque1->qu_jobs,pjob1,pjob2);
+      /* keeps the summary list's order and rank index in step with the qranks */
+      swap_jobs(pque1->qu_jobs_array_sum,pjob1,pjob2);
       swap_jobs(NULL,pjob1,pjob2);
       }
     }
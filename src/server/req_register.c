@@ -107,6 +107,7 @@
 #include "mutex_mgr.hpp"
 #include "utils.h"
 #include "job_func.h"
+#include "issue_request.h" /* que_to_local_svr_batch */
 
 
 #define SYNC_SCHED_HINT_NULL 0
@@ -145,6 +146,7 @@ int    build_depend(pbs_attribute *, const char *);
 void   clear_depend(struct depend *, int type, int exists);
 int    release_cheapest(job *, struct depend *);
 int    send_depend_req(job *, depend_job *pparent, int, int, int, void (*postfunc)(batch_request *),bool bAsyncOk);
+int    send_depend_reqs(job *, struct depend *, unsigned int first, int op);
 depend_job *alloc_dependjob(const char *jobid);
 
 /* External Global Data Items */
@@ -1760,19 +1762,8 @@ int depend_on_term(
 
         if (shouldkill)
           {
-
-          for (unsigned int i = 1; i < pdep->dp_jobs.size(); i++)
-            {
-            pparent = pdep->dp_jobs[i];
-
-            rc = send_depend_req(pjob, pparent, type, JOB_DEPEND_OP_DELETE, SYNC_SCHED_HINT_NULL, free_br,true);
-            
-            if (rc == PBSE_JOBNOTFOUND)
-              {
-              return(rc);
-              }
-            }
-
+          /* the first job in the set is this one */
+          send_depend_reqs(pjob, pdep, 1, JOB_DEPEND_OP_DELETE);
           }
 
         break;
@@ -1781,15 +1772,10 @@ int depend_on_term(
 
     if (op != -1)
       {
-      for (unsigned int i = 0; i < pdep->dp_jobs.size(); i++)
+      /* "release" the jobs to execute */
+      if ((rc = send_depend_reqs(pjob, pdep, 0, op)) != PBSE_NONE)
         {
-        pparent = pdep->dp_jobs[i];
-
-        /* "release" the job to execute */
-        if ((rc = send_depend_req(pjob, pparent, type, op, SYNC_SCHED_HINT_NULL, free_br,true)) != PBSE_NONE)
-          {
-          return(rc);
-          }
+        return(rc);
         }
       }
 
@@ -2413,27 +2399,33 @@ depend_job *make_dependjob(
 
 
 /*
- * send_depend_req - build and send a Register Dependent request
+ * build_depend_req()
+ *
+ * Builds the Register Dependent request which tells pparent about pjob.
+ *
+ * @param pjob - the job whose dependency this is (locked)
+ * @param pparent - the job the request is for
+ * @param type - the dependency type
+ * @param op - the JOB_DEPEND_OP_* operation
+ * @param schedhint - the scheduling hint for a syncwith release
+ * @param preq_ptr - set to the new request
+ * @return PBSE_NONE, PBSE_SYSTEM or PBSE_BADATVAL
  */
 
-int send_depend_req(
+int build_depend_req(
 
-  job         *pjob,
-  depend_job  *pparent,
-  int          type,
-  int          op,
-  int          schedhint,
-  void       (*postfunc)(batch_request *),
-  bool         bAsyncOk)
+  job            *pjob,
+  depend_job     *pparent,
+  int             type,
+  int             op,
+  int             schedhint,
+  batch_request **preq_ptr)
 
   {
-  int                   rc = 0;
   int                   i;
-  char                  job_id[PBS_MAXSVRJOBID + 1];
-  char                  br_id[MAXLINE];
-
   struct batch_request *preq;
-  char                  log_buf[LOCAL_LOG_BUF_SIZE];
+
+  *preq_ptr = NULL;
 
   preq = alloc_br(PBS_BATCH_RegistDep);
 
@@ -2497,6 +2489,96 @@ int send_depend_req(
     preq->rq_ind.rq_register.rq_cost = 0;
     }
 
+  *preq_ptr = preq;
+
+  return(PBSE_NONE);
+  }  /* END build_depend_req() */
+
+
+
+
+
+/*
+ * send_depend_reqs()
+ *
+ * Sends the same dependency operation to every job in pdep starting at first.
+ * The jobs all live on this server, so rather than sending one request at a
+ * time, which unlocks and finds pjob again for each, the requests are all
+ * built while pjob stays locked and are handed to one work task to be handled
+ * in order. This is what releases a large fan-out when its parent finishes.
+ *
+ * @param pjob - the job whose dependency this is (locked, and stays locked)
+ * @param pdep - the dependency whose jobs are sent the request
+ * @param first - the index of the first job to send to
+ * @param op - the JOB_DEPEND_OP_* operation
+ * @return PBSE_NONE or the error from building or queueing the requests
+ */
+
+int send_depend_reqs(
+
+  job            *pjob,
+  struct depend  *pdep,
+  unsigned int    first,
+  int             op)
+
+  {
+  std::vector<batch_request *> requests;
+  batch_request               *preq;
+  int                          rc = PBSE_NONE;
+  char                         log_buf[LOCAL_LOG_BUF_SIZE];
+
+  for (unsigned int i = first; i < pdep->dp_jobs.size(); i++)
+    {
+    if ((rc = build_depend_req(pjob, pdep->dp_jobs[i], pdep->dp_type, op, SYNC_SCHED_HINT_NULL, &preq)) != PBSE_NONE)
+      break;
+
+    requests.push_back(preq);
+    }
+
+  if (rc == PBSE_NONE)
+    rc = que_to_local_svr_batch(requests);
+
+  if (rc != PBSE_NONE)
+    {
+    snprintf(log_buf, sizeof(log_buf), "Unable to perform dependencies for job %s", pjob->ji_qs.ji_jobid);
+    log_err(rc, __func__, log_buf);
+
+    for (unsigned int i = 0; i < requests.size(); i++)
+      free_br(requests[i]);
+    }
+
+  return(rc);
+  }  /* END send_depend_reqs() */
+
+
+
+
+
+/*
+ * send_depend_req - build and send a Register Dependent request
+ */
+
+int send_depend_req(
+
+  job         *pjob,
+  depend_job  *pparent,
+  int          type,
+  int          op,
+  int          schedhint,
+  void       (*postfunc)(batch_request *),
+  bool         bAsyncOk)
+
+  {
+  int                   rc = 0;
+  char                  job_id[PBS_MAXSVRJOBID + 1];
+  char                  br_id[MAXLINE];
+
+  struct batch_request *preq;
+  char                  log_buf[LOCAL_LOG_BUF_SIZE];
+
+  if ((rc = build_depend_req(pjob, pparent, type, op, schedhint, &preq)) != PBSE_NONE)
+    return(rc);
+
   /* save jobid and unlock mutex */
   strcpy(job_id, pjob->ji_qs.ji_jobid);
   unlock_ji_mutex(pjob, __func__, "2", LOGLEVEL);
@@ -2941,7 +3023,7 @@ int encode_depend(
     {
     /* there are no dependencies, just the base structure, */
     /* so remove this svrattrl from ths list  */
-    (void)free(pal);
+    free_attrlist_entry(pal);
     return (0);
     }
   }  /* END encode_depend() */
@@ -122,6 +122,7 @@
 #include "unistd.h"
 #include "log.h"
 #include "job_func.h"
+#include "job_change_log.hpp"
 
 /* Global Data Items: */
 
@@ -197,6 +198,9 @@ int req_stat_job(
   int                   rc = PBSE_NONE;
   char                  log_buf[LOCAL_LOG_BUF_SIZE];
   bool                  condensed = false;
+  char                 *since = NULL;
+  char                 *page = NULL;
+  char                 *after = NULL;
 
   enum TJobStatTypeEnum type = tjstNONE;
 
@@ -235,6 +239,13 @@ int req_stat_job(
       condensed = true;
       }
 
+    /* FORMAT:  since_generation=<server start time>.<generation> */
+    since = strstr(preq->rq_extend, SINCEGENERATION);
+
+    /* FORMAT:  page_size=<jobs>,[page_after=<next from the last page>,] */
+    page = strstr(preq->rq_extend, STATPAGESIZE);
+    after = strstr(preq->rq_extend, STATPAGEAFTER);
+
     }    /* END if (preq->rq_extend != NULL) */
 
   if (isdigit((int)*name))
@@ -328,6 +339,44 @@ int req_stat_job(
   cntl->sc_jobid[0] = '\0'; /* cause "start from beginning" */
   cntl->sc_condensed = condensed;
 
+  if (since != NULL)
+    {
+    char *gen_ptr = NULL;
+
+    since += strlen(SINCEGENERATION);
+    cntl->sc_since_set = true;
+    cntl->sc_since_start = (time_t)strtol(since, &gen_ptr, 10);
+
+    if (*gen_ptr == '.')
+      cntl->sc_since_generation = strtoul(gen_ptr + 1, NULL, 10);
+    else
+      cntl->sc_since_start = 0;
+    }
+
+  if (page != NULL)
+    {
+    cntl->sc_page_size = atoi(page + strlen(STATPAGESIZE));
+
+    if (cntl->sc_page_size < 0)
+      cntl->sc_page_size = 0;
+
+    if (after != NULL)
+      {
+      /* FORMAT:  <jobs walked>/<job id>, see add_page_status() */
+      char *id_ptr = NULL;
+
+      after += strlen(STATPAGEAFTER);
+      cntl->sc_page_offset = (int)strtol(after, &id_ptr, 10);
+
+      if (*id_ptr == '/')
+        {
+        id_ptr++;
+        snprintf(cntl->sc_page_after, sizeof(cntl->sc_page_after), "%.*s",
+          (int)strcspn(id_ptr, ","), id_ptr);
+        }
+      }
+    }
+
   req_stat_job_step2(cntl); /* go to step 2, see if running is current */
 
   if (pque != NULL)
@@ -482,7 +531,25 @@ all_jobs_iterator *get_correct_status_iterator(
     ajptr = &alljobs;
 
   ajptr->lock();
-  iter = ajptr->get_iterator();
+
+  if (cntl->sc_page_after[0] != '\0')
+    {
+    /* pick up after the last job of the previous page, or at the same
+     * position if that job has left the server since */
+    if ((iter = ajptr->get_iterator_after(cntl->sc_page_after)) == NULL)
+      {
+      iter = ajptr->get_iterator();
+
+      for (int i = 0; i < cntl->sc_page_offset; i++)
+        {
+        if (iter->get_next_item() == NULL)
+          break;
+        }
+      }
+    }
+  else
+    iter = ajptr->get_iterator();
+
   ajptr->unlock();
 
   return(iter);
@@ -575,6 +642,129 @@ bool in_execution_queue(
 
 
 
+/*
+ * add_generation_status()
+ *
+ * Ends an incremental job status with an entry that tells the client which
+ * generation it is now up to and which jobs left the server since the last one.
+ *
+ * @param pstathd - the status list of the reply
+ * @param generation - the generation the jobs in the reply are current to
+ * @param resync - true if the reply holds every job, not just the changed ones
+ * @param removed - the ids of the jobs removed since the client's generation
+ * @return PBSE_NONE on success, PBSE_SYSTEM if out of memory
+ */
+
+int add_generation_status(
+
+  tlist_head               *pstathd,
+  unsigned long             generation,
+  bool                      resync,
+  std::vector<std::string> &removed)
+
+  {
+  struct brp_status *pstat;
+  svrattrl          *pal;
+  std::string        removed_list;
+  char               buf[MAXLINE];
+
+  if ((pstat = (struct brp_status *)calloc(1, sizeof(struct brp_status))) == NULL)
+    return(PBSE_SYSTEM);
+
+  CLEAR_LINK(pstat->brp_stlink);
+  pstat->brp_objtype = MGR_OBJ_JOB;
+  snprintf(pstat->brp_objname, sizeof(pstat->brp_objname), "%s", GENERATION_STATUS_NAME);
+  CLEAR_HEAD(pstat->brp_attr);
+  append_link(pstathd, &pstat->brp_stlink, pstat);
+
+  snprintf(buf, sizeof(buf), "%ld.%lu", (long)job_changes.started(), generation);
+
+  if ((pal = attrlist_create(GENERATION_ATTR, NULL, strlen(buf) + 1)) == NULL)
+    return(PBSE_SYSTEM);
+
+  strcpy(pal->al_value, buf);
+  pal->al_flags = ATR_VFLAG_SET;
+  append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+  if (resync == true)
+    {
+    if ((pal = attrlist_create(GENERATION_RESYNC, NULL, strlen("True") + 1)) == NULL)
+      return(PBSE_SYSTEM);
+
+    strcpy(pal->al_value, "True");
+    pal->al_flags = ATR_VFLAG_SET;
+    append_link(&pstat->brp_attr, &pal->al_link, pal);
+    }
+  else if (removed.size() > 0)
+    {
+    for (size_t i = 0; i < removed.size(); i++)
+      {
+      if (i > 0)
+        removed_list += ",";
+
+      removed_list += removed[i];
+      }
+
+    if ((pal = attrlist_create(GENERATION_REMOVED, NULL, removed_list.size() + 1)) == NULL)
+      return(PBSE_SYSTEM);
+
+    strcpy(pal->al_value, removed_list.c_str());
+    pal->al_flags = ATR_VFLAG_SET;
+    append_link(&pstat->brp_attr, &pal->al_link, pal);
+    }
+
+  return(PBSE_NONE);
+  } // END add_generation_status()
+
+
+
+/*
+ * add_page_status()
+ *
+ * Ends a full page of a paged job status with an entry whose PAGE_NEXT
+ * attribute the client sends back as STATPAGEAFTER to get the next page.
+ * A page without this entry is the last one.
+ *
+ * @param pstathd - the status list of the reply
+ * @param walked - how many jobs the status has walked over, on all pages
+ * @param last_jobid - the id of the last job in the page
+ * @return PBSE_NONE on success, PBSE_SYSTEM if out of memory
+ */
+
+int add_page_status(
+
+  tlist_head *pstathd,
+  int         walked,
+  const char *last_jobid)
+
+  {
+  struct brp_status *pstat;
+  svrattrl          *pal;
+  char               buf[MAXLINE];
+
+  if ((pstat = (struct brp_status *)calloc(1, sizeof(struct brp_status))) == NULL)
+    return(PBSE_SYSTEM);
+
+  CLEAR_LINK(pstat->brp_stlink);
+  pstat->brp_objtype = MGR_OBJ_JOB;
+  snprintf(pstat->brp_objname, sizeof(pstat->brp_objname), "%s", PAGE_STATUS_NAME);
+  CLEAR_HEAD(pstat->brp_attr);
+  append_link(pstathd, &pstat->brp_stlink, pstat);
+
+  snprintf(buf, sizeof(buf), "%d/%s", walked, last_jobid);
+
+  if ((pal = attrlist_create(PAGE_NEXT, NULL, strlen(buf) + 1)) == NULL)
+    return(PBSE_SYSTEM);
+
+  strcpy(pal->al_value, buf);
+  pal->al_flags = ATR_VFLAG_SET;
+  append_link(&pstat->brp_attr, &pal->al_link, pal);
+
+  return(PBSE_NONE);
+  } // END add_page_status()
+
+
+
 /*
  * req_stat_job_step2 - continue with statusing of jobs
  *
@@ -613,6 +803,19 @@ void req_stat_job_step2(
   job_array             *pa = NULL;
   all_jobs_iterator     *iter;
 
+  /* only the jobs changed since sc_since_generation, see job_change_log */
+  bool                     incremental = false;
+  bool                     resync = false;
+  unsigned long            generation = 0;
+  std::vector<std::string> removed;
+
+  /* when the status is paged, see add_page_status() */
+  int                      paged = 0;
+  int                      walked = 0;
+  char                     last_jobid[PBS_MAXSVRJOBID + 1];
+
+  last_jobid[0] = '\0';
+
   if (preq->rq_extend != NULL)
     {
     /* FORMAT:  { EXECQONLY } */
@@ -660,6 +863,26 @@ void req_stat_job_step2(
     else if ((type == tjstSummarizeArraysQueue) || 
              (type == tjstSummarizeArraysServer))
       update_array_statuses();
+    else if ((cntl->sc_since_set == true) &&
+             ((type == tjstServer) ||
+              (type == tjstQueue)))
+      {
+      /* take the generation first: anything changed while the jobs are walked
+       * is reported again next time rather than missed */
+      incremental = true;
+      generation = job_changes.current();
+      resync = (job_changes.removed_since(cntl->sc_since_start, cntl->sc_since_generation, removed) == false);
+      }
+
+    /* arrays and incremental statuses are always sent whole */
+    if ((type == tjstArray) ||
+        (incremental == true))
+      {
+      cntl->sc_page_size = 0;
+      cntl->sc_page_after[0] = '\0';
+      }
+    else if (cntl->sc_page_after[0] != '\0')
+      walked = cntl->sc_page_offset;
 
     iter = get_correct_status_iterator(cntl);
 
@@ -669,10 +892,17 @@ void req_stat_job_step2(
       {
       mutex_mgr job_mutex(pjob->ji_mutex, true);
 
+      walked++;
+
       /* go ahead and build the status reply for this job */
       if (pjob->ji_being_recycled == true)
         continue;
 
+      if ((incremental == true) &&
+          (resync == false) &&
+          (pjob->ji_status_generation <= cntl->sc_since_generation))
+        continue;
+
       if (exec_only)
         {
         if (cntl->sc_pque != NULL)
@@ -698,6 +928,15 @@ void req_stat_job_step2(
 
         return;
         }
+
+      if ((rc == PBSE_NONE) &&
+          (cntl->sc_page_size > 0) &&
+          (++paged >= cntl->sc_page_size))
+        {
+        /* the page is full, send it and let the client ask for the next */
+        snprintf(last_jobid, sizeof(last_jobid), "%s", pjob->ji_qs.ji_jobid);
+        break;
+        }
       }  /* END for (pjob != NULL) */
 
     delete iter;
@@ -706,6 +945,20 @@ void req_stat_job_step2(
       {
       unlock_ai_mutex(pa, __func__, "1", LOGLEVEL);
       }
+
+    if ((incremental == true) &&
+        (add_generation_status(&preply->brp_un.brp_status, generation, resync, removed) != PBSE_NONE))
+      {
+      req_reject(PBSE_SYSTEM, 0, preq, NULL, NULL);
+      return;
+      }
+
+    if ((last_jobid[0] != '\0') &&
+        (add_page_status(&preply->brp_un.brp_status, walked, last_jobid) != PBSE_NONE))
+      {
+      req_reject(PBSE_SYSTEM, 0, preq, NULL, NULL);
+      return;
+      }
    
     reply_send_svr(preq);
     }
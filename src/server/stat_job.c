@@ -141,6 +141,8 @@ int status_job(
   int                IsOwner = 0;
   bool               query_others = false;
   long               condensed_timeout = JOB_CONDENSED_TIMEOUT;
+  attrlist_arena    *previous_arena;
+  int                rc = PBSE_NONE;
 
   /* Make sure procct is removed from the job 
      resource attributes */
@@ -185,6 +187,13 @@ int status_job(
   /* add attributes to the status reply */
   *bad = 0;
 
+  /* carve the entries from the reply's arena so that they are freed at once
+   * when the reply is, instead of one at a time */
+  if (preq->rq_reply.brp_arena == NULL)
+    preq->rq_reply.brp_arena = attrlist_arena_create();
+
+  previous_arena = attrlist_use_arena(preq->rq_reply.brp_arena);
+
   if (status_attrib(
         pal,
         job_attr_def,
@@ -196,14 +205,16 @@ int status_job(
         bad,
         IsOwner))
     {
-    return(PBSE_NOATTR);
+    rc = PBSE_NOATTR;
     }
   else if (condensed == false)
     {
     pjob->encode_plugin_resource_usage(&pstat->brp_attr);
     }
 
-  return (PBSE_NONE);
+  attrlist_use_arena(previous_arena);
+
+  return(rc);
   }  /* END status_job() */
 
 
@@ -1637,4 +1637,17 @@ attribute_def svr_attr_def[] =
    PARENT_TYPE_SERVER
   },
 
+  // SRV_ATR_JobJournal
+  {(char *)ATTR_job_journal, /* "job_journal" */
+    decode_b,
+    encode_b,
+    set_b,
+    comp_b,
+    free_null,
+    NULL_FUNC,
+    MGR_ONLY_SET,
+    ATR_TYPE_BOOL,
+    PARENT_TYPE_SERVER
+  },
+
   };
@@ -152,6 +152,7 @@
 #include "utils.h"
 #include "pbs_nodes.h"
 #include "policy_values.h"
+#include "job_change_log.hpp"
 
 #include "user_info.h" /* remove_server_suffix() */
 
@@ -303,7 +304,22 @@ const char *PJobSubState[] =
 
 
 
-int insert_into_alljobs_by_rank(
+/*
+ * insert_into_alljobs_by_walk()
+ *
+ * Inserts pjob into aj after the last job with a lower queue rank, found by
+ * walking aj back from the end and comparing each job's qrank. This is
+ * needed when aj holds jobs its rank index doesn't know. pjob is unlocked
+ * while the other jobs are locked, and is locked again on success.
+ *
+ * @param aj - the queue's job list
+ * @param pjob - the job to insert (locked)
+ * @param jobid - pjob's id
+ * @return PBSE_NONE, ALREADY_IN_LIST if the job is already in aj, or
+ * PBSE_JOBNOTFOUND if the job went away while it was unlocked
+ */
+
+int insert_into_alljobs_by_walk(
 
   all_jobs         *aj,
   job              *pjob,
@@ -368,6 +384,49 @@ int insert_into_alljobs_by_rank(
   aj->unlock();
 
   return(PBSE_NONE);
+  } /* END insert_into_alljobs_by_walk() */
+
+
+
+/*
+ * insert_into_alljobs_by_rank()
+ *
+ * Inserts pjob into aj after the last job with a lower queue rank. The place
+ * normally comes from the container's rank index, so no other job is locked
+ * and pjob stays locked throughout. If aj holds jobs that weren't inserted by
+ * rank, the index can't place pjob and the list is walked instead.
+ *
+ * @param aj - the queue's job list
+ * @param pjob - the job to insert (locked)
+ * @param jobid - pjob's id
+ * @return PBSE_NONE, ALREADY_IN_LIST if the job is already in aj,
+ * PBSE_JOBNOTFOUND if the job went away during a walk, or ENOMEM
+ */
+
+int insert_into_alljobs_by_rank(
+
+  all_jobs         *aj,
+  job              *pjob,
+  char            *jobid)
+
+  {
+  long  job_qrank = pjob->ji_wattr[JOB_ATR_qrank].at_val.at_long;
+  int   rc;
+
+  aj->lock();
+  rc = aj->insert_by_rank(pjob, jobid, job_qrank);
+  aj->unlock();
+
+  if (rc == RANKS_INCOMPLETE)
+    return(insert_into_alljobs_by_walk(aj, pjob, jobid));
+
+  if (rc < 0)
+    {
+    rc = ENOMEM;
+    log_err(rc, __func__, "No memory to resize the array...SYSTEM FAILURE");
+    }
+
+  return(rc);
   } /* END insert_into_alljobs_by_rank() */
 
 
@@ -553,8 +612,7 @@ int svr_enquejob(
     {
     rc = insert_into_alljobs_by_rank(pque->qu_jobs, pjob, job_id);
 
-    if ((rc == ALREADY_IN_LIST) ||
-        (rc == PBSE_JOBNOTFOUND))
+    if (rc != PBSE_NONE)
       {
       if (rc == ALREADY_IN_LIST)
         {
@@ -584,8 +642,7 @@ int svr_enquejob(
     {
     rc = insert_into_alljobs_by_rank(pque->qu_jobs_array_sum, pjob, job_id);
 
-    if ((rc == ALREADY_IN_LIST) ||
-        (rc == PBSE_JOBNOTFOUND))
+    if (rc != PBSE_NONE)
       {
       if (rc == ALREADY_IN_LIST)
         rc = PBSE_NONE;
@@ -608,6 +665,8 @@ int svr_enquejob(
 
   pjob->ji_wattr[JOB_ATR_queuetype].at_flags |= ATR_VFLAG_SET;
 
+  pjob->ji_status_generation = job_changes.mark_changed();
+
   // The array template isn't a real job so it shouldn't have a queued accounting record.
   if (((pjob->ji_wattr[JOB_ATR_qtime].at_flags & ATR_VFLAG_SET) == 0) &&
       (!pjob->ji_is_array_template))
@@ -851,6 +910,8 @@ int svr_dequejob(
   /* the only error is if the job isn't present */
   if ((rc = remove_job(&alljobs, pjob)) == PBSE_NONE)
     {
+    job_changes.mark_removed(pjob->ji_qs.ji_jobid);
+
     if (!pjob->ji_is_array_template)
       {
       lock_sv_qs_mutex(server.sv_qs_mutex, __func__);
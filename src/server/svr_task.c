@@ -89,8 +89,6 @@
  */
 
 #include <pbs_config.h>   /* the master config generated by configure */
-#include <list>
-
 #include "portability.h"
 #include <stdlib.h>
 #include <time.h>
@@ -108,39 +106,215 @@ extern void check_nodes(struct work_task *);
 
 /* Global Data Items: */
 
-std::list<timed_task>  *task_list_timed;
+timed_task_heap        *task_list_timed;
 extern pthread_mutex_t  task_list_timed_mutex;
 extern task_recycler    tr;
 
 
 
-void insert_timed_task(
+/*
+ * earlier()
+ *
+ * @return true if the task at heap position a fires before the one at b
+ */
+
+bool timed_task_heap::earlier(
+
+  size_t a,
+  size_t b) const
+
+  {
+  if (this->heap[a].task_time != this->heap[b].task_time)
+    return(this->heap[a].task_time < this->heap[b].task_time);
+
+  return(this->heap[a].sequence < this->heap[b].sequence);
+  } /* END earlier() */
+
+
+
+/*
+ * place()
+ *
+ * Stores tt at a heap position and tells its task where it is.
+ */
+
+void timed_task_heap::place(
+
+  size_t            index,
+  const timed_task &tt)
+
+  {
+  this->heap[index] = tt;
+  tt.wt->wt_timed_index = index + 1;
+  } /* END place() */
+
+
+
+void timed_task_heap::sift_up(
+
+  size_t index)
+
+  {
+  timed_task tt = this->heap[index];
+
+  while (index > 0)
+    {
+    size_t parent = (index - 1) / 2;
+
+    if ((this->heap[parent].task_time < tt.task_time) ||
+        ((this->heap[parent].task_time == tt.task_time) &&
+         (this->heap[parent].sequence < tt.sequence)))
+      break;
+
+    this->place(index, this->heap[parent]);
+    index = parent;
+    }
+
+  this->place(index, tt);
+  } /* END sift_up() */
+
+
+
+void timed_task_heap::sift_down(
+
+  size_t index)
+
+  {
+  size_t count = this->heap.size();
+
+  while (true)
+    {
+    size_t smallest = index;
+    size_t left = index * 2 + 1;
+    size_t right = left + 1;
+
+    if ((left < count) &&
+        (this->earlier(left, smallest)))
+      smallest = left;
+
+    if ((right < count) &&
+        (this->earlier(right, smallest)))
+      smallest = right;
+
+    if (smallest == index)
+      break;
+
+    timed_task tt = this->heap[index];
+
+    this->place(index, this->heap[smallest]);
+    this->place(smallest, tt);
+    index = smallest;
+    }
+  } /* END sift_down() */
+
+
+
+/*
+ * push()
+ *
+ * Queues a task to fire at wt->wt_event. O(log n).
+ */
+
+void timed_task_heap::push(
 
   work_task *wt)
 
   {
-  std::list<timed_task>::iterator it;
-  bool                            inserted = false;
-  timed_task                      tt;
+  timed_task tt;
 
   tt.wt = wt;
   tt.task_time = wt->wt_event;
+  tt.sequence = this->next_sequence++;
 
-  pthread_mutex_lock(&task_list_timed_mutex);
+  this->heap.push_back(tt);
+  this->sift_up(this->heap.size() - 1);
+  } /* END push() */
+
+
+
+/*
+ * pop_due()
+ *
+ * @return the earliest task if it is due at time_now, otherwise NULL
+ */
+
+work_task *timed_task_heap::pop_due(
+
+  long time_now)
 
-  for (it = task_list_timed->begin(); it != task_list_timed->end(); it++)
+  {
+  work_task *wt;
+
+  if ((this->heap.size() == 0) ||
+      (this->heap[0].task_time > time_now))
+    return(NULL);
+
+  wt = this->heap[0].wt;
+  this->remove(wt);
+
+  return(wt);
+  } /* END pop_due() */
+
+
+
+/*
+ * remove()
+ *
+ * Takes a queued task out of the heap. O(log n).
+ *
+ * @return true if the task was queued
+ */
+
+bool timed_task_heap::remove(
+
+  work_task *wt)
+
+  {
+  size_t index;
+  size_t last = this->heap.size() - 1;
+
+  if ((wt->wt_timed_index == 0) ||
+      (wt->wt_timed_index > this->heap.size()) ||
+      (this->heap[wt->wt_timed_index - 1].wt != wt))
+    return(false);
+
+  index = wt->wt_timed_index - 1;
+  wt->wt_timed_index = 0;
+
+  if (index != last)
     {
-    if (it->task_time >= tt.task_time)
-      {
-      task_list_timed->insert(it, tt);
-      inserted = true;
-      break;
-      }
+    this->place(index, this->heap[last]);
+    this->heap.pop_back();
+
+    if ((index > 0) &&
+        (this->earlier(index, (index - 1) / 2)))
+      this->sift_up(index);
+    else
+      this->sift_down(index);
     }
+  else
+    this->heap.pop_back();
+
+  return(true);
+  } /* END remove() */
+
+
+
+size_t timed_task_heap::size() const
+
+  {
+  return(this->heap.size());
+  } /* END size() */
+
+
+
+void insert_timed_task(
 
-  if (inserted == false)
-    task_list_timed->push_back(tt);
+  work_task *wt)
 
+  {
+  pthread_mutex_lock(&task_list_timed_mutex);
+  task_list_timed->push(wt);
   pthread_mutex_unlock(&task_list_timed_mutex);
   } /* END insert_timed_task() */
 
@@ -157,22 +331,12 @@ work_task *pop_timed_task(
   time_t  time_now)
 
   {
-  struct work_task                *wt = NULL;
-  std::list<timed_task>::iterator  it;
+  struct work_task *wt;
 
   // lock the mutex for the timed task list
   pthread_mutex_lock(&task_list_timed_mutex);
 
-  if (task_list_timed->begin() != task_list_timed->end())
-    {
-    it = task_list_timed->begin();
-
-    if (it->task_time <= time_now)
-      {
-      wt = it->wt;
-      task_list_timed->pop_front();
-      }
-    }
+  wt = task_list_timed->pop_due(time_now);
 
   // lock the mutex for the task
   if (wt != NULL)
@@ -186,6 +350,32 @@ work_task *pop_timed_task(
 
 
 
+/*
+ * remove_timed_task - cancel a task that is still waiting for its time.
+ *
+ * The task's mutex must be held. It is held again on return.
+ */
+
+void remove_timed_task(
+
+  work_task *wt)
+
+  {
+  /* the heap is locked before the task everywhere else */
+  if (pthread_mutex_trylock(&task_list_timed_mutex))
+    {
+    pthread_mutex_unlock(wt->wt_mutex);
+    pthread_mutex_lock(&task_list_timed_mutex);
+    pthread_mutex_lock(wt->wt_mutex);
+    }
+
+  task_list_timed->remove(wt);
+
+  pthread_mutex_unlock(&task_list_timed_mutex);
+  } /* END remove_timed_task() */
+
+
+
 /*
  * set_task - add the job entry to the task list
  *
@@ -349,6 +539,10 @@ void delete_task(
   if (ptask->wt_tasklist)
     remove_task(ptask->wt_tasklist,ptask);
 
+  /* a cancelled timed task must not fire after it is recycled */
+  if (ptask->wt_timed_index != 0)
+    remove_timed_task(ptask);
+
   /* put the task in the recycler */
   insert_task_into_recycler(ptask);
 
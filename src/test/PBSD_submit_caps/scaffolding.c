@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <vector>
 
 #include "libpbs.h" /* connect_handle, batch_reply */
 #include "u_hash_map_structs.h" /* job_data */
@@ -28,6 +29,8 @@ const char *dis_emsg[] =
 
 int flush_rc;
 int extend_rc;
+std::vector<off_t> chunk_offsets;
+std::vector<int>   chunk_lens;
 
 
 ssize_t read_nonblocking_socket(int fd, void *buf, ssize_t count)
@@ -48,6 +51,13 @@ int encode_DIS_JobFile(struct tcp_chan *chan, int seq, char *buf, int len, const
   exit(1);
   }
 
+int encode_DIS_JobFile_fd(struct tcp_chan *chan, int seq, int fd, off_t offset, int len, const char *jobid, int which)
+  {
+  chunk_offsets.push_back(offset);
+  chunk_lens.push_back(len);
+  return(0);
+  }
+
 struct tcp_chan *DIS_tcp_setup(int fd)
   {
   static tcp_chan chan;
@@ -68,8 +78,7 @@ int DIS_tcp_wflush(tcp_chan *chan)
 
 struct batch_reply *PBSD_rdrpy(int *local_errno, int c)
   {
-  fprintf(stderr, "The call to PBSD_rdrpy needs to be mocked!!\n");
-  exit(1);
+  return(NULL);
   }
 
 int encode_DIS_QueueJob_hash(struct tcp_chan *chan, char *jobid, char *destin, job_data_container *job_attr, job_data_container *res_attr)
@@ -79,8 +88,6 @@ int encode_DIS_QueueJob_hash(struct tcp_chan *chan, char *jobid, char *destin, j
 
 void PBSD_FreeReply(struct batch_reply *reply)
   {
-  fprintf(stderr, "The call to PBSD_FreeReply needs to be mocked!!\n");
-  exit(1);
   }
 
 int encode_DIS_ReqExtend(struct tcp_chan *chan, char *extend)
@@ -3,6 +3,9 @@
 #include "test_PBSD_submit_caps.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
 
 
 #include "pbs_error.h"
@@ -11,6 +14,8 @@ extern int flush_rc;
 extern int extend_rc;
 extern struct connect_handle connection[];
 extern const char *dis_emsg[];
+extern std::vector<off_t> chunk_offsets;
+extern std::vector<int>   chunk_lens;
 
 void initialize_connections()
 
@@ -141,6 +146,49 @@ START_TEST(test_PBSD_jscript2)
 END_TEST
 
 
+START_TEST(test_PBSD_jscript_chunks)
+  {
+  char  path[] = "/tmp/PBSD_submit_caps_XXXXXX";
+  char *buf = (char *)calloc(1, SCRIPT_CHUNK_Z * 2 + 10);
+  int   fd = mkstemp(path);
+
+  initialize_connections();
+  flush_rc = 0;
+  extend_rc = 0;
+  connection[4].ch_errno = 0;
+
+  fail_unless(fd >= 0);
+
+  // an empty script is not sent at all
+  chunk_offsets.clear();
+  chunk_lens.clear();
+  fail_unless(PBSD_jscript(4, path, "1.napali") == PBSE_NONE);
+  fail_unless(chunk_offsets.size() == 0);
+
+  fail_unless(write(fd, buf, SCRIPT_CHUNK_Z * 2 + 10) == SCRIPT_CHUNK_Z * 2 + 10);
+  fail_unless(PBSD_jscript2(4, path, "1.napali") == PBSE_NONE);
+  fail_unless(chunk_offsets.size() == 3);
+  fail_unless(chunk_offsets[1] == SCRIPT_CHUNK_Z);
+  fail_unless(chunk_offsets[2] == SCRIPT_CHUNK_Z * 2);
+  fail_unless(chunk_lens[0] == SCRIPT_CHUNK_Z);
+  fail_unless(chunk_lens[2] == 10);
+
+  // the rest of the file isn't sent once a chunk fails
+  chunk_offsets.clear();
+  flush_rc = 1;
+  fail_unless(PBSD_jobfile(4, PBS_BATCH_MvJobFile, path, (char *)"1.napali", StdOut) == PBSE_NONE);
+  fail_unless(chunk_offsets.size() == 1);
+  flush_rc = 0;
+
+  fail_unless(PBSD_jscript(4, "/tmp/not_a_real_script", "1.napali") == -1);
+
+  close(fd);
+  unlink(path);
+  free(buf);
+  }
+END_TEST
+
+
 Suite *PBSD_submit_caps_suite(void)
   {
   Suite *s = suite_create("PBSD_submit_caps_suite methods");
@@ -152,6 +200,10 @@ Suite *PBSD_submit_caps_suite(void)
   tcase_add_test(tc_core, test_PBSD_jscript2);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_PBSD_jscript_chunks");
+  tcase_add_test(tc_core, test_PBSD_jscript_chunks);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_PBSD_QueueJob_hash");
   tcase_add_test(tc_core, test_PBSD_QueueJob_hash);
   tcase_add_test(tc_core, test_PBSD_scbuf);
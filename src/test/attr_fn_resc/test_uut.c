@@ -4,6 +4,7 @@
 #include <stdio.h>
 
 #include "attribute.h"
+#include "resource.h"
 #include "pbs_error.h"
 
 START_TEST(test_one)
@@ -34,6 +35,53 @@ START_TEST(test_two)
   }
 END_TEST
 
+START_TEST(test_find_resc_def)
+  {
+  resource_def defs[4];
+
+  memset(defs, 0, sizeof(defs));
+
+  defs[0].rs_name = "nodes";
+  defs[1].rs_name = "walltime";
+  defs[2].rs_name = "nodes";
+  defs[3].rs_name = "|unknown|";
+
+  fail_unless(find_resc_def(defs, "nodes", 4) == defs);
+  fail_unless(find_resc_def(defs, "walltime", 4) == defs + 1);
+  fail_unless(find_resc_def(defs, "Walltime", 4) == NULL);
+  fail_unless(find_resc_def(defs, "|unknown|", 3) == NULL);
+
+  /* growing the array as init_resc_defs() does with site resources */
+  defs[3].rs_name = "site_resc";
+  fail_unless(find_resc_def(defs, "site_resc", 3) == NULL);
+  fail_unless(find_resc_def(defs, "site_resc", 4) == defs + 3);
+  fail_unless(find_resc_def(defs, "walltime", 4) == defs + 1);
+  }
+END_TEST
+
+START_TEST(test_find_resc_entry)
+  {
+  pbs_attribute attr;
+  resource_def  copy;
+  resource_def *string_def = find_resc_def(svr_resc_def, "string", svr_resc_size);
+  resource     *pr;
+
+  memset(&attr, 0, sizeof(attr));
+  fail_unless(string_def != NULL);
+  fail_unless(find_resc_entry(&attr, string_def) == NULL);
+
+  pr = add_resource_entry(&attr, string_def);
+  fail_unless(pr != NULL);
+  fail_unless(find_resc_entry(&attr, string_def) == pr);
+
+  /* a definition with the same name but a different address still matches */
+  memcpy(&copy, string_def, sizeof(copy));
+  fail_unless(find_resc_entry(&attr, &copy) == pr);
+
+  free_resc(&attr);
+  }
+END_TEST
+
 Suite *attr_fn_resc_suite(void)
   {
   Suite *s = suite_create("attr_fn_resc_suite methods");
@@ -45,6 +93,14 @@ Suite *attr_fn_resc_suite(void)
   tcase_add_test(tc_core, test_two);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_find_resc_def");
+  tcase_add_test(tc_core, test_find_resc_def);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_find_resc_entry");
+  tcase_add_test(tc_core, test_find_resc_entry);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
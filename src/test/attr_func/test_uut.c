@@ -2,6 +2,9 @@
 #include "test_uut.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
 
 #include "attribute.h"
 #include "pbs_error.h"
@@ -113,6 +116,210 @@ START_TEST(test_three)
 END_TEST
 
 
+START_TEST(test_find_attr_index)
+  {
+  attribute_def defs[4];
+  const char   *grown[] = { "Job_Name", "Job_Owner", "job_name", "Account_Name" };
+
+  memset(defs, 0, sizeof(defs));
+
+  for (int i = 0; i < 4; i++)
+    defs[i].at_name = grown[i];
+
+  /* the first of two names that differ only in case wins, as with a scan */
+  fail_unless(find_attr(defs, "JOB_NAME", 4) == 0);
+  fail_unless(find_attr(defs, "account_name", 4) == 3);
+  fail_unless(find_attr(defs, "Account_Name", 3) == -1);
+  fail_unless(find_attr(defs, "Job_Owner", 2) == 1);
+  fail_unless(find_attr(defs, "Job_Owner", 1) == -1);
+  fail_unless(find_attr(defs, "Job", 4) == -1);
+  fail_unless(find_attr(defs, "", 4) == -1);
+  fail_unless(find_attr(defs, NULL, 4) == -1);
+  fail_unless(find_attr(NULL, "Job_Name", 4) == -1);
+
+  /* a different array at the same address */
+  defs[0].at_name = "Priority";
+  defs[3].at_name = "Rerunable";
+  fail_unless(find_attr(defs, "priority", 4) == 0);
+  fail_unless(find_attr(defs, "job_name", 4) == 2);
+  fail_unless(find_attr(defs, "Account_Name", 4) == -1);
+  }
+END_TEST
+
+
+/*
+ * Times looking up the names of a job submission, as decode_attributes_into_job()
+ * does for each attribute it is sent, against a job sized definition array.
+ */
+
+START_TEST(test_find_attr_throughput)
+  {
+  const int      def_count = 120;
+  const int      rounds = 20000;
+  attribute_def  defs[def_count];
+  char           names[def_count][32];
+  const char    *submitted[] = { "Job_Name", "Resource_List", "Resource_List", "Resource_List",
+                                 "Variable_List", "Output_Path", "Error_Path", "Mail_Points",
+                                 "Rerunable", "Checkpoint", "Join_Path", "Keep_Files",
+                                 "submit_args", "init_work_dir", "fault_tolerant", "job_radix" };
+  int            submitted_count = sizeof(submitted) / sizeof(submitted[0]);
+  struct timeval start;
+  struct timeval end;
+  double         scan_time;
+  double         index_time;
+  int            found = 0;
+
+  memset(defs, 0, sizeof(defs));
+
+  /* the submitted names are spread out like they are in job_attr_def */
+  for (int i = 0; i < def_count; i++)
+    {
+    if ((i % 7 == 6) &&
+        (i / 7 < submitted_count))
+      snprintf(names[i], sizeof(names[i]), "%s", submitted[i / 7]);
+    else
+      snprintf(names[i], sizeof(names[i]), "job_attribute_%d", i);
+
+    defs[i].at_name = names[i];
+    }
+
+  gettimeofday(&start, NULL);
+
+  for (int r = 0; r < rounds; r++)
+    {
+    for (int j = 0; j < submitted_count; j++)
+      {
+      for (int i = 0; i < def_count; i++)
+        {
+        if (!strcasecmp(defs[i].at_name, submitted[j]))
+          {
+          found += i;
+          break;
+          }
+        }
+      }
+    }
+
+  gettimeofday(&end, NULL);
+  scan_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+  gettimeofday(&start, NULL);
+
+  for (int r = 0; r < rounds; r++)
+    {
+    for (int j = 0; j < submitted_count; j++)
+      found -= find_attr(defs, submitted[j], def_count);
+    }
+
+  gettimeofday(&end, NULL);
+  index_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+  fprintf(stderr, "%d attribute lookups: scan %.3fs, find_attr %.3fs\n",
+    rounds * submitted_count, scan_time, index_time);
+
+  fail_unless(found == 0);
+  }
+END_TEST
+
+
+START_TEST(test_attrlist_arena)
+  {
+  attrlist_arena *arena = attrlist_arena_create();
+  tlist_head      head;
+  svrattrl       *pal;
+  svrattrl       *big;
+  svrattrl       *plain;
+
+  fail_unless(arena != NULL);
+  fail_unless(attrlist_use_arena(arena) == NULL);
+
+  CLEAR_HEAD(head);
+
+  pal = attrlist_create("Resource_List", "walltime", 9);
+  fail_unless(pal != NULL);
+  fail_unless(pal->al_arena == 1);
+  fail_unless(!strcmp(pal->al_name, "Resource_List"));
+  fail_unless(!strcmp(pal->al_resc, "walltime"));
+  fail_unless(pal->al_value[0] == '\0');
+  fail_unless(((unsigned long)pal % sizeof(void *)) == 0);
+  append_link(&head, &pal->al_link, pal);
+
+  /* bigger than a chunk */
+  big = attrlist_create("Variable_List", NULL, 100000);
+  fail_unless(big != NULL);
+  fail_unless(big->al_arena == 1);
+  memset(big->al_value, 'x', 99999);
+  append_link(&head, &big->al_link, big);
+
+  /* carving continues after the big entry */
+  pal = attrlist_create("Job_Name", NULL, 5);
+  fail_unless(pal->al_arena == 1);
+  fail_unless(pal->al_value[0] == '\0');
+  append_link(&head, &pal->al_link, pal);
+
+  fail_unless(attrlist_use_arena(NULL) == arena);
+
+  plain = attrlist_create("Job_Owner", NULL, 5);
+  fail_unless(plain->al_arena == 0);
+  append_link(&head, &plain->al_link, plain);
+
+  free_attrlist(&head);
+  fail_unless(GET_NEXT(head) == NULL);
+
+  attrlist_arena_free(arena);
+  attrlist_arena_free(NULL);
+  }
+END_TEST
+
+
+START_TEST(test_attrlist_arena_entries_survive_free)
+  {
+  attrlist_arena *arena = attrlist_arena_create();
+  tlist_head      head;
+  svrattrl       *entries[3];
+  svrattrl       *plain;
+  char            value[32];
+
+  CLEAR_HEAD(head);
+
+  attrlist_use_arena(arena);
+
+  for (int i = 0; i < 3; i++)
+    {
+    snprintf(value, sizeof(value), "%d:00:00", i);
+    entries[i] = attrlist_create("Resource_List", "walltime", strlen(value) + 1);
+    fail_unless(entries[i]->al_arena == 1);
+    strcpy(entries[i]->al_value, value);
+    append_link(&head, &entries[i]->al_link, entries[i]);
+    }
+
+  attrlist_use_arena(NULL);
+
+  plain = attrlist_create("Job_Owner", NULL, 5);
+  fail_unless(plain->al_arena == 0);
+  append_link(&head, &plain->al_link, plain);
+
+  /* free_attrlist() unlinks everything but only frees the malloc'd entry */
+  free_attrlist(&head);
+  fail_unless(GET_NEXT(head) == NULL);
+
+  for (int i = 0; i < 3; i++)
+    {
+    snprintf(value, sizeof(value), "%d:00:00", i);
+    fail_unless(!strcmp(entries[i]->al_name, "Resource_List"));
+    fail_unless(!strcmp(entries[i]->al_resc, "walltime"));
+    fail_unless(!strcmp(entries[i]->al_value, value));
+    }
+
+  /* nor does freeing a single entry touch one from the arena */
+  free_attrlist_entry(entries[1]);
+  fail_unless(!strcmp(entries[1]->al_value, "1:00:00"));
+
+  attrlist_arena_free(arena);
+  }
+END_TEST
+
+
 Suite *attr_func_suite(void)
   {
   Suite *s = suite_create("attr_func_suite methods");
@@ -128,6 +335,23 @@ Suite *attr_func_suite(void)
   tcase_add_test(tc_core, test_three);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_find_attr_index");
+  tcase_add_test(tc_core, test_find_attr_index);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_find_attr_throughput");
+  tcase_add_test(tc_core, test_find_attr_throughput);
+  tcase_set_timeout(tc_core, 120);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_attrlist_arena");
+  tcase_add_test(tc_core, test_attrlist_arena);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_attrlist_arena_entries_survive_free");
+  tcase_add_test(tc_core, test_attrlist_arena_entries_survive_free);
+  suite_add_tcase(s, tc_core);
+
 
   return s;
   }
@@ -20,3 +20,9 @@ int tcp_getc(tcp_chan *chan, unsigned int timeout)
   exit(1);
   }
 
+int disrvi_(tcp_chan *chan, int *negate, unsigned *value, unsigned int timeout)
+  {
+  fprintf(stderr, "The call to disrvi_ needs to be mocked!!\n");
+  exit(1);
+  }
+
@@ -27,3 +27,8 @@ char *discul_(char *cp, unsigned long value, unsigned *ndigs)
   return(NULL);
   }
 
+int disrv_(tcp_chan *chan, int *negate, unsigned long *value, unsigned int timeout)
+  {
+  return(0);
+  }
+
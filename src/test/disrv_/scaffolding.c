@@ -0,0 +1,6 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+time_t pbs_tcp_timeout = 300;
@@ -0,0 +1,9 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _DISRV__CT_H
+#define _DISRV__CT_H
+#include <check.h>
+
+#define DISRV__SUITE 1
+Suite *disrv__suite();
+
+#endif /* _DISRV__CT_H */
@@ -0,0 +1,281 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>
+#include "dis.h"
+#include "dis_internal.h"
+#include "lib_ifl.h"
+#include "test_disrv_.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/time.h>
+
+
+#include "pbs_error.h"
+
+/*
+ * Moves what has been written to chan to its read buffer, as if the other end
+ * had sent it back.
+ */
+
+void loop_back(
+
+  struct tcp_chan *chan)
+
+  {
+  struct tcpdisbuf read_buf = chan->readbuf;
+
+  chan->readbuf = chan->writebuf;
+  chan->readbuf.tdis_eod = chan->readbuf.tdis_trailp;
+  chan->readbuf.tdis_leadp = chan->readbuf.tdis_thebuf;
+  chan->readbuf.tdis_trailp = chan->readbuf.tdis_thebuf;
+
+  chan->writebuf = read_buf;
+  DIS_tcp_reset(chan, 1);
+  }
+
+
+void put_bytes(
+
+  struct tcp_chan *chan,
+  const char      *bytes,
+  size_t           len)
+
+  {
+  DIS_tcp_reset(chan, 0);
+  memcpy(chan->readbuf.tdis_thebuf, bytes, len);
+  chan->readbuf.tdis_eod = chan->readbuf.tdis_thebuf + len;
+  }
+
+
+START_TEST(test_round_trip)
+  {
+  struct tcp_chan *chan = DIS_tcp_setup(10);
+  long             values[] = { 0, 1, -1, 63, -64, 64, 8191, 8192, 1 << 20, -2000000000, LONG_MAX, LONG_MIN + 1 };
+  int              count = sizeof(values) / sizeof(values[0]);
+  int              rc;
+
+  chan->dis_version = DIS_VERSION_BINARY;
+
+  for (int i = 0; i < count; i++)
+    fail_unless(diswsl(chan, values[i]) == DIS_SUCCESS);
+
+  fail_unless(diswul(chan, ULONG_MAX) == DIS_SUCCESS);
+  loop_back(chan);
+
+  for (int i = 0; i < count; i++)
+    {
+    fail_unless(disrsl(chan, &rc) == values[i], "value %d was %ld", i, values[i]);
+    fail_unless(rc == DIS_SUCCESS);
+    }
+
+  fail_unless(disrul(chan, &rc) == ULONG_MAX);
+  fail_unless(rc == DIS_SUCCESS);
+
+  DIS_tcp_cleanup(chan);
+  }
+END_TEST
+
+
+START_TEST(test_strings_are_binary_safe)
+  {
+  struct tcp_chan *chan = DIS_tcp_setup(11);
+  const char       bytes[] = { 'a', '\0', (char)0xff, '+', '9' };
+  char            *str;
+  size_t           len;
+  int              rc;
+
+  chan->dis_version = DIS_VERSION_BINARY;
+
+  fail_unless(diswcs(chan, bytes, sizeof(bytes)) == DIS_SUCCESS);
+  fail_unless(diswst(chan, "resources_used.walltime") == DIS_SUCCESS);
+  fail_unless(diswf(chan, 2.5) == DIS_SUCCESS);
+  loop_back(chan);
+
+  str = disrcs(chan, &len, &rc);
+  fail_unless(rc == DIS_SUCCESS);
+  fail_unless(len == sizeof(bytes));
+  fail_unless(memcmp(str, bytes, len) == 0);
+  free(str);
+
+  str = disrst(chan, &rc);
+  fail_unless(rc == DIS_SUCCESS);
+  fail_unless(strcmp(str, "resources_used.walltime") == 0);
+  free(str);
+
+  fail_unless(disrd(chan, &rc) == 2.5);
+  fail_unless(rc == DIS_SUCCESS);
+
+  DIS_tcp_cleanup(chan);
+  }
+END_TEST
+
+
+START_TEST(test_bad_input)
+  {
+  struct tcp_chan *chan = DIS_tcp_setup(12);
+  unsigned long    value;
+  unsigned         ivalue;
+  int              negate;
+
+  /* longer than any unsigned long, even though the value is 0 */
+  put_bytes(chan, "\x80\x80\x80\x80\x80\x80\x80\x80\x80\x80\x00", 11);
+  fail_unless(disrv_(chan, &negate, &value, 0) == DIS_PROTO);
+
+  /* 2^64 */
+  put_bytes(chan, "\x80\x80\x80\x80\x80\x80\x80\x80\x80\x04", 10);
+  fail_unless(disrv_(chan, &negate, &value, 0) == DIS_OVERFLOW);
+  fail_unless(value == ULONG_MAX);
+
+  /* 2^32 */
+  put_bytes(chan, "\x80\x80\x80\x80\x20", 5);
+  fail_unless(disrvi_(chan, &negate, &ivalue, 0) == DIS_OVERFLOW);
+  fail_unless(ivalue == UINT_MAX);
+
+  put_bytes(chan, "\xc7\x05", 2);
+  fail_unless(disrvi_(chan, &negate, &ivalue, 0) == DIS_SUCCESS);
+  fail_unless(negate == TRUE);
+  fail_unless(ivalue == 327);
+
+  DIS_tcp_cleanup(chan);
+  }
+END_TEST
+
+
+START_TEST(test_read_from_socket)
+  {
+  struct tcp_chan *chan = DIS_tcp_setup(13);
+  unsigned long    value;
+  int              negate;
+
+  /* nothing is buffered, so the bytes are read one at a time */
+  chan->dis_version = DIS_VERSION_BINARY;
+  diswul(chan, 1UL << 40);
+  DIS_tcp_wflush(chan);
+
+  fail_unless(disrv_(chan, &negate, &value, 0) == DIS_SUCCESS);
+  fail_unless(negate == FALSE);
+  fail_unless(value == 1UL << 40);
+
+  DIS_tcp_cleanup(chan);
+  }
+END_TEST
+
+
+/*
+ * Encodes and decodes records shaped like a job status attribute: a couple of
+ * integers and a name and value.
+ */
+
+double time_codec(
+
+  struct tcp_chan *chan,
+  int              version,
+  int              records,
+  size_t          *bytes)
+
+  {
+  struct timeval start;
+  struct timeval end;
+  char           value[64];
+  char          *str;
+  int            rc;
+
+  gettimeofday(&start, NULL);
+
+  chan->dis_version = version;
+
+  for (int i = 0; i < records; i++)
+    {
+    snprintf(value, sizeof(value), "%d:%02d:%02d", i / 3600, (i / 60) % 60, i % 60);
+
+    diswui(chan, i);
+    diswsl(chan, -i * 1024L);
+    diswst(chan, "resources_used.walltime");
+    diswst(chan, value);
+    }
+
+  *bytes = chan->writebuf.tdis_trailp - chan->writebuf.tdis_thebuf;
+  loop_back(chan);
+
+  for (int i = 0; i < records; i++)
+    {
+    fail_unless((int)disrui(chan, &rc) == i);
+    fail_unless(disrsl(chan, &rc) == -i * 1024L);
+
+    str = disrst(chan, &rc);
+    free(str);
+    str = disrst(chan, &rc);
+    free(str);
+    }
+
+  gettimeofday(&end, NULL);
+
+  DIS_tcp_reset(chan, 0);
+
+  return((end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0);
+  }
+
+
+START_TEST(test_codec_throughput)
+  {
+  struct tcp_chan *chan = DIS_tcp_setup(14);
+  int              records = 200000;
+  size_t           text_bytes;
+  size_t           binary_bytes;
+  double           text_time = time_codec(chan, DIS_VERSION_TEXT, records, &text_bytes);
+  double           binary_time = time_codec(chan, DIS_VERSION_BINARY, records, &binary_bytes);
+
+  fprintf(stderr, "%d records: text %lu bytes in %.3fs, binary %lu bytes in %.3fs\n",
+    records, text_bytes, text_time, binary_bytes, binary_time);
+
+  fail_unless(binary_bytes < text_bytes);
+
+  DIS_tcp_cleanup(chan);
+  }
+END_TEST
+
+
+Suite *disrv__suite(void)
+  {
+  Suite *s = suite_create("disrv__suite methods");
+  TCase *tc_core = tcase_create("test_round_trip");
+  tcase_add_test(tc_core, test_round_trip);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_strings_are_binary_safe");
+  tcase_add_test(tc_core, test_strings_are_binary_safe);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_bad_input");
+  tcase_add_test(tc_core, test_bad_input);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_read_from_socket");
+  tcase_add_test(tc_core, test_read_from_socket);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_codec_throughput");
+  tcase_add_test(tc_core, test_codec_throughput);
+  tcase_set_timeout(tc_core, 120);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(disrv__suite());
+  srunner_set_log(sr, "disrv__suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return number_failed;
+  }
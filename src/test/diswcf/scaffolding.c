@@ -0,0 +1,33 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+#include "tcp.h"
+#include "dis.h"
+
+std::string output;
+int         put_file_rc = 0;
+int         put_fd = -1;
+off_t       put_offset = 0;
+size_t      put_len = 0;
+int         committed = -1;
+
+int diswui_(tcp_chan *chan, unsigned value)
+  {
+  output += std::to_string(value);
+  return(DIS_SUCCESS);
+  }
+
+int DIS_tcp_put_file(tcp_chan *chan, int fd, off_t offset, size_t len)
+  {
+  put_fd = fd;
+  put_offset = offset;
+  put_len = len;
+  return(put_file_rc);
+  }
+
+int tcp_wcommit(tcp_chan *chan, int commit_flag)
+  {
+  committed = commit_flag;
+  return(0);
+  }
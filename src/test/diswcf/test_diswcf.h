@@ -0,0 +1,11 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _DISWCF_CT_H
+#define _DISWCF_CT_H
+#include <check.h>
+
+#define DISWCF_SUITE 1
+Suite *diswcf_suite();
+#define METH_2 2
+Suite *meth_2_suite();
+
+#endif /* _DISWCF_CT_H */
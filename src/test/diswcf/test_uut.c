@@ -0,0 +1,73 @@
+#include "license_pbs.h" /* See here for the software license */
+#include "dis.h"
+#include "dis_internal.h"
+#include "test_diswcf.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string>
+
+
+#include "pbs_error.h"
+
+extern std::string output;
+extern int         put_file_rc;
+extern int         put_fd;
+extern off_t       put_offset;
+extern size_t      put_len;
+extern int         committed;
+
+START_TEST(test_diswcf)
+  {
+  struct tcp_chan chan;
+
+  output = "";
+  fail_unless(diswcf(&chan, 7, 4096, 123) == DIS_SUCCESS);
+  fail_unless(output == "123");
+  fail_unless(put_fd == 7);
+  fail_unless(put_offset == 4096);
+  fail_unless(put_len == 123);
+  fail_unless(committed == TRUE);
+  }
+END_TEST
+
+START_TEST(test_diswcf_failure)
+  {
+  struct tcp_chan chan;
+
+  put_file_rc = -1;
+  fail_unless(diswcf(&chan, 7, 0, 10) == DIS_PROTO);
+  fail_unless(committed == FALSE);
+  put_file_rc = 0;
+  }
+END_TEST
+
+Suite *diswcf_suite(void)
+  {
+  Suite *s = suite_create("diswcf_suite methods");
+  TCase *tc_core = tcase_create("test_diswcf");
+  tcase_add_test(tc_core, test_diswcf);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_diswcf_failure");
+  tcase_add_test(tc_core, test_diswcf_failure);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(diswcf_suite());
+  srunner_set_log(sr, "diswcf_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return number_failed;
+  }
@@ -26,3 +26,9 @@ char *discul_(char *cp, unsigned long value, unsigned *ndigs)
   fprintf(stderr, "The call to discul_ needs to be mocked!!\n");
   exit(1);
   }
+
+int diswv_(tcp_chan *chan, int negate, unsigned long value)
+  {
+  fprintf(stderr, "The call to diswv_ needs to be mocked!!\n");
+  exit(1);
+  }
@@ -16,3 +16,8 @@ int tcp_wcommit(tcp_chan *chan, int commit_flag)
   {
   return 0;
   }
+
+int diswv_(tcp_chan *chan, int negate, unsigned long value)
+  {
+  return 0;
+  }
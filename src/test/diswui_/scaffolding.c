@@ -14,3 +14,9 @@ char *discui_(char *cp, unsigned value, unsigned *ndigs)
   fprintf(stderr, "The call to discui_ needs to be mocked!!\n");
   exit(1);
   }
+
+int diswv_(tcp_chan *chan, int negate, unsigned long value)
+  {
+  fprintf(stderr, "The call to diswv_ needs to be mocked!!\n");
+  exit(1);
+  }
@@ -0,0 +1,9 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _DISWV__CT_H
+#define _DISWV__CT_H
+#include <check.h>
+
+#define DISWV__SUITE 1
+Suite *diswv__suite();
+
+#endif /* _DISWV__CT_H */
@@ -0,0 +1,93 @@
+#include "license_pbs.h" /* See here for the software license */
+#include "dis_internal.h"
+#include "test_diswv_.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <string>
+
+
+#include "pbs_error.h"
+
+extern std::string output;
+
+START_TEST(test_small_values)
+  {
+  struct tcp_chan chan;
+
+  output = "";
+  fail_unless(diswv_(&chan, FALSE, 0) == DIS_SUCCESS);
+  fail_unless(output == std::string("\x00", 1));
+
+  output = "";
+  diswv_(&chan, FALSE, 63);
+  fail_unless(output == "\x3f");
+
+  output = "";
+  diswv_(&chan, TRUE, 1);
+  fail_unless(output == "\x41");
+
+  output = "";
+  diswv_(&chan, TRUE, 63);
+  fail_unless(output == "\x7f");
+  }
+END_TEST
+
+START_TEST(test_large_values)
+  {
+  struct tcp_chan chan;
+
+  output = "";
+  diswv_(&chan, FALSE, 64);
+  fail_unless(output == std::string("\x80\x01", 2));
+
+  output = "";
+  diswv_(&chan, TRUE, 327);
+  fail_unless(output == std::string("\xc7\x05", 2), "327 is 7 + (5 << 6)");
+
+  output = "";
+  diswv_(&chan, FALSE, 8191);
+  fail_unless(output == std::string("\xbf\x7f", 2));
+
+  output = "";
+  diswv_(&chan, FALSE, 8192);
+  fail_unless(output == std::string("\x80\x80\x01", 3));
+
+  output = "";
+  diswv_(&chan, FALSE, ULONG_MAX);
+  fail_unless(output.size() == DIS_VARINT_MAX);
+  fail_unless(output[0] == (char)0xbf);
+  fail_unless(output[DIS_VARINT_MAX - 1] == 0x03);
+  }
+END_TEST
+
+Suite *diswv__suite(void)
+  {
+  Suite *s = suite_create("diswv__suite methods");
+  TCase *tc_core = tcase_create("test_small_values");
+  tcase_add_test(tc_core, test_small_values);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_large_values");
+  tcase_add_test(tc_core, test_large_values);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(diswv__suite());
+  srunner_set_log(sr, "diswv__suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return number_failed;
+  }
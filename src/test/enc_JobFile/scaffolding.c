@@ -14,3 +14,9 @@ int diswui(tcp_chan *chan, unsigned value)
   fprintf(stderr, "The call to diswui needs to be mocked!!\n");
   exit(1);
   }
+
+int diswcf(tcp_chan *chan, int fd, off_t offset, size_t nchars)
+  {
+  fprintf(stderr, "The call to diswcf needs to be mocked!!\n");
+  exit(1);
+  }
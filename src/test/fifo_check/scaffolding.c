@@ -0,0 +1,38 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "data_types.h"
+#include "globals.h"
+
+const struct rescheck res_to_check[] = { { "", "", "" } };
+const int num_res = 0;
+struct config conf;
+struct status cstat;
+
+resource *find_resource(resource *reslist, const char *name)
+  {
+  return(NULL);
+  }
+
+resource_req *find_resource_req(resource_req *reqlist, const char *name)
+  {
+  return(NULL);
+  }
+
+token *get_token(char *token_string)
+  {
+  fprintf(stderr, "The call to get_token needs to be mocked!!\n");
+  exit(1);
+  }
+
+void free_token(token *token_ptr) {}
+
+void token_account_record(int acctype, char *job_id, char *text) {}
+
+void sched_log(int event, int cls, const char *name, const char *text) {}
+
+int pbs_rescquery(int connect, char **rlist, int nresc, int *avail, int *alloc, int *resv, int *down)
+  {
+  return(0);
+  }
@@ -0,0 +1,207 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "data_types.h"
+#include "check.h"
+#include "test_fifo_check.h"
+
+
+job_info *new_test_job(
+
+  const char *account,
+  const char *group)
+
+  {
+  job_info *jinfo = (job_info *)calloc(1, sizeof(job_info));
+
+  jinfo->account = strdup(account);
+  jinfo->group = strdup(group);
+
+  return(jinfo);
+  }
+
+
+START_TEST(test_running_job_counts)
+  {
+  job_info   *jobs[5];
+  run_counts *users = NULL;
+  run_counts *groups = NULL;
+
+  jobs[0] = new_test_job("dbeer", "staff");
+  jobs[1] = new_test_job("dbeer", "staff");
+  jobs[2] = new_test_job("kaladin", "bridge4");
+  jobs[3] = new_test_job("shallan", "staff");
+  jobs[4] = NULL;
+
+  count_running_jobs(jobs, &users, &groups);
+
+  fail_unless(running_job_count(users, "dbeer") == 2);
+  fail_unless(running_job_count(users, "kaladin") == 1);
+  fail_unless(running_job_count(users, "nobody") == 0);
+  fail_unless(running_job_count(groups, "staff") == 3);
+  fail_unless(running_job_count(groups, "bridge4") == 1);
+  fail_unless(running_job_count(NULL, "staff") == 0);
+
+  // the counts agree with scanning the array
+  fail_unless(running_job_count(users, "dbeer") == count_by_user(jobs, (char *)"dbeer"));
+  fail_unless(running_job_count(groups, "staff") == count_by_group(jobs, (char *)"staff"));
+
+  delete users;
+  delete groups;
+
+  count_running_jobs(NULL, &users, &groups);
+  fail_unless(users->size() == 0);
+  fail_unless(groups->size() == 0);
+  }
+END_TEST
+
+
+START_TEST(test_add_running_job)
+  {
+  server_info  sinfo;
+  job_info    *jinfo = new_test_job("dbeer", "staff");
+
+  memset(&sinfo, 0, sizeof(sinfo));
+  sinfo.max_user_run = 1;
+  sinfo.max_group_run = 2;
+
+  count_running_jobs(NULL, &sinfo.user_running, &sinfo.group_running);
+  fail_unless(check_server_max_user_run(&sinfo, (char *)"dbeer") == 0);
+
+  sinfo.running_jobs = add_running_job(sinfo.running_jobs, sinfo.user_running, sinfo.group_running, jinfo);
+  fail_unless(sinfo.running_jobs != NULL);
+  fail_unless(sinfo.running_jobs[0] == jinfo);
+  fail_unless(sinfo.running_jobs[1] == NULL);
+
+  // the limits see the job right away
+  fail_unless(check_server_max_user_run(&sinfo, (char *)"dbeer") == SERVER_USER_LIMIT_REACHED);
+  fail_unless(check_server_max_group_run(&sinfo, (char *)"staff") == 0);
+
+  sinfo.running_jobs = add_running_job(sinfo.running_jobs, sinfo.user_running, sinfo.group_running,
+                                       new_test_job("shallan", "staff"));
+  fail_unless(sinfo.running_jobs[2] == NULL);
+  fail_unless(check_server_max_group_run(&sinfo, (char *)"staff") == SERVER_GROUP_LIMIT_REACHED);
+  fail_unless(check_server_max_user_run(&sinfo, (char *)"shallan") == SERVER_USER_LIMIT_REACHED);
+  fail_unless(check_server_max_user_run(&sinfo, (char *)"kaladin") == 0);
+  }
+END_TEST
+
+
+#define BENCH_JOBS    50000
+#define BENCH_RUNNING 5000
+#define BENCH_USERS   500
+#define BENCH_GROUPS  50
+
+/*
+ * microbenchmark: the user and group run limit checks of one scheduling cycle
+ * over a synthetic 50000 job queue, counted by scanning the running jobs for
+ * every job compared with the counts built once per cycle
+ */
+
+START_TEST(run_limit_cycle_benchmark)
+  {
+  job_info      **jobs = (job_info **)calloc(BENCH_JOBS + 1, sizeof(job_info *));
+  job_info      **running = (job_info **)calloc(BENCH_RUNNING + 1, sizeof(job_info *));
+  server_info     sinfo;
+  queue_info      qinfo;
+  struct timeval  start;
+  struct timeval  end;
+  char            name[64];
+  int             scanned = 0;
+  int             counted = 0;
+  double          scan_time;
+  double          count_time;
+
+  for (int i = 0; i < BENCH_JOBS; i++)
+    {
+    char group[64];
+
+    snprintf(name, sizeof(name), "user%d", i % BENCH_USERS);
+    snprintf(group, sizeof(group), "group%d", i % BENCH_GROUPS);
+    jobs[i] = new_test_job(name, group);
+
+    if (i < BENCH_RUNNING)
+      running[i] = jobs[i];
+    }
+
+  memset(&sinfo, 0, sizeof(sinfo));
+  memset(&qinfo, 0, sizeof(qinfo));
+  sinfo.running_jobs = running;
+  qinfo.running_jobs = running;
+  sinfo.max_user_run = qinfo.max_user_run = 25;
+  sinfo.max_group_run = qinfo.max_group_run = 250;
+
+  gettimeofday(&start, NULL);
+
+  for (int i = BENCH_RUNNING; i < BENCH_JOBS; i++)
+    {
+    if ((count_by_user(sinfo.running_jobs, jobs[i]->account) < sinfo.max_user_run) &&
+        (count_by_user(qinfo.running_jobs, jobs[i]->account) < qinfo.max_user_run) &&
+        (count_by_group(qinfo.running_jobs, jobs[i]->group) < qinfo.max_group_run) &&
+        (count_by_group(sinfo.running_jobs, jobs[i]->group) < sinfo.max_group_run))
+      scanned++;
+    }
+
+  gettimeofday(&end, NULL);
+  scan_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+  gettimeofday(&start, NULL);
+
+  count_running_jobs(sinfo.running_jobs, &sinfo.user_running, &sinfo.group_running);
+  count_running_jobs(qinfo.running_jobs, &qinfo.user_running, &qinfo.group_running);
+
+  for (int i = BENCH_RUNNING; i < BENCH_JOBS; i++)
+    {
+    if ((check_server_max_user_run(&sinfo, jobs[i]->account) == 0) &&
+        (check_queue_max_user_run(&qinfo, jobs[i]->account) == 0) &&
+        (check_queue_max_group_run(&qinfo, jobs[i]->group) == 0) &&
+        (check_server_max_group_run(&sinfo, jobs[i]->group) == 0))
+      counted++;
+    }
+
+  gettimeofday(&end, NULL);
+  count_time = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+  fail_unless(counted == scanned);
+
+  fprintf(stderr, "run limit checks for %d jobs with %d running: scanning %.3f sec, counts %.3f sec\n",
+    BENCH_JOBS - BENCH_RUNNING, BENCH_RUNNING, scan_time, count_time);
+  }
+END_TEST
+
+
+Suite *fifo_check_suite(void)
+  {
+  Suite *s = suite_create("fifo_check_suite methods");
+  TCase *tc_core = tcase_create("test_running_job_counts");
+  tcase_add_test(tc_core, test_running_job_counts);
+  tcase_add_test(tc_core, test_add_running_job);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("run_limit_cycle_benchmark");
+  tcase_add_test(tc_core, run_limit_cycle_benchmark);
+  tcase_set_timeout(tc_core, 120);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(fifo_check_suite());
+  srunner_set_log(sr, "fifo_check_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
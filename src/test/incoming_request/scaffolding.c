@@ -66,6 +66,11 @@ int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *t
   return(0);
   }
 
+int enqueue_threadpool_request_lane(void *(*func)(void *), void *arg, threadpool_t *tp, int lane)
+  {
+  return(0);
+  }
+
 threadpool_t *request_pool;
 
 bool threadpool_is_too_busy(threadpool_t *tp, int perm)
@@ -1,5 +1,6 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <string>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
 #include <pthread.h>
@@ -97,22 +98,26 @@ int encode_DIS_ReturnFiles(struct tcp_chan *chan, struct batch_request *preq)
   return(0);
   }
 
+int        immediate_tasks = 0;
+work_task *last_immediate_task = NULL;
+
 int enqueue_threadpool_request(
 
   void *(*func)(void *),
   void *arg)
   
   {
+  immediate_tasks++;
+  last_immediate_task = (work_task *)arg;
   return(PBSE_NONE);
   }
 
 
-int insert_timed_task(
+void insert_timed_task(
 
     work_task *wt)
 
   {
-  return(PBSE_NONE);
   }
 
 
@@ -237,8 +242,11 @@ int dispatch_task(struct work_task *ptask)
   return(0);
   }
 
+std::vector<batch_request *> dispatched;
+
 int dispatch_request(int sfds, struct batch_request *request)
   {
+  dispatched.push_back(request);
   return(PBSE_NONE);
   }
 
@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 
 #include <string>
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -15,6 +16,9 @@ bool net_rc_retry;
 bool connect_error;
 
 extern std::string rq_id_str;
+extern int immediate_tasks;
+extern work_task *last_immediate_task;
+extern std::vector<batch_request *> dispatched;
 void queue_a_retry_task(batch_request *preq, void (*replyfunc)(struct work_task *));
 int send_request_to_remote_server(int conn, batch_request *request, bool close_handle);
 int issue_Drequest(int conn, batch_request *request, bool close_handle);
@@ -213,6 +217,48 @@ START_TEST(test_handle_local_request)
   }
 END_TEST
 
+START_TEST(test_que_to_local_svr_batch)
+  {
+  std::vector<batch_request *> requests;
+  std::vector<batch_request *> queued;
+
+  immediate_tasks = 0;
+  dispatched.clear();
+
+  fail_unless(que_to_local_svr_batch(requests) == PBSE_NONE);
+  fail_unless(immediate_tasks == 0);
+
+  for (int i = 0; i < 3; i++)
+    requests.push_back(alloc_br(PBS_BATCH_RegistDep));
+  queued = requests;
+
+  fail_unless(que_to_local_svr_batch(requests) == PBSE_NONE);
+  fail_unless(requests.size() == 0);
+  fail_unless(immediate_tasks == 1);
+
+  /* a task is already pending, so it picks these up too */
+  requests.push_back(alloc_br(PBS_BATCH_RegistDep));
+  queued.push_back(requests[0]);
+  fail_unless(que_to_local_svr_batch(requests) == PBSE_NONE);
+  fail_unless(immediate_tasks == 1);
+
+  handle_local_requests(last_immediate_task);
+  fail_unless(dispatched == queued);
+  fail_unless(queued[3]->rq_fromsvr == 1);
+  fail_unless(queued[3]->rq_conn == PBS_LOCAL_CONNECTION);
+
+  /* the queue was emptied, so the next batch starts a new task */
+  requests.push_back(alloc_br(PBS_BATCH_RegistDep));
+  fail_unless(que_to_local_svr_batch(requests) == PBSE_NONE);
+  fail_unless(immediate_tasks == 2);
+  handle_local_requests(last_immediate_task);
+  fail_unless(dispatched.size() == 5);
+
+  for (unsigned int i = 0; i < dispatched.size(); i++)
+    free_br(dispatched[i]);
+  }
+END_TEST
+
 START_TEST(test_issue_Drequest)
   {
   int rc;
@@ -315,6 +361,10 @@ Suite *issue_request_suite(void)
   tc_core = tcase_create("test_handle_local_request");
   tcase_add_test(tc_core, test_handle_local_request);
   suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_que_to_local_svr_batch");
+  tcase_add_test(tc_core, test_que_to_local_svr_batch);
+  suite_add_tcase(s, tc_core);
   
   tc_core = tcase_create("test_issue_Drequest");
   tcase_add_test(tc_core, test_issue_Drequest);
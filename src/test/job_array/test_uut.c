@@ -122,11 +122,9 @@ START_TEST(test_parse_array_request)
 
   pa.ai_qs.idle_slot_limit = 2;
   pa.ai_qs.num_idle = 0;
-  int internal_index = -1;
 
   // It should tell us to create sub job 0 next
-  fail_unless(pa.get_next_index_to_create(internal_index) == 0);
-  fail_unless(internal_index == 0);
+  fail_unless(pa.get_next_index_to_create() == 0);
 
   // Make sure we'll create a job
   pa.create_job_if_needed();
@@ -135,6 +133,49 @@ START_TEST(test_parse_array_request)
   pa.create_job_if_needed();
   fail_unless(pa.job_ids[1] != NULL);
   fail_unless(pa.ai_qs.highest_id_created == 1);
+  fail_unless(pa.uncreated_ids.size() == 8);
+
+  // the size comes from the largest index, not the last one
+  job_array pb;
+  fail_unless(pb.parse_array_request("5,1-3") == PBSE_NONE);
+  fail_unless(pb.ai_qs.array_size == 6);
+  fail_unless(pb.ai_qs.num_jobs == 4);
+  }
+END_TEST
+
+
+START_TEST(test_array_index_ranges)
+  {
+  array_index_ranges ranges;
+
+  fail_unless(ranges.front() == -1);
+  fail_unless(ranges.parse("nope", -1) != PBSE_NONE);
+
+  // a large array is held as its ranges and handed out in request order
+  fail_unless(ranges.parse("0-99999", -1) == PBSE_NONE);
+  fail_unless(ranges.size() == 100000);
+  fail_unless(ranges.highest() == 99999);
+
+  fail_unless(ranges.parse("10-12,3, 7-8,20-19", -1) == PBSE_NONE);
+  fail_unless(ranges.size() == 6);
+  fail_unless(ranges.highest() == 12);
+
+  int expected[] = {10, 11, 12, 3, 7, 8};
+  for (int i = 0; i < 6; i++)
+    {
+    fail_unless(ranges.front() == expected[i]);
+    ranges.pop_front();
+    }
+
+  fail_unless(ranges.front() == -1);
+  fail_unless(ranges.size() == 0);
+  ranges.pop_front();
+  fail_unless(ranges.size() == 0);
+
+  // indices at or below the highest created are dropped
+  fail_unless(ranges.parse("0-9,4,12", 4) == PBSE_NONE);
+  fail_unless(ranges.size() == 6);
+  fail_unless(ranges.front() == 5);
   }
 END_TEST
 
@@ -203,6 +244,7 @@ Suite *job_array_suite(void)
   tcase_add_test(tc_core, update_array_values_test);
   tcase_add_test(tc_core, test_set_slot_limit);
   tcase_add_test(tc_core, test_initialize_uncreated_ids);
+  tcase_add_test(tc_core, test_array_index_ranges);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -0,0 +1,3 @@
+#include "job_change_log.hpp"
+
+job_change_log job_changes;
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+#include "job_change_log.hpp"
+#include "pbs_error.h"
+
+
+START_TEST(test_generations)
+  {
+  job_change_log log;
+  unsigned long  first;
+
+  fail_unless(log.current() == 0);
+
+  first = log.mark_changed();
+  fail_unless(first == 1);
+  fail_unless(log.mark_changed() == first + 1);
+  fail_unless(log.current() == first + 1);
+
+  // removals are changes too
+  log.mark_removed("1.napali");
+  fail_unless(log.current() == first + 2);
+  }
+END_TEST
+
+
+START_TEST(test_removed_since)
+  {
+  job_change_log           log;
+  std::vector<std::string> ids;
+  time_t                   started = log.started();
+
+  log.mark_changed();
+  log.mark_removed("1.napali");
+  log.mark_changed();
+  log.mark_removed("2.napali");
+
+  fail_unless(log.removed_since(started, 0, ids) == true);
+  fail_unless(ids.size() == 2);
+  fail_unless(ids[0] == "2.napali");
+  fail_unless(ids[1] == "1.napali");
+
+  // only the removals after the generation given
+  ids.clear();
+  fail_unless(log.removed_since(started, 2, ids) == true);
+  fail_unless(ids.size() == 1);
+  fail_unless(ids[0] == "2.napali");
+
+  ids.clear();
+  fail_unless(log.removed_since(started, log.current(), ids) == true);
+  fail_unless(ids.size() == 0);
+
+  // a generation from another run of the server
+  fail_unless(log.removed_since(started + 1, 2, ids) == false);
+  fail_unless(log.removed_since(started, log.current() + 1, ids) == false);
+  }
+END_TEST
+
+
+START_TEST(test_forgotten_removals)
+  {
+  job_change_log           log(2);
+  std::vector<std::string> ids;
+  time_t                   started = log.started();
+
+  log.mark_removed("1.napali");
+  log.mark_removed("2.napali");
+  log.mark_removed("3.napali");
+
+  // 1.napali was forgotten, so anything from before it needs a full status
+  fail_unless(log.removed_since(started, 0, ids) == false);
+
+  fail_unless(log.removed_since(started, 1, ids) == true);
+  fail_unless(ids.size() == 2);
+  }
+END_TEST
+
+
+Suite *job_change_log_suite(void)
+  {
+  Suite *s = suite_create("job_change_log test suite methods");
+  TCase *tc_core = tcase_create("test_generations");
+  tcase_add_test(tc_core, test_generations);
+  suite_add_tcase(s, tc_core);
+  
+  tc_core = tcase_create("test_removed_since");
+  tcase_add_test(tc_core, test_removed_since);
+  tcase_add_test(tc_core, test_forgotten_removals);
+  suite_add_tcase(s, tc_core);
+  
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(job_change_log_suite());
+  srunner_set_log(sr, "job_change_log_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
@@ -62,5 +62,11 @@ const char *id_map::get_name(int id)
   return(NULL);
   }
 
-job::job() {}
+job::job()
+  {
+  ji_cray_clone = NULL;
+  ji_mutex = NULL;
+  ji_being_recycled = false;
+  }
+
 job::~job() {}
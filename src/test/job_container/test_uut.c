@@ -4,8 +4,14 @@
 #include "pbs_job.h"
 #include "pbs_error.h"
 #include <check.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <map>
+#include <string>
 
 char *get_correct_jobname(const char *jobid);
+job  *find_job_by_array(all_jobs *aj, const char *job_id, int get_subjob, bool locked);
 
 void log_err(int,const char *,const char *)
 {}
@@ -42,6 +48,18 @@ START_TEST(swap_jobs_test)
   insert_job(&alljobs, second_test_job);
   result = swap_jobs(&alljobs, test_job,second_test_job);
   fail_unless(result == PBSE_NONE, "swap jobs fail");
+
+  /* both jobs are still found by id, and removing one leaves the other */
+  alljobs.lock();
+  fail_unless(alljobs.find("test") == test_job);
+  fail_unless(alljobs.find("second_test") == second_test_job);
+  fail_unless(alljobs.remove("test") == true);
+  fail_unless(alljobs.find("test") == NULL);
+  fail_unless(alljobs.find("second_test") == second_test_job);
+  fail_unless(alljobs.remove("second_test") == true);
+  fail_unless(alljobs.find("second_test") == NULL);
+  fail_unless(alljobs.count() == 0);
+  alljobs.unlock();
   }
 END_TEST
 
@@ -226,6 +244,49 @@ START_TEST(next_job_test)
   }
 END_TEST
 
+START_TEST(get_iterator_after_test)
+  {
+  all_jobs           aj;
+  all_jobs_iterator *iter;
+  char               id[PBS_MAXSVRJOBID + 1];
+
+  for (int i = 0; i < 5; i++)
+    {
+    job *pjob = job_alloc();
+    snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "%d.napali", i);
+    insert_job(&aj, pjob);
+    }
+
+  aj.lock();
+  fail_unless(aj.get_iterator_after("9.napali") == NULL);
+  iter = aj.get_iterator_after("2.napali");
+  aj.unlock();
+
+  fail_unless(iter != NULL);
+
+  /* resumes with the job after 2.napali */
+  for (int i = 3; i < 5; i++)
+    {
+    job *pjob = next_job(&aj, iter);
+
+    snprintf(id, sizeof(id), "%d.napali", i);
+    fail_unless(pjob != NULL);
+    fail_unless(!strcmp(pjob->ji_qs.ji_jobid, id), "got %s, expected %s", pjob->ji_qs.ji_jobid, id);
+    }
+
+  fail_unless(next_job(&aj, iter) == NULL);
+  delete iter;
+
+  /* nothing follows the last job */
+  aj.lock();
+  iter = aj.get_iterator_after("4.napali");
+  aj.unlock();
+
+  fail_unless(next_job(&aj, iter) == NULL);
+  delete iter;
+  }
+END_TEST
+
 START_TEST(find_job_by_array_with_removed_record_test)
   {
   int result;
@@ -258,6 +319,393 @@ START_TEST(find_job_by_array_with_removed_record_test)
   }
 END_TEST
 
+
+START_TEST(find_job_by_array_sharded_lookup_test)
+  {
+  all_jobs  alljobs;
+  char      jobid[PBS_MAXSVRJOBID + 1];
+  job      *pjob;
+
+  for (int i = 0; i < 100; i++)
+    {
+    pjob = job_alloc();
+    snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "%d.napali", i);
+    fail_unless(insert_job(&alljobs, pjob) == PBSE_NONE);
+    }
+
+  for (int i = 0; i < 100; i++)
+    {
+    snprintf(jobid, sizeof(jobid), "%d.napali", i);
+    pjob = find_job_by_array(&alljobs, jobid, FALSE, false);
+    fail_unless(pjob != NULL, "couldn't find %s", jobid);
+    fail_unless(!strcmp(pjob->ji_qs.ji_jobid, jobid));
+    fail_unless(find_job_by_array(&alljobs, jobid, FALSE, true) == pjob);
+    }
+
+  fail_unless(find_job_by_array(&alljobs, "100.napali", FALSE, false) == NULL);
+
+  /* removal and popping must also drop the job from the index */
+  pjob = find_job_by_array(&alljobs, "42.napali", FALSE, false);
+  fail_unless(remove_job(&alljobs, pjob) == PBSE_NONE);
+  fail_unless(find_job_by_array(&alljobs, "42.napali", FALSE, false) == NULL);
+
+  alljobs.lock();
+  pjob = alljobs.pop();
+  alljobs.unlock();
+  fail_unless(!strcmp(pjob->ji_qs.ji_jobid, "0.napali"));
+  fail_unless(find_job_by_array(&alljobs, "0.napali", FALSE, false) == NULL);
+
+  alljobs.lock();
+  alljobs.clear();
+  alljobs.unlock();
+  fail_unless(find_job_by_array(&alljobs, "1.napali", FALSE, false) == NULL);
+  }
+END_TEST
+
+
+START_TEST(container_open_addressing_test)
+  {
+  all_jobs  alljobs;
+  char      jobid[PBS_MAXSVRJOBID + 1];
+  job      *jobs[1000];
+
+  alljobs.lock();
+
+  /* misses must not add anything to the container */
+  for (int i = 0; i < 1000; i++)
+    {
+    snprintf(jobid, sizeof(jobid), "%d.bogus", i);
+    fail_unless(alljobs.find(jobid) == NULL);
+    fail_unless(alljobs.remove(jobid) == false);
+    }
+  fail_unless(alljobs.count() == 0);
+
+  for (int i = 0; i < 1000; i++)
+    {
+    jobs[i] = job_alloc();
+    snprintf(jobs[i]->ji_qs.ji_jobid, sizeof(jobs[i]->ji_qs.ji_jobid), "%d.napali", i);
+    fail_unless(alljobs.insert(jobs[i], jobs[i]->ji_qs.ji_jobid) == true);
+    }
+  fail_unless(alljobs.count() == 1000);
+  fail_unless(alljobs.insert(jobs[5], jobs[5]->ji_qs.ji_jobid) == false);
+
+  /* churn the table so that removed entries have to be skipped and reused */
+  for (int round = 0; round < 5; round++)
+    {
+    for (int i = 0; i < 1000; i += 2)
+      fail_unless(alljobs.remove(jobs[i]->ji_qs.ji_jobid) == true);
+
+    for (int i = 0; i < 1000; i++)
+      {
+      if (i % 2 == 0)
+        fail_unless(alljobs.find(jobs[i]->ji_qs.ji_jobid) == NULL);
+      else
+        fail_unless(alljobs.find(jobs[i]->ji_qs.ji_jobid) == jobs[i]);
+      }
+
+    for (int i = 0; i < 1000; i += 2)
+      fail_unless(alljobs.insert(jobs[i], jobs[i]->ji_qs.ji_jobid) == true);
+    }
+
+  fail_unless(alljobs.count() == 1000);
+  for (int i = 0; i < 1000; i++)
+    fail_unless(alljobs.find(std::string(jobs[i]->ji_qs.ji_jobid)) == jobs[i]);
+
+  fail_unless(alljobs.swap(jobs[1]->ji_qs.ji_jobid, jobs[2]->ji_qs.ji_jobid) == true);
+  fail_unless(alljobs.find(jobs[1]->ji_qs.ji_jobid) == jobs[1]);
+  fail_unless(alljobs.find(jobs[2]->ji_qs.ji_jobid) == jobs[2]);
+
+  fail_unless(alljobs.insert_after(jobs[3]->ji_qs.ji_jobid, jobs[3], "after.napali") == true);
+  fail_unless(alljobs.find("after.napali") == jobs[3]);
+  fail_unless(alljobs.insert_before("nowhere.napali", jobs[3], "before.napali") == false);
+  fail_unless(alljobs.find("before.napali") == NULL);
+
+  alljobs.clear();
+  fail_unless(alljobs.find(jobs[7]->ji_qs.ji_jobid) == NULL);
+  alljobs.unlock();
+  }
+END_TEST
+
+
+
+START_TEST(insert_by_rank_test)
+  {
+  all_jobs             aj;
+  all_jobs_iterator   *iter;
+  job                 *jobs[8];
+  job                 *pjob;
+  long                 ranks[] = { 50, 10, 30, 30, 70, 20, 60, 40 };
+  const char          *order[] = { "1.napali", "5.napali", "3.napali", "2.napali", "7.napali", "0.napali", "6.napali", "4.napali" };
+  int                  i = 0;
+
+  aj.lock();
+
+  for (i = 0; i < 8; i++)
+    {
+    jobs[i] = job_alloc();
+    snprintf(jobs[i]->ji_qs.ji_jobid, sizeof(jobs[i]->ji_qs.ji_jobid), "%d.napali", i);
+    fail_unless(aj.insert_by_rank(jobs[i], jobs[i]->ji_qs.ji_jobid, ranks[i]) == PBSE_NONE);
+    }
+
+  fail_unless(aj.insert_by_rank(jobs[3], jobs[3]->ji_qs.ji_jobid, 30) == ALREADY_IN_LIST);
+
+  /* ascending rank, and a job goes ahead of those already there with its rank */
+  iter = aj.get_iterator();
+  for (i = 0; (pjob = iter->get_next_item()) != NULL; i++)
+    fail_unless(strcmp(pjob->ji_qs.ji_jobid, order[i]) == 0, "%d was %s", i, pjob->ji_qs.ji_jobid);
+  delete iter;
+  fail_unless(i == 8);
+
+  /* removed jobs no longer anchor an insert */
+  fail_unless(aj.remove(jobs[0]->ji_qs.ji_jobid) == true);
+  fail_unless(aj.insert_by_rank(jobs[0], "late.napali", 55) == PBSE_NONE);
+  iter = aj.get_iterator();
+  while ((pjob = iter->get_next_item()) != NULL)
+    if (pjob == jobs[0])
+      break;
+  fail_unless(iter->get_next_item() == jobs[6]);
+  delete iter;
+
+  /* a swap exchanges ranks, so later inserts still land in order */
+  fail_unless(aj.swap(jobs[1]->ji_qs.ji_jobid, jobs[4]->ji_qs.ji_jobid) == true);
+  fail_unless(aj.insert_by_rank(jobs[1], "first.napali", 15) == PBSE_NONE);
+  iter = aj.get_iterator();
+  fail_unless(iter->get_next_item() == jobs[4]);
+  fail_unless(iter->get_next_item() == jobs[1]);
+  delete iter;
+
+  aj.clear();
+  fail_unless(aj.insert_by_rank(jobs[2], jobs[2]->ji_qs.ji_jobid, 100) == PBSE_NONE);
+  fail_unless(aj.insert_by_rank(jobs[3], jobs[3]->ji_qs.ji_jobid, 1) == PBSE_NONE);
+  iter = aj.get_iterator();
+  fail_unless(iter->get_next_item() == jobs[3]);
+  fail_unless(iter->get_next_item() == jobs[2]);
+  delete iter;
+
+  aj.unlock();
+  }
+END_TEST
+
+
+
+/*
+ * checks that aj is in ascending qrank order and that jobs with the same
+ * qrank are newest first, going by when each was inserted. Returns how many
+ * jobs aj holds.
+ */
+
+int check_rank_order(
+
+  all_jobs                   &aj,
+  std::map<std::string, int> &inserted_at)
+
+  {
+  all_jobs_iterator *iter = aj.get_iterator();
+  job               *pjob;
+  job               *prev = NULL;
+  int                count = 0;
+
+  while ((pjob = iter->get_next_item()) != NULL)
+    {
+    if (prev != NULL)
+      {
+      long prev_rank = prev->ji_wattr[JOB_ATR_qrank].at_val.at_long;
+      long rank = pjob->ji_wattr[JOB_ATR_qrank].at_val.at_long;
+
+      fail_unless(prev_rank <= rank, "%s (%ld) ahead of %s (%ld)",
+        prev->ji_qs.ji_jobid, prev_rank, pjob->ji_qs.ji_jobid, rank);
+
+      if (prev_rank == rank)
+        fail_unless(inserted_at[prev->ji_qs.ji_jobid] > inserted_at[pjob->ji_qs.ji_jobid]);
+      }
+
+    prev = pjob;
+    count++;
+    }
+
+  delete iter;
+
+  return(count);
+  }
+
+
+
+START_TEST(insert_by_rank_order_test)
+  {
+  all_jobs                    aj;
+  job                        *jobs[200];
+  std::map<std::string, int>  inserted_at;
+  int                         queued = 0;
+  int                         count = 200;
+  int                         inserted = 0;
+
+  for (int i = 0; i < count; i++)
+    {
+    jobs[i] = job_alloc();
+    snprintf(jobs[i]->ji_qs.ji_jobid, sizeof(jobs[i]->ji_qs.ji_jobid), "%d.napali", i);
+    /* mostly increasing, as qrank is, with repeats and jobs requeued behind others */
+    jobs[i]->ji_wattr[JOB_ATR_qrank].at_val.at_long = (i % 7 == 0) ? i / 3 : i - (i % 3);
+    }
+
+  aj.lock();
+
+  for (int i = 0; i < count; i++)
+    {
+    inserted_at[jobs[i]->ji_qs.ji_jobid] = inserted++;
+    fail_unless(aj.insert_by_rank(jobs[i], jobs[i]->ji_qs.ji_jobid,
+      jobs[i]->ji_wattr[JOB_ATR_qrank].at_val.at_long) == PBSE_NONE);
+    queued++;
+
+    /* dequeue some jobs along the way, and requeue a few of them */
+    if (i % 5 == 4)
+      {
+      fail_unless(aj.remove(jobs[i - 2]->ji_qs.ji_jobid) == true);
+      queued--;
+
+      if (i % 10 == 9)
+        {
+        inserted_at[jobs[i - 2]->ji_qs.ji_jobid] = inserted++;
+        fail_unless(aj.insert_by_rank(jobs[i - 2], jobs[i - 2]->ji_qs.ji_jobid,
+          jobs[i - 2]->ji_wattr[JOB_ATR_qrank].at_val.at_long) == PBSE_NONE);
+        queued++;
+        }
+      }
+
+    fail_unless(check_rank_order(aj, inserted_at) == queued);
+    }
+
+  /* qorder swaps the jobs' qranks along with their places */
+  long rank = jobs[10]->ji_wattr[JOB_ATR_qrank].at_val.at_long;
+  int  order = inserted_at["10.napali"];
+  jobs[10]->ji_wattr[JOB_ATR_qrank].at_val.at_long = jobs[150]->ji_wattr[JOB_ATR_qrank].at_val.at_long;
+  inserted_at["10.napali"] = inserted_at["150.napali"];
+  jobs[150]->ji_wattr[JOB_ATR_qrank].at_val.at_long = rank;
+  inserted_at["150.napali"] = order;
+  fail_unless(aj.swap(jobs[10]->ji_qs.ji_jobid, jobs[150]->ji_qs.ji_jobid) == true);
+
+  job *late = job_alloc();
+  snprintf(late->ji_qs.ji_jobid, sizeof(late->ji_qs.ji_jobid), "late.napali");
+  late->ji_wattr[JOB_ATR_qrank].at_val.at_long = rank;
+  inserted_at[late->ji_qs.ji_jobid] = inserted++;
+  fail_unless(aj.insert_by_rank(late, late->ji_qs.ji_jobid, rank) == PBSE_NONE);
+  queued++;
+  fail_unless(check_rank_order(aj, inserted_at) == queued);
+
+  /* a job inserted without a rank leaves the index unable to place the next */
+  job *unranked = job_alloc();
+  snprintf(unranked->ji_qs.ji_jobid, sizeof(unranked->ji_qs.ji_jobid), "unranked.napali");
+  fail_unless(aj.insert(unranked, unranked->ji_qs.ji_jobid) == true);
+  fail_unless(aj.insert_by_rank(jobs[2], jobs[2]->ji_qs.ji_jobid, 5) == RANKS_INCOMPLETE);
+  fail_unless(aj.find(jobs[2]->ji_qs.ji_jobid) == NULL);
+  fail_unless(aj.count() == (size_t)queued + 1);
+
+  /* and once it is gone the index is complete again */
+  fail_unless(aj.remove(unranked->ji_qs.ji_jobid) == true);
+  inserted_at[jobs[2]->ji_qs.ji_jobid] = inserted++;
+  fail_unless(aj.insert_by_rank(jobs[2], jobs[2]->ji_qs.ji_jobid,
+    jobs[2]->ji_wattr[JOB_ATR_qrank].at_val.at_long) == PBSE_NONE);
+  queued++;
+  fail_unless(check_rank_order(aj, inserted_at) == queued);
+
+  aj.clear();
+  aj.unlock();
+  }
+END_TEST
+
+
+
+#define BENCH_JOBS     20000
+#define BENCH_LOOKUPS  200000
+
+all_jobs bench_jobs;
+
+void *bench_lookup_thread(
+
+  void *vp)
+
+  {
+  bool  locked = *(bool *)vp;
+  char  jobid[PBS_MAXSVRJOBID + 1];
+  long  found = 0;
+
+  for (int i = 0; i < BENCH_LOOKUPS; i++)
+    {
+    snprintf(jobid, sizeof(jobid), "%d.napali", (i * 7919) % BENCH_JOBS);
+
+    if (locked)
+      {
+      bench_jobs.lock();
+      if (find_job_by_array(&bench_jobs, jobid, FALSE, true) != NULL)
+        found++;
+      bench_jobs.unlock();
+      }
+    else if (find_job_by_array(&bench_jobs, jobid, FALSE, false) != NULL)
+      found++;
+    }
+
+  return((void *)found);
+  }
+
+
+
+double time_lookups(
+
+  int  num_threads,
+  bool locked)
+
+  {
+  pthread_t      threads[16];
+  struct timeval start;
+  struct timeval end;
+  void          *found;
+
+  gettimeofday(&start, NULL);
+
+  for (int i = 0; i < num_threads; i++)
+    pthread_create(threads + i, NULL, bench_lookup_thread, &locked);
+
+  for (int i = 0; i < num_threads; i++)
+    {
+    pthread_join(threads[i], &found);
+    fail_unless((long)found == BENCH_LOOKUPS);
+    }
+
+  gettimeofday(&end, NULL);
+
+  return((end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0);
+  }
+
+
+
+/*
+ * microbenchmark: lookup throughput through the sharded index compared with
+ * the same lookups made under the container's single mutex, as the number of
+ * threads grows
+ */
+
+START_TEST(find_job_by_array_throughput_test)
+  {
+  for (int i = 0; i < BENCH_JOBS; i++)
+    {
+    job *pjob = job_alloc();
+    snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "%d.napali", i);
+    insert_job(&bench_jobs, pjob);
+    }
+
+  for (int num_threads = 1; num_threads <= 16; num_threads *= 2)
+    {
+    double sharded = time_lookups(num_threads, false);
+    double single = time_lookups(num_threads, true);
+    double total = (double)num_threads * BENCH_LOOKUPS;
+
+    fprintf(stderr, "find_job_by_array: %2d threads: sharded %.0f lookups/sec, single mutex %.0f lookups/sec\n",
+      num_threads, total / sharded, total / single);
+    }
+  }
+END_TEST
+
+
+
 Suite *job_container_suite(void)
   {
   Suite *s = suite_create("job_container test suite methods");
@@ -293,10 +741,35 @@ Suite *job_container_suite(void)
   tcase_add_test(tc_core, next_job_test);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("get_iterator_after_test");
+  tcase_add_test(tc_core, get_iterator_after_test);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("find_job_by_array_with_removed_record");
   tcase_add_test(tc_core, find_job_by_array_with_removed_record_test);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("find_job_by_array_sharded_lookup_test");
+  tcase_add_test(tc_core, find_job_by_array_sharded_lookup_test);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("container_open_addressing_test");
+  tcase_add_test(tc_core, container_open_addressing_test);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("insert_by_rank_test");
+  tcase_add_test(tc_core, insert_by_rank_test);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("insert_by_rank_order_test");
+  tcase_add_test(tc_core, insert_by_rank_order_test);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("find_job_by_array_throughput_test");
+  tcase_add_test(tc_core, find_job_by_array_throughput_test);
+  tcase_set_timeout(tc_core, 120);
+  suite_add_tcase(s, tc_core);
+
   return(s);
   }
 
@@ -715,3 +715,18 @@ bool job_array::is_deleted() const
   {
   return(this->being_deleted);
   }
+
+int array_index_ranges::front() const
+  {
+  return(this->next);
+  }
+
+void array_index_ranges::pop_front()
+  {
+  this->remaining = 0;
+  }
+
+size_t array_index_ranges::size() const
+  {
+  return(this->remaining);
+  }
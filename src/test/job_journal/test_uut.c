@@ -0,0 +1,329 @@
+#include "license_pbs.h" /* See here for the software license */
+#include "pbs_config.h"
+#include "job_journal.h"
+#include "test_job_journal.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <set>
+#include <string>
+#include "pbs_error.h"
+#include "pbs_job.h"
+#include "attribute.h"
+#include "server.h"
+
+sem_t *job_clone_semaphore;
+extern attribute_def job_attr_def[];
+extern job *found_job;
+extern const char *path_jobs;
+extern int journal_fd;
+extern bool journal_checkpointing;
+extern std::set<std::string> journaled_jobs;
+extern std::set<std::string> checkpoint_jobs;
+void clear_attr(pbs_attribute *pattr, attribute_def *def);
+
+char server_name[] = "napali";
+
+
+job *journal_test_job(
+
+  const char *jobid)
+
+  {
+  job *pjob = new job();
+
+  for (int i = 0; i < JOB_ATR_LAST; i++)
+    clear_attr(&pjob->ji_wattr[i], &job_attr_def[i]);
+
+  snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "%s", jobid);
+  snprintf(pjob->ji_qs.ji_fileprefix, sizeof(pjob->ji_qs.ji_fileprefix), "%s", jobid);
+  snprintf(pjob->ji_qs.ji_queue, sizeof(pjob->ji_qs.ji_queue), "batch");
+  pjob->ji_qs.ji_state = JOB_STATE_QUEUED;
+  pjob->ji_qs.ji_substate = JOB_SUBSTATE_QUEUED;
+
+  job_attr_def[JOB_ATR_jobname].at_decode(&pjob->ji_wattr[JOB_ATR_jobname], NULL, NULL, "STDIN", 0);
+  job_attr_def[JOB_ATR_job_owner].at_decode(&pjob->ji_wattr[JOB_ATR_job_owner], NULL, NULL, "dbeer@napali", 0);
+  job_attr_def[JOB_ATR_outpath].at_decode(&pjob->ji_wattr[JOB_ATR_outpath], NULL, NULL, "napali:/home/dbeer/STDIN.o1", 0);
+
+  pjob->ji_wattr[JOB_ATR_state].at_val.at_char = 'Q';
+  pjob->ji_wattr[JOB_ATR_state].at_flags = ATR_VFLAG_SET;
+  pjob->ji_wattr[JOB_ATR_substate].at_val.at_long = JOB_SUBSTATE_QUEUED;
+  pjob->ji_wattr[JOB_ATR_substate].at_flags = ATR_VFLAG_SET;
+
+  return(pjob);
+  }
+
+
+job *journal_blank_job(
+
+  const char *jobid)
+
+  {
+  job *pjob = new job();
+
+  for (int i = 0; i < JOB_ATR_LAST; i++)
+    clear_attr(&pjob->ji_wattr[i], &job_attr_def[i]);
+
+  snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "%s", jobid);
+
+  return(pjob);
+  }
+
+
+/* parse the given records as if they had been read from a journal file */
+int load_records(
+
+  const std::string &buf)
+
+  {
+  size_t consumed = 0;
+
+  return(parse_journal_buffer(buf.c_str(), buf.size(), consumed));
+  }
+
+
+START_TEST(test_image_round_trip)
+  {
+  job         *pjob = journal_test_job("1.napali");
+  job         *recovered = journal_blank_job("1.napali");
+  std::string  rec;
+
+  fail_unless(encode_journal_record(pjob, JOURNAL_REC_IMAGE, rec) == PBSE_NONE);
+  fail_unless(load_records(rec) == 1);
+  fail_unless(job_journal_replay(recovered) == PBSE_NONE);
+
+  fail_unless(recovered->ji_qs.ji_state == JOB_STATE_QUEUED);
+  fail_unless(!strcmp(recovered->ji_qs.ji_queue, "batch"));
+  fail_unless(!strcmp(recovered->ji_wattr[JOB_ATR_jobname].at_val.at_str, "STDIN"));
+  fail_unless(!strcmp(recovered->ji_wattr[JOB_ATR_job_owner].at_val.at_str, "dbeer@napali"));
+  fail_unless(!strcmp(recovered->ji_wattr[JOB_ATR_outpath].at_val.at_str, "napali:/home/dbeer/STDIN.o1"));
+
+  // the records are consumed by the replay
+  fail_unless(job_journal_replay(recovered) == PBSE_NONE);
+  }
+END_TEST
+
+
+START_TEST(test_delta_records)
+  {
+  job         *pjob = journal_test_job("2.napali");
+  job         *recovered = journal_test_job("2.napali");
+  std::string  rec;
+
+  for (int i = 0; i < JOB_ATR_LAST; i++)
+    pjob->ji_wattr[i].at_flags &= ~ATR_VFLAG_MODIFY;
+
+  // a state change, a modified attribute and an attribute that was unset
+  pjob->ji_qs.ji_state = JOB_STATE_RUNNING;
+  pjob->ji_qs.ji_substate = JOB_SUBSTATE_RUNNING;
+  pjob->ji_wattr[JOB_ATR_state].at_val.at_char = 'R';
+  pjob->ji_wattr[JOB_ATR_substate].at_val.at_long = JOB_SUBSTATE_RUNNING;
+  job_attr_def[JOB_ATR_jobname].at_free(&pjob->ji_wattr[JOB_ATR_jobname]);
+  job_attr_def[JOB_ATR_jobname].at_decode(&pjob->ji_wattr[JOB_ATR_jobname], NULL, NULL, "renamed", 0);
+  pjob->ji_wattr[JOB_ATR_jobname].at_flags |= ATR_VFLAG_MODIFY;
+  job_attr_def[JOB_ATR_job_owner].at_free(&pjob->ji_wattr[JOB_ATR_job_owner]);
+  pjob->ji_wattr[JOB_ATR_job_owner].at_flags = ATR_VFLAG_MODIFY;
+
+  fail_unless(encode_journal_record(pjob, JOURNAL_REC_DELTA, rec) == PBSE_NONE);
+
+  // encoding clears the modify flags, so nothing else is recorded next time
+  fail_unless((pjob->ji_wattr[JOB_ATR_jobname].at_flags & ATR_VFLAG_MODIFY) == 0);
+
+  fail_unless(load_records(rec) == 1);
+  fail_unless(job_journal_replay(recovered) == PBSE_NONE);
+
+  fail_unless(recovered->ji_qs.ji_state == JOB_STATE_RUNNING);
+  fail_unless(recovered->ji_qs.ji_substate == JOB_SUBSTATE_RUNNING);
+  fail_unless(!strcmp(recovered->ji_wattr[JOB_ATR_jobname].at_val.at_str, "renamed"));
+  fail_unless((recovered->ji_wattr[JOB_ATR_job_owner].at_flags & ATR_VFLAG_SET) == 0);
+
+  // attributes that weren't in the delta are left alone
+  fail_unless(!strcmp(recovered->ji_wattr[JOB_ATR_outpath].at_val.at_str, "napali:/home/dbeer/STDIN.o1"));
+  }
+END_TEST
+
+
+START_TEST(test_reset_and_image_supersede)
+  {
+  job         *pjob = journal_test_job("3.napali");
+  job         *recovered = journal_test_job("3.napali");
+  std::string  journal;
+  std::string  rec;
+
+  pjob->ji_qs.ji_state = JOB_STATE_RUNNING;
+  encode_journal_record(pjob, JOURNAL_REC_DELTA, rec);
+  journal += rec;
+
+  // the XML file was rewritten, so the delta above must not be replayed
+  encode_journal_record(pjob, JOURNAL_REC_RESET, rec);
+  journal += rec;
+
+  fail_unless(load_records(journal) == 2);
+  fail_unless(job_journal_replay(recovered) == PBSE_NONE);
+  fail_unless(recovered->ji_qs.ji_state == JOB_STATE_QUEUED);
+
+  // an image replaces the deltas before it
+  journal.clear();
+  pjob->ji_qs.ji_state = JOB_STATE_HELD;
+  encode_journal_record(pjob, JOURNAL_REC_DELTA, rec);
+  journal += rec;
+  pjob->ji_qs.ji_state = JOB_STATE_COMPLETE;
+  encode_journal_record(pjob, JOURNAL_REC_IMAGE, rec);
+  journal += rec;
+
+  fail_unless(load_records(journal) == 2);
+  fail_unless(job_journal_replay(recovered) == PBSE_NONE);
+  fail_unless(recovered->ji_qs.ji_state == JOB_STATE_COMPLETE);
+  }
+END_TEST
+
+
+START_TEST(test_torn_and_corrupt_records)
+  {
+  job         *pjob = journal_test_job("4.napali");
+  std::string  journal;
+  std::string  rec;
+  size_t       consumed = 0;
+  size_t       complete;
+  size_t       second;
+
+  encode_journal_record(pjob, JOURNAL_REC_IMAGE, rec);
+  journal += rec;
+  encode_journal_record(pjob, JOURNAL_REC_DELTA, rec);
+  journal += rec;
+  second = rec.size();
+  complete = journal.size();
+
+  // a record cut short by a crash
+  encode_journal_record(pjob, JOURNAL_REC_DELTA, rec);
+  journal += rec.substr(0, rec.size() - 3);
+
+  fail_unless(parse_journal_buffer(journal.c_str(), journal.size(), consumed) == 2);
+  fail_unless(consumed == complete);
+
+  // a flipped byte in the second record ends the parse after the first
+  journal.resize(complete);
+  journal[complete - 2] ^= 0x55;
+  fail_unless(parse_journal_buffer(journal.c_str(), journal.size(), consumed) == 1);
+  fail_unless(consumed == complete - second);
+
+  fail_unless(parse_journal_buffer(journal.c_str(), 0, consumed) == 0);
+  fail_unless(consumed == 0);
+  }
+END_TEST
+
+
+START_TEST(test_journal_file)
+  {
+  char         dir[] = "/tmp/job_journal_XXXXXX";
+  std::string  jobs_path;
+  job         *pjob = journal_test_job("5.napali");
+  job         *recovered = journal_test_job("5.napali");
+
+  fail_unless(mkdtemp(dir) != NULL);
+  jobs_path = std::string(dir) + "/";
+
+  // disabled - no journal is kept
+  fail_unless(job_journal_start(jobs_path.c_str(), false) == PBSE_NONE);
+  fail_unless(job_journal_active() == false);
+  fail_unless(job_journal_append(pjob, SAVEJOB_QUICK) == -1);
+
+  fail_unless(job_journal_start(jobs_path.c_str(), true) == PBSE_NONE);
+  fail_unless(job_journal_active() == true);
+
+  pjob->ji_qs.ji_state = JOB_STATE_RUNNING;
+  fail_unless(job_journal_append(pjob, SAVEJOB_QUICK) == PBSE_NONE);
+  pjob->ji_qs.ji_state = JOB_STATE_EXITING;
+  fail_unless(job_journal_append(pjob, SAVEJOB_FULL) == PBSE_NONE);
+  job_journal_flush();
+
+  // simulate a torn write at the end of the file
+  std::string path = jobs_path + JOB_JOURNAL_FILE;
+  int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+  fail_unless(write(fd, "JRN", 3) == 3);
+  close(fd);
+
+  fail_unless(job_journal_load(jobs_path.c_str()) == PBSE_NONE);
+  fail_unless(job_journal_replay(recovered) == PBSE_NONE);
+  fail_unless(recovered->ji_qs.ji_state == JOB_STATE_EXITING);
+
+  unlink(path.c_str());
+  rmdir(dir);
+  }
+END_TEST
+
+
+START_TEST(test_failed_checkpoint)
+  {
+  char         dir[] = "/tmp/job_journal_XXXXXX";
+  std::string  jobs_path;
+  job         *pjob = journal_test_job("6.napali");
+  const char  *saved_path_jobs = path_jobs;
+
+  fail_unless(mkdtemp(dir) != NULL);
+  jobs_path = std::string(dir) + "/";
+
+  fail_unless(job_journal_start(jobs_path.c_str(), true) == PBSE_NONE);
+  fail_unless(job_journal_append(pjob, SAVEJOB_FULL) == PBSE_NONE);
+
+  // the job's records are in the old journal, and neither its XML file nor
+  // a new journal record can be written
+  checkpoint_jobs.swap(journaled_jobs);
+  journal_checkpointing = true;
+  found_job = pjob;
+  path_jobs = "/nonexistent/jobs/";
+  close(journal_fd);
+  journal_fd = -1;
+
+  job_journal_checkpoint(NULL);
+
+  // the job waits for the next checkpoint and journaling goes on
+  fail_unless(journal_checkpointing == false);
+  fail_unless(checkpoint_jobs.size() == 0);
+  fail_unless(journaled_jobs.size() == 1);
+  fail_unless(journaled_jobs.count("6.napali") == 1);
+
+  found_job = NULL;
+  path_jobs = saved_path_jobs;
+  unlink((jobs_path + JOB_JOURNAL_FILE).c_str());
+  rmdir(dir);
+  }
+END_TEST
+
+
+Suite *job_journal_suite(void)
+  {
+  Suite *s = suite_create("job_journal_suite methods");
+  TCase *tc_core = tcase_create("test_records");
+  tcase_add_test(tc_core, test_image_round_trip);
+  tcase_add_test(tc_core, test_delta_records);
+  tcase_add_test(tc_core, test_reset_and_image_supersede);
+  tcase_add_test(tc_core, test_torn_and_corrupt_records);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_journal_file");
+  tcase_add_test(tc_core, test_journal_file);
+  tcase_add_test(tc_core, test_failed_checkpoint);
+  suite_add_tcase(s, tc_core);
+
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(job_journal_suite());
+  srunner_set_log(sr, "job_journal_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
@@ -15,6 +15,7 @@
 #include "id_map.hpp"
 #include "completed_jobs_map.h"
 #include "pbs_nodes.h"
+#include "job_change_log.hpp"
 
 const char *text_name              = "text";
 const char *PJobSubState[10];
@@ -22,6 +23,7 @@ const char *PJobState[] = {"hi", "hello"};
 const char *path_jobs = "";
 pthread_mutex_t *setup_save_mutex = NULL;
 int LOGLEVEL=0;
+job_change_log job_changes;
 bool exit_called = false;
 pthread_mutex_t job_log_mutex = PTHREAD_MUTEX_INITIALIZER;
 all_jobs array_summary;
@@ -290,6 +292,7 @@ batch_request *get_remove_batch_request(char *br_id) {return NULL;}
 long calc_job_cost(job *pjob) {return(0);}
 int issue_to_svr(const char *servern, struct batch_request **preq, void (*replyfunc)(struct work_task *)) {return 0;}
 int que_to_local_svr(struct batch_request *preq) {return 0;}
+int que_to_local_svr_batch(std::vector<batch_request *> &requests) {return 0;}
 int job_set_wait(pbs_attribute *pattr, void *pjob, int mode) {return 0;}
 int get_batch_request_id(batch_request *preq) {return 0;}
 int encode_inter(pbs_attribute *attr, tlist_head *phead, const char *atname, const char *rsname, int mode, int perm) {return 0;}
@@ -529,3 +532,38 @@ bool job_array::is_deleted() const
   {
   return(this->being_deleted);
   }
+
+int array_index_ranges::front() const
+  {
+  return(this->next);
+  }
+
+void array_index_ranges::pop_front()
+  {
+  this->remaining = 0;
+  }
+
+size_t array_index_ranges::size() const
+  {
+  return(this->remaining);
+  }
+
+bool job_journal_active()
+  {
+  return(false);
+  }
+
+int job_journal_append(job *pjob, int updatetype)
+  {
+  return(-1);
+  }
+
+int job_journal_reset(job *pjob)
+  {
+  return(0);
+  }
+
+int job_journal_replay(job *pjob)
+  {
+  return(0);
+  }
@@ -348,6 +348,44 @@ int trq_cg_get_task_memory_stats(
   return(0);
   }
 
+int trq_cg_get_job_cput_stats(
+
+  const char    *job_id,
+  unsigned long &cput_used)
+
+  {
+  cput_used = 0;
+  return(0);
+  }
+
+int trq_cg_get_job_memory_stats(
+
+  const char         *job_id,
+  unsigned long long &mem_used)
+
+  {
+  mem_used = 0;
+  return(0);
+  }
+
+int cg_job_pids_reads = 0;
+std::vector<pid_t> cg_job_pids;
+
+int trq_cg_get_job_pids(
+
+  const char         *job_id,
+  std::vector<pid_t> &pids)
+
+  {
+  cg_job_pids_reads++;
+
+  if (cg_job_pids.size() == 0)
+    return(PBSE_CAN_NOT_OPEN_FILE);
+
+  pids = cg_job_pids;
+  return(0);
+  }
+
 void free_pwnam(
 
   struct passwd *pwdp,
@@ -1,9 +1,13 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "pbs_config.h"
 #include "mom_mach.h"
@@ -20,6 +24,8 @@ int overmem_proc(job*, unsigned long long);
 int overcpu_proc(job*, unsigned long);
 unsigned long long resi_sum(job*);
 unsigned long long mem_sum(job*);
+int mom_get_sample(void);
+void get_job_proc_indices(job *, std::vector<int> &);
 
 double cputfactor;
 
@@ -29,7 +35,9 @@ job_pid_set_t global_job_sid_set;
 pid2jobsid_map_t pid2jobsid_map;
 
 extern pid2procarrayindex_map_t pid2procarrayindex_map;
+extern jobsid2procarrayindex_map_t jobsid2procarrayindex_map;
 extern proc_stat_t   *proc_array;
+extern char           procfs[];
 
 extern void *get_next_return_value;
 
@@ -40,6 +48,7 @@ START_TEST(test_get_job_sid_from_pid)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* expect fail for pids < 2 */
@@ -96,6 +105,7 @@ START_TEST(test_injob)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* create space for job structure */
@@ -153,6 +163,7 @@ START_TEST(test_cput_sum)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* create space for job structure */
@@ -191,6 +202,7 @@ START_TEST(test_cput_sum)
 
   /* map pid to index */
   pid2procarrayindex_map[proc_array[0].pid] = 0;
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 0));
 
   /* set job to have 1000 as a session id */
   pjob->ji_job_pid_set->insert(1000);
@@ -214,6 +226,7 @@ START_TEST(test_overmem_proc)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* create space for job structure */
@@ -244,6 +257,7 @@ START_TEST(test_overmem_proc)
   /* setup values so that injob() will return false */
   pjob->ji_job_pid_set->insert(1000);
   pid2jobsid_map[10] = 2000;
+  jobsid2procarrayindex_map.insert(std::make_pair(2000, 0));
 
   /* pid 10 is not in job so expect FALSE */
   fail_unless(overmem_proc(pjob, 0) == FALSE);
@@ -251,6 +265,8 @@ START_TEST(test_overmem_proc)
   /* add new sid for pid 10 */
   pid2jobsid_map.clear();
   pid2jobsid_map[10] = 1000;
+  jobsid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 0));
 
   /* pid 10 is in job and vsize > 0 so expect TRUE */
   fail_unless(overmem_proc(pjob, 0) == TRUE);
@@ -258,10 +274,11 @@ START_TEST(test_overmem_proc)
   /* pid 10 is in job but vsize < 100 so expect FALSE */
   fail_unless(overmem_proc(pjob, 100) == FALSE);
 
-  /* clear map */
+  /* clear maps */
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
 
-  /* pid 10 is in job but can't look up pid in pid2procarrayindex_map so expect FALSE */
+  /* pid 10 is in job but was not sampled so expect FALSE */
   fail_unless(overmem_proc(pjob, 0) == FALSE);
   }
 END_TEST
@@ -273,6 +290,7 @@ START_TEST(test_overcpu_proc)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* create space for job structure */
@@ -304,6 +322,7 @@ START_TEST(test_overcpu_proc)
   /* setup values so that injob() will return false */
   pjob->ji_job_pid_set->insert(1000);
   pid2jobsid_map[10] = 2000;
+  jobsid2procarrayindex_map.insert(std::make_pair(2000, 0));
 
   /* pid 10 is not in job so expect FALSE */
   fail_unless(overcpu_proc(pjob, 0) == FALSE);
@@ -311,6 +330,8 @@ START_TEST(test_overcpu_proc)
   /* add new sid for pid 10 */
   pid2jobsid_map.clear();
   pid2jobsid_map[10] = 1000;
+  jobsid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 0));
 
   cputfactor = 1.0;
 
@@ -320,10 +341,11 @@ START_TEST(test_overcpu_proc)
   /* pid 10 is in job but cputime < 100 so expect FALSE */
   fail_unless(overcpu_proc(pjob, 100) == FALSE);
 
-  /* clear map */
+  /* clear maps */
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
 
-  /* pid 10 is in job but can't look up pid in pid2procarrayindex_map so expect FALSE */
+  /* pid 10 is in job but was not sampled so expect FALSE */
   fail_unless(overcpu_proc(pjob, 0) == FALSE);
   }
 END_TEST
@@ -336,6 +358,7 @@ START_TEST(test_resi_sum)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* create space for job structure */
@@ -366,6 +389,7 @@ START_TEST(test_resi_sum)
   /* setup values so that injob() will return false */
   pjob->ji_job_pid_set->insert(1000);
   pid2jobsid_map[10] = 2000;
+  jobsid2procarrayindex_map.insert(std::make_pair(2000, 0));
 
   /* pid 10 is not in job so expect 0 */
   fail_unless(resi_sum(pjob) == 0);
@@ -373,16 +397,19 @@ START_TEST(test_resi_sum)
   /* add new sid for pid 10 */
   pid2jobsid_map.clear();
   pid2jobsid_map[10] = 1000;
+  jobsid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 0));
 
   pagesize = 4096;
 
   /* pid 10 is in job so expect 1*pagesize */
   fail_unless(resi_sum(pjob) == (unsigned long long)pagesize);
 
-  /* clear map */
+  /* clear maps */
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
 
-  /* pid is in job but can't look up pid in pid2procarrayindex_map so expect 0 */
+  /* pid is in job but was not sampled so expect 0 */
   fail_unless(resi_sum(pjob) == 0);
 
   /* todo: test when USELIBMEMACCT set */
@@ -397,6 +424,7 @@ START_TEST(test_mem_sum)
   /* all the maps/sets should be empty */
   pid2jobsid_map.clear();
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
   global_job_sid_set.clear();
 
   /* create space for job structure */
@@ -427,6 +455,7 @@ START_TEST(test_mem_sum)
   /* setup values so that injob() will return false */
   pjob->ji_job_pid_set->insert(1000);
   pid2jobsid_map[10] = 2000;
+  jobsid2procarrayindex_map.insert(std::make_pair(2000, 0));
 
   /* pid 10 is not in job so expect 0 */
   fail_unless(mem_sum(pjob) == 0);
@@ -434,18 +463,292 @@ START_TEST(test_mem_sum)
   /* add new sid for pid 10 */
   pid2jobsid_map.clear();
   pid2jobsid_map[10] = 1000;
+  jobsid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 0));
 
   /* pid 10 is in job so expect 10 */
   fail_unless(mem_sum(pjob) == 10);
 
-  /* clear map */
+  /* clear maps */
   pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
 
-  /* pid is in job but can't look up pid in pid2procarrayindex_map so expect 0 */
+  /* pid is in job but was not sampled so expect 0 */
   fail_unless(mem_sum(pjob) == 0);
   }
 END_TEST
 
+START_TEST(test_get_job_proc_indices)
+  {
+  job              *pjob;
+  std::vector<int>  indices;
+
+  pid2jobsid_map.clear();
+  pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
+  global_job_sid_set.clear();
+
+  pjob = (job *) calloc(1, sizeof(job));
+  fail_unless(pjob != NULL);
+  pjob->ji_tasks = new std::vector<task *>();
+  pjob->ji_job_pid_set = new job_pid_set_t;
+
+  /* two processes in session 1000, one in 2000 and one in someone else's 3000 */
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 0));
+  jobsid2procarrayindex_map.insert(std::make_pair(1000, 1));
+  jobsid2procarrayindex_map.insert(std::make_pair(2000, 2));
+  jobsid2procarrayindex_map.insert(std::make_pair(3000, 3));
+
+  get_job_proc_indices(pjob, indices);
+  fail_unless(indices.size() == 0);
+
+  pjob->ji_job_pid_set->insert(1000);
+
+  /* a task in a session already in the pid set must not be counted twice */
+  task *tp = new task();
+  tp->ti_qs.ti_sid = 1000;
+  pjob->ji_tasks->push_back(tp);
+
+  tp = new task();
+  tp->ti_qs.ti_sid = 2000;
+  pjob->ji_tasks->push_back(tp);
+
+  tp = new task();
+  tp->ti_qs.ti_sid = 2000;
+  pjob->ji_tasks->push_back(tp);
+
+  get_job_proc_indices(pjob, indices);
+  fail_unless(indices.size() == 3, "expected 3 processes, got %d", (int)indices.size());
+  fail_unless(indices[0] == 0);
+  fail_unless(indices[1] == 1);
+  fail_unless(indices[2] == 2);
+  }
+END_TEST
+
+
+
+#define BENCH_JOBS           256
+#define BENCH_PROCS_PER_JOB  8
+#define BENCH_OTHER_PROCS    1024
+#define BENCH_ROUNDS         20
+
+/*
+ * write a /proc/<pid>/stat file for a synthetic process under dir
+ */
+
+void write_fake_proc(
+
+  const char         *dir,
+  int                 pid,
+  int                 ppid,
+  int                 session,
+  unsigned long long  vsize)
+
+  {
+  char  path[MAXPATHLEN];
+  FILE *fp;
+
+  snprintf(path, sizeof(path), "%s/%d", dir, pid);
+  mkdir(path, 0755);
+
+  snprintf(path, sizeof(path), "%s/%d/stat", dir, pid);
+  fp = fopen(path, "w");
+  fail_unless(fp != NULL);
+
+  fprintf(fp, "%d (bench) S %d %d %d 0 -1 4202496 0 0 0 0 100 50 0 0 20 0 1 0 1000 %llu 10\n",
+    pid, ppid, pid, session, vsize);
+
+  fclose(fp);
+  }
+
+
+
+/* the pre-index rollup: every job pid on the node is checked against the job */
+
+unsigned long long mem_sum_by_scan(
+
+  job *pjob)
+
+  {
+  unsigned long long segadd = 0;
+
+  for (pid2jobsid_map_t::const_iterator iter = pid2jobsid_map.begin();
+       iter != pid2jobsid_map.end();
+       iter++)
+    {
+    if (!injob(pjob, iter->first))
+      continue;
+
+    pid2procarrayindex_map_t::const_iterator pa_iter = pid2procarrayindex_map.find(iter->first);
+    if (pa_iter != pid2procarrayindex_map.end())
+      segadd += proc_array[pa_iter->second].vsize;
+    }
+
+  return(segadd);
+  }
+
+
+
+/*
+ * benchmark: sample a synthetic procfs tree with BENCH_JOBS single-session
+ * jobs and roll up every job's usage through the session index and through
+ * the full pid scan it replaced
+ */
+
+START_TEST(test_mom_get_sample_job_index)
+  {
+  char            dir[] = "/tmp/mom_mach_procfsXXXXXX";
+  job            *jobs[BENCH_JOBS];
+  struct timeval  start;
+  struct timeval  mid;
+  struct timeval  end;
+  unsigned long long expected = 0;
+
+  fail_unless(mkdtemp(dir) != NULL);
+
+  pid2jobsid_map.clear();
+  pid2procarrayindex_map.clear();
+  jobsid2procarrayindex_map.clear();
+  global_job_sid_set.clear();
+
+  for (int j = 0; j < BENCH_JOBS; j++)
+    {
+    int sid = 10000 + j * 16;
+
+    jobs[j] = (job *)calloc(1, sizeof(job));
+    fail_unless(jobs[j] != NULL);
+    jobs[j]->ji_tasks = new std::vector<task *>();
+    jobs[j]->ji_job_pid_set = new job_pid_set_t;
+    jobs[j]->ji_job_pid_set->insert(sid);
+    global_job_sid_set.insert(sid);
+
+    /* the session leader and its children; the last child called setsid() and
+     * is only found through its lineage */
+    write_fake_proc(dir, sid, 2, sid, 1024);
+    for (int p = 1; p < BENCH_PROCS_PER_JOB; p++)
+      write_fake_proc(dir, sid + p, sid, (p == BENCH_PROCS_PER_JOB - 1) ? sid + p : sid, 1024 * (p + 1));
+    }
+
+  for (int p = 1; p <= BENCH_PROCS_PER_JOB; p++)
+    expected += 1024 * p;
+
+  for (int o = 0; o < BENCH_OTHER_PROCS; o++)
+    write_fake_proc(dir, 50000 + o, 2, 50000 + o, 4096);
+
+  snprintf(procfs, MAXPATHLEN, "%s", dir);
+  free(proc_array);
+  proc_array = NULL;
+
+  fail_unless(mom_get_sample() == PBSE_NONE);
+  fail_unless(pid2procarrayindex_map.size() == BENCH_JOBS * BENCH_PROCS_PER_JOB + BENCH_OTHER_PROCS);
+  fail_unless(jobsid2procarrayindex_map.size() == BENCH_JOBS * BENCH_PROCS_PER_JOB);
+
+  for (int j = 0; j < BENCH_JOBS; j++)
+    {
+    fail_unless(mem_sum(jobs[j]) == expected);
+    fail_unless(mem_sum_by_scan(jobs[j]) == expected);
+    fail_unless(overmem_proc(jobs[j], 1024 * BENCH_PROCS_PER_JOB) == FALSE);
+    fail_unless(overmem_proc(jobs[j], 1024 * (BENCH_PROCS_PER_JOB - 1)) == TRUE);
+    }
+
+  gettimeofday(&start, NULL);
+
+  for (int r = 0; r < BENCH_ROUNDS; r++)
+    for (int j = 0; j < BENCH_JOBS; j++)
+      mem_sum(jobs[j]);
+
+  gettimeofday(&mid, NULL);
+
+  for (int r = 0; r < BENCH_ROUNDS; r++)
+    for (int j = 0; j < BENCH_JOBS; j++)
+      mem_sum_by_scan(jobs[j]);
+
+  gettimeofday(&end, NULL);
+
+  fprintf(stderr, "mem_sum over %d jobs x %d procs: session index %.3f ms/poll, full pid scan %.3f ms/poll\n",
+    BENCH_JOBS, BENCH_PROCS_PER_JOB,
+    ((mid.tv_sec - start.tv_sec) * 1000.0 + (mid.tv_usec - start.tv_usec) / 1000.0) / BENCH_ROUNDS,
+    ((end.tv_sec - mid.tv_sec) * 1000.0 + (end.tv_usec - mid.tv_usec) / 1000.0) / BENCH_ROUNDS);
+
+  snprintf(procfs, MAXPATHLEN, "/proc");
+
+  std::string cleanup = std::string("rm -rf ") + dir;
+  fail_unless(system(cleanup.c_str()) == 0);
+  }
+END_TEST
+
+
+
+#ifdef PENABLE_LINUX_CGROUPS
+extern int                 cg_job_pids_reads;
+extern std::vector<pid_t>  cg_job_pids;
+extern std::list<job *>    alljobs_list;
+
+/*
+ * the job's cgroup is read once per sample, and the rollups use the processes
+ * listed in it even when they left the job's session
+ */
+
+START_TEST(test_mom_get_sample_cgroup_procs)
+  {
+  char  dir[] = "/tmp/mom_mach_cgroupXXXXXX";
+  job  *pjob;
+
+  fail_unless(mkdtemp(dir) != NULL);
+
+  global_job_sid_set.clear();
+
+  pjob = (job *)calloc(1, sizeof(job));
+  fail_unless(pjob != NULL);
+  pjob->ji_tasks = new std::vector<task *>();
+  pjob->ji_job_pid_set = new job_pid_set_t;
+  pjob->ji_cgroups_created = true;
+  snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "1.napali");
+  pjob->ji_job_pid_set->insert(3000);
+  global_job_sid_set.insert(3000);
+  alljobs_list.clear();
+  alljobs_list.push_back(pjob);
+
+  /* the session leader, a child that called setsid() and a process outside the job */
+  write_fake_proc(dir, 3000, 2, 3000, 1024);
+  write_fake_proc(dir, 3001, 2, 3001, 2048);
+  write_fake_proc(dir, 4000, 2, 4000, 4096);
+
+  cg_job_pids.clear();
+  cg_job_pids.push_back(3000);
+  cg_job_pids.push_back(3001);
+  cg_job_pids_reads = 0;
+
+  snprintf(procfs, MAXPATHLEN, "%s", dir);
+  free(proc_array);
+  proc_array = NULL;
+
+  fail_unless(mom_get_sample() == PBSE_NONE);
+  fail_unless(cg_job_pids_reads == 1);
+
+  fail_unless(mem_sum(pjob) == 1024 + 2048);
+  fail_unless(overmem_proc(pjob, 2048) == FALSE);
+  fail_unless(overmem_proc(pjob, 1024) == TRUE);
+  overcpu_proc(pjob, 0);
+  fail_unless(cg_job_pids_reads == 1, "cgroup pids read %d times in one sample", cg_job_pids_reads);
+
+  /* without a readable cgroup the job falls back to its session */
+  cg_job_pids.clear();
+  fail_unless(mom_get_sample() == PBSE_NONE);
+  fail_unless(cg_job_pids_reads == 2);
+  fail_unless(mem_sum(pjob) == 1024);
+
+  alljobs_list.clear();
+  snprintf(procfs, MAXPATHLEN, "/proc");
+
+  std::string cleanup = std::string("rm -rf ") + dir;
+  fail_unless(system(cleanup.c_str()) == 0);
+  }
+END_TEST
+#endif
+
+
+
 Suite *mom_mach_suite(void)
   {
   Suite *s = suite_create("mom_mach_suite methods");
@@ -484,6 +787,21 @@ Suite *mom_mach_suite(void)
   tcase_add_test(tc_core, test_mem_sum);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_get_job_proc_indices");
+  tcase_add_test(tc_core, test_get_job_proc_indices);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_mom_get_sample_job_index");
+  tcase_add_test(tc_core, test_mom_get_sample_job_index);
+  tcase_set_timeout(tc_core, 60);
+  suite_add_tcase(s, tc_core);
+
+#ifdef PENABLE_LINUX_CGROUPS
+  tc_core = tcase_create("test_mom_get_sample_cgroup_procs");
+  tcase_add_test(tc_core, test_mom_get_sample_cgroup_procs);
+  suite_add_tcase(s, tc_core);
+#endif
+
   return s;
   }
 
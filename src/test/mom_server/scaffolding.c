@@ -147,6 +147,11 @@ int read_tcp_reply(struct tcp_chan *chan, int protocol, int version, int command
   return *exit_status; 
   }
 
+int write_buffer(char *buf, int len, int fds)
+  {
+  return((write(fds, buf, len) == len) ? PBSE_NONE : -1);
+  }
+
 char *conf_res(char *resline, struct rm_attribute *attr)
   {
   fprintf(stderr, "The call to conf_res needs to be mocked!!\n");
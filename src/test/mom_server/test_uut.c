@@ -7,6 +7,7 @@
 #include "pbs_error.h"
 #include "mom_server.h"
 #include "resmon.h"
+#include "pbs_nodes.h"
 
 #define MAXLINE 1024
 #define NO_SERVER_CONFIGURED -1
@@ -31,6 +32,8 @@ extern int    UpdateFailCount;
 extern time_t LastServerUpdateTime;
 extern int    is_reporter_mom;
 extern mom_server mom_servers[PBS_MAXSERVER];
+extern std::vector<std::string> mom_status;
+extern bool server_accepts_status_deltas;
 
 bool is_for_this_host(std::string gpu_spec, const char *suffix);
 void get_device_indices(const char *gpu_str, std::vector<unsigned int> &gpu_indices, const char *suffix);
@@ -220,6 +223,132 @@ START_TEST(test_mom_server_all_update_stat_clear_force)
   }
 END_TEST
 
+START_TEST(test_build_status_delta)
+  {
+  std::vector<std::string> acked;
+  std::vector<std::string> current;
+  std::vector<std::string> delta;
+
+  acked.push_back("arch=x86_64");
+  acked.push_back("state=free");
+  acked.push_back("loadave=0.10");
+  acked.push_back("message=nothing to report");
+  acked.push_back("netload=100");
+  acked.push_back(START_GPU_STATUS);
+  acked.push_back("gpuid=0");
+  acked.push_back("gpu_utilization=0%");
+  acked.push_back(END_GPU_STATUS);
+
+  current.push_back("arch=x86_64");
+  current.push_back("state=free");
+  current.push_back("loadave=1.20");
+  current.push_back("netload=100");
+  current.push_back("availmem=12345kb");
+  current.push_back(START_GPU_STATUS);
+  current.push_back("gpuid=0");
+  current.push_back("gpu_utilization=0%");
+  current.push_back(END_GPU_STATUS);
+
+  build_status_delta(acked, current, 4, 5, delta);
+
+  // the markers, state every time, what changed or is new, and what's gone
+  fail_unless(delta.size() == 6, "delta has %d strings", (int)delta.size());
+  fail_unless(delta[0] == "status_version=5");
+  fail_unless(delta[1] == "status_base=4");
+  fail_unless(delta[2] == "state=free");
+  fail_unless(delta[3] == "loadave=1.20");
+  fail_unless(delta[4] == "availmem=12345kb");
+  fail_unless(delta[5] == "status_unset=message");
+
+  // a change anywhere in the gpu section sends all of it
+  current[7] = "gpu_utilization=50%";
+  delta.clear();
+  build_status_delta(acked, current, 4, 5, delta);
+  fail_unless(delta.size() == 10, "delta has %d strings", (int)delta.size());
+  fail_unless(delta[5] == START_GPU_STATUS);
+  fail_unless(delta[8] == END_GPU_STATUS);
+
+  delta.clear();
+  build_status_delta(current, current, 5, 6, delta);
+  fail_unless(delta.size() == 3);
+  fail_unless(delta[2] == "state=free");
+  }
+END_TEST
+
+
+START_TEST(test_update_acked_status)
+  {
+  std::vector<std::string> full_status;
+
+  full_status.push_back("state=free");
+
+  // servers that don't version updates always get everything
+  update_acked_status(PBSE_NONE, PBSE_NONE, false, full_status);
+  fail_unless(should_send_status_delta() == false);
+  fail_unless(server_accepts_status_deltas == false);
+
+  // that update wasn't versioned, so it can't be diffed against yet
+  update_acked_status(PBSE_NONE, STATUS_DELTAS_OK, false, full_status);
+  fail_unless(should_send_status_delta() == false);
+  fail_unless(server_accepts_status_deltas == true);
+
+  full_status.push_back("state=free");
+  update_acked_status(PBSE_NONE, STATUS_DELTAS_OK, false, full_status);
+  fail_unless(should_send_status_delta() == true);
+
+  // a full update is due every so often
+  for (int i = 0; i < 20; i++)
+    {
+    full_status.push_back("state=free");
+    update_acked_status(PBSE_NONE, STATUS_DELTAS_OK, true, full_status);
+    }
+  fail_unless(should_send_status_delta() == false);
+
+  full_status.push_back("state=free");
+  update_acked_status(PBSE_NONE, STATUS_DELTAS_OK, false, full_status);
+  fail_unless(should_send_status_delta() == true);
+
+  full_status.push_back("state=free");
+  update_acked_status(PBSE_NONE, STATUS_RESYNC, true, full_status);
+  fail_unless(should_send_status_delta() == false);
+
+  full_status.push_back("state=free");
+  update_acked_status(PBSE_NONE, STATUS_DELTAS_OK, false, full_status);
+  fail_unless(should_send_status_delta() == true);
+
+  // a failed update means the server may have missed it
+  update_acked_status(-1, PBSE_NONE, true, full_status);
+  fail_unless(should_send_status_delta() == false);
+  }
+END_TEST
+
+
+START_TEST(test_version_mom_status)
+  {
+  std::vector<std::string> full_status;
+
+  // until the server says it takes versions, the status goes as it is
+  server_accepts_status_deltas = false;
+  mom_status.clear();
+  mom_status.push_back("state=free");
+  version_mom_status(false, full_status);
+  fail_unless(mom_status.size() == 1);
+  fail_unless(mom_status[0] == "state=free");
+  fail_unless(full_status.size() == 1);
+
+  server_accepts_status_deltas = true;
+  full_status.clear();
+  version_mom_status(false, full_status);
+  fail_unless(mom_status.size() == 2);
+  fail_unless(!strncmp(mom_status[0].c_str(), STATUS_VERSION_EQUALS, strlen(STATUS_VERSION_EQUALS)));
+  fail_unless(mom_status[1] == "state=free");
+  fail_unless(full_status.size() == 1);
+
+  server_accepts_status_deltas = false;
+  }
+END_TEST
+
+
 START_TEST(test_is_for_this_host)
   {
   std::string spec;
@@ -288,6 +417,12 @@ Suite *mom_server_suite(void)
   tcase_add_test(tc_core, test_is_for_this_host);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_build_status_delta");
+  tcase_add_test(tc_core, test_build_status_delta);
+  tcase_add_test(tc_core, test_update_acked_status);
+  tcase_add_test(tc_core, test_version_mom_status);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_get_device_indices");
   tcase_add_test(tc_core, test_get_device_indices);
   tcase_add_test(tc_core, test_mom_server_all_update_stat_clear_force);
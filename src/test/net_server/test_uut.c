@@ -9,6 +9,7 @@
 #include <string>
 #include <errno.h>
 #include <string.h>
+#include <sys/socket.h>
 
 
 #include "server_limits.h"
@@ -24,6 +25,17 @@ extern bool  socket_read_code;
 int add_connection(int sock, enum conn_type type, pbs_net_t addr, unsigned int port, unsigned int socktype, void *(*func)(void *), int add_wait_request);
 void *accept_conn(void *new_conn);
 
+extern struct connection svr_conn[];
+extern char             *net_server_name;
+
+int ready_sock = -1;
+
+void *record_ready_sock(void *vp)
+  {
+  ready_sock = ((int *)vp)[0];
+  return(NULL);
+  }
+
 
 START_TEST(netaddr_pbs_net_t_test_one)
   {
@@ -146,6 +158,49 @@ START_TEST(test_check_trqauthd_unix_domain_port)
 END_TEST
 
 
+START_TEST(test_wait_request_dispatch_and_idle_expiry)
+  {
+  int    sv[2];
+  time_t now = time(NULL);
+
+  net_server_name = strdup("napali");
+  fail_unless(init_network(0, record_ready_sock) == PBSE_NONE);
+
+  fail_unless(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+  fail_unless(add_connection(sv[0], FromClientDIS, 0, 0, PBS_SOCK_UNIX, record_ready_sock, TRUE) == PBSE_NONE);
+
+  /* nothing to read yet */
+  ready_sock = -1;
+  fail_unless(wait_request(0, NULL) == PBSE_NONE);
+  fail_unless(ready_sock == -1);
+
+  fail_unless(write(sv[1], "x", 1) == 1);
+  fail_unless(wait_request(1, NULL) == PBSE_NONE);
+  fail_unless(ready_sock == sv[0]);
+
+  /* the connection isn't idle long enough to be closed yet */
+  expire_idle_connections(now + PBS_NET_MAXCONNECTIDLE / 2);
+  fail_unless(svr_conn[sv[0]].cn_active == FromClientDIS);
+
+  expire_idle_connections(now + PBS_NET_MAXCONNECTIDLE * 2);
+  fail_unless(svr_conn[sv[0]].cn_active == Idle);
+
+  close(sv[1]);
+
+  /* a regular file can't be polled, so the connection isn't added */
+  char path[] = "/tmp/net_server_XXXXXX";
+  int  fd = mkstemp(path);
+
+  fail_unless(fd >= 0);
+  fail_unless(add_connection(fd, FromClientDIS, 0, 0, PBS_SOCK_UNIX, record_ready_sock, TRUE) == PBSE_SYSTEM);
+  fail_unless(svr_conn[fd].cn_active == Idle);
+
+  close(fd);
+  unlink(path);
+  }
+END_TEST
+
+
 Suite *net_server_suite(void)
   {
   Suite *s = suite_create("net_server_suite methods");
@@ -169,6 +224,10 @@ Suite *net_server_suite(void)
   tcase_add_test(tc_core, test_check_trqauthd_unix_domain_port);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_wait_request_dispatch_and_idle_expiry");
+  tcase_add_test(tc_core, test_wait_request_dispatch_and_idle_expiry);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
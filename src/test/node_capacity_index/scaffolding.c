@@ -0,0 +1,3 @@
+#include "node_capacity_index.hpp"
+
+node_capacity_index node_index;
@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <check.h>
+
+#include "node_capacity_index.hpp"
+#include "pbs_error.h"
+
+
+node_capacity make_capacity(
+
+  int         id,
+  bool        available,
+  int         total,
+  int         free_slots,
+  const char *prop)
+
+  {
+  node_capacity nc;
+
+  nc.id = id;
+  nc.available = available;
+  nc.total_slots = total;
+  nc.free_slots = free_slots;
+
+  if (prop != NULL)
+    nc.properties.push_back(prop);
+
+  return(nc);
+  }
+
+
+
+START_TEST(test_find_candidates)
+  {
+  node_capacity_index      index;
+  std::vector<std::string> props;
+  std::vector<int>         ids;
+
+  index.update(make_capacity(3, true, 16, 16, "bigmem"));
+  index.update(make_capacity(1, true, 8, 2, NULL));
+  index.update(make_capacity(2, false, 8, 8, "bigmem"));
+  index.update(make_capacity(4, true, 8, 8, NULL));
+  fail_unless(index.size() == 4);
+
+  // no properties - every available node with enough free slots, in id order
+  fail_unless(index.find_candidates(props, 1, ids) == 3);
+  fail_unless(ids[0] == 1);
+  fail_unless(ids[1] == 3);
+  fail_unless(ids[2] == 4);
+
+  ids.clear();
+  fail_unless(index.find_candidates(props, 4, ids) == 2);
+  fail_unless(ids[0] == 3);
+  fail_unless(ids[1] == 4);
+
+  // node 2 has the property but isn't available
+  ids.clear();
+  props.push_back("bigmem");
+  fail_unless(index.find_candidates(props, 1, ids) == 1);
+  fail_unless(ids[0] == 3);
+
+  ids.clear();
+  props.push_back("gpu");
+  fail_unless(index.find_candidates(props, 1, ids) == 0);
+  fail_unless(ids.size() == 0);
+  }
+END_TEST
+
+
+
+START_TEST(test_updates)
+  {
+  node_capacity_index      index;
+  std::vector<std::string> props;
+  std::vector<int>         ids;
+  node_capacity            nc = make_capacity(1, true, 8, 8, "fast");
+
+  index.update(nc);
+
+  // a job starts on the node
+  nc.free_slots = 0;
+  index.update(nc);
+  fail_unless(index.find_candidates(props, 1, ids) == 0);
+
+  // the job finishes and the node is given a new property
+  nc.free_slots = 8;
+  nc.properties.clear();
+  nc.properties.push_back("slow");
+  index.update(nc);
+  fail_unless(index.find_candidates(props, 8, ids) == 1);
+
+  ids.clear();
+  props.push_back("fast");
+  fail_unless(index.find_candidates(props, 1, ids) == 0);
+
+  props[0] = "slow";
+  fail_unless(index.find_candidates(props, 1, ids) == 1);
+
+  index.remove(1);
+  ids.clear();
+  fail_unless(index.size() == 0);
+  fail_unless(index.find_candidates(props, 1, ids) == 0);
+
+  // ids less than 0 belong to nodes that were never named
+  index.update(make_capacity(-1, true, 8, 8, NULL));
+  fail_unless(index.size() == 0);
+
+  nc.has_node_boards = true;
+  index.update(nc);
+  fail_unless(index.has_node_boards() == true);
+  nc.has_node_boards = false;
+  index.update(nc);
+  fail_unless(index.has_node_boards() == false);
+
+  index.clear();
+  fail_unless(index.size() == 0);
+  }
+END_TEST
+
+
+
+START_TEST(test_count_eligible)
+  {
+  node_capacity_index      index;
+  std::vector<std::string> props;
+  node_capacity            nc = make_capacity(1, false, 8, 0, "bigmem");
+
+  nc.gpus = 2;
+  index.update(nc);
+  index.update(make_capacity(2, true, 4, 4, "bigmem"));
+  index.update(make_capacity(3, true, 16, 16, NULL));
+
+  // busy or not, a node that is big enough is eligible
+  fail_unless(index.count_eligible(props, 4, 0, 0) == 3);
+  fail_unless(index.count_eligible(props, 8, 0, 0) == 2);
+  fail_unless(index.count_eligible(props, 1, 1, 0) == 1);
+  fail_unless(index.count_eligible(props, 1, 0, 1) == 0);
+
+  props.push_back("bigmem");
+  fail_unless(index.count_eligible(props, 1, 0, 0) == 2);
+  fail_unless(index.count_eligible(props, 16, 0, 0) == 0);
+  }
+END_TEST
+
+
+
+START_TEST(test_capacity_compare)
+  {
+  node_capacity a = make_capacity(1, true, 8, 8, "fast");
+  node_capacity b = a;
+
+  fail_unless(a == b);
+
+  b.properties.push_back("slow");
+  fail_unless(a.same_counts(b) == true);
+  fail_unless(a != b);
+
+  b = a;
+  b.free_slots = 4;
+  fail_unless(a.same_counts(b) == false);
+  fail_unless(a != b);
+  }
+END_TEST
+
+
+
+Suite *node_capacity_index_suite(void)
+  {
+  Suite *s = suite_create("node_capacity_index test suite methods");
+  TCase *tc_core = tcase_create("test_find_candidates");
+  tcase_add_test(tc_core, test_find_candidates);
+  tcase_add_test(tc_core, test_updates);
+  suite_add_tcase(s, tc_core);
+  
+  tc_core = tcase_create("test_count_eligible");
+  tcase_add_test(tc_core, test_count_eligible);
+  tcase_add_test(tc_core, test_capacity_compare);
+  suite_add_tcase(s, tc_core);
+  
+  return(s);
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  rundebug();
+  sr = srunner_create(node_capacity_index_suite());
+  srunner_set_log(sr, "node_capacity_index_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return(number_failed);
+  }
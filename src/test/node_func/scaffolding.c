@@ -397,6 +397,7 @@ id_map::~id_map()
 
 
 id_map node_mapper;
+node_capacity_index node_index;
 id_map job_mapper;
 
 struct pbsnode *tfind_addr(
@@ -129,6 +129,11 @@ int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *t
   return(0);
   }
 
+int enqueue_threadpool_request_lane(void *(*func)(void *), void *arg, threadpool_t *tp, int lane)
+  {
+  return(0);
+  }
+
 struct pbsnode *find_nodebyname(const char *nodename)
   {
   static struct pbsnode bob;
@@ -663,6 +668,7 @@ void capture_until_close_character(
   
 
 id_map node_mapper;
+node_capacity_index node_index;
 id_map job_mapper;
 
 job_usage_info::job_usage_info(int id) : internal_job_id(id)
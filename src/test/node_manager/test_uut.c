@@ -32,6 +32,7 @@ bool job_already_being_killed(int internal_job_id);
 void process_job_attribute_information(std::string &job_id, Json::Value &job_info, pbs_net_t addr);
 bool process_as_node_list(const char *spec, std::list<node_job_add_info> *naji_list);
 bool node_is_spec_acceptable(struct pbsnode *pnode, single_spec_data &spec, char *ProcBMStr, int *eligible_nodes, bool job_is_exclusive);
+int select_from_all_nodes(complete_spec_data &all_reqs, std::list<node_job_add_info> *naji_list, int *eligible_nodes, alps_req_data **ard_array, int first_node_id, int num_alps_reqs, enum job_types job_type, char *ProcBMStr, bool job_is_exclusive);
 void populate_range_string_from_slot_tracker(const execution_slot_tracker &est, std::string &range_str);
 int  translate_job_reservation_info_to_string(std::vector<job_reservation_info> &host_info, int *NCount, std::string &exec_host_output, std::stringstream *exec_port_output);
 int place_subnodes_in_hostlist(job *pjob, struct pbsnode *pnode, node_job_add_info &naji, job_reservation_info &jri, char *ProcBMStr);
@@ -368,6 +369,46 @@ START_TEST(populate_range_string_from_job_reservation_info_test)
 END_TEST
 
 
+START_TEST(select_from_indexed_nodes_test)
+  {
+  complete_spec_data all_reqs;
+  single_spec_data   req;
+  node_capacity      nc;
+  int                eligible_nodes = 0;
+
+  node_index.clear();
+
+  // find_nodebyid() returns an unusable node for 1 and nothing for 2
+  nc.available = true;
+  nc.total_slots = 4;
+  nc.free_slots = 4;
+  nc.id = 1;
+  node_index.update(nc);
+  nc.id = 2;
+  node_index.update(nc);
+
+  req.nodes = 2;
+  all_reqs.reqs.push_back(req);
+  all_reqs.num_reqs = 1;
+  all_reqs.total_nodes = 2;
+
+  // the candidates are re-checked under their locks, so nothing is selected,
+  // and the nodes that weren't visited are still counted as eligible
+  fail_unless(select_from_all_nodes(all_reqs, NULL, &eligible_nodes, NULL, 0, 0, JOB_TYPE_normal, NULL, false) == 0);
+  fail_unless(all_reqs.total_nodes == 2);
+  fail_unless(eligible_nodes == 2);
+
+  // nodes without the property aren't eligible
+  eligible_nodes = 0;
+  all_reqs.reqs[0].plist.push_back(prop("bigmem"));
+  fail_unless(select_from_all_nodes(all_reqs, NULL, &eligible_nodes, NULL, 0, 0, JOB_TYPE_normal, NULL, false) == 0);
+  fail_unless(eligible_nodes == 0);
+
+  node_index.clear();
+  }
+END_TEST
+
+
 START_TEST(node_is_spec_acceptable_test)
   {
   struct pbsnode   pnode;
@@ -949,6 +990,7 @@ Suite *node_manager_suite(void)
   
   tc_core = tcase_create("even more tests");
   tcase_add_test(tc_core, node_is_spec_acceptable_test);
+  tcase_add_test(tc_core, select_from_indexed_nodes_test);
   tcase_add_test(tc_core, populate_range_string_from_job_reservation_info_test);
   tcase_add_test(tc_core, check_node_jobs_exitence_test);
   suite_add_tcase(s, tc_core);
@@ -6,6 +6,7 @@
 #include "hwloc.h"
 #include "pbs_error.h"
 #include <sstream>
+#include <sys/time.h>
 
 extern int recorded;
 
@@ -1072,6 +1073,67 @@ START_TEST(test_place_and_free_task)
 END_TEST
 
 
+#define BENCH_CORES  256
+#define BENCH_CYCLES 2000
+
+START_TEST(test_placement_benchmark)
+  {
+  int             remainder = 0;
+  int             pn_remainder = 0;
+  const char     *host = "napali";
+  struct timeval  start;
+  struct timeval  end;
+  double          elapsed;
+  req             r;
+  Chip            c(BENCH_CORES, remainder, pn_remainder);
+
+  c.setMemory(BENCH_CORES * 1024);
+  c.setChipAvailable(true);
+  r.set_value("lprocs", "2", false);
+  r.set_value("memory", "1kb", false);
+
+  gettimeofday(&start, NULL);
+
+  for (int cycle = 0; cycle < BENCH_CYCLES; cycle++)
+    {
+    char jobid[64];
+    int  tasks = (cycle % 16) + 1;
+
+    // alternate between placing whole cores and placing threads
+    if (cycle % 2 == 0)
+      thread_type = use_cores;
+    else
+      thread_type = "";
+
+    // keep part of the chip busy so placement has to skip over used cores
+    snprintf(jobid, sizeof(jobid), "%d.napali", cycle);
+    allocation busy(jobid);
+    fail_unless(c.place_task(r, busy, BENCH_CORES / 8, host) == BENCH_CORES / 8);
+
+    snprintf(jobid, sizeof(jobid), "%d-small.napali", cycle);
+    allocation a(jobid);
+    fail_unless(c.how_many_tasks_fit(r, 0) >= tasks);
+    fail_unless(c.place_task(r, a, tasks, host) == tasks);
+
+    c.free_task(a.jobid.c_str());
+    c.free_task(busy.jobid.c_str());
+    fail_unless(c.free_core_count() == BENCH_CORES, "%d free", c.free_core_count());
+    }
+
+  gettimeofday(&end, NULL);
+  elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0;
+
+  fail_unless(c.getAvailableCores() == BENCH_CORES);
+  fail_unless(c.getAvailableThreads() == BENCH_CORES);
+
+  fprintf(stderr, "%d place/free cycles on a %d core chip: %.3f sec\n",
+    BENCH_CYCLES, BENCH_CORES, elapsed);
+
+  thread_type = "";
+  }
+END_TEST
+
+
 Suite *numa_socket_suite(void)
   {
   Suite *s = suite_create("numa_socket test suite methods");
@@ -1095,6 +1157,11 @@ Suite *numa_socket_suite(void)
   tcase_add_test(tc_core, test_initialize_allocation);
   tcase_add_test(tc_core, test_place_tasks_execution_slots);
   suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_placement_benchmark");
+  tcase_add_test(tc_core, test_placement_benchmark);
+  tcase_set_timeout(tc_core, 120);
+  suite_add_tcase(s, tc_core);
   
   return(s);
   }
@@ -5,8 +5,13 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include <string>
+#include <vector>
 
 #include "pbs_error.h"
 
@@ -87,10 +92,236 @@ START_TEST(test_one)
   }
 END_TEST
 
-START_TEST(test_two)
+/* each thread's messages fit in its ring, so none are dropped however the
+ * writer is scheduled */
+#define LOG_THREADS    8
+#define LOG_MESSAGES   2000
+
+void *log_messages(
+
+  void *arg)
+
+  {
+  long id = (long)arg;
+  char msg[128];
+
+  for (int i = 0; i < LOG_MESSAGES; i++)
+    {
+    snprintf(msg, sizeof(msg), "thread %ld message %d", id, i);
+    log_record(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, "1.napali", msg);
+    }
+
+  return(NULL);
+  }
+
+
+void log_from_threads()
+
   {
+  pthread_t threads[LOG_THREADS];
 
+  for (long i = 0; i < LOG_THREADS; i++)
+    pthread_create(threads + i, NULL, log_messages, (void *)i);
 
+  for (int i = 0; i < LOG_THREADS; i++)
+    pthread_join(threads[i], NULL);
+  }
+
+
+/*
+ * Reads the log at path and checks that every thread's messages are there
+ * once and in order. Returns how many messages were found.
+ */
+
+int check_log(
+
+  const char *path,
+  bool       *dropped)
+
+  {
+  FILE *fp = fopen(path, "r");
+  char  line[1024];
+  int   next[LOG_THREADS];
+  int   found = 0;
+  long  id;
+  int   i;
+  char *msg;
+
+  memset(next, 0, sizeof(next));
+  *dropped = false;
+
+  fail_unless(fp != NULL);
+
+  while (fgets(line, sizeof(line), fp) != NULL)
+    {
+    if (strstr(line, "messages were dropped") != NULL)
+      *dropped = true;
+
+    if ((msg = strstr(line, ";Job;1.napali;thread ")) == NULL)
+      continue;
+
+    fail_unless(sscanf(msg, ";Job;1.napali;thread %ld message %d", &id, &i) == 2);
+
+    if (*dropped == false)
+      fail_unless(i == next[id], "thread %ld logged %d before %d", id, i, next[id]);
+
+    next[id] = i + 1;
+    found++;
+    }
+
+  fclose(fp);
+
+  return(found);
+  }
+
+
+START_TEST(test_async_logging)
+  {
+  char dir[] = "/tmp/pbs_log_XXXXXX";
+  char path[256];
+  bool dropped;
+
+  fail_unless(mkdtemp(dir) != NULL);
+  snprintf(path, sizeof(path), "%s/sync", dir);
+
+  pthread_mutex_lock(&log_mutex);
+  fail_unless(log_open(path, dir) == 0);
+  pthread_mutex_unlock(&log_mutex);
+
+  log_from_threads();
+
+  pthread_mutex_lock(&log_mutex);
+  log_close(1);
+  pthread_mutex_unlock(&log_mutex);
+
+  fail_unless(check_log(path, &dropped) == LOG_THREADS * LOG_MESSAGES);
+
+  snprintf(path, sizeof(path), "%s/async", dir);
+
+  pthread_mutex_lock(&log_mutex);
+  fail_unless(log_open(path, dir) == 0);
+  pthread_mutex_unlock(&log_mutex);
+
+  fail_unless(log_async_start() == PBSE_NONE);
+  log_from_threads();
+
+  /* closing the log writes what is still queued first */
+  pthread_mutex_lock(&log_mutex);
+  log_close(1);
+  pthread_mutex_unlock(&log_mutex);
+  log_async_stop();
+
+  fail_unless(check_log(path, &dropped) == LOG_THREADS * LOG_MESSAGES);
+  fail_unless(dropped == false);
+
+  unlink(path);
+  snprintf(path, sizeof(path), "%s/sync", dir);
+  unlink(path);
+  rmdir(dir);
+  }
+END_TEST
+
+
+START_TEST(test_async_drops_when_full)
+  {
+  char dir[] = "/tmp/pbs_log_XXXXXX";
+  char path[256];
+  bool dropped;
+  int  found;
+
+  fail_unless(mkdtemp(dir) != NULL);
+  snprintf(path, sizeof(path), "%s/log", dir);
+
+  pthread_mutex_lock(&log_mutex);
+  fail_unless(log_open(path, dir) == 0);
+  pthread_mutex_unlock(&log_mutex);
+
+  fail_unless(log_async_start() == PBSE_NONE);
+
+  /* the writer needs log_mutex, so nothing is drained while this holds it */
+  pthread_mutex_lock(&log_mutex);
+  log_messages((void *)0);
+  log_messages((void *)1);
+  pthread_mutex_unlock(&log_mutex);
+
+  log_async_stop();
+
+  pthread_mutex_lock(&log_mutex);
+  log_close(1);
+  pthread_mutex_unlock(&log_mutex);
+
+  found = check_log(path, &dropped);
+  fail_unless(dropped == true);
+  fail_unless(found > 0);
+  fail_unless(found < 2 * LOG_MESSAGES);
+
+  unlink(path);
+  rmdir(dir);
+  }
+END_TEST
+
+START_TEST(test_async_fork)
+  {
+  char  dir[] = "/tmp/pbs_log_XXXXXX";
+  char  path[256];
+  char  line[1024];
+  bool  dropped;
+  int   status;
+  int   child_lines = 0;
+  pid_t pid;
+  FILE *fp;
+
+  fail_unless(mkdtemp(dir) != NULL);
+  snprintf(path, sizeof(path), "%s/log", dir);
+
+  pthread_mutex_lock(&log_mutex);
+  fail_unless(log_open(path, dir) == 0);
+  pthread_mutex_unlock(&log_mutex);
+
+  fail_unless(log_async_start() == PBSE_NONE);
+
+  /* queue messages the writer can't drain yet, then fork */
+  pthread_mutex_lock(&log_mutex);
+  log_messages((void *)0);
+
+  pid = fork();
+
+  if (pid == 0)
+    {
+    /* the child must neither block on the log nor write the parent's queue */
+    log_record(PBSEVENT_JOB, PBS_EVENTCLASS_JOB, "1.napali", "forked child");
+    exit(0);
+    }
+
+  pthread_mutex_unlock(&log_mutex);
+
+  fail_unless(pid > 0);
+  fail_unless(waitpid(pid, &status, 0) == pid);
+  fail_unless(WIFEXITED(status));
+  fail_unless(WEXITSTATUS(status) == 0);
+
+  log_async_stop();
+
+  pthread_mutex_lock(&log_mutex);
+  log_close(1);
+  pthread_mutex_unlock(&log_mutex);
+
+  fail_unless(check_log(path, &dropped) == LOG_MESSAGES);
+  fail_unless(dropped == false);
+
+  fail_unless((fp = fopen(path, "r")) != NULL);
+
+  while (fgets(line, sizeof(line), fp) != NULL)
+    {
+    if (strstr(line, ";Job;1.napali;forked child") != NULL)
+      child_lines++;
+    }
+
+  fclose(fp);
+  fail_unless(child_lines == 1);
+
+  unlink(path);
+  rmdir(dir);
   }
 END_TEST
 
@@ -101,8 +332,17 @@ Suite *pbs_log_suite(void)
   tcase_add_test(tc_core, test_one);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_async_logging");
+  tcase_add_test(tc_core, test_async_logging);
+  tcase_set_timeout(tc_core, 120);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_async_drops_when_full");
+  tcase_add_test(tc_core, test_async_drops_when_full);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_async_fork");
+  tcase_add_test(tc_core, test_async_fork);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -372,9 +372,15 @@ int setup_nodes(void)
   exit(1);
   }
 
-job *job_recov(const char *filename)
+job *job_recov_parse(const char *filename)
   {
-  fprintf(stderr, "The call to job_recov needs to be mocked!!\n");
+  fprintf(stderr, "The call to job_recov_parse needs to be mocked!!\n");
+  exit(1);
+  }
+
+int job_recov_fixup(job **pjob)
+  {
+  fprintf(stderr, "The call to job_recov_fixup needs to be mocked!!\n");
   exit(1);
   }
 
@@ -907,3 +913,13 @@ void job_array::update_array_values(
 
   {
   }
+
+int job_journal_load(const char *jobs_path)
+  {
+  return(0);
+  }
+
+int job_journal_start(const char *jobs_path, bool enabled)
+  {
+  return(0);
+  }
@@ -221,6 +221,18 @@ int log_open(char *filename, char *directory)
   exit(1);
   }
 
+int log_async_start(void)
+  {
+  fprintf(stderr, "The call to log_async_start needs to be mocked!!\n");
+  exit(1);
+  }
+
+void log_async_stop(void)
+  {
+  fprintf(stderr, "The call to log_async_stop needs to be mocked!!\n");
+  exit(1);
+  }
+
 int init_network(unsigned int socket, void *(*readfunc)(void *))
   {
   fprintf(stderr, "The call to init_network needs to be mocked!!\n");
@@ -381,6 +393,11 @@ void *send_hierarchy_threadtask(void *vp)
 
 void log_init(const char *suffix, const char *hostname) {}
 
+int threadpool_get_lane_stats(threadpool_t *tp, int lane, tp_lane_queue_t *stats)
+  {
+  return(PBSE_BAD_PARAMETER);
+  }
+
 int enqueue_threadpool_request(void *(*func)(void *), void *arg, threadpool_t *tp)
   {
   return(0);
@@ -516,3 +533,5 @@ completed_jobs_map_class::~completed_jobs_map_class() {}
 void *remove_completed_jobs(void *vp) {return(NULL);}
 
 acl_special::acl_special() {}
+
+void job_journal_flush() {}
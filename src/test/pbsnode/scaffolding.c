@@ -12,6 +12,7 @@ extern std::string global_string;
 AvlTree                 ipaddrs = NULL;
 int                     LOGLEVEL = 10;
 id_map                  node_mapper;
+node_capacity_index     node_index;
 mom_hierarchy_handler   hierarchy_handler; //The global declaration.
 bool                    exit_called;
 bool                    cray_enabled;
@@ -64,6 +64,46 @@ START_TEST(test_constructors)
 END_TEST
 
 
+START_TEST(test_update_capacity_index)
+  {
+  pbsnode                  pnode("napali", NULL, true);
+  std::vector<std::string> props;
+  std::vector<int>         ids;
+
+  node_index.clear();
+
+  // down nodes are indexed, but aren't candidates
+  pnode.lock_node(__func__, NULL, 0);
+  for (int i = 0; i < 4; i++)
+    pnode.nd_slots.add_execution_slot();
+  pnode.unlock_node(__func__, NULL, 0);
+  fail_unless(node_index.size() == 1);
+  fail_unless(node_index.find_candidates(props, 1, ids) == 0);
+  fail_unless(node_index.count_eligible(props, 4, 0, 0) == 1);
+
+  pnode.lock_node(__func__, NULL, 0);
+  pnode.nd_state = INUSE_FREE;
+  pnode.unlock_node(__func__, NULL, 0);
+  fail_unless(node_index.find_candidates(props, 4, ids) == 1);
+  fail_unless(ids[0] == pnode.nd_id);
+
+  // the node's name is one of its properties
+  ids.clear();
+  props.push_back("napali");
+  fail_unless(node_index.find_candidates(props, 1, ids) == 1);
+
+  ids.clear();
+  pnode.lock_node(__func__, NULL, 0);
+  pnode.nd_slots.mark_as_used(0);
+  pnode.unlock_node(__func__, NULL, 0);
+  fail_unless(node_index.find_candidates(props, 4, ids) == 0);
+  fail_unless(node_index.find_candidates(props, 3, ids) == 1);
+
+  node_index.clear();
+  }
+END_TEST
+
+
 START_TEST(test_copy_properties)
   {
   struct pbsnode pn_src;
@@ -129,6 +169,7 @@ Suite *pbsnode_suite(void)
   Suite *s = suite_create("pbsnode test suite methods");
   TCase *tc_core = tcase_create("test_constructors");
   tcase_add_test(tc_core, test_constructors);
+  tcase_add_test(tc_core, test_update_capacity_index);
   tcase_add_test(tc_core, test_version);
   suite_add_tcase(s, tc_core);
   
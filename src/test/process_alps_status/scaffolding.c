@@ -1861,7 +1861,7 @@ Chip &Chip::operator =(
   return(*this);
   }
 
-Core::Core() : indices(), is_index_busy() {}
+Core::Core() : indices(), busy_units(0) {}
 Core::~Core() {}
 
 allocation::allocation(
@@ -20,6 +20,7 @@ char        server_name[PBS_MAXSERVERNAME + 1]; /* host_name[:service|port] */
 int         allow_any_mom;
 int         LOGLEVEL = 10;
 int         event_logged;
+struct pbsnode *reporting_node = NULL;
 const char *dis_emsg[] =
   {
   "No error",
@@ -125,6 +126,17 @@ int enqueue_threadpool_request(
   return(0);
   }
 
+int enqueue_threadpool_request_lane(
+
+  void *(*func)(void *),
+  void *arg,
+  threadpool_t *tp,
+  int           lane)
+
+  {
+  return(0);
+  }
+
 int lock_node(
     
   struct pbsnode *the_node,
@@ -149,6 +161,10 @@ struct pbsnode *find_nodebyname(
   const char *nodename) /* I */
 
   {
+  if ((reporting_node != NULL) &&
+      (!strcmp(nodename, reporting_node->get_name())))
+    return(reporting_node);
+
   return(NULL);
   }
 
@@ -235,6 +251,9 @@ int node_micstatus_list(
   int            actmode)  /* action mode; "NEW" or "ALTER"   */
 
   {
+  if (actmode == ATR_ACTION_ALTER)
+    ((struct pbsnode *)pnode)->nd_micstatus = new_attr->at_val.at_arst;
+
   return(0);
   }
 
@@ -285,7 +304,12 @@ int node_gpustatus_list(
   return(0);
   }
 
-void clear_nvidia_gpus(struct pbsnode *np) {}
+int gpus_cleared = 0;
+
+void clear_nvidia_gpus(struct pbsnode *np)
+  {
+  gpus_cleared++;
+  }
 
 const char *id_map::get_name(int id)
   {
@@ -486,11 +510,21 @@ void pbsnode::capture_plugin_resources(const char *str)
   {
   }
 
-void pbsnode::set_version(const char *ver_str) {}
+void pbsnode::set_version(const char *ver_str)
+  {
+  if (!strcmp(ver_str, "master"))
+    this->nd_version = 1000;
+  }
+
+int pbsnode::get_version() const
+  {
+  return(this->nd_version);
+  }
 
 pbsnode::pbsnode() : nd_error(0), nd_properties(), nd_version(0), nd_proximal_failures(0),
                      nd_consecutive_successes(0),
                      nd_mutex(), nd_id(-1), nd_f_st(), nd_addrs(), nd_prop(NULL), nd_status(),
+                     nd_status_entries(), nd_status_version(0),
                      nd_note(),
                      nd_stream(-1),
                      nd_flag(okay), nd_mom_port(PBS_MOM_SERVICE_PORT),
@@ -6,10 +6,16 @@
 #include <pbs_config.h>
 #include "pbs_nodes.h"
 #include "machine.hpp"
+#include <set>
 #include <check.h>
 
 int set_note_error(struct pbsnode *np, const char *str);
 int restore_note(struct pbsnode *np);
+void merge_status_delta(std::vector<std::string> &stored, const std::vector<std::string> &changed, const std::set<std::string> &unset);
+int process_status_info(const char *nd_name, std::vector<std::string> &status_info);
+
+extern struct pbsnode *reporting_node;
+extern int             gpus_cleared;
 
 #ifdef PENABLE_LINUX_CGROUPS
 void update_layout_if_needed(pbsnode *pnode, const std::string &layout);
@@ -114,6 +120,131 @@ END_TEST
 
 
 
+START_TEST(test_merge_status_delta)
+  {
+  std::vector<std::string> stored;
+  std::vector<std::string> changed;
+  std::set<std::string>    unset;
+
+  stored.push_back("state=free");
+  stored.push_back("loadave=0.10");
+  stored.push_back("varattr=a");
+  stored.push_back("varattr=b");
+  stored.push_back("message=hi");
+
+  changed.push_back("state=busy");
+  changed.push_back("availmem=100kb");
+  changed.push_back("varattr=c");
+  unset.insert("message");
+
+  merge_status_delta(stored, changed, unset);
+
+  // changed entries stay where they were, new ones go on the end
+  fail_unless(stored.size() == 4, "%d entries", (int)stored.size());
+  fail_unless(stored[0] == "state=busy");
+  fail_unless(stored[1] == "loadave=0.10");
+  fail_unless(stored[2] == "varattr=c");
+  fail_unless(stored[3] == "availmem=100kb");
+  }
+END_TEST
+
+
+
+START_TEST(test_versioned_status)
+  {
+  pbsnode                  pnode;
+  std::vector<std::string> status;
+
+  pnode.change_name("napali");
+  reporting_node = &pnode;
+
+  status.push_back("node=napali");
+  status.push_back("status_version=1");
+  status.push_back("state=free");
+  status.push_back("loadave=0.50");
+  status.push_back("message=hi");
+  fail_unless(process_status_info("napali", status) == STATUS_DELTAS_OK);
+  fail_unless(pnode.nd_status_version == 1);
+  fail_unless(pnode.nd_status.find("state=free,loadave=0.50,message=hi,rectime=") == 0);
+
+  status.clear();
+  status.push_back("node=napali");
+  status.push_back("status_version=2");
+  status.push_back("status_base=1");
+  status.push_back("state=free");
+  status.push_back("loadave=1.50");
+  status.push_back("status_unset=message");
+  fail_unless(process_status_info("napali", status) == STATUS_DELTAS_OK);
+  fail_unless(pnode.nd_status_version == 2);
+  fail_unless(pnode.nd_status.find("state=free,loadave=1.50,rectime=") == 0, "%s", pnode.nd_status.c_str());
+
+  // a delta against a version we never applied is kept, but the mom has to resync
+  status[1] = "status_version=4";
+  status[2] = "status_base=3";
+  status[4] = "loadave=2.50";
+  fail_unless(process_status_info("napali", status) == STATUS_RESYNC);
+  fail_unless(pnode.nd_status.find("state=free,loadave=2.50,rectime=") == 0);
+
+  // unversioned updates replace everything
+  status.clear();
+  status.push_back("node=napali");
+  status.push_back("state=free");
+  status.push_back("ncpus=4");
+  fail_unless(process_status_info("napali", status) == PBSE_NONE);
+  fail_unless(pnode.nd_status_version == 0);
+  fail_unless(pnode.nd_status.find("state=free,ncpus=4,rectime=") == 0);
+
+  // a mom that can version its updates is told it may
+  status.push_back("version=master");
+  fail_unless(process_status_info("napali", status) == STATUS_DELTAS_OK);
+  fail_unless(pnode.nd_status_version == 0);
+
+  reporting_node = NULL;
+  }
+END_TEST
+
+
+
+START_TEST(test_unset_gpu_mic_status)
+  {
+  pbsnode                  pnode;
+  std::vector<std::string> status;
+  struct array_strings     mic_status;
+
+  pnode.change_name("napali");
+  reporting_node = &pnode;
+  gpus_cleared = 0;
+
+  status.push_back("node=napali");
+  status.push_back("status_version=1");
+  status.push_back("state=free");
+  fail_unless(process_status_info("napali", status) == STATUS_DELTAS_OK);
+
+  // a delta that doesn't unset them leaves the gpu and mic data alone
+  pnode.nd_micstatus = &mic_status;
+  status.clear();
+  status.push_back("node=napali");
+  status.push_back("status_version=2");
+  status.push_back("status_base=1");
+  status.push_back("state=free");
+  fail_unless(process_status_info("napali", status) == STATUS_DELTAS_OK);
+  fail_unless(gpus_cleared == 0);
+  fail_unless(pnode.nd_micstatus == &mic_status);
+
+  status[1] = "status_version=3";
+  status[2] = "status_base=2";
+  status.push_back("status_unset=" START_GPU_STATUS);
+  status.push_back("status_unset=" START_MIC_STATUS);
+  fail_unless(process_status_info("napali", status) == STATUS_DELTAS_OK);
+  fail_unless(gpus_cleared == 1);
+  fail_unless(pnode.nd_micstatus == NULL);
+
+  reporting_node = NULL;
+  }
+END_TEST
+
+
+
 Suite *process_mom_update_suite(void)
   {
   Suite *s = suite_create("process_mom_update test suite methods");
@@ -127,6 +258,12 @@ Suite *process_mom_update_suite(void)
   tc_core = tcase_create("test_two");
   tcase_add_test(tc_core, test_two);
   suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_versioned_status");
+  tcase_add_test(tc_core, test_merge_status_delta);
+  tcase_add_test(tc_core, test_versioned_status);
+  tcase_add_test(tc_core, test_unset_gpu_mic_status);
+  suite_add_tcase(s, tc_core);
   
   return(s);
   }
@@ -30,6 +30,10 @@ int timestring_to_int(const char *timestring, int *req_walltime);
 int process_commandline_opts(int argc, char **argv, int *exec_only_flg, int *errflg_out);
 void get_ct(const char *str, int *jque, int *jrun);
 string get_err_msg(int any_failed, const char *mode, int connect, char *id);
+string job_stat_extend(const char *base, const string &after);
+void take_page_cursor(struct batch_status **pstatus, string &next);
+extern int page_size;
+extern bool condensed;
 
 START_TEST(time_to_string_test)
   {
@@ -656,6 +660,60 @@ START_TEST(test_get_tasks_from_nodes_resc)
   }
 END_TEST
 
+START_TEST(test_job_stat_extend)
+  {
+  page_size = 0;
+  fail_unless(job_stat_extend("exec_queue_only", "") == "exec_queue_only");
+
+  page_size = 500;
+  fail_unless(job_stat_extend("", "") == "page_size=500,");
+  fail_unless(job_stat_extend("exec_queue_only", "") == "exec_queue_only,page_size=500,");
+  fail_unless(job_stat_extend("", "500/12.napali") == "page_size=500,page_after=500/12.napali,");
+
+  // condensed has to stay the last character
+  condensed = true;
+  fail_unless(job_stat_extend("C", "500/12.napali") == "page_size=500,page_after=500/12.napali,C");
+  fail_unless(job_stat_extend("summarize_arraysC", "") == "summarize_arrays,page_size=500,C");
+  condensed = false;
+
+  page_size = 1000;
+  }
+END_TEST
+
+START_TEST(test_take_page_cursor)
+  {
+  struct batch_status  job1;
+  struct batch_status  page;
+  struct batch_status *pstatus = &job1;
+  struct attrl        *next = (struct attrl *)calloc(1, sizeof(struct attrl));
+  string               cursor("stale");
+
+  memset(&job1, 0, sizeof(job1));
+  memset(&page, 0, sizeof(page));
+  job1.name = (char *)"1.napali";
+  job1.next = &page;
+  page.name = (char *)PAGE_STATUS_NAME;
+  page.attribs = next;
+  next->name = (char *)PAGE_NEXT;
+  next->value = (char *)"1/1.napali";
+
+  take_page_cursor(&pstatus, cursor);
+  fail_unless(cursor == "1/1.napali");
+  fail_unless(pstatus == &job1);
+  fail_unless(job1.next == NULL);
+
+  // the last page has no cursor
+  take_page_cursor(&pstatus, cursor);
+  fail_unless(cursor.size() == 0);
+  fail_unless(pstatus == &job1);
+
+  pstatus = &page;
+  take_page_cursor(&pstatus, cursor);
+  fail_unless(cursor == "1/1.napali");
+  fail_unless(pstatus == NULL);
+  }
+END_TEST
+
 Suite *qstat_suite(void)
   {
   Suite *s = suite_create("qstat_suite methods");
@@ -715,6 +773,11 @@ Suite *qstat_suite(void)
   tcase_add_test(tc_core, test_get_tasks_from_nodes_resc);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_job_stat_extend");
+  tcase_add_test(tc_core, test_job_stat_extend);
+  tcase_add_test(tc_core, test_take_page_cursor);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
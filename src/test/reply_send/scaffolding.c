@@ -48,6 +48,13 @@ void free_attrlist(tlist_head *pattrlisthead)
   exit(1);
   }
 
+attrlist_arena *freed_arena = NULL;
+
+void attrlist_arena_free(attrlist_arena *arena)
+  {
+  freed_arena = arena;
+  }
+
 char *pbse_to_txt(int err)
   {
   fprintf(stderr, "The call to pbse_to_txt needs to be mocked!!\n");
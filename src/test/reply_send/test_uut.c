@@ -3,11 +3,32 @@
 #include "test_reply_send.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "pbs_error.h"
+#include "libpbs.h"
+
+extern attrlist_arena *freed_arena;
+
 START_TEST(test_one)
   {
+  struct batch_reply  reply;
+  char                stand_in;
+  attrlist_arena     *arena = (attrlist_arena *)&stand_in;
+
+  memset(&reply, 0, sizeof(reply));
+
+  /* the arena holding a status reply's entries goes with the reply */
+  reply.brp_choice = BATCH_REPLY_CHOICE_NULL;
+  reply.brp_arena = arena;
 
+  reply_free(&reply);
+  fail_unless(freed_arena == arena);
+  fail_unless(reply.brp_arena == NULL);
 
+  /* a reply without one frees nothing more */
+  freed_arena = NULL;
+  reply_free(&reply);
+  fail_unless(freed_arena == NULL);
   }
 END_TEST
 
@@ -13,6 +13,7 @@
 #include "queue.h" /* pbs_queue */
 #include "work_task.h" /* work_task */
 #include "threadpool.h"
+#include "job_change_log.hpp"
 
 const char *PJobSubState[10];
 int svr_resc_size = 0;
@@ -24,6 +25,7 @@ resource_def *svr_resc_def;
 const char *PJobState[] = {"hi", "hello"};
 struct server server;
 int LOGLEVEL = 7; /* force logging code to be exercised as tests run */
+job_change_log job_changes;
 
 static int acl_check_n = 0;
 
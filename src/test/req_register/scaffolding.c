@@ -1,4 +1,5 @@
 #include "license_pbs.h" /* See here for the software license */
+#include <vector>
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
 #include <ctype.h>
@@ -29,8 +30,10 @@ int   is_attr_set;
 
 struct batch_request *alloc_br(int type)
   {
-  fprintf(stderr, "The call to alloc_br to be mocked!!\n");
-  exit(1);
+  batch_request *preq = (batch_request *)calloc(1, sizeof(batch_request));
+
+  preq->rq_type = type;
+  return(preq);
   }
 
 int job_save(job *pjob, int updatetype, int mom_port)
@@ -82,6 +85,11 @@ svrattrl *attrlist_create(const char *aname, const char *rname, int vsize)
   return(pal);
   }
 
+void free_attrlist_entry(svrattrl *pal)
+  {
+  free(pal);
+  }
+
 void reply_ack(struct batch_request *preq)
   {
   }
@@ -179,6 +187,17 @@ int que_to_local_svr(struct batch_request *preq)
   exit(1);
   }
 
+int                          local_batches = 0;
+std::vector<batch_request *> local_batch;
+
+int que_to_local_svr_batch(std::vector<batch_request *> &requests)
+  {
+  local_batches++;
+  local_batch = requests;
+  requests.clear();
+  return(PBSE_NONE);
+  }
+
 
 int svr_setjobstate(job *pjob, int newstate, int newsubstate, int has_queue_mutex)
   {
@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h>
+#include <vector>
 
 #include "req_register.h"
 #include "test_uut.h"
@@ -39,12 +40,15 @@ int req_register(batch_request *preq);
 bool remove_array_dependency_job_from_job(struct array_depend *pdep, job *pjob, char *job_array_id);
 void removeAfterAnyDependency(const char *pJobID, const char *targetJob);
 bool job_ids_match(const char *parent, const char *child);
+int depend_on_term(job *pjob);
 
 
 extern char server_name[];
 extern int i;
 extern int svr;
 extern int is_attr_set;
+extern int local_batches;
+extern std::vector<batch_request *> local_batch;
 
 char          *job1 = (char *)"1.napali";
 char          *job2 = (char *)"2.napali";
@@ -701,6 +705,57 @@ START_TEST(set_depend_hold_test)
 END_TEST
 
 
+START_TEST(depend_on_term_test)
+  {
+  job            pjob;
+  pbs_attribute *pattr;
+  struct depend *pdep;
+  char           child[PBS_MAXSVRJOBID + 1];
+
+  strcpy(server_name, host);
+  strcpy(pjob.ji_qs.ji_jobid, job1);
+  pjob.ji_wattr[JOB_ATR_job_owner].at_val.at_str = strdup("dbeer@napali");
+  pjob.ji_qs.ji_un.ji_exect.ji_exitstat = 0;
+  pattr = &pjob.ji_wattr[JOB_ATR_depend];
+  initialize_depend_attr(pattr);
+
+  pdep = make_depend(JOB_DEPEND_TYPE_BEFOREOK, pattr);
+  for (int j = 0; j < 100; j++)
+    {
+    snprintf(child, sizeof(child), "%d.napali", j + 10);
+    make_dependjob(pdep, child);
+    }
+
+  /* the whole fan-out is released by one batch */
+  local_batches = 0;
+  fail_unless(depend_on_term(&pjob) == PBSE_NONE);
+  fail_unless(local_batches == 1);
+  fail_unless(local_batch.size() == 100);
+
+  for (unsigned int j = 0; j < local_batch.size(); j++)
+    {
+    snprintf(child, sizeof(child), "%d.napali", j + 10);
+    fail_unless(local_batch[j]->rq_type == PBS_BATCH_RegistDep);
+    fail_unless(local_batch[j]->rq_ind.rq_register.rq_op == JOB_DEPEND_OP_RELEASE);
+    fail_unless(strcmp(local_batch[j]->rq_ind.rq_register.rq_parent, child) == 0);
+    fail_unless(strcmp(local_batch[j]->rq_ind.rq_register.rq_child, job1) == 0);
+    fail_unless(strcmp(local_batch[j]->rq_ind.rq_register.rq_owner, "dbeer") == 0);
+    free(local_batch[j]);
+    }
+
+  /* a failed job deletes its beforeok jobs instead */
+  pjob.ji_qs.ji_un.ji_exect.ji_exitstat = 1;
+  fail_unless(depend_on_term(&pjob) == PBSE_NONE);
+  fail_unless(local_batches == 2);
+  fail_unless(local_batch.size() == 100);
+  fail_unless(local_batch[99]->rq_ind.rq_register.rq_op == JOB_DEPEND_OP_DELETE);
+
+  for (unsigned int j = 0; j < local_batch.size(); j++)
+    free(local_batch[j]);
+  }
+END_TEST
+
+
 START_TEST(delete_dependency_job_test)
   {
   job           *pjob = job_alloc();
@@ -823,6 +878,7 @@ Suite *req_register_suite(void)
   tcase_add_test(tc_core, release_syncwith_dependency_test);
   tcase_add_test(tc_core, set_depend_hold_test);
   tcase_add_test(tc_core, delete_dependency_job_test);
+  tcase_add_test(tc_core, depend_on_term_test);
   tcase_add_test(tc_core, remove_after_any_test);
   tcase_add_test(tc_core, req_register_test);
   tcase_add_test(tc_core, set_array_depend_holds_test);
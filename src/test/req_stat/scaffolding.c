@@ -1,6 +1,7 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <string.h>
 #include <pthread.h> /* pthread_mutex_t */
 
 #include "pbs_nodes.h" /* all_nodes, pbsnode */
@@ -14,6 +15,7 @@
 #include "work_task.h" /* work_task, work_type */
 #include "u_tree.h" /* AvlTree */
 #include "queue.h"
+#include "job_change_log.hpp"
 
 all_nodes allnodes;
 pthread_mutex_t *netrates_mutex = NULL;
@@ -27,6 +29,7 @@ all_jobs array_summary;
 attribute_def svr_attr_def[10];
 int svr_totnodes = 0;
 int LOGLEVEL = 7; /* force logging code to be exercised as tests run */
+job_change_log job_changes;
 bool exit_called = false;
 int abort_called;
 
@@ -56,8 +59,18 @@ void svr_mailowner(job *pjob, int mailpoint, int force, const char *text)
 
 svrattrl *attrlist_create(const char *aname, const char *rname, int vsize)
   {
-  fprintf(stderr, "The call to attrlist_create to be mocked!!\n");
-  exit(1);
+  size_t    asz = strlen(aname) + 1;
+  svrattrl *pal = (svrattrl *)calloc(1, sizeof(svrattrl) + asz + vsize);
+
+  CLEAR_LINK(pal->al_link);
+  pal->al_tsize = sizeof(svrattrl) + asz + vsize;
+  pal->al_nameln = asz;
+  pal->al_valln = vsize;
+  pal->al_name = (char *)pal + sizeof(svrattrl);
+  pal->al_value = pal->al_name + asz;
+  strcpy(pal->al_name, aname);
+
+  return(pal);
   }
 
 int modify_job_attr(job *pjob, svrattrl *plist, int perm, int *bad)
@@ -204,8 +217,11 @@ void release_req(struct work_task *pwt)
 
 void append_link(tlist_head *head, list_link *new_link, void *pobj)
   {
-  fprintf(stderr, "The call to append_link to be mocked!!\n");
-  exit(1);
+  new_link->ll_struct = pobj;
+  new_link->ll_prior = head->ll_prior;
+  new_link->ll_next = head;
+  head->ll_prior->ll_next = new_link;
+  head->ll_prior = new_link;
   }
 
 pbs_queue *next_queue(all_queues *aq, all_queues_iterator *iter)
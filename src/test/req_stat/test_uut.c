@@ -8,7 +8,10 @@
 
 bool in_execution_queue(job *pjob, job_array *pa);
 job *get_next_status_job(struct stat_cntl *cntl, int &job_array_index, job_array *pa, all_jobs_iterator *iter);
+all_jobs_iterator *get_correct_status_iterator(struct stat_cntl *cntl);
+int add_page_status(tlist_head *pstathd, int walked, const char *last_jobid);
 extern int abort_called;
+extern all_jobs alljobs;
 
 enum TJobStatTypeEnum
   {
@@ -107,6 +110,71 @@ START_TEST(test_get_next_status_job)
 END_TEST
 
 
+START_TEST(test_paged_status_iterator)
+  {
+  struct stat_cntl   cntl;
+  all_jobs_iterator *iter;
+  job               *pjob;
+
+  memset(&cntl, 0, sizeof(cntl));
+  cntl.sc_type = tjstServer;
+
+  for (int i = 0; i < 4; i++)
+    {
+    pjob = (job *)calloc(1, sizeof(job));
+    snprintf(pjob->ji_qs.ji_jobid, sizeof(pjob->ji_qs.ji_jobid), "%d.napali", i);
+    alljobs.insert(pjob, pjob->ji_qs.ji_jobid);
+    }
+
+  // the first page starts at the beginning
+  iter = get_correct_status_iterator(&cntl);
+  pjob = iter->get_next_item();
+  fail_unless(!strcmp(pjob->ji_qs.ji_jobid, "0.napali"));
+  delete iter;
+
+  // later pages start after the last job of the one before
+  cntl.sc_page_offset = 2;
+  strcpy(cntl.sc_page_after, "1.napali");
+  iter = get_correct_status_iterator(&cntl);
+  pjob = iter->get_next_item();
+  fail_unless(!strcmp(pjob->ji_qs.ji_jobid, "2.napali"));
+  delete iter;
+
+  // if that job is gone, at the same position
+  alljobs.remove("1.napali");
+  cntl.sc_page_offset = 2;
+  iter = get_correct_status_iterator(&cntl);
+  pjob = iter->get_next_item();
+  fail_unless(!strcmp(pjob->ji_qs.ji_jobid, "3.napali"));
+  delete iter;
+
+  alljobs.clear();
+  }
+END_TEST
+
+
+START_TEST(test_add_page_status)
+  {
+  tlist_head         stathd;
+  struct brp_status *pstat;
+  svrattrl          *pal;
+
+  CLEAR_HEAD(stathd);
+
+  fail_unless(add_page_status(&stathd, 1000, "1234.napali") == PBSE_NONE);
+
+  pstat = (struct brp_status *)stathd.ll_next->ll_struct;
+  fail_unless(pstat != NULL);
+  fail_unless(!strcmp(pstat->brp_objname, PAGE_STATUS_NAME));
+
+  pal = (svrattrl *)pstat->brp_attr.ll_next->ll_struct;
+  fail_unless(pal != NULL);
+  fail_unless(!strcmp(pal->al_name, PAGE_NEXT));
+  fail_unless(!strcmp(pal->al_value, "1000/1234.napali"), "got '%s'", pal->al_value);
+  }
+END_TEST
+
+
 Suite *req_stat_suite(void)
   {
   Suite *s = suite_create("req_stat_suite methods");
@@ -119,6 +187,11 @@ Suite *req_stat_suite(void)
   tcase_add_test(tc_core, test_get_next_status_job);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_paged_status_iterator");
+  tcase_add_test(tc_core, test_paged_status_iterator);
+  tcase_add_test(tc_core, test_add_page_status);
+  suite_add_tcase(s, tc_core);
+
   return s;
   }
 
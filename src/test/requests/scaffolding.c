@@ -135,6 +135,11 @@ int encode_DIS_JobFile(struct tcp_chan *chan, int seq, char *buf, int len, const
   return(0);
   }
 
+int encode_DIS_JobFile_fd(struct tcp_chan *chan, int seq, int fd, off_t offset, int len, const char *jobid, int which)
+  {
+  return(0);
+  }
+
 void free_br(struct batch_request *preq)
   {
   fprintf(stderr, "The call to free_br needs to be mocked!!\n");
@@ -241,6 +241,11 @@ int x11_create_display(int x11_use_localhost, char *display, char *phost, int pp
   exit(1);
   }
 
+int socket_get_tcp_priv()
+  {
+  return(socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0));
+  }
+
 eventent *event_alloc(int command, hnodent *pnode, tm_event_t event, tm_task_id taskid)
   {
   fprintf(stderr, "The call to event_alloc needs to be mocked!!\n");
@@ -19,6 +19,7 @@ int get_indices_from_exec_str(const char *exec_str, char *buf, int buf_size);
 int  remove_leading_hostname(char **jobpath);
 int get_num_nodes_ppn(const char*, int*, int*);
 int setup_process_launch_pipes(int &kid_read, int &kid_write, int &parent_read, int &parent_write);
+void join_latency_histogram(const std::vector<long> &latencies, std::string &histogram);
 
 #ifdef NUMA_SUPPORT
 extern nodeboard node_boards[];
@@ -595,6 +596,25 @@ START_TEST(test_get_num_nodes_ppn)
   }
 END_TEST
 
+START_TEST(test_join_latency_histogram)
+  {
+  std::vector<long> latencies;
+  std::string       histogram;
+
+  join_latency_histogram(latencies, histogram);
+  fail_unless(histogram == "<1ms:0 <10ms:0 <100ms:0 <1s:0 <10s:0 >=10s:0 max:0ms", histogram.c_str());
+
+  latencies.push_back(500);
+  latencies.push_back(999);
+  latencies.push_back(1000);
+  latencies.push_back(250000);
+  latencies.push_back(12000000);
+
+  join_latency_histogram(latencies, histogram);
+  fail_unless(histogram == "<1ms:2 <10ms:1 <100ms:0 <1s:1 <10s:0 >=10s:1 max:12000ms", histogram.c_str());
+  }
+END_TEST
+
 Suite *start_exec_suite(void)
   {
   Suite *s = suite_create("start_exec_suite methods");
@@ -641,6 +661,7 @@ Suite *start_exec_suite(void)
 
   tc_core = tcase_create("test_get_num_nodes_ppn");
   tcase_add_test(tc_core, test_get_num_nodes_ppn);
+  tcase_add_test(tc_core, test_join_latency_histogram);
   tcase_add_test(tc_core, test_setup_process_launch_pipes);
   tcase_add_test(tc_core, test_read_launcher_child_status);
 #ifdef PENABLE_LINUX_CGROUPS
@@ -135,6 +135,16 @@ svrattrl *attrlist_create(const char *aname, const char *rname, int vsize)
   exit(1);
   }
 
+attrlist_arena *attrlist_arena_create(void)
+  {
+  return(NULL);
+  }
+
+attrlist_arena *attrlist_use_arena(attrlist_arena *arena)
+  {
+  return(NULL);
+  }
+
 int svr_authorize_jobreq(struct batch_request *preq, job *pjob)
   {
   fprintf(stderr, "The call to svr_authorize_jobreq to be mocked!!\n");
@@ -20,6 +20,7 @@
 #include "machine.hpp"
 #include "log.h"
 #include "utils.h"
+#include "job_change_log.hpp"
 
 all_nodes               allnodes;
 bool possible = false;
@@ -42,6 +43,7 @@ all_jobs array_summary;
 int svr_do_schedule = SCH_SCHEDULE_NULL;
 int listener_command = SCH_SCHEDULE_NULL;
 int LOGLEVEL = 10;
+job_change_log job_changes;
 pthread_mutex_t *svr_do_schedule_mutex;
 pthread_mutex_t *listener_command_mutex;
 struct pbsnode *alps_reporter;
@@ -82,6 +84,7 @@ pbs_queue *find_queuebyname(const char *quename)
   pq->qu_mutex = (pthread_mutex_t*)calloc(1, sizeof(pthread_mutex_t));
   pq->qu_jobs = new all_jobs();
   pq->qu_jobs_array_sum = new all_jobs();
+  pq->qu_attr[QA_ATR_QType].at_val.at_str = strdup("Execution");
 
   snprintf(pq->qu_qs.qu_name, sizeof(pq->qu_qs.qu_name), "%s", quename);
 
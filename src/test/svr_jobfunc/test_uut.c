@@ -188,6 +188,11 @@ START_TEST(chk_mppnodect_test)
   }
 END_TEST
 
+int decode_noop(pbs_attribute *pattr, const char *name, const char *rescn, const char *val, int perm)
+  {
+  return(0);
+  }
+
 START_TEST(svr_enquejob_test)
   {
   struct job test_job;
@@ -207,9 +212,12 @@ START_TEST(svr_enquejob_test)
   result = svr_enquejob(NULL, 0, NULL, false, false);
   fail_unless(result != PBSE_NONE, "NULL input pointer fail");
 
+  /* the job is queued in rank order without being looked up again */
+  job_attr_def[JOB_ATR_in_queue].at_free = free_null;
+  job_attr_def[JOB_ATR_in_queue].at_decode = decode_noop;
+  test_job.ji_wattr[JOB_ATR_qtime].at_flags = ATR_VFLAG_SET;
   result = svr_enquejob(&test_job, 0, NULL, false, false);
-  /*Need more complicated mocking in order to have other result than PBSE_JOBNOTFOUND*/
-  fail_unless(result == PBSE_JOBNOTFOUND, "svr_enquejob fail: %d", result);
+  fail_unless(result == PBSE_NONE, "svr_enquejob fail: %d", result);
 
   }
 END_TEST
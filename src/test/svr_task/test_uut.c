@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <sys/time.h>
 #include "pbs_error.h"
 #include "threadpool.h"
 
@@ -17,7 +18,8 @@ int          dispatch_timed_task(work_task *ptask);
 extern all_tasks      task_list_event;
 extern task_recycler  tr;
 extern threadpool_t  *request_pool;
-extern std::list<timed_task> *task_list_timed;
+extern timed_task_heap *task_list_timed;
+extern pthread_mutex_t  task_list_timed_mutex;
 
 START_TEST(dispatch_timed_task_test)
   {
@@ -28,7 +30,7 @@ START_TEST(dispatch_timed_task_test)
   wt.wt_event = 200;
 
   if (task_list_timed == NULL)
-    task_list_timed = new std::list<timed_task>();
+    task_list_timed = new timed_task_heap();
 
   if (request_pool == NULL)
     initialize_threadpool(&request_pool,10,50,50);
@@ -82,7 +84,7 @@ START_TEST(manage_timed_task_test)
   pthread_mutex_init(ptask3.wt_mutex, NULL);
 
   if (task_list_timed == NULL)
-    task_list_timed = new std::list<timed_task>();
+    task_list_timed = new timed_task_heap();
 
   ptask1.wt_event = 100;
   ptask2.wt_event = 200;
@@ -124,7 +126,7 @@ START_TEST(test_one)
   initialize_task_recycler();
 
   if (task_list_timed == NULL)
-    task_list_timed = new std::list<timed_task>();
+    task_list_timed = new timed_task_heap();
 
   rc = initialize_threadpool(&request_pool, 5, 50, 60);
   fail_unless(rc == PBSE_NONE, "initalize_threadpool failed", rc);
@@ -148,6 +150,121 @@ START_TEST(test_one)
   }
 END_TEST
 
+START_TEST(delete_timed_task_test)
+  {
+  work_task tasks[5];
+  work_task *wt;
+
+  if (task_list_timed == NULL)
+    task_list_timed = new timed_task_heap();
+
+  initialize_task_recycler();
+
+  for (int i = 0; i < 5; i++)
+    {
+    memset(tasks + i, 0, sizeof(work_task));
+    tasks[i].wt_mutex = (pthread_mutex_t *)calloc(1, sizeof(pthread_mutex_t));
+    pthread_mutex_init(tasks[i].wt_mutex, NULL);
+    tasks[i].wt_event = 500 - (i * 100);
+    insert_timed_task(tasks + i);
+    }
+
+  // equal times fire in the order they were set
+  fail_unless(task_list_timed->remove(tasks + 3) == true);
+  fail_unless(task_list_timed->remove(tasks + 3) == false);
+  tasks[3].wt_event = 100;
+  insert_timed_task(tasks + 3);
+
+  // a deleted task never fires
+  pthread_mutex_lock(tasks[2].wt_mutex);
+  delete_task(tasks + 2);
+  fail_unless(tasks[2].wt_timed_index == 0);
+  fail_unless(task_list_timed->size() == 4);
+
+  wt = pop_timed_task(1000);
+  fail_unless(wt == tasks + 4);
+  pthread_mutex_unlock(wt->wt_mutex);
+  wt = pop_timed_task(1000);
+  fail_unless(wt == tasks + 3);
+  pthread_mutex_unlock(wt->wt_mutex);
+  wt = pop_timed_task(1000);
+  fail_unless(wt == tasks + 1);
+  pthread_mutex_unlock(wt->wt_mutex);
+  wt = pop_timed_task(1000);
+  fail_unless(wt == tasks + 0);
+  pthread_mutex_unlock(wt->wt_mutex);
+  fail_unless(pop_timed_task(1000) == NULL);
+  }
+END_TEST
+
+
+
+#define BENCH_TASKS 1000000
+
+/*
+ * microbenchmark: schedule a million timed tasks at random times, cancel
+ * every tenth one and fire the rest in order
+ */
+
+START_TEST(timed_task_heap_benchmark)
+  {
+  work_task       *tasks = (work_task *)calloc(BENCH_TASKS, sizeof(work_task));
+  pthread_mutex_t  shared;
+  struct timeval   start;
+  struct timeval   scheduled;
+  struct timeval   end;
+  work_task       *wt;
+  long             last = 0;
+  int              fired = 0;
+
+  if (task_list_timed == NULL)
+    task_list_timed = new timed_task_heap();
+
+  pthread_mutex_init(&shared, NULL);
+  srand(12);
+
+  gettimeofday(&start, NULL);
+
+  for (int i = 0; i < BENCH_TASKS; i++)
+    {
+    tasks[i].wt_mutex = &shared;
+    tasks[i].wt_event = rand() % 86400;
+    insert_timed_task(tasks + i);
+    }
+
+  for (int i = 0; i < BENCH_TASKS; i += 10)
+    {
+    pthread_mutex_lock(&task_list_timed_mutex);
+    fail_unless(task_list_timed->remove(tasks + i) == true);
+    pthread_mutex_unlock(&task_list_timed_mutex);
+    }
+
+  gettimeofday(&scheduled, NULL);
+
+  while ((wt = pop_timed_task(86400)) != NULL)
+    {
+    fail_unless(wt->wt_event >= last);
+    last = wt->wt_event;
+    fired++;
+    pthread_mutex_unlock(wt->wt_mutex);
+    }
+
+  gettimeofday(&end, NULL);
+
+  fail_unless(fired == BENCH_TASKS - (BENCH_TASKS / 10));
+
+  fprintf(stderr, "timed tasks: scheduled %d and cancelled %d in %.3f sec, fired %d in %.3f sec\n",
+    BENCH_TASKS, BENCH_TASKS / 10,
+    (scheduled.tv_sec - start.tv_sec) + (scheduled.tv_usec - start.tv_usec) / 1000000.0,
+    fired,
+    (end.tv_sec - scheduled.tv_sec) + (end.tv_usec - scheduled.tv_usec) / 1000000.0);
+
+  free(tasks);
+  }
+END_TEST
+
+
+
 Suite *svr_task_suite(void)
   {
   Suite *s = suite_create("svr_task_suite methods");
@@ -159,6 +276,12 @@ Suite *svr_task_suite(void)
   tcase_add_test(tc_core, can_dispatch_task_test);
   tcase_add_test(tc_core, manage_timed_task_test);
   tcase_add_test(tc_core, dispatch_timed_task_test);
+  tcase_add_test(tc_core, delete_timed_task_test);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("timed_task_heap_benchmark");
+  tcase_add_test(tc_core, timed_task_heap_benchmark);
+  tcase_set_timeout(tc_core, 60);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -1,7 +1,11 @@
 #include "license_pbs.h" /* See here for the software license */
 #include <stdlib.h>
 #include <stdio.h> /* fprintf */
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
 #include "tcp.h"
+#include "pbs_error.h"
 
 ssize_t read_nonblocking_socket(int fd, void *buf, ssize_t count)
   {
@@ -29,15 +33,34 @@ int unlock_tcp_table()
 
 void log_err(int errnum, const char *routine, const char *text) {}
 
-int socket_read(int socket, char **the_str, long long *str_len, unsigned int timeout)
+int socket_wait_for_data(int socket, unsigned int timeout, long long *avail_bytes)
   {
-  fprintf(stderr, "The call to socket_read needs to be mocked!!\n");
-  return(1);
+  struct pollfd pfd = { socket, POLLIN, 0 };
+  int           avail = 0;
+
+  if (poll(&pfd, 1, timeout * 1000) != 1)
+    return(PBSE_TIMEOUT);
+
+  ioctl(socket, FIONREAD, &avail);
+  *avail_bytes = avail;
+
+  return((avail == 0) ? PBSE_SOCKET_READ : PBSE_NONE);
+  }
+
+int socket_read_force(int socket, char *the_str, long long avail_bytes, long long *byte_count)
+  {
+  ssize_t rc = read(socket, the_str, avail_bytes);
+
+  if (rc <= 0)
+    return(PBSE_SOCKET_READ);
+
+  *byte_count += rc;
+  return(PBSE_NONE);
   }
 
 ssize_t write_ac_socket(int fd, const void *buf, ssize_t count)
   {
-  return(0);
+  return(write(fd, buf, count));
   }
 
 ssize_t read_ac_socket(int fd, void *buf, ssize_t count)
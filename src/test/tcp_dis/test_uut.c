@@ -1,35 +1,167 @@
 #include "license_pbs.h" /* See here for the software license */
 #include "lib_ifl.h"
+#include "dis.h"
 #include "test_tcp_dis.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
 
 
 #include "pbs_error.h"
 
-START_TEST(test_one)
+#define BIG_MESSAGE (THE_BUF_SIZE * 10 + 7)
+
+int  sockets[2];
+char big[BIG_MESSAGE];
+
+
+void *write_big(
+
+  void *arg)
+
   {
+  size_t written = 0;
+  ssize_t rc;
 
+  while (written < sizeof(big))
+    {
+    if ((rc = write(sockets[1], big + written, sizeof(big) - written)) <= 0)
+      break;
 
+    written += rc;
+    }
+
+  return(NULL);
+  }
+
+
+START_TEST(test_read_grows_buffer)
+  {
+  struct tcp_chan *chan;
+  pthread_t        writer;
+  char            *got = (char *)calloc(1, sizeof(big));
+
+  for (size_t i = 0; i < sizeof(big); i++)
+    big[i] = 'a' + i % 26;
+
+  fail_unless(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+  chan = DIS_tcp_setup(sockets[0]);
+
+  pthread_create(&writer, NULL, write_big, NULL);
+
+  fail_unless(tcp_gets(chan, got, 10, 5) == 10);
+  tcp_rcommit(chan, TRUE);
+  fail_unless(tcp_gets(chan, got + 10, sizeof(big) - 10, 5) == (int)sizeof(big) - 10);
+  fail_unless(memcmp(got, big, sizeof(big)) == 0);
+
+  pthread_join(writer, NULL);
+
+  /* the other end is closed and nothing was read */
+  close(sockets[1]);
+  fail_unless(tcp_gets(chan, got, 1, 5) == -2);
+
+  DIS_tcp_cleanup(chan);
+  close(sockets[0]);
+  free(got);
   }
 END_TEST
 
-START_TEST(test_two)
+
+START_TEST(test_puts_grows_buffer)
   {
+  struct tcp_chan *chan = DIS_tcp_setup(10);
+  char             chunk[1000];
+
+  memset(chunk, 'x', sizeof(chunk));
 
+  for (int i = 0; i < 100; i++)
+    {
+    chunk[0] = (char)i;
+    fail_unless(tcp_puts(chan, chunk, sizeof(chunk)) == (int)sizeof(chunk));
+    tcp_wcommit(chan, TRUE);
+    }
 
+  /* an uncommitted write is taken back */
+  fail_unless(tcp_puts(chan, chunk, sizeof(chunk)) == (int)sizeof(chunk));
+  tcp_wcommit(chan, FALSE);
+
+  fail_unless(chan->writebuf.tdis_trailp - chan->writebuf.tdis_thebuf == 100 * sizeof(chunk));
+  fail_unless(chan->writebuf.tdis_bufsize >= 100 * sizeof(chunk));
+
+  for (int i = 0; i < 100; i++)
+    fail_unless(chan->writebuf.tdis_thebuf[i * sizeof(chunk)] == (char)i);
+
+  DIS_tcp_cleanup(chan);
+  }
+END_TEST
+
+
+START_TEST(test_wflush_sends_file)
+  {
+  struct tcp_chan *chan;
+  char             path[] = "/tmp/tcp_dis_XXXXXX";
+  const char      *body = "#!/bin/bash\necho hello\n";
+  char             got[256];
+  int              fd = mkstemp(path);
+  ssize_t          len;
+
+  fail_unless(fd >= 0);
+  fail_unless(write(fd, body, strlen(body)) == (ssize_t)strlen(body));
+  fail_unless(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+  chan = DIS_tcp_setup(sockets[0]);
+
+  tcp_puts(chan, "head:", 5);
+  tcp_wcommit(chan, TRUE);
+  fail_unless(DIS_tcp_put_file(chan, fd, 12, strlen(body) - 12) == 0);
+  tcp_puts(chan, ":tail", 5);
+  tcp_wcommit(chan, TRUE);
+  fail_unless(DIS_tcp_wflush(chan) == 0);
+
+  len = read(sockets[1], got, sizeof(got) - 1);
+  got[len] = '\0';
+  fail_unless(strcmp(got, "head:echo hello\n:tail") == 0, got);
+
+  /* a file that isn't committed isn't sent */
+  tcp_puts(chan, "one", 3);
+  tcp_wcommit(chan, TRUE);
+  fail_unless(DIS_tcp_put_file(chan, fd, 0, strlen(body)) == 0);
+  tcp_wcommit(chan, FALSE);
+  fail_unless(DIS_tcp_wflush(chan) == 0);
+
+  len = read(sockets[1], got, sizeof(got) - 1);
+  got[len] = '\0';
+  fail_unless(strcmp(got, "one") == 0, got);
+
+  /* a file that is shorter than it should be is an error */
+  fail_unless(DIS_tcp_put_file(chan, fd, 0, strlen(body) + 1) == 0);
+  tcp_wcommit(chan, TRUE);
+  fail_unless(DIS_tcp_wflush(chan) == -1);
+
+  DIS_tcp_cleanup(chan);
+  close(sockets[0]);
+  close(sockets[1]);
+  close(fd);
+  unlink(path);
   }
 END_TEST
 
+
 Suite *tcp_dis_suite(void)
   {
   Suite *s = suite_create("tcp_dis_suite methods");
-  TCase *tc_core = tcase_create("test_one");
-  tcase_add_test(tc_core, test_one);
+  TCase *tc_core = tcase_create("test_read_grows_buffer");
+  tcase_add_test(tc_core, test_read_grows_buffer);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_puts_grows_buffer");
+  tcase_add_test(tc_core, test_puts_grows_buffer);
   suite_add_tcase(s, tc_core);
 
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  tc_core = tcase_create("test_wflush_sends_file");
+  tcase_add_test(tc_core, test_wflush_sends_file);
   suite_add_tcase(s, tc_core);
 
   return s;
@@ -10,6 +10,7 @@
 #include <map>
 #include <stdio.h>
 #include <errno.h>
+#include <unistd.h>
 #include "dis.h"
 #include "pbs_error.h"
 
@@ -220,7 +221,8 @@ int tcp_read(
     tmp_trailp = tp->tdis_trailp - tp->tdis_thebuf;
     tmp_eod = tp->tdis_eod - tp->tdis_thebuf;
 
-    snprintf(ptr, newsize, "%s%s", tp->tdis_thebuf, new_data);
+    memcpy(ptr, tp->tdis_thebuf, tmp_eod);
+    memcpy(ptr + tmp_eod, new_data, *read_len);
     free(tp->tdis_thebuf);
     tp->tdis_thebuf = ptr;
     tp->tdis_bufsize = newsize;
@@ -586,6 +588,39 @@ int tcp_wcommit(
 
 
 
+/*
+ * DIS_tcp_put_file - the file is copied into the write buffer here instead
+ * of being sent when the buffer is flushed
+ */
+
+int DIS_tcp_put_file(
+
+  struct tcp_chan *chan,
+  int              fd,
+  off_t            offset,
+  size_t           len)
+
+  {
+  char    buf[4096];
+  ssize_t amt;
+
+  while (len > 0)
+    {
+    if ((amt = pread(fd, buf, (len < sizeof(buf)) ? len : sizeof(buf), offset)) <= 0)
+      return(-1);
+
+    if (tcp_puts(chan, buf, amt) < 0)
+      return(-1);
+
+    offset += amt;
+    len -= amt;
+    }
+
+  return(0);
+  }
+
+
+
 int tcp_chan_has_data(
     struct tcp_chan *chan)
   {
@@ -694,3 +729,43 @@ void DIS_tcp_close(
   DIS_tcp_cleanup(chan);
   }
 
+std::map<int, int> peer_versions;
+std::map<int, int> reply_versions;
+
+void DIS_tcp_set_peer_version(
+
+  int sock,
+  int version)
+
+  {
+  peer_versions[sock] = version;
+  }
+
+int DIS_tcp_get_peer_version(
+
+  int sock)
+
+  {
+  std::map<int, int>::iterator it = peer_versions.find(sock);
+
+  return((it == peer_versions.end()) ? DIS_VERSION_TEXT : it->second);
+  }
+
+void DIS_tcp_set_reply_version(
+
+  int sock,
+  int version)
+
+  {
+  reply_versions[sock] = version;
+  }
+
+int DIS_tcp_get_reply_version(
+
+  int sock)
+
+  {
+  std::map<int, int>::iterator it = reply_versions.find(sock);
+
+  return((it == reply_versions.end()) ? DIS_VERSION_TEXT : it->second);
+  }
@@ -39,6 +39,9 @@ bool    getpwuid_success = true;
 bool    trqauthd_terminate_success = true;
 
 int     request_type;
+int     socket_connect_calls = 0;
+int     socket_close_calls = 0;
+std::string socket_written;
 int     trq_down = 0;
 
 char *my_active_server;
@@ -102,6 +105,7 @@ struct passwd *getpwuid(uid_t uid)
 
 int socket_close(int socket)
   {
+  socket_close_calls++;
   return(PBSE_NONE);
   }
 
@@ -109,6 +113,7 @@ int socket_write(int socket, const char *data, int data_len)
   {
   if (write_success == true)
     {
+    socket_written.assign(data, data_len);
     return(data_len);
     }
   else
@@ -305,6 +310,8 @@ int socket_read_num(int socket, long long *the_num)
 
 int socket_connect(int &local_socket, char *dest_addr, int dest_addr_len, int dest_port, int family, int is_privileged, std::string &err_msg)
   {
+  socket_connect_calls++;
+
   if (socket_connect_success == false)
     return(PBSE_SOCKET_FAULT);
   local_socket = 21;
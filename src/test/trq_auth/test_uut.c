@@ -32,17 +32,27 @@ bool    trqauthd_terminate_success;
 
 extern   int request_type;
 extern   int process_svr_conn_rc;
+extern   int socket_connect_calls;
+extern   int socket_close_calls;
+extern   std::string socket_written;
 
 int get_active_pbs_server(char **active_server, int *port);
 int build_request_svr(int auth_type, const char *user, int sock, std::string &message);
 int build_active_server_response(std::string &message);
 int set_active_pbs_server(const char *server_name, const int);
+int take_svr_conn(const char *server_name, int server_port);
+void give_svr_conn(const char *server_name, int server_port, int sock, const char *user_name);
+int close_idle_svr_conns(time_t now);
 
 extern time_t pbs_tcp_timeout;
 extern char   *my_active_server;
 
 
-
+/* closes the server connections authorizations have left open */
+void drain_svr_conns()
+  {
+  close_idle_svr_conns(time(NULL) + 3600);
+  }
 
 
 START_TEST(get_active_pbs_server_test)
@@ -334,7 +344,8 @@ START_TEST(test_process_svr_conn)
   (*process_svr_conn)((void *)sock);
   fail_unless(process_svr_conn_rc != PBSE_NONE, "TRQ_AUTH_CONNECTION failed");
 
-  // Test when socket_get_tcp_priv fails
+  // Test when socket_get_tcp_priv fails, with no open connection to reuse
+  drain_svr_conns();
   getsockopt_success = true;
   tcp_priv_success = false;
   sock = (int *)calloc(1, sizeof(int));
@@ -372,6 +383,86 @@ START_TEST(test_process_svr_conn)
   }
 END_TEST 
 
+START_TEST(test_persistent_svr_conn)
+  {
+  int *sock;
+
+  drain_svr_conns();
+
+  give_svr_conn("hosta", 15001, 30, "fred");
+  fail_unless(take_svr_conn("hosta", 15002) == -1);
+  fail_unless(take_svr_conn("hostb", 15001) == -1);
+  fail_unless(take_svr_conn("hosta", 15001) == 30);
+  fail_unless(take_svr_conn("hosta", 15001) == -1);
+
+  // only so many are kept open
+  for (int i = 0; i < 6; i++)
+    give_svr_conn("hosta", 15001, 30 + i, "fred");
+
+  for (int i = 0; i < 4; i++)
+    fail_unless(take_svr_conn("hosta", 15001) >= 0);
+
+  fail_unless(take_svr_conn("hosta", 15001) == -1);
+
+  // idle connections are disconnected, freeing the server's threads
+  write_success = true;
+  give_svr_conn("hosta", 15001, 40, "fred");
+  give_svr_conn("hostb", 15001, 41, "barney");
+  fail_unless(close_idle_svr_conns(time(NULL)) == 0);
+  socket_close_calls = 0;
+  socket_written.clear();
+  fail_unless(close_idle_svr_conns(time(NULL) + 60) == 2);
+  fail_unless(socket_close_calls == 2);
+  fail_unless(socket_written.find("+2+22+59") == 0, "wrote '%s'", socket_written.c_str());
+  fail_unless(take_svr_conn("hosta", 15001) == -1);
+  fail_unless(take_svr_conn("hostb", 15001) == -1);
+  fail_unless(close_idle_svr_conns(time(NULL) + 60) == 0);
+
+  // a second authorization goes over the first one's connection
+  connect_success = true;
+  getaddrinfo_success = true;
+  socket_success = true;
+  setsockopt_success = true;
+  close_success = true;
+  write_success = true;
+  socket_read_success = true;
+  socket_read_num_success = true;
+  getsockopt_success = true;
+  tcp_priv_success = true;
+  socket_connect_success = true;
+  DIS_success = true;
+  getpwuid_success = true;
+  get_hostaddr_success = true;
+  gethostname_success = true;
+  trqauthd_terminate_success = false;
+  socket_connect_calls = 0;
+
+  for (int i = 0; i < 2; i++)
+    {
+    sock = (int *)calloc(1, sizeof(int));
+    *sock = 20;
+    request_type = TRQ_AUTH_CONNECTION;
+    (*process_svr_conn)((void *)sock);
+    fail_unless(process_svr_conn_rc == PBSE_NONE, "TRQ_AUTH_CONNECTION failed: %d", process_svr_conn_rc);
+    }
+
+  fail_unless(socket_connect_calls == 1, "connected %d times", socket_connect_calls);
+
+  // if the server has dropped it, a new connection is made right away
+  DIS_success = false;
+  sock = (int *)calloc(1, sizeof(int));
+  *sock = 20;
+  request_type = TRQ_AUTH_CONNECTION;
+  (*process_svr_conn)((void *)sock);
+  fail_unless(process_svr_conn_rc != PBSE_NONE);
+  // the dropped connection is not counted as one of MAX_RETRIES (5) attempts
+  fail_unless(socket_connect_calls == 1 + 5, "connected %d times", socket_connect_calls);
+
+  DIS_success = true;
+  drain_svr_conns();
+  }
+END_TEST
+
 START_TEST(test_send_svr_disconnect)
   {
   int sock = 10;
@@ -524,6 +615,10 @@ Suite *trq_auth_suite(void)
   tcase_add_test(tc_core, test_process_svr_conn);
   suite_add_tcase(s, tc_core);
 
+  tc_core = tcase_create("test_persistent_svr_conn");
+  tcase_add_test(tc_core, test_persistent_svr_conn);
+  suite_add_tcase(s, tc_core);
+
   tc_core = tcase_create("test_send_svr_disconnect");
   tcase_add_test(tc_core, test_send_svr_disconnect);
   suite_add_tcase(s, tc_core);
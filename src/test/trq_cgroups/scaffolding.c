@@ -0,0 +1,97 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <stdlib.h>
+#include <stdio.h>
+#include <pbs_config.h>
+
+#include "log.h" /* LOG_BUF_SIZE */
+#include "pbs_ifl.h" /* PBS_MAXHOSTNAME */
+#include "attribute.h"
+#include "machine.hpp"
+#include "complete_req.hpp"
+#include "allocation.hpp"
+
+int  LOGLEVEL = 7; /* force logging code to be exercised as tests run */
+char log_buffer[LOG_BUF_SIZE];
+char mom_alias[PBS_MAXHOSTNAME + 1];
+int  is_login_node = 0;
+
+Machine::Machine() {}
+Machine::~Machine() {}
+
+PCI_Device::~PCI_Device() {}
+
+Socket::~Socket() {}
+
+Chip::~Chip() {}
+
+Core::~Core() {}
+
+Machine this_node;
+
+int Machine::getTotalChips() const
+  {
+  return(0);
+  }
+
+int Machine::getTotalThreads() const
+  {
+  return(0);
+  }
+
+allocation::allocation() {}
+
+unsigned int complete_req::get_num_reqs()
+  {
+  return(0);
+  }
+
+req &complete_req::get_req(int index)
+  {
+  static req r;
+
+  return(r);
+  }
+
+int complete_req::req_count() const
+  {
+  return(0);
+  }
+
+req::req() {}
+
+bool req::is_per_task() const
+  {
+  return(false);
+  }
+
+int req::getTaskCount() const
+  {
+  return(0);
+  }
+
+int req::get_task_allocation(unsigned int index, allocation &task_allocation) const
+  {
+  return(0);
+  }
+
+void req::get_task_host_name(std::string &host, unsigned int task_index) {}
+
+void get_device_indices(const char *device_str, std::vector<unsigned int> &device_indices, const char *suffix) {}
+
+bool task_hosts_match(const char *one, const char *two)
+  {
+  return(true);
+  }
+
+bool have_incompatible_dash_l_resource(pbs_attribute *pattr)
+  {
+  return(false);
+  }
+
+int rmdir_ext(const char *dirname, int retry_limit)
+  {
+  return(0);
+  }
+
+void log_err(int errnum, const char *routine, const char *text) {}
+void log_event(int eventtype, int objclass, const char *objname, const char *text) {}
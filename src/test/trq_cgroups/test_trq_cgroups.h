@@ -0,0 +1,9 @@
+#include "license_pbs.h" /* See here for the software license */
+#ifndef _TRQ_CGROUPS_CT_H
+#define _TRQ_CGROUPS_CT_H
+#include <check.h>
+
+#define TRQ_CGROUPS_SUITE 1
+Suite *trq_cgroups_suite();
+
+#endif /* _TRQ_CGROUPS_CT_H */
@@ -0,0 +1,178 @@
+#include "license_pbs.h" /* See here for the software license */
+#include <pbs_config.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "trq_cgroups.h"
+#include "test_trq_cgroups.h"
+#include "pbs_error.h"
+
+char fake_cgroup_root[] = "/tmp/trq_cgroupsXXXXXX";
+
+
+void make_fake_cgroup_file(
+
+  const std::string &path,
+  const char        *contents)
+
+  {
+  std::string dir = path.substr(0, path.rfind('/'));
+  std::string cmd = "mkdir -p " + dir;
+  FILE       *fp;
+
+  fail_unless(system(cmd.c_str()) == 0);
+
+  fp = fopen(path.c_str(), "w");
+  fail_unless(fp != NULL);
+  fprintf(fp, "%s", contents);
+  fclose(fp);
+  }
+
+
+/*
+ * builds a fake cgroup filesystem with a cpuacct and memory hierarchy
+ * holding jobs 1.napali and 3.napali
+ */
+
+void setup_fake_cgroups()
+
+  {
+  std::string root;
+
+  fail_unless(mkdtemp(fake_cgroup_root) != NULL);
+  root = fake_cgroup_root;
+
+  make_fake_cgroup_file(root + "/cpuacct/torque/1.napali/cpuacct.usage", "5000000000\n");
+  make_fake_cgroup_file(root + "/cpuacct/torque/1.napali/cgroup.procs", "101\n102\n");
+  make_fake_cgroup_file(root + "/cpuacct/torque/1.napali/R0.t0/cpuacct.usage", "3000000000\n");
+  make_fake_cgroup_file(root + "/cpuacct/torque/1.napali/R0.t0/cgroup.procs", "103\n");
+  make_fake_cgroup_file(root + "/cpuacct/torque/3.napali/cgroup.procs", "301\n");
+  make_fake_cgroup_file(root + "/memory/torque/1.napali/memory.max_usage_in_bytes", "1048576\n");
+  make_fake_cgroup_file(root + "/memory/torque/1.napali/R0.t0/memory.max_usage_in_bytes", "524288\n");
+  }
+
+
+void use_fake_hierarchy()
+
+  {
+  cg_cpuacct_path = std::string(fake_cgroup_root) + "/cpuacct/torque/";
+  cg_memory_path = std::string(fake_cgroup_root) + "/memory/torque/";
+  }
+
+
+START_TEST(test_trq_cg_get_job_stats)
+  {
+  unsigned long      cput_used;
+  unsigned long long mem_used;
+
+  use_fake_hierarchy();
+
+  fail_unless(trq_cg_get_job_cput_stats("1.napali", cput_used) == PBSE_NONE);
+  fail_unless(cput_used == 5, "cput %lu", cput_used);
+
+  fail_unless(trq_cg_get_job_memory_stats("1.napali", mem_used) == PBSE_NONE);
+  fail_unless(mem_used == 1048576);
+
+  /* no cgroup for this job */
+  fail_unless(trq_cg_get_job_cput_stats("4.napali", cput_used) == PBSE_CAN_NOT_OPEN_FILE);
+  fail_unless(trq_cg_get_job_memory_stats("4.napali", mem_used) == PBSE_CAN_NOT_OPEN_FILE);
+  }
+END_TEST
+
+
+START_TEST(test_trq_cg_get_task_stats)
+  {
+  unsigned long      cput_used;
+  unsigned long long mem_used;
+
+  use_fake_hierarchy();
+
+  /* task stats are reported in nanoseconds */
+  fail_unless(trq_cg_get_task_cput_stats("1.napali", 0, 0, cput_used) == PBSE_NONE);
+  fail_unless(cput_used == 3000000000UL);
+
+  fail_unless(trq_cg_get_task_memory_stats("1.napali", 0, 0, mem_used) == PBSE_NONE);
+  fail_unless(mem_used == 524288);
+
+  /* a missing task cgroup is an error */
+  fail_unless(trq_cg_get_task_cput_stats("1.napali", 0, 1, cput_used) == PBSE_SYSTEM);
+  fail_unless(trq_cg_get_task_memory_stats("1.napali", 0, 1, mem_used) == PBSE_SYSTEM);
+  }
+END_TEST
+
+
+START_TEST(test_trq_cg_get_job_pids)
+  {
+  std::vector<pid_t> pids;
+
+  use_fake_hierarchy();
+
+  /* the job's own pids and its task cgroup's, but not 3.napali's */
+  fail_unless(trq_cg_get_job_pids("1.napali", pids) == PBSE_NONE);
+  std::sort(pids.begin(), pids.end());
+
+  fail_unless(pids.size() == 3, "found %d pids", (int)pids.size());
+  fail_unless(pids[0] == 101);
+  fail_unless(pids[1] == 102);
+  fail_unless(pids[2] == 103);
+
+  pids.clear();
+  fail_unless(trq_cg_get_job_pids("3.napali", pids) == PBSE_NONE);
+  fail_unless(pids.size() == 1);
+  fail_unless(pids[0] == 301);
+
+  pids.clear();
+  fail_unless(trq_cg_get_job_pids("4.napali", pids) == PBSE_CAN_NOT_OPEN_FILE);
+  fail_unless(pids.size() == 0);
+  }
+END_TEST
+
+
+Suite *trq_cgroups_suite(void)
+  {
+  Suite *s = suite_create("trq_cgroups_suite methods");
+  TCase *tc_core = tcase_create("test_trq_cg_get_job_stats");
+  tcase_add_test(tc_core, test_trq_cg_get_job_stats);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_trq_cg_get_task_stats");
+  tcase_add_test(tc_core, test_trq_cg_get_task_stats);
+  suite_add_tcase(s, tc_core);
+
+  tc_core = tcase_create("test_trq_cg_get_job_pids");
+  tcase_add_test(tc_core, test_trq_cg_get_job_pids);
+  suite_add_tcase(s, tc_core);
+
+  return s;
+  }
+
+void rundebug()
+  {
+  }
+
+int main(void)
+  {
+  int number_failed = 0;
+  SRunner *sr = NULL;
+  std::string cleanup;
+
+  rundebug();
+  setup_fake_cgroups();
+  sr = srunner_create(trq_cgroups_suite());
+  srunner_set_log(sr, "trq_cgroups_suite.log");
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+
+  cleanup = std::string("rm -rf ") + fake_cgroup_root;
+  if (system(cleanup.c_str()) != 0)
+    number_failed++;
+
+  return number_failed;
+  }
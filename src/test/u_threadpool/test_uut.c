@@ -3,33 +3,87 @@
 #include "test_u_threadpool.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
 
-
+#include "threadpool.h"
 #include "pbs_error.h"
 
-START_TEST(test_one)
-  {
+pthread_mutex_t work_order_mutex = PTHREAD_MUTEX_INITIALIZER;
+std::string     work_order;
+
+void *record_work(
 
+  void *arg)
+
+  {
+  pthread_mutex_lock(&work_order_mutex);
+  work_order += (const char *)arg;
+  pthread_mutex_unlock(&work_order_mutex);
 
+  return(NULL);
   }
-END_TEST
 
-START_TEST(test_two)
+
+
+START_TEST(test_lane_priority)
   {
+  threadpool_t    *tp = NULL;
+  tp_lane_queue_t  stats;
+
+  /* a single static thread, so work runs one item at a time in dequeue order */
+  fail_unless(initialize_threadpool(&tp, 1, 1, -1) == PBSE_NONE);
 
+  fail_unless(enqueue_threadpool_request_lane(record_work, (void *)"b", tp, TP_LANE_BACKGROUND) == 0);
+  fail_unless(enqueue_threadpool_request_lane(record_work, (void *)"m", tp, TP_LANE_MOM_STATUS) == 0);
+  fail_unless(enqueue_threadpool_request(record_work, (void *)"c", tp) == 0);
+  fail_unless(enqueue_threadpool_request_lane(record_work, (void *)"C", tp, TP_LANE_CLIENT) == 0);
+  fail_unless(enqueue_threadpool_request_lane(record_work, (void *)"x", tp, TP_NUM_LANES) == PBSE_BAD_PARAMETER);
+  fail_unless(enqueue_threadpool_request_lane(record_work, (void *)"x", tp, -1) == PBSE_BAD_PARAMETER);
 
+  fail_unless(threadpool_get_lane_stats(tp, TP_LANE_CLIENT, &stats) == PBSE_NONE);
+  fail_unless(stats.depth == 2);
+  fail_unless(stats.max_depth == 2);
+  fail_unless(stats.dequeued == 0);
+  fail_unless(threadpool_get_lane_stats(tp, TP_NUM_LANES, &stats) == PBSE_BAD_PARAMETER);
+
+  start_request_pool(tp);
+
+  for (int i = 0; i < 100; i++)
+    {
+    pthread_mutex_lock(&work_order_mutex);
+    bool done = (work_order.size() == 4);
+    pthread_mutex_unlock(&work_order_mutex);
+
+    if (done)
+      break;
+
+    usleep(50000);
+    }
+
+  fail_unless(work_order == "cCmb", "work ran in order '%s'", work_order.c_str());
+
+  for (int lane = 0; lane < TP_NUM_LANES; lane++)
+    {
+    fail_unless(threadpool_get_lane_stats(tp, lane, &stats) == PBSE_NONE);
+    fail_unless(stats.depth == 0);
+    fail_unless(stats.first == NULL);
+    }
+
+  fail_unless(threadpool_get_lane_stats(tp, TP_LANE_CLIENT, &stats) == PBSE_NONE);
+  fail_unless(stats.dequeued == 2);
+  fail_unless(stats.total_wait_usecs >= stats.max_wait_usecs);
   }
 END_TEST
 
 Suite *u_threadpool_suite(void)
   {
   Suite *s = suite_create("u_threadpool_suite methods");
-  TCase *tc_core = tcase_create("test_one");
-  tcase_add_test(tc_core, test_one);
-  suite_add_tcase(s, tc_core);
-
-  tc_core = tcase_create("test_two");
-  tcase_add_test(tc_core, test_two);
+  TCase *tc_core = tcase_create("test_lane_priority");
+  tcase_add_test(tc_core, test_lane_priority);
+  tcase_set_timeout(tc_core, 30);
   suite_add_tcase(s, tc_core);
 
   return s;